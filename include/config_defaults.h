@@ -45,12 +45,52 @@
 #define WT_PROFINET_TICK_INTERVAL_US 1000   /* PROFINET stack tick rate (microseconds) */
 #define WT_PROFINET_MAX_SLOTS       64      /* Maximum I/O modules supported */
 #define WT_PROFINET_DATA_SIZE       256     /* Maximum data payload size per slot */
+#define WT_PROFINET_PACKED_CHANNELS 0       /* Sensors per packed submodule (0 = one each) */
+#define WT_PROFINET_ALARM_WINDOW_MS 1000    /* Coalescing window per (slot, subslot, type) */
+#define WT_PROFINET_ALARM_RATE      5       /* Sustained alarms/s sent to controller (0 = unlimited) */
+#define WT_PROFINET_ALARM_BURST     10      /* Token bucket depth */
+#define WT_PROFINET_ALARM_AGGREGATE 3       /* Same-type channels folded into one alarm */
 
 /* ============================================================================
  * Database Configuration
  * ============================================================================ */
 #define WT_DATABASE_PATH            "/var/lib/water-treat/water-treat.db"
 #define WT_DATABASE_TIMEOUT_MS      5000    /* SQLite busy timeout */
+#define WT_DATABASE_STMT_CACHE      64      /* Prepared statements kept per connection */
+#define WT_DATABASE_READERS         3       /* Pooled read-only connections */
+#define WT_DATABASE_WRITER_BATCH    64      /* Write requests per group commit */
+#define WT_STORAGE_PROFILE          "sd"    /* sd, emmc or tmpfs (see db_storage.h) */
+#define WT_EVENT_PARTITION_DAYS     7       /* Days per events table (retention granularity) */
+
+/* ============================================================================
+ * Sensor History Storage
+ * ============================================================================ */
+#define WT_HISTORY_BLOCK_BYTES      1024    /* Encoded block size cap (fits one page) */
+#define WT_HISTORY_BLOCK_SPAN_S     21600   /* Longest time one block may cover (6 h) */
+#define WT_HISTORY_PENDING_BLOCKS   64      /* Sealed blocks held while the DB is failing */
+#define WT_HISTORY_CHECKPOINT_S     300     /* Open blocks rewritten at most this often */
+#define WT_HISTORY_PARTITION_DAYS   1       /* Days per history table (retention granularity) */
+#define WT_ROLLUP_PENDING_BUCKETS   4096    /* Closed rollup buckets held while the DB is failing */
+#define WT_ROLLUP_MINUTE_DAYS       14      /* Retention of the 1-minute tier */
+#define WT_ROLLUP_HOUR_DAYS         400     /* Retention of the 1-hour tier */
+#define WT_ROLLUP_DAY_DAYS          3650    /* Retention of the 1-day tier */
+
+/* ============================================================================
+ * History HTTP API (/api/history on the health server)
+ * ============================================================================ */
+#define WT_HISTORY_API_RANGE_S      86400   /* Range when the request gives no start */
+#define WT_HISTORY_API_POINTS       1000    /* Points aimed for when it gives no step */
+#define WT_HISTORY_API_CHUNK_BYTES  4096    /* Response chunk size */
+#define WT_HISTORY_API_SEND_TIMEOUT_S 10    /* A client not reading this long is dropped */
+#define WT_HISTORY_API_WORKERS      2       /* Concurrent requests; below WT_DATABASE_READERS */
+
+/* ============================================================================
+ * Sample Bus Configuration
+ * ============================================================================ */
+#define WT_SAMPLE_BUS_MAX_SUBSCRIBERS 8     /* Concurrent sample consumers */
+#define WT_SAMPLE_BUS_ALARM_DEPTH   1024    /* Alarm evaluator ring (drops oldest) */
+#define WT_SAMPLE_BUS_LOGGER_DEPTH  4096    /* Data logger ring (drops newest) */
+#define WT_SAMPLE_BUS_TUI_DEPTH     256     /* TUI live-value ring (drops oldest) */
 
 /* ============================================================================
  * Logging Configuration
@@ -58,19 +98,55 @@
 #define WT_LOG_LEVEL_DEFAULT        "info"
 #define WT_LOG_BUFFER_SIZE          4096    /* Maximum log message length */
 #define WT_LOG_RETENTION_DAYS       30      /* Days to keep data logs */
+#define WT_LOG_CLEANUP_CHUNK        2000    /* Legacy log rows deleted per transaction */
 
 /* Data logger queue settings */
-#define WT_LOG_QUEUE_SIZE           1000    /* Max pending log entries */
+#define WT_LOG_QUEUE_SIZE           1024    /* Max pending log entries (power of two) */
 #define WT_LOG_BATCH_SIZE           100     /* Entries per write batch */
 #define WT_LOG_REMOTE_BATCH         50      /* Entries per remote upload */
 #define WT_LOG_REMOTE_RETRY_MS      60000   /* Remote retry interval (60 sec) */
 
+/* Store-and-forward spool for remote uploads */
+#define WT_SPOOL_DIR                "/var/lib/water-treat/spool"
+#define WT_SPOOL_SEGMENT_BYTES      (1024 * 1024)   /* Size of each segment file */
+#define WT_SPOOL_MAX_MB             64      /* Backlog cap; oldest segments dropped beyond it */
+
+/* Remote upload protocol */
+#define WT_UPLINK_FORMAT            "json"  /* "json" or "binary" (opt-in, needs a WTB1 receiver) */
+#define WT_UPLINK_COMPRESS          false   /* gzip request bodies (opt-in) */
+#define WT_UPLINK_WINDOW            4       /* Batches in flight */
+#define WT_UPLINK_MAX_WINDOW        32
+#define WT_UPLINK_TIMEOUT_S         10      /* Per batch, including connect */
+#define WT_UPLINK_TOPICS            "batch"     /* MQTT: "batch" or "module" */
+#define WT_UPLINK_TOPIC_PREFIX      "water-treat"
+#define WT_MQTT_PORT                1883
+#define WT_MQTT_VERSION             4       /* 4 = 3.1.1, 5 = MQTT 5 */
+#define WT_MQTT_KEEPALIVE_S         60
+#define WT_MQTT_SESSION_EXPIRY_S    86400   /* MQTT 5: broker keeps the session a day */
+
+/* Historian compression: which logged points are stored and uploaded */
+#define WT_COMPRESSION              "swinging_door"  /* "swinging_door", "deadband" or "off" */
+#define WT_COMPRESSION_DEV          0.0f    /* Reconstruction error bound; 0 drops only exact lines */
+#define WT_COMPRESSION_HEARTBEAT_S  900     /* At least one stored point per sensor this often */
+
 /* ============================================================================
  * Alarm Configuration
  * ============================================================================ */
-#define WT_ALARM_MAX_RULES          256     /* Maximum alarm definitions */
+#ifndef WT_ALARM_MAX_RULES
+#define WT_ALARM_MAX_RULES          256     /* Maximum alarm definitions (per-rule state is static) */
+#endif
+#define WT_ALARM_MAX_ACTIVE         512     /* Active alarms tracked in memory (power of two) */
 #define WT_ALARM_CHECK_INTERVAL_MS  1000    /* Alarm evaluation frequency */
 #define WT_ALARM_HYSTERESIS_PCT     5       /* Default hysteresis percentage */
+#define WT_ALARM_WINDOW_SEC         60      /* Rate/baseline/stale/sigma time constant */
+#define WT_ALARM_TIMER_TICK_MS      100     /* Delay/chatter/shelve timer resolution */
+#define WT_ALARM_TIMER_SLOTS        512     /* Timer wheel slots (power of two) */
+#define WT_ALARM_CHATTER_MAX        16      /* Largest chatter_count honoured */
+#define WT_ALARM_SHELVE_DEFAULT_SEC 3600    /* Shelve duration when none is given */
+#define WT_ALARM_SHELVE_MAX_SEC     (8 * 3600) /* Longest permitted shelve */
+#define WT_ALARM_JOURNAL_DEPTH      1024    /* Pending alarm/event rows before drop */
+#define WT_ALARM_JOURNAL_BATCH      256     /* Max rows per journal transaction */
+#define WT_ALARM_JOURNAL_RETRY_MS   100     /* Backoff after a failed transaction */
 
 /* ============================================================================
  * Actuator/Watchdog Configuration
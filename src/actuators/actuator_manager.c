@@ -303,6 +303,7 @@ static void profinet_disconnect_handler(void *ctx) {
     LOG_WARNING("PROFINET controller disconnected");
 }
 
+/* Runs on the PROFINET dispatch thread - GPIO writes here do not stretch the cycle */
 static void profinet_output_handler(int slot, int subslot,
                                      const uint8_t *data, size_t len, void *ctx) {
     actuator_manager_t *mgr = (actuator_manager_t *)ctx;
@@ -0,0 +1,395 @@
+/**
+ * @file alarm_journal.c
+ * @brief Ordered write-behind journal for alarm and event rows
+ */
+
+#include "alarm_journal.h"
+#include "db/db_events.h"
+#include "db/db_writer.h"
+#include "utils/logger.h"
+#include "config_defaults.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define JOURNAL_QUEUE_SIZE  WT_ALARM_JOURNAL_DEPTH
+#define JOURNAL_BATCH_SIZE  WT_ALARM_JOURNAL_BATCH
+#define JOURNAL_RETRY_MS    WT_ALARM_JOURNAL_RETRY_MS
+#define JOURNAL_STOP_RETRIES 3
+
+typedef enum {
+    JOURNAL_OP_RAISE = 0,
+    JOURNAL_OP_CLEAR,
+    JOURNAL_OP_ACK,
+    JOURNAL_OP_CLEAR_RULE,
+    JOURNAL_OP_EVENT
+} journal_op_t;
+
+typedef struct {
+    journal_op_t op;
+    time_t timestamp;
+    int alarm_id;
+    int rule_id;
+    int module_id;
+    alarm_severity_t severity;
+    float trigger_value;
+    char source[32];
+    char level[16];
+    char user[64];              /* Acknowledged by */
+    char message[256];
+} journal_record_t;
+
+typedef struct {
+    database_t *db;             /* Main connection, used while the writer is stopped */
+
+    /*
+     * FIFO ring. Producers only fill free slots at head; the journal thread
+     * reads committed-pending slots from tail without holding the mutex and
+     * advances tail only after the batch commits.
+     */
+    journal_record_t queue[JOURNAL_QUEUE_SIZE];
+    int queue_head;
+    int queue_tail;
+    int queue_count;
+
+    uint64_t submitted_seq;     /* Records accepted so far */
+    uint64_t committed_seq;     /* Records durable so far */
+    atomic_int next_alarm_id;
+
+    alarm_journal_stats_t stats;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;        /* Records queued / stop requested */
+    pthread_cond_t committed;   /* committed_seq advanced */
+    bool running;
+    bool initialized;
+} alarm_journal_t;
+
+static alarm_journal_t g_journal = {0};
+
+/* ============================================================================
+ * Internal Functions
+ * ============================================================================ */
+
+static result_t write_record(database_t *db, const journal_record_t *rec) {
+    switch (rec->op) {
+        case JOURNAL_OP_RAISE: {
+            db_alarm_history_t alarm = {0};
+            alarm.id = rec->alarm_id;
+            alarm.rule_id = rec->rule_id;
+            alarm.module_id = rec->module_id;
+            alarm.severity = rec->severity;
+            alarm.trigger_value = rec->trigger_value;
+            alarm.raised_time = rec->timestamp;
+            SAFE_STRNCPY(alarm.message, rec->message, sizeof(alarm.message));
+            return db_alarm_insert(db, &alarm);
+        }
+        case JOURNAL_OP_CLEAR:
+            return db_alarm_clear_at(db, rec->alarm_id, rec->timestamp);
+        case JOURNAL_OP_ACK:
+            return db_alarm_acknowledge_at(db, rec->alarm_id, rec->user, rec->timestamp);
+        case JOURNAL_OP_CLEAR_RULE:
+            return db_alarm_clear_by_rule(db, rec->rule_id);
+        case JOURNAL_OP_EVENT:
+            return db_event_insert_at(db, rec->timestamp, rec->source,
+                                      rec->level, rec->message);
+    }
+    return RESULT_INVALID_PARAM;
+}
+
+/**
+ * Write *count records starting at the queue tail (db_writer request).
+ * A record the database refuses for good (duplicate alarm row, alarm
+ * already cleared) is logged and skipped; it would fail identically on
+ * every retry. Any other error undoes the whole batch, which stays queued
+ * and is retried in order, so the database keeps a prefix of the sequence.
+ */
+static result_t write_batch(database_t *db, void *arg) {
+    int count = *(const int *)arg;
+    int idx = g_journal.queue_tail;
+    for (int i = 0; i < count; i++) {
+        const journal_record_t *rec = &g_journal.queue[idx];
+        result_t r = write_record(db, rec);
+        /* Clear/ack of an alarm already cleared elsewhere is not an error */
+        bool benign = r == RESULT_NOT_FOUND &&
+                      (rec->op == JOURNAL_OP_CLEAR || rec->op == JOURNAL_OP_ACK);
+        bool rejected = r == RESULT_ALREADY_EXISTS && rec->op == JOURNAL_OP_RAISE;
+        if (rejected) {
+            LOG_WARNING("Alarm journal: record %d (alarm %d) rejected: %s",
+                        (int)rec->op, rec->alarm_id, result_to_string(r));
+        } else if (r != RESULT_OK && !benign) {
+            return r;
+        }
+        idx = (idx + 1) % JOURNAL_QUEUE_SIZE;
+    }
+    return RESULT_OK;
+}
+
+static void* journal_thread(void *arg) {
+    UNUSED(arg);
+    int consecutive_failures = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&g_journal.mutex);
+        while (g_journal.queue_count == 0 && g_journal.running) {
+            pthread_cond_wait(&g_journal.cond, &g_journal.mutex);
+        }
+        if (g_journal.queue_count == 0) {
+            pthread_mutex_unlock(&g_journal.mutex);
+            break;
+        }
+        /* Everything queued so far goes into one transaction (group commit) */
+        int count = MIN(g_journal.queue_count, JOURNAL_BATCH_SIZE);
+        pthread_mutex_unlock(&g_journal.mutex);
+
+        /* Shares the writer's transaction with whatever else is queued there */
+        result_t r = db_writer_call(g_journal.db, write_batch, &count);
+
+        pthread_mutex_lock(&g_journal.mutex);
+        if (r == RESULT_OK) {
+            g_journal.queue_tail = (g_journal.queue_tail + count) % JOURNAL_QUEUE_SIZE;
+            g_journal.queue_count -= count;
+            g_journal.committed_seq += (uint64_t)count;
+            g_journal.stats.written += (uint64_t)count;
+            g_journal.stats.batches++;
+            if (count > g_journal.stats.max_batch) g_journal.stats.max_batch = count;
+            pthread_cond_broadcast(&g_journal.committed);
+            consecutive_failures = 0;
+        } else {
+            g_journal.stats.failures++;
+            consecutive_failures++;
+        }
+        bool stopping = !g_journal.running;
+        int pending = g_journal.queue_count;
+        pthread_mutex_unlock(&g_journal.mutex);
+
+        if (r != RESULT_OK) {
+            if (stopping && consecutive_failures >= JOURNAL_STOP_RETRIES) {
+                LOG_ERROR("Alarm journal: database unavailable at shutdown, %d records lost", pending);
+                break;
+            }
+            LOG_WARNING("Alarm journal: batch of %d failed, retrying", count);
+            usleep(JOURNAL_RETRY_MS * 1000);
+        }
+    }
+
+    return NULL;
+}
+
+/* Caller holds g_journal.mutex; returns the slot to fill or NULL if full */
+static journal_record_t* reserve_record(journal_op_t op) {
+    if (g_journal.queue_count >= JOURNAL_QUEUE_SIZE) {
+        g_journal.stats.dropped++;
+        return NULL;
+    }
+
+    journal_record_t *rec = &g_journal.queue[g_journal.queue_head];
+    memset(rec, 0, sizeof(*rec));
+    rec->op = op;
+    rec->timestamp = time(NULL);
+    return rec;
+}
+
+/* Caller holds g_journal.mutex */
+static void commit_record(void) {
+    g_journal.queue_head = (g_journal.queue_head + 1) % JOURNAL_QUEUE_SIZE;
+    g_journal.queue_count++;
+    g_journal.submitted_seq++;
+    g_journal.stats.submitted++;
+    pthread_cond_signal(&g_journal.cond);
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+result_t alarm_journal_init(database_t *db) {
+    CHECK_NULL(db);
+    if (g_journal.initialized) return RESULT_OK;
+
+    memset(&g_journal, 0, sizeof(g_journal));
+    g_journal.db = db;
+
+    int next_id = 1;
+    result_t r = db_alarm_next_id(g_journal.db, &next_id);
+    if (r != RESULT_OK) {
+        LOG_ERROR("Alarm journal: cannot read alarm ID sequence");
+        return r;
+    }
+    atomic_store(&g_journal.next_alarm_id, next_id);
+
+    pthread_mutex_init(&g_journal.mutex, NULL);
+    pthread_cond_init(&g_journal.cond, NULL);
+    pthread_cond_init(&g_journal.committed, NULL);
+    g_journal.initialized = true;
+
+    LOG_INFO("Alarm journal initialized (next alarm id %d)", next_id);
+    return RESULT_OK;
+}
+
+result_t alarm_journal_start(void) {
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+    if (g_journal.running) return RESULT_OK;
+
+    g_journal.running = true;
+    if (pthread_create(&g_journal.thread, NULL, journal_thread, NULL) != 0) {
+        LOG_ERROR("Failed to create alarm journal thread");
+        g_journal.running = false;
+        return RESULT_ERROR;
+    }
+    return RESULT_OK;
+}
+
+result_t alarm_journal_stop(void) {
+    if (!g_journal.running) return RESULT_OK;
+
+    pthread_mutex_lock(&g_journal.mutex);
+    g_journal.running = false;
+    pthread_cond_signal(&g_journal.cond);
+    pthread_mutex_unlock(&g_journal.mutex);
+
+    /* Thread exits once the queue is drained */
+    pthread_join(g_journal.thread, NULL);
+    return RESULT_OK;
+}
+
+void alarm_journal_shutdown(void) {
+    if (!g_journal.initialized) return;
+    alarm_journal_stop();
+
+    pthread_cond_destroy(&g_journal.committed);
+    pthread_cond_destroy(&g_journal.cond);
+    pthread_mutex_destroy(&g_journal.mutex);
+    g_journal.initialized = false;
+}
+
+int alarm_journal_alloc_id(void) {
+    return atomic_fetch_add(&g_journal.next_alarm_id, 1);
+}
+
+result_t alarm_journal_raise(const db_alarm_history_t *alarm) {
+    CHECK_NULL(alarm);
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_journal.mutex);
+    journal_record_t *rec = reserve_record(JOURNAL_OP_RAISE);
+    if (!rec) {
+        pthread_mutex_unlock(&g_journal.mutex);
+        LOG_ERROR("Alarm journal full, alarm %d not persisted", alarm->id);
+        return RESULT_BUSY;
+    }
+    rec->alarm_id = alarm->id;
+    rec->rule_id = alarm->rule_id;
+    rec->module_id = alarm->module_id;
+    rec->severity = alarm->severity;
+    rec->trigger_value = alarm->trigger_value;
+    SAFE_STRNCPY(rec->message, alarm->message, sizeof(rec->message));
+    commit_record();
+    pthread_mutex_unlock(&g_journal.mutex);
+    return RESULT_OK;
+}
+
+result_t alarm_journal_clear(int alarm_id) {
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_journal.mutex);
+    journal_record_t *rec = reserve_record(JOURNAL_OP_CLEAR);
+    if (!rec) {
+        pthread_mutex_unlock(&g_journal.mutex);
+        LOG_ERROR("Alarm journal full, clear of alarm %d not persisted", alarm_id);
+        return RESULT_BUSY;
+    }
+    rec->alarm_id = alarm_id;
+    commit_record();
+    pthread_mutex_unlock(&g_journal.mutex);
+    return RESULT_OK;
+}
+
+result_t alarm_journal_acknowledge(int alarm_id, const char *user) {
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_journal.mutex);
+    journal_record_t *rec = reserve_record(JOURNAL_OP_ACK);
+    if (!rec) {
+        pthread_mutex_unlock(&g_journal.mutex);
+        LOG_ERROR("Alarm journal full, acknowledge of alarm %d not persisted", alarm_id);
+        return RESULT_BUSY;
+    }
+    rec->alarm_id = alarm_id;
+    SAFE_STRNCPY(rec->user, user ? user : "operator", sizeof(rec->user));
+    commit_record();
+    pthread_mutex_unlock(&g_journal.mutex);
+    return RESULT_OK;
+}
+
+result_t alarm_journal_clear_rule(int rule_id) {
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_journal.mutex);
+    journal_record_t *rec = reserve_record(JOURNAL_OP_CLEAR_RULE);
+    if (!rec) {
+        pthread_mutex_unlock(&g_journal.mutex);
+        LOG_ERROR("Alarm journal full, clear of rule %d alarms not persisted", rule_id);
+        return RESULT_BUSY;
+    }
+    rec->rule_id = rule_id;
+    commit_record();
+    pthread_mutex_unlock(&g_journal.mutex);
+    return RESULT_OK;
+}
+
+result_t alarm_journal_event(const char *source, const char *level, const char *message) {
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_journal.mutex);
+    journal_record_t *rec = reserve_record(JOURNAL_OP_EVENT);
+    if (!rec) {
+        pthread_mutex_unlock(&g_journal.mutex);
+        return RESULT_BUSY;
+    }
+    SAFE_STRNCPY(rec->source, source ? source : "system", sizeof(rec->source));
+    SAFE_STRNCPY(rec->level, level ? level : "info", sizeof(rec->level));
+    SAFE_STRNCPY(rec->message, message ? message : "", sizeof(rec->message));
+    commit_record();
+    pthread_mutex_unlock(&g_journal.mutex);
+    return RESULT_OK;
+}
+
+result_t alarm_journal_flush(uint32_t timeout_ms) {
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    result_t result = RESULT_OK;
+    pthread_mutex_lock(&g_journal.mutex);
+    uint64_t target = g_journal.submitted_seq;
+    while (g_journal.committed_seq < target) {
+        if (!g_journal.running ||
+            pthread_cond_timedwait(&g_journal.committed, &g_journal.mutex, &deadline) != 0) {
+            result = RESULT_TIMEOUT;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_journal.mutex);
+    return result;
+}
+
+result_t alarm_journal_get_stats(alarm_journal_stats_t *stats) {
+    CHECK_NULL(stats);
+    if (!g_journal.initialized) return RESULT_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_journal.mutex);
+    *stats = g_journal.stats;
+    stats->queue_count = g_journal.queue_count;
+    stats->queue_capacity = JOURNAL_QUEUE_SIZE;
+    pthread_mutex_unlock(&g_journal.mutex);
+    return RESULT_OK;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file alarm_journal.h
+ * @brief Ordered write-behind journal for alarm and event rows
+ *
+ * Alarm state transitions are applied in memory by the caller; the journal
+ * persists them from its own thread so SQLite writes (and WAL fsyncs) never
+ * run on the acquisition path. Records are written strictly in submission
+ * order, batched into one transaction per drain, so after a crash the
+ * database holds a prefix of the submitted sequence.
+ */
+
+#ifndef ALARM_JOURNAL_H
+#define ALARM_JOURNAL_H
+
+#include "common.h"
+#include "db/database.h"
+#include "db/db_alarms.h"
+
+typedef struct {
+    uint64_t submitted;        /* Records accepted */
+    uint64_t written;          /* Records committed */
+    uint64_t dropped;          /* Records rejected, queue full */
+    uint64_t batches;          /* Transactions committed */
+    uint64_t failures;         /* Transactions rolled back (retried) */
+    int queue_count;
+    int queue_capacity;
+    int max_batch;             /* Largest batch committed */
+} alarm_journal_stats_t;
+
+/**
+ * @brief Initialize the journal and seed the alarm ID allocator
+ *
+ * Batches are written through the database writer (db_writer.h), so
+ * they never interleave with other writers' statements; db is used
+ * directly while the writer is not running.
+ */
+result_t alarm_journal_init(database_t *db);
+result_t alarm_journal_start(void);
+
+/**
+ * @brief Stop the journal thread after writing every queued record
+ */
+result_t alarm_journal_stop(void);
+void alarm_journal_shutdown(void);
+
+/**
+ * @brief Allocate the ID the next alarm row will be written with
+ *
+ * IDs are handed out before the insert, so callers can reference an alarm
+ * (clear, callbacks) while its row is still queued.
+ */
+int alarm_journal_alloc_id(void);
+
+/**
+ * @brief Queue an alarm_history insert (alarm->id from alarm_journal_alloc_id())
+ * @return RESULT_OK, RESULT_BUSY if the queue is full
+ */
+result_t alarm_journal_raise(const db_alarm_history_t *alarm);
+
+/**
+ * @brief Queue a clear of a previously raised alarm
+ */
+result_t alarm_journal_clear(int alarm_id);
+
+/**
+ * @brief Queue an acknowledge of a previously raised alarm
+ */
+result_t alarm_journal_acknowledge(int alarm_id, const char *user);
+
+/**
+ * @brief Queue a clear of every open alarm of a rule (rule deleted)
+ *
+ * Written after any raise queued before it, so none is left active.
+ */
+result_t alarm_journal_clear_rule(int rule_id);
+
+/**
+ * @brief Queue an events row, timestamped now
+ */
+result_t alarm_journal_event(const char *source, const char *level, const char *message);
+
+/**
+ * @brief Wait until every record queued before the call is committed
+ * @param timeout_ms Maximum wait
+ * @return RESULT_OK, RESULT_TIMEOUT
+ */
+result_t alarm_journal_flush(uint32_t timeout_ms);
+
+result_t alarm_journal_get_stats(alarm_journal_stats_t *stats);
+
+#endif
@@ -4,47 +4,166 @@
  */
 
 #include "alarm_manager.h"
+#include "alarm_journal.h"
+#include "alarm_timer.h"
 #include "db/db_alarms.h"
 #include "db/db_events.h"
-#include "db/db_modules.h"
+#include "db/db_writer.h"
 #include "actuators/actuator_manager.h"
+#include "sensors/sample_bus.h"
 #include "utils/logger.h"
+#include "config_defaults.h"
 #include <pthread.h>
 #include <math.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdatomic.h>
 #include <unistd.h>
 
 /* External actuator manager for safety interlocks */
 extern actuator_manager_t g_actuator_mgr;
 
-#define MAX_ALARM_RULES 256
+#define MAX_ALARM_RULES WT_ALARM_MAX_RULES
 #define ALARM_CHECK_INTERVAL_MS 1000
 #define CACHE_REFRESH_INTERVAL_MS (5 * 60 * 1000)  /* Safety net: refresh every 5 minutes */
+#define MAX_ACTIVE_ALARMS WT_ALARM_MAX_ACTIVE
+#define ACTIVE_HASH_SIZE (2 * MAX_ACTIVE_ALARMS)  /* Power of two, load <= 50% */
+#define ACTIVE_HASH_MASK (ACTIVE_HASH_SIZE - 1)
+#define SEVERITY_COUNT (ALARM_SEVERITY_CRITICAL + 1)
+#define SIGNAL_MIN_SAMPLES 5    /* Warm-up before windowed conditions may trip */
+#define ALARM_SAMPLE_BATCH 64   /* Bus samples evaluated per wakeup */
+
+/*
+ * Incremental signal statistics for the windowed conditions. Every sum is
+ * exponentially weighted with the rule's window as time constant, so each
+ * sample is an O(1) update and nothing is ever rescanned:
+ *  - regression sums over (t, y), t in seconds relative to the newest
+ *    sample, give the least-squares slope;
+ *  - West's weighted form of Welford's algorithm gives mean (baseline)
+ *    and variance.
+ */
+typedef struct {
+    double s0, st, sy, stt, sty;  /* Weighted regression sums */
+    double mean;
+    double var;
+    double deviation;             /* Sample minus mean before the update */
+    double sigma;                 /* deviation in standard deviations */
+    uint32_t samples;
+    uint64_t last_sample_ms;
+    float flat_ref;               /* Value when the current flat run began */
+    uint64_t flat_since_ms;
+} alarm_signal_t;
+
+/*
+ * Flood damping (ISA-18.2 style). The undamped condition ("raw": tripped
+ * while normal, not yet clearable while in alarm) drives three timers on
+ * a shared wheel instead of per-rule polling:
+ *  - delay: on-delay while normal, off-delay while in alarm; any reversal
+ *    of the raw condition cancels it;
+ *  - chatter: chatter_count onsets within chatter_window_seconds latch the
+ *    alarm (raised once, never cleared) until a full window passes with no
+ *    further onset;
+ *  - shelve: operator shelving, expires back to normal evaluation.
+ */
+typedef enum {
+    TIMER_DELAY = 0,
+    TIMER_CHATTER,
+    TIMER_SHELVE
+} alarm_timer_kind_t;
 
 typedef struct {
     int rule_id;
+    db_alarm_rule_t *rule;        /* Entry in the current index, NULL if dropped */
     float last_value;
     bool in_alarm;
     int active_alarm_id;
     uint64_t last_check_time;
-    float rate_buffer[10];
-    int rate_buffer_idx;
+    alarm_signal_t signal;
+    float metric;                 /* Last evaluated windowed metric */
+
+    bool raw;                     /* Undamped condition at the last evaluation */
+    bool chatter_latched;
+    bool shelved;
+    uint64_t shelved_until_ms;
+    uint64_t onsets[WT_ALARM_CHATTER_MAX];  /* Ring of recent onset times */
+    int onset_pos;
+    alarm_timer_t delay_timer;
+    alarm_timer_t chatter_timer;
+    alarm_timer_t shelve_timer;
 } alarm_rule_state_t;
 
+/*
+ * Rule index
+ *
+ * Immutable snapshot of all rules, sorted by module_id, with one bucket per
+ * module for binary search. Sample-path evaluation reads the current
+ * snapshot without touching SQLite or allocating. Rule edits build a new
+ * snapshot and publish it with a single pointer swap (RCU-style): readers
+ * register in one of two reader counters selected by the generation
+ * parity, and the writer frees the old snapshot only after the counter of
+ * the previous generation has drained.
+ */
+typedef struct {
+    int module_id;
+    int first;                      /* Index into rules[] */
+    int count;
+} alarm_module_bucket_t;
+
+typedef struct {
+    db_alarm_rule_t *rules;         /* Sorted by module_id */
+    alarm_rule_state_t **states;    /* Per rule, resolved at build time */
+    int rule_count;
+    alarm_module_bucket_t *buckets; /* Sorted by module_id */
+    int bucket_count;
+} alarm_rule_index_t;
+
+/*
+ * Active alarm table
+ *
+ * Every alarm in state active or acknowledged, kept densely in entries[]
+ * with an open-addressing alarm_id -> entry index. Counters are atomics so
+ * count queries (LED refresh on every sample, status pages, health) are a
+ * single load. Seeded from the DB at init, then maintained on raise, ack
+ * and clear; the journal keeps the DB in step.
+ */
+typedef struct {
+    db_alarm_history_t entries[MAX_ACTIVE_ALARMS];
+    int count;
+    int hash[ACTIVE_HASH_SIZE];     /* Entry index + 1, 0 = empty */
+    atomic_int total;
+    atomic_int by_severity[SEVERITY_COUNT];
+    pthread_mutex_t mutex;
+} alarm_active_table_t;
+
 typedef struct {
     database_t *db;
     alarm_rule_state_t states[MAX_ALARM_RULES];
     int state_count;
 
-    /* Cached alarm rules - avoids DB query every check cycle */
-    db_alarm_rule_t *cached_rules;
-    int cached_rule_count;
-    bool cache_dirty;  /* Set true when rules change, triggers refresh */
-    uint64_t last_cache_refresh;  /* Timestamp for periodic refresh safety net */
+    /* Rule index - read lock-free, rebuilt on rule edits */
+    _Atomic(alarm_rule_index_t *) index;
+    atomic_uint index_gen;
+    atomic_int index_readers[2];
+    pthread_mutex_t rebuild_mutex;  /* Serializes rebuilds */
+    uint64_t last_index_rebuild;    /* Timestamp for periodic refresh safety net */
+
+    alarm_active_table_t active;
+
+    alarm_timer_wheel_t wheel;      /* Guarded by mutex */
+    int shelved_count;
+    uint64_t chatter_latches;
+    uint64_t timers_fired;
 
     /* Performance metrics */
-    uint64_t cache_hits;      /* Checks using cached rules */
-    uint64_t cache_refreshes; /* Times cache was refreshed from DB */
-    uint64_t total_checks;    /* Total rule checks performed */
+    uint64_t cache_hits;      /* Check cycles using the current index */
+    atomic_uint_least64_t cache_refreshes; /* Index rebuilds from DB */
+    uint64_t total_checks;    /* Polling thread rule checks */
+    atomic_uint_least64_t evaluations;     /* Sample-path rule evaluations */
+    uint64_t rate_last_count;
+    uint64_t rate_last_ms;
+    double evaluations_per_sec;
+
+    sample_subscriber_t *samples;   /* Scan output; drained by the check thread */
 
     pthread_t check_thread;
     pthread_mutex_t mutex;
@@ -62,41 +181,290 @@ static alarm_manager_t g_alarm_mgr = {0};
  * Internal Functions
  * ========================================================================== */
 
+static int index_read_lock(void) {
+    for (;;) {
+        unsigned int gen = atomic_load(&g_alarm_mgr.index_gen);
+        int parity = (int)(gen & 1u);
+        atomic_fetch_add(&g_alarm_mgr.index_readers[parity], 1);
+        if (atomic_load(&g_alarm_mgr.index_gen) == gen) return parity;
+        /* Writer flipped generations meanwhile: register in the new one */
+        atomic_fetch_sub(&g_alarm_mgr.index_readers[parity], 1);
+    }
+}
+
+static void index_read_unlock(int parity) {
+    atomic_fetch_sub(&g_alarm_mgr.index_readers[parity], 1);
+}
+
+/* Wait until no reader can still hold the previously published index */
+static void index_synchronize(void) {
+    unsigned int gen = atomic_fetch_add(&g_alarm_mgr.index_gen, 1);
+    int old = (int)(gen & 1u);
+    while (atomic_load(&g_alarm_mgr.index_readers[old]) > 0) {
+        sched_yield();
+    }
+}
+
+static void index_free(alarm_rule_index_t *index) {
+    if (!index) return;
+    free(index->rules);
+    free(index->states);
+    free(index->buckets);
+    free(index);
+}
+
+static const alarm_module_bucket_t* index_find_module(const alarm_rule_index_t *index, int module_id) {
+    int lo = 0, hi = index->bucket_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int m = index->buckets[mid].module_id;
+        if (m == module_id) return &index->buckets[mid];
+        if (m < module_id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return NULL;
+}
+
+static int compare_rule_module(const void *a, const void *b) {
+    const db_alarm_rule_t *ra = a, *rb = b;
+    if (ra->module_id != rb->module_id) return ra->module_id < rb->module_id ? -1 : 1;
+    return (ra->id > rb->id) - (ra->id < rb->id);
+}
+
+static alarm_rule_state_t* find_state(int rule_id);
+static alarm_rule_state_t* get_or_create_state(int rule_id);
+
 /**
- * Refresh the cached alarm rules from database.
- * Called when cache_dirty is true or periodically as safety net.
- * Caller must hold mutex.
+ * Rebuild the rule index from the database and publish it.
+ * Must not be called with g_alarm_mgr.mutex held.
  */
-static void refresh_rule_cache(void) {
-    if (g_alarm_mgr.cached_rules) {
-        free(g_alarm_mgr.cached_rules);
-        g_alarm_mgr.cached_rules = NULL;
-        g_alarm_mgr.cached_rule_count = 0;
+static result_t rebuild_rule_index(void) {
+    db_alarm_rule_t *rules = NULL;
+    int count = 0;
+
+    pthread_mutex_lock(&g_alarm_mgr.rebuild_mutex);
+
+    /* Pooled read connection: never queued behind journal writes */
+    database_t *reader = db_reader_acquire(g_alarm_mgr.db);
+    result_t r = db_alarm_rule_list(reader, &rules, &count);
+    db_reader_release(reader);
+    if (r != RESULT_OK) {
+        pthread_mutex_unlock(&g_alarm_mgr.rebuild_mutex);
+        LOG_ERROR("Failed to load alarm rules: %s", result_to_string(r));
+        return r;
+    }
+
+    alarm_rule_index_t *index = calloc(1, sizeof(*index));
+    if (!index) {
+        free(rules);
+        pthread_mutex_unlock(&g_alarm_mgr.rebuild_mutex);
+        return RESULT_NO_MEMORY;
+    }
+    index->rules = rules;
+    index->rule_count = count;
+
+    if (count > 0) {
+        qsort(rules, (size_t)count, sizeof(*rules), compare_rule_module);
+        index->states = calloc((size_t)count, sizeof(*index->states));
+        index->buckets = calloc((size_t)count, sizeof(*index->buckets));
+        if (!index->states || !index->buckets) {
+            index_free(index);
+            pthread_mutex_unlock(&g_alarm_mgr.rebuild_mutex);
+            return RESULT_NO_MEMORY;
+        }
+
+        for (int i = 0; i < count; i++) {
+            alarm_module_bucket_t *b = index->bucket_count > 0 ?
+                &index->buckets[index->bucket_count - 1] : NULL;
+            if (!b || b->module_id != rules[i].module_id) {
+                b = &index->buckets[index->bucket_count++];
+                b->module_id = rules[i].module_id;
+                b->first = i;
+            }
+            b->count++;
+        }
+    }
+
+    /* Resolve per-rule state once, so evaluation never searches for it */
+    pthread_mutex_lock(&g_alarm_mgr.mutex);
+    for (int i = 0; i < g_alarm_mgr.state_count; i++) {
+        g_alarm_mgr.states[i].rule = NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        index->states[i] = get_or_create_state(rules[i].id);
+        if (index->states[i]) index->states[i]->rule = &rules[i];
     }
+    alarm_rule_index_t *old = atomic_exchange(&g_alarm_mgr.index, index);
+    g_alarm_mgr.last_index_rebuild = get_time_ms();
+    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+
+    index_synchronize();
+    index_free(old);
+    atomic_fetch_add_explicit(&g_alarm_mgr.cache_refreshes, 1, memory_order_relaxed);
+
+    pthread_mutex_unlock(&g_alarm_mgr.rebuild_mutex);
 
-    db_alarm_rule_list(g_alarm_mgr.db, &g_alarm_mgr.cached_rules, &g_alarm_mgr.cached_rule_count);
-    g_alarm_mgr.cache_dirty = false;
-    g_alarm_mgr.last_cache_refresh = get_time_ms();
+    LOG_DEBUG("Alarm rule index rebuilt: %d rules across %d modules", count, index->bucket_count);
+    return RESULT_OK;
 }
 
 /**
- * Check if cache needs refresh (dirty or periodic timeout)
+ * Periodic safety net: catches rule changes made directly in the DB
  */
-static bool cache_needs_refresh(void) {
-    if (g_alarm_mgr.cache_dirty || !g_alarm_mgr.cached_rules) {
-        return true;
-    }
-    /* Safety net: periodic refresh catches external DB modifications */
+static bool index_needs_refresh(void) {
+    if (!atomic_load(&g_alarm_mgr.index)) return true;
     uint64_t now = get_time_ms();
-    return (now - g_alarm_mgr.last_cache_refresh) >= CACHE_REFRESH_INTERVAL_MS;
+    return (now - g_alarm_mgr.last_index_rebuild) >= CACHE_REFRESH_INTERVAL_MS;
+}
+
+static int severity_index(alarm_severity_t severity) {
+    return (severity >= ALARM_SEVERITY_LOW && severity <= ALARM_SEVERITY_CRITICAL) ?
+           (int)severity : (int)ALARM_SEVERITY_LOW;
+}
+
+static int active_hash(int alarm_id) {
+    return (int)(((uint32_t)alarm_id * 2654435761u) & ACTIVE_HASH_MASK);
+}
+
+/* Caller holds active.mutex; returns the hash slot holding alarm_id or -1 */
+static int active_find_slot(int alarm_id) {
+    alarm_active_table_t *t = &g_alarm_mgr.active;
+    for (int i = active_hash(alarm_id); t->hash[i] != 0; i = (i + 1) & ACTIVE_HASH_MASK) {
+        if (t->entries[t->hash[i] - 1].id == alarm_id) return i;
+    }
+    return -1;
+}
+
+/* Caller holds active.mutex; backward-shift delete keeps probe chains intact */
+static void active_hash_delete(int slot) {
+    alarm_active_table_t *t = &g_alarm_mgr.active;
+    int hole = slot;
+    int i = slot;
+
+    t->hash[hole] = 0;
+    for (;;) {
+        i = (i + 1) & ACTIVE_HASH_MASK;
+        if (t->hash[i] == 0) return;
+        int home = active_hash(t->entries[t->hash[i] - 1].id);
+        /* Entry stays if its home lies cyclically in (hole, i] */
+        bool stays = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!stays) {
+            t->hash[hole] = t->hash[i];
+            t->hash[i] = 0;
+            hole = i;
+        }
+    }
+}
+
+static void active_insert(const db_alarm_history_t *alarm) {
+    alarm_active_table_t *t = &g_alarm_mgr.active;
+
+    pthread_mutex_lock(&t->mutex);
+    if (active_find_slot(alarm->id) >= 0) {
+        pthread_mutex_unlock(&t->mutex);
+        return;
+    }
+    if (t->count >= MAX_ACTIVE_ALARMS) {
+        pthread_mutex_unlock(&t->mutex);
+        LOG_ERROR("LIMIT REACHED: Maximum active alarms (%d), alarm %d not tracked",
+                  MAX_ACTIVE_ALARMS, alarm->id);
+        return;
+    }
+
+    int idx = t->count++;
+    t->entries[idx] = *alarm;
+    int i = active_hash(alarm->id);
+    while (t->hash[i] != 0) i = (i + 1) & ACTIVE_HASH_MASK;
+    t->hash[i] = idx + 1;
+
+    atomic_fetch_add(&t->total, 1);
+    atomic_fetch_add(&t->by_severity[severity_index(alarm->severity)], 1);
+    pthread_mutex_unlock(&t->mutex);
+}
+
+static void active_remove(int alarm_id) {
+    alarm_active_table_t *t = &g_alarm_mgr.active;
+
+    pthread_mutex_lock(&t->mutex);
+    int slot = active_find_slot(alarm_id);
+    if (slot < 0) {
+        pthread_mutex_unlock(&t->mutex);
+        return;
+    }
+
+    int idx = t->hash[slot] - 1;
+    atomic_fetch_sub(&t->total, 1);
+    atomic_fetch_sub(&t->by_severity[severity_index(t->entries[idx].severity)], 1);
+    active_hash_delete(slot);
+
+    /* Keep entries[] dense: move the last entry into the freed index */
+    int last = --t->count;
+    if (idx != last) {
+        t->entries[idx] = t->entries[last];
+        t->hash[active_find_slot(t->entries[idx].id)] = idx + 1;
+    }
+    pthread_mutex_unlock(&t->mutex);
+}
+
+static result_t active_acknowledge(int alarm_id, const char *user) {
+    alarm_active_table_t *t = &g_alarm_mgr.active;
+    result_t result = RESULT_NOT_FOUND;
+
+    pthread_mutex_lock(&t->mutex);
+    int slot = active_find_slot(alarm_id);
+    if (slot >= 0) {
+        db_alarm_history_t *alarm = &t->entries[t->hash[slot] - 1];
+        if (alarm->state == ALARM_STATE_ACTIVE) {
+            alarm->state = ALARM_STATE_ACKNOWLEDGED;
+            alarm->acknowledged_time = time(NULL);
+            SAFE_STRNCPY(alarm->acknowledged_by, user ? user : "operator",
+                         sizeof(alarm->acknowledged_by));
+            result = RESULT_OK;
+        }
+    }
+    pthread_mutex_unlock(&t->mutex);
+
+    if (result == RESULT_OK) {
+        LOG_INFO("Alarm %d acknowledged by %s", alarm_id, user ? user : "operator");
+        alarm_journal_acknowledge(alarm_id, user);
+    }
+    return result;
 }
 
 /**
- * Mark cache as dirty - triggers refresh on next check cycle.
- * Used when rules are created, deleted, or enabled/disabled.
+ * Seed the active table from the DB and mark the owning rules in alarm,
+ * so a restart neither forgets nor re-raises standing alarms.
  */
-static void invalidate_rule_cache(void) {
-    g_alarm_mgr.cache_dirty = true;
+static void reconcile_active_alarms(void) {
+    db_alarm_history_t *alarms = NULL;
+    int count = 0;
+
+    database_t *reader = db_reader_acquire(g_alarm_mgr.db);
+    result_t r = db_alarm_list_active(reader, &alarms, &count);
+    db_reader_release(reader);
+    if (r != RESULT_OK || !alarms) return;
+
+    pthread_mutex_lock(&g_alarm_mgr.mutex);
+    for (int i = 0; i < count; i++) {
+        active_insert(&alarms[i]);
+        alarm_rule_state_t *state = find_state(alarms[i].rule_id);
+        if (state && !state->in_alarm) {
+            state->in_alarm = true;
+            state->raw = true;
+            state->active_alarm_id = alarms[i].id;
+        }
+    }
+    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+    free(alarms);
+
+    LOG_INFO("Reconciled %d active alarms from database", count);
+}
+
+static int compare_active(const void *a, const void *b) {
+    const db_alarm_history_t *x = a, *y = b;
+    if (x->severity != y->severity) return x->severity > y->severity ? -1 : 1;
+    if (x->raised_time != y->raised_time) return x->raised_time > y->raised_time ? -1 : 1;
+    return (y->id > x->id) - (y->id < x->id);
 }
 
 static alarm_rule_state_t* find_state(int rule_id) {
@@ -110,29 +478,153 @@ static alarm_rule_state_t* get_or_create_state(int rule_id) {
     alarm_rule_state_t *state = find_state(rule_id);
     if (state) return state;
 
-    if (g_alarm_mgr.state_count >= MAX_ALARM_RULES) {
+    /* Reuse slots of deleted rules first; slots never move (index holds pointers) */
+    for (int i = 0; i < g_alarm_mgr.state_count; i++) {
+        if (g_alarm_mgr.states[i].rule_id == 0) {
+            state = &g_alarm_mgr.states[i];
+            break;
+        }
+    }
+
+    if (!state && g_alarm_mgr.state_count >= MAX_ALARM_RULES) {
         LOG_ERROR("LIMIT REACHED: Maximum alarm rules (%d) exceeded. "
                   "Cannot track state for rule %d. Delete unused rules or increase MAX_ALARM_RULES.",
                   MAX_ALARM_RULES, rule_id);
         return NULL;
     }
 
-    /* Warn at 80% capacity */
-    int warning_threshold = MAX_ALARM_RULES * 80 / 100;
-    if (g_alarm_mgr.state_count >= warning_threshold) {
-        LOG_WARNING("Alarm rules approaching limit: %d/%d (%.0f%% used)",
-                    g_alarm_mgr.state_count + 1, MAX_ALARM_RULES,
-                    100.0f * (g_alarm_mgr.state_count + 1) / MAX_ALARM_RULES);
+    if (!state) {
+        /* Warn at 80% capacity */
+        int warning_threshold = MAX_ALARM_RULES * 80 / 100;
+        if (g_alarm_mgr.state_count >= warning_threshold) {
+            LOG_WARNING("Alarm rules approaching limit: %d/%d (%.0f%% used)",
+                        g_alarm_mgr.state_count + 1, MAX_ALARM_RULES,
+                        100.0f * (g_alarm_mgr.state_count + 1) / MAX_ALARM_RULES);
+        }
+        state = &g_alarm_mgr.states[g_alarm_mgr.state_count++];
     }
 
-    state = &g_alarm_mgr.states[g_alarm_mgr.state_count++];
     memset(state, 0, sizeof(*state));
     state->rule_id = rule_id;
     state->last_value = NAN;
+    alarm_timer_init(&state->delay_timer, TIMER_DELAY);
+    alarm_timer_init(&state->chatter_timer, TIMER_CHATTER);
+    alarm_timer_init(&state->shelve_timer, TIMER_SHELVE);
     return state;
 }
 
-static bool check_condition(db_alarm_rule_t *rule, float value, float hysteresis) {
+/* Free a slot in place; its timers must leave the wheel first */
+static void release_state(alarm_rule_state_t *state) {
+    alarm_timer_cancel(&g_alarm_mgr.wheel, &state->delay_timer);
+    alarm_timer_cancel(&g_alarm_mgr.wheel, &state->chatter_timer);
+    alarm_timer_cancel(&g_alarm_mgr.wheel, &state->shelve_timer);
+    if (state->shelved) g_alarm_mgr.shelved_count--;
+    memset(state, 0, sizeof(*state));
+}
+
+static alarm_rule_state_t* timer_owner(alarm_timer_t *timer) {
+    size_t offset;
+    switch (timer->kind) {
+        case TIMER_CHATTER: offset = offsetof(alarm_rule_state_t, chatter_timer); break;
+        case TIMER_SHELVE:  offset = offsetof(alarm_rule_state_t, shelve_timer); break;
+        default:            offset = offsetof(alarm_rule_state_t, delay_timer); break;
+    }
+    return (alarm_rule_state_t*)((char*)timer - offset);
+}
+
+static double rule_window_s(const db_alarm_rule_t *rule) {
+    return rule->window_seconds > 0 ? (double)rule->window_seconds : (double)WT_ALARM_WINDOW_SEC;
+}
+
+static bool is_windowed(alarm_condition_t condition) {
+    return condition == ALARM_CONDITION_RATE_OF_CHANGE || condition == ALARM_CONDITION_DEVIATION ||
+           condition == ALARM_CONDITION_STALE || condition == ALARM_CONDITION_SIGMA;
+}
+
+/* Fold one fresh sample into the rule's statistics */
+static void signal_update(const db_alarm_rule_t *rule, alarm_signal_t *sig, float value, uint64_t now) {
+    if (sig->samples == 0) {
+        memset(sig, 0, sizeof(*sig));
+        sig->s0 = 1.0;
+        sig->sy = value;
+        sig->mean = value;
+        sig->flat_ref = value;
+        sig->flat_since_ms = now;
+        sig->last_sample_ms = now;
+        sig->samples = 1;
+        return;
+    }
+
+    double dt = now > sig->last_sample_ms ? (double)(now - sig->last_sample_ms) / 1000.0 : 0.0;
+    double decay = exp(-dt / rule_window_s(rule));
+
+    /* Deviation is judged against the baseline before this sample joins it */
+    sig->deviation = value - sig->mean;
+    sig->sigma = sig->var > 0.0 ? sig->deviation / sqrt(sig->var) : 0.0;
+
+    /* Shift existing points dt seconds into the past, decay, add (0, value) */
+    double st = sig->st - dt * sig->s0;
+    sig->stt = decay * (sig->stt - 2.0 * dt * sig->st + dt * dt * sig->s0);
+    sig->sty = decay * (sig->sty - dt * sig->sy);
+    sig->st = decay * st;
+    sig->sy = decay * sig->sy + value;
+    sig->s0 = decay * sig->s0 + 1.0;
+
+    double alpha = 1.0 - decay;
+    double diff = value - sig->mean;
+    double incr = alpha * diff;
+    sig->mean += incr;
+    sig->var = (1.0 - alpha) * (sig->var + diff * incr);
+
+    float tolerance = rule->threshold_low > 0.0f ? rule->threshold_low : 0.0f;
+    if (fabsf(value - sig->flat_ref) > tolerance) {
+        sig->flat_ref = value;
+        sig->flat_since_ms = now;
+    }
+
+    sig->last_sample_ms = now;
+    if (sig->samples < UINT32_MAX) sig->samples++;
+}
+
+/* Least-squares slope in units per minute */
+static double signal_slope(const alarm_signal_t *sig) {
+    double denom = sig->s0 * sig->stt - sig->st * sig->st;
+    if (fabs(denom) < 1e-12) return 0.0;
+    return (sig->s0 * sig->sty - sig->st * sig->sy) / denom * 60.0;
+}
+
+/* Current metric of a windowed condition; false while still warming up */
+static bool signal_metric(const db_alarm_rule_t *rule, const alarm_signal_t *sig,
+                          uint64_t now, double *metric) {
+    switch (rule->condition) {
+        case ALARM_CONDITION_RATE_OF_CHANGE:
+            if (sig->samples < SIGNAL_MIN_SAMPLES) return false;
+            *metric = signal_slope(sig);
+            return true;
+        case ALARM_CONDITION_DEVIATION:
+            if (sig->samples < SIGNAL_MIN_SAMPLES) return false;
+            *metric = fabs(sig->deviation);
+            return true;
+        case ALARM_CONDITION_SIGMA:
+            if (sig->samples < SIGNAL_MIN_SAMPLES) return false;
+            *metric = fabs(sig->sigma);
+            return true;
+        case ALARM_CONDITION_STALE:
+            if (sig->samples == 0) return false;
+            *metric = now > sig->flat_since_ms ? (double)(now - sig->flat_since_ms) / 1000.0 : 0.0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Lower limit of a rate band: the rule's low if set below zero, else -high */
+static float rate_low(const db_alarm_rule_t *rule) {
+    return rule->threshold_low < 0.0f ? rule->threshold_low : -rule->threshold_high;
+}
+
+static bool check_condition(db_alarm_rule_t *rule, alarm_rule_state_t *state, float value, float hysteresis) {
+    double m;
     switch (rule->condition) {
         case ALARM_CONDITION_ABOVE_THRESHOLD:
             return value > (rule->threshold_high - hysteresis);
@@ -141,12 +633,26 @@ static bool check_condition(db_alarm_rule_t *rule, float value, float hysteresis
         case ALARM_CONDITION_OUT_OF_RANGE:
             return value > (rule->threshold_high - hysteresis) || 
                    value < (rule->threshold_low + hysteresis);
+        case ALARM_CONDITION_RATE_OF_CHANGE:
+            if (!signal_metric(rule, &state->signal, get_time_ms(), &m)) return false;
+            state->metric = (float)m;
+            return m > rule->threshold_high || m < rate_low(rule);
+        case ALARM_CONDITION_DEVIATION:
+        case ALARM_CONDITION_SIGMA:
+            if (!signal_metric(rule, &state->signal, get_time_ms(), &m)) return false;
+            state->metric = (float)m;
+            return m > rule->threshold_high;
+        case ALARM_CONDITION_STALE:
+            if (!signal_metric(rule, &state->signal, get_time_ms(), &m)) return false;
+            state->metric = (float)m;
+            return m >= rule_window_s(rule);
         default:
             return false;
     }
 }
 
-static bool check_clear_condition(db_alarm_rule_t *rule, float value, float hysteresis) {
+static bool check_clear_condition(db_alarm_rule_t *rule, alarm_rule_state_t *state, float value, float hysteresis) {
+    double m;
     switch (rule->condition) {
         case ALARM_CONDITION_ABOVE_THRESHOLD:
             return value < (rule->threshold_high - hysteresis);
@@ -155,6 +661,17 @@ static bool check_clear_condition(db_alarm_rule_t *rule, float value, float hyst
         case ALARM_CONDITION_OUT_OF_RANGE:
             return value < (rule->threshold_high - hysteresis) && 
                    value > (rule->threshold_low + hysteresis);
+        case ALARM_CONDITION_RATE_OF_CHANGE:
+            if (!signal_metric(rule, &state->signal, get_time_ms(), &m)) return false;
+            return m < rule->threshold_high - hysteresis && m > rate_low(rule) + hysteresis;
+        case ALARM_CONDITION_DEVIATION:
+        case ALARM_CONDITION_SIGMA:
+            if (!signal_metric(rule, &state->signal, get_time_ms(), &m)) return false;
+            /* Band on the limit itself; the low threshold is not used here */
+            return m < rule->threshold_high * (1.0f - rule->hysteresis_percent / 100.0f);
+        case ALARM_CONDITION_STALE:
+            if (!signal_metric(rule, &state->signal, get_time_ms(), &m)) return false;
+            return m < rule_window_s(rule);
         default:
             return true;
     }
@@ -180,68 +697,99 @@ static void raise_alarm(db_alarm_rule_t *rule, alarm_rule_state_t *state, float
             snprintf(alarm.message, sizeof(alarm.message), 
                      "%s: %.2f out of range [%.2f, %.2f]", rule->name, value, rule->threshold_low, rule->threshold_high);
             break;
+        case ALARM_CONDITION_RATE_OF_CHANGE:
+            snprintf(alarm.message, sizeof(alarm.message),
+                     "%s: rate %.3f/min outside [%.3f, %.3f] at %.2f", rule->name, state->metric,
+                     rate_low(rule), rule->threshold_high, value);
+            break;
+        case ALARM_CONDITION_DEVIATION:
+            snprintf(alarm.message, sizeof(alarm.message),
+                     "%s: %.2f deviates %.2f from baseline %.2f", rule->name, value,
+                     state->metric, state->signal.mean);
+            break;
+        case ALARM_CONDITION_STALE:
+            snprintf(alarm.message, sizeof(alarm.message),
+                     "%s: value flat at %.2f for %.0f s", rule->name, value, state->metric);
+            break;
+        case ALARM_CONDITION_SIGMA:
+            snprintf(alarm.message, sizeof(alarm.message),
+                     "%s: %.2f is %.1f sigma from mean %.2f", rule->name, value,
+                     state->metric, state->signal.mean);
+            break;
         default:
             snprintf(alarm.message, sizeof(alarm.message), "%s: Alarm triggered", rule->name);
     }
     
-    int alarm_id;
-    if (db_alarm_raise(g_alarm_mgr.db, &alarm, &alarm_id) == RESULT_OK) {
-        state->in_alarm = true;
-        state->active_alarm_id = alarm_id;
-        db_event_insert(g_alarm_mgr.db, "alarm", "warning", alarm.message);
-
-        /* Execute safety interlock if configured */
-        if (rule->interlock_enabled && rule->interlock_slot > 0) {
-            actuator_state_t act_state;
-            uint8_t pwm_duty = rule->interlock_pwm_duty;
-
-            switch (rule->interlock_action) {
-                case INTERLOCK_ACTION_OFF:
-                    act_state = ACTUATOR_STATE_OFF;
-                    pwm_duty = 0;
-                    break;
-                case INTERLOCK_ACTION_ON:
-                    act_state = ACTUATOR_STATE_ON;
-                    pwm_duty = 100;
-                    break;
-                case INTERLOCK_ACTION_PWM:
-                    act_state = ACTUATOR_STATE_ON;
-                    /* pwm_duty already set from rule */
-                    break;
-                default:
-                    act_state = ACTUATOR_STATE_OFF;
-                    pwm_duty = 0;
-            }
-
-            if (actuator_manager_manual_set(&g_actuator_mgr, rule->interlock_slot,
-                                            act_state, pwm_duty) == RESULT_OK) {
-                LOG_WARNING("INTERLOCK: Alarm '%s' forcing slot %d to %s (safety override)",
-                           rule->name, rule->interlock_slot,
-                           act_state == ACTUATOR_STATE_OFF ? "OFF" : "ON");
-
-                char interlock_msg[256];
-                snprintf(interlock_msg, sizeof(interlock_msg),
-                        "Safety interlock: Slot %d forced %s by alarm '%s'",
-                        rule->interlock_slot,
-                        act_state == ACTUATOR_STATE_OFF ? "OFF" : "ON",
-                        rule->name);
-                db_event_insert(g_alarm_mgr.db, "interlock", "critical", interlock_msg);
-            }
+    /*
+     * State and interlock take effect now; the rows are persisted in order
+     * by the journal thread under an ID allocated up front.
+     */
+    alarm_timer_cancel(&g_alarm_mgr.wheel, &state->delay_timer);
+    alarm.id = alarm_journal_alloc_id();
+    alarm.state = ALARM_STATE_ACTIVE;
+    alarm.raised_time = time(NULL);
+    state->in_alarm = true;
+    state->active_alarm_id = alarm.id;
+    LOG_WARNING("Alarm raised: %s (id=%d, severity=%d)", alarm.message, alarm.id, alarm.severity);
+    active_insert(&alarm);
+    alarm_journal_raise(&alarm);
+    alarm_journal_event("alarm", "warning", alarm.message);
+
+    /* Execute safety interlock if configured */
+    if (rule->interlock_enabled && rule->interlock_slot > 0) {
+        actuator_state_t act_state;
+        uint8_t pwm_duty = rule->interlock_pwm_duty;
+
+        switch (rule->interlock_action) {
+            case INTERLOCK_ACTION_OFF:
+                act_state = ACTUATOR_STATE_OFF;
+                pwm_duty = 0;
+                break;
+            case INTERLOCK_ACTION_ON:
+                act_state = ACTUATOR_STATE_ON;
+                pwm_duty = 100;
+                break;
+            case INTERLOCK_ACTION_PWM:
+                act_state = ACTUATOR_STATE_ON;
+                /* pwm_duty already set from rule */
+                break;
+            default:
+                act_state = ACTUATOR_STATE_OFF;
+                pwm_duty = 0;
         }
 
-        if (g_alarm_mgr.on_alarm_raised) {
-            g_alarm_mgr.on_alarm_raised(&alarm, g_alarm_mgr.callback_ctx);
+        if (actuator_manager_manual_set(&g_actuator_mgr, rule->interlock_slot,
+                                        act_state, pwm_duty) == RESULT_OK) {
+            LOG_WARNING("INTERLOCK: Alarm '%s' forcing slot %d to %s (safety override)",
+                       rule->name, rule->interlock_slot,
+                       act_state == ACTUATOR_STATE_OFF ? "OFF" : "ON");
+
+            char interlock_msg[256];
+            snprintf(interlock_msg, sizeof(interlock_msg),
+                    "Safety interlock: Slot %d forced %s by alarm '%s'",
+                    rule->interlock_slot,
+                    act_state == ACTUATOR_STATE_OFF ? "OFF" : "ON",
+                    rule->name);
+            alarm_journal_event("interlock", "critical", interlock_msg);
         }
     }
+
+    if (g_alarm_mgr.on_alarm_raised) {
+        g_alarm_mgr.on_alarm_raised(&alarm, g_alarm_mgr.callback_ctx);
+    }
 }
 
 static void clear_alarm(db_alarm_rule_t *rule, alarm_rule_state_t *state) {
+    alarm_timer_cancel(&g_alarm_mgr.wheel, &state->delay_timer);
+
     if (state->active_alarm_id > 0) {
-        db_alarm_clear(g_alarm_mgr.db, state->active_alarm_id);
+        LOG_INFO("Alarm %d cleared", state->active_alarm_id);
+        active_remove(state->active_alarm_id);
+        alarm_journal_clear(state->active_alarm_id);
 
         char msg[256];
         snprintf(msg, sizeof(msg), "%s: Alarm cleared", rule->name);
-        db_event_insert(g_alarm_mgr.db, "alarm", "info", msg);
+        alarm_journal_event("alarm", "info", msg);
 
         /* Release safety interlock if configured */
         if (rule->interlock_enabled && rule->interlock_slot > 0 && rule->release_on_clear) {
@@ -256,7 +804,7 @@ static void clear_alarm(db_alarm_rule_t *rule, alarm_rule_state_t *state) {
                 snprintf(release_msg, sizeof(release_msg),
                         "Safety interlock released: Slot %d returned to controller (alarm '%s' cleared)",
                         rule->interlock_slot, rule->name);
-                db_event_insert(g_alarm_mgr.db, "interlock", "info", release_msg);
+                alarm_journal_event("interlock", "info", release_msg);
             }
         }
 
@@ -274,60 +822,217 @@ static void clear_alarm(db_alarm_rule_t *rule, alarm_rule_state_t *state) {
     state->active_alarm_id = 0;
 }
 
-static void check_rule(db_alarm_rule_t *rule, float current_value) {
-    if (!rule->enabled) return;
-    
-    alarm_rule_state_t *state = get_or_create_state(rule->id);
-    if (!state) return;
-    
-    float range = fabsf(rule->threshold_high - rule->threshold_low);
-    float hysteresis = range * rule->hysteresis_percent / 100.0f;
-    
+/* Act on state->raw: raise or clear now, or start the configured delay */
+static void apply_transition(db_alarm_rule_t *rule, alarm_rule_state_t *state, uint64_t now) {
     if (state->in_alarm) {
-        if (rule->auto_clear && check_clear_condition(rule, current_value, hysteresis)) {
+        if (state->raw) {
+            alarm_timer_cancel(&g_alarm_mgr.wheel, &state->delay_timer);
+        } else if (rule->off_delay_seconds <= 0) {
             clear_alarm(rule, state);
+        } else if (!alarm_timer_armed(&state->delay_timer)) {
+            alarm_timer_arm(&g_alarm_mgr.wheel, &state->delay_timer, now,
+                            (uint64_t)rule->off_delay_seconds * 1000);
         }
     } else {
-        if (check_condition(rule, current_value, 0)) {
-            raise_alarm(rule, state, current_value);
+        if (!state->raw || state->shelved) {
+            alarm_timer_cancel(&g_alarm_mgr.wheel, &state->delay_timer);
+        } else if (rule->on_delay_seconds <= 0) {
+            raise_alarm(rule, state, state->last_value);
+        } else if (!alarm_timer_armed(&state->delay_timer)) {
+            alarm_timer_arm(&g_alarm_mgr.wheel, &state->delay_timer, now,
+                            (uint64_t)rule->on_delay_seconds * 1000);
         }
     }
+}
+
+/**
+ * Record an onset of the raw condition.
+ * @return true when the rule is (now) latched for chattering
+ */
+static bool chatter_onset(db_alarm_rule_t *rule, alarm_rule_state_t *state, uint64_t now) {
+    int n = MIN(rule->chatter_count, WT_ALARM_CHATTER_MAX);
+    if (n < 2 || rule->chatter_window_seconds <= 0) return false;
+    uint64_t window_ms = (uint64_t)rule->chatter_window_seconds * 1000;
+
+    /* Still chattering: the latch releases only after a quiet window */
+    if (state->chatter_latched) {
+        alarm_timer_arm(&g_alarm_mgr.wheel, &state->chatter_timer, now, window_ms);
+        return true;
+    }
+
+    /* After the write, the next slot holds the onset n-1 onsets back */
+    int pos = state->onset_pos % n;
+    state->onsets[pos] = now;
+    state->onset_pos = (pos + 1) % n;
+    uint64_t oldest = state->onsets[state->onset_pos];
+    if (oldest == 0 || now - oldest > window_ms) return false;
+
+    state->chatter_latched = true;
+    memset(state->onsets, 0, sizeof(state->onsets));
+    state->onset_pos = 0;
+    alarm_timer_arm(&g_alarm_mgr.wheel, &state->chatter_timer, now, window_ms);
+    g_alarm_mgr.chatter_latches++;
+
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%s: chattering (%d onsets in %d s), alarm latched",
+             rule->name, n, rule->chatter_window_seconds);
+    LOG_WARNING("%s", msg);
+    alarm_journal_event("alarm", "warning", msg);
+    return true;
+}
+
+static void set_unshelved(alarm_rule_state_t *state, const char *name, const char *why) {
+    state->shelved = false;
+    state->shelved_until_ms = 0;
+    g_alarm_mgr.shelved_count--;
+
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%s: unshelved (%s)", name, why);
+    LOG_INFO("%s", msg);
+    alarm_journal_event("alarm", "info", msg);
+}
+
+/* Wheel expiry; runs on the check thread with g_alarm_mgr.mutex held */
+static void on_timer(alarm_timer_t *timer, void *ctx) {
+    uint64_t now = *(const uint64_t *)ctx;
+    alarm_rule_state_t *state = timer_owner(timer);
+    db_alarm_rule_t *rule = state->rule;
+
+    switch ((alarm_timer_kind_t)timer->kind) {
+        case TIMER_DELAY:
+            /* Any reversal cancels the timer, so the condition held throughout */
+            if (!rule || !rule->enabled) break;
+            if (state->in_alarm) {
+                if (!state->raw) clear_alarm(rule, state);
+            } else if (state->raw && !state->shelved && !state->chatter_latched) {
+                raise_alarm(rule, state, state->last_value);
+            }
+            break;
+
+        case TIMER_CHATTER: {
+            state->chatter_latched = false;
+            if (!rule) break;
+            char msg[256];
+            snprintf(msg, sizeof(msg), "%s: quiet for %d s, chatter latch released",
+                     rule->name, rule->chatter_window_seconds);
+            LOG_INFO("%s", msg);
+            alarm_journal_event("alarm", "info", msg);
+            if (rule->enabled) apply_transition(rule, state, now);
+            break;
+        }
+
+        case TIMER_SHELVE:
+            if (!state->shelved) break;
+            set_unshelved(state, rule ? rule->name : "alarm", "expired");
+            if (rule && rule->enabled) apply_transition(rule, state, now);
+            break;
+    }
+}
+
+/*
+ * Caller holds g_alarm_mgr.mutex; state comes from the rule index.
+ * fresh is true for samples from the acquisition path; the polling thread
+ * re-checks the last stored value and must not feed it into the windowed
+ * statistics a second time.
+ */
+static void check_rule(db_alarm_rule_t *rule, alarm_rule_state_t *state, float current_value, bool fresh) {
+    if (!rule->enabled) return;
+
+    /* Slot released by a delete the reader's snapshot predates */
+    if (!state || state->rule_id != rule->id) return;
+
+    uint64_t now = get_time_ms();
+    if (fresh && is_windowed(rule->condition)) {
+        signal_update(rule, &state->signal, current_value, now);
+    }
     
+    float low = rule->condition == ALARM_CONDITION_RATE_OF_CHANGE ? rate_low(rule)
+                                                                   : rule->threshold_low;
+    float range = fabsf(rule->threshold_high - low);
+    float hysteresis = range * rule->hysteresis_percent / 100.0f;
+    
+    bool raw = state->in_alarm ?
+        !(rule->auto_clear && check_clear_condition(rule, state, current_value, hysteresis)) :
+        check_condition(rule, state, current_value, 0);
+    bool onset = raw && !state->raw;
+
+    state->raw = raw;
     state->last_value = current_value;
-    state->last_check_time = get_time_ms();
+    state->last_check_time = now;
+
+    if (onset && chatter_onset(rule, state, now)) {
+        /* Annunciate once, bypassing the on-delay, then hold */
+        alarm_timer_cancel(&g_alarm_mgr.wheel, &state->delay_timer);
+        if (!state->in_alarm && !state->shelved) {
+            raise_alarm(rule, state, current_value);
+        }
+        return;
+    }
+    if (state->chatter_latched) return;
+
+    apply_transition(rule, state, now);
+}
+
+/* Feed a batch of bus samples through the per-module rule index */
+static void evaluate_samples(const sensor_sample_t *samples, int count) {
+    for (int i = 0; i < count; i++) {
+        /* Bad or disconnected readings carry a stale value; never alarm on it */
+        if (samples[i].quality >= QUALITY_BAD) continue;
+        alarm_manager_check_value(samples[i].module_id, samples[i].value);
+    }
 }
 
 static void* alarm_check_thread(void *arg) {
     UNUSED(arg);
+    uint64_t next_poll = 0;
+    sensor_sample_t samples[ALARM_SAMPLE_BATCH];
 
     while (g_alarm_mgr.running) {
+        /* Sleeps until samples arrive or the next timer tick is due */
+        if (g_alarm_mgr.samples) {
+            int n = sample_bus_wait(g_alarm_mgr.samples, samples, ALARM_SAMPLE_BATCH,
+                                    WT_ALARM_TIMER_TICK_MS);
+            evaluate_samples(samples, n);
+        } else {
+            usleep(WT_ALARM_TIMER_TICK_MS * 1000);
+        }
+
+        uint64_t now = get_time_ms();
+
+        /* Delays, chatter latches and shelves expire here, not by polling rules */
         pthread_mutex_lock(&g_alarm_mgr.mutex);
+        g_alarm_mgr.timers_fired += (uint64_t)alarm_timer_advance(&g_alarm_mgr.wheel, now, on_timer, &now);
+        pthread_mutex_unlock(&g_alarm_mgr.mutex);
+
+        if (now < next_poll) continue;
+        next_poll = now + ALARM_CHECK_INTERVAL_MS;
 
-        /* Refresh cache if dirty or periodic timeout (safety net for external DB changes) */
-        if (cache_needs_refresh()) {
-            refresh_rule_cache();
-            g_alarm_mgr.cache_refreshes++;
+        /* Periodic rebuild is a safety net for external DB changes */
+        if (index_needs_refresh()) {
+            rebuild_rule_index();
         } else {
             g_alarm_mgr.cache_hits++;
         }
 
-        /* Use cached rules - no DB query unless cache is dirty */
-        for (int i = 0; i < g_alarm_mgr.cached_rule_count; i++) {
-            db_alarm_rule_t *rule = &g_alarm_mgr.cached_rules[i];
-            if (!rule->enabled) continue;
-
-            float value;
-            char status[16];
-            if (db_sensor_status_get(g_alarm_mgr.db, rule->module_id, &value, status, sizeof(status)) == RESULT_OK) {
-                if (strcmp(status, "ok") == 0 || strcmp(status, "unknown") == 0) {
-                    check_rule(rule, value);
-                    g_alarm_mgr.total_checks++;
-                }
-            }
-        }
+        /*
+         * Re-evaluate each rule against its last sample so time-based
+         * conditions (stale, rate decay) progress between samples.
+         */
+        int parity = index_read_lock();
+        alarm_rule_index_t *index = atomic_load(&g_alarm_mgr.index);
 
+        pthread_mutex_lock(&g_alarm_mgr.mutex);
+        for (int i = 0; index && i < index->rule_count; i++) {
+            db_alarm_rule_t *rule = &index->rules[i];
+            alarm_rule_state_t *state = index->states[i];
+            if (!rule->enabled || !state || isnan(state->last_value)) continue;
+
+            check_rule(rule, state, state->last_value, false);
+            g_alarm_mgr.total_checks++;
+        }
         pthread_mutex_unlock(&g_alarm_mgr.mutex);
-        usleep(ALARM_CHECK_INTERVAL_MS * 1000);
+
+        index_read_unlock(parity);
     }
 
     return NULL;
@@ -341,12 +1046,28 @@ result_t alarm_manager_init(database_t *db) {
     CHECK_NULL(db);
     if (g_alarm_mgr.initialized) return RESULT_OK;
 
+    result_t r = alarm_journal_init(db);
+    if (r != RESULT_OK) return r;
+
     memset(&g_alarm_mgr, 0, sizeof(g_alarm_mgr));
     g_alarm_mgr.db = db;
-    g_alarm_mgr.cache_dirty = true;  /* Force initial cache load */
     pthread_mutex_init(&g_alarm_mgr.mutex, NULL);
+    pthread_mutex_init(&g_alarm_mgr.rebuild_mutex, NULL);
+    pthread_mutex_init(&g_alarm_mgr.active.mutex, NULL);
+    g_alarm_mgr.rate_last_ms = get_time_ms();
+
+    r = alarm_timer_wheel_init(&g_alarm_mgr.wheel, WT_ALARM_TIMER_SLOTS, WT_ALARM_TIMER_TICK_MS,
+                               get_time_ms());
+    if (r != RESULT_OK) {
+        alarm_journal_shutdown();
+        return r;
+    }
     g_alarm_mgr.initialized = true;
 
+    /* Initial index load; the check thread retries if this fails */
+    rebuild_rule_index();
+    reconcile_active_alarms();
+
     LOG_INFO("Alarm manager initialized");
     return RESULT_OK;
 }
@@ -355,11 +1076,23 @@ result_t alarm_manager_start(void) {
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
     if (g_alarm_mgr.running) return RESULT_OK;
     
+    result_t r = alarm_journal_start();
+    if (r != RESULT_OK) return r;
+
+    /* Without a subscription rules still evaluate via alarm_manager_check_value() */
+    if (sample_bus_subscribe("alarms", WT_SAMPLE_BUS_ALARM_DEPTH, SAMPLE_BUS_DROP_OLDEST,
+                             &g_alarm_mgr.samples) != RESULT_OK) {
+        LOG_WARNING("Alarm manager: sample bus subscription failed");
+        g_alarm_mgr.samples = NULL;
+    }
+
     g_alarm_mgr.running = true;
     
     if (pthread_create(&g_alarm_mgr.check_thread, NULL, alarm_check_thread, NULL) != 0) {
         LOG_ERROR("Failed to create alarm thread");
         g_alarm_mgr.running = false;
+        sample_bus_unsubscribe(g_alarm_mgr.samples);
+        g_alarm_mgr.samples = NULL;
         return RESULT_ERROR;
     }
     
@@ -372,6 +1105,12 @@ result_t alarm_manager_stop(void) {
     
     g_alarm_mgr.running = false;
     pthread_join(g_alarm_mgr.check_thread, NULL);
+
+    sample_bus_unsubscribe(g_alarm_mgr.samples);
+    g_alarm_mgr.samples = NULL;
+
+    /* Persist every transition raised before the stop */
+    alarm_journal_stop();
     
     LOG_INFO("Alarm manager stopped");
     return RESULT_OK;
@@ -380,13 +1119,13 @@ result_t alarm_manager_stop(void) {
 void alarm_manager_shutdown(void) {
     alarm_manager_stop();
 
-    /* Free cached rules */
-    if (g_alarm_mgr.cached_rules) {
-        free(g_alarm_mgr.cached_rules);
-        g_alarm_mgr.cached_rules = NULL;
-        g_alarm_mgr.cached_rule_count = 0;
-    }
+    /* No readers remain once the check thread is joined and sensors stopped */
+    index_free(atomic_exchange(&g_alarm_mgr.index, NULL));
+    alarm_timer_wheel_destroy(&g_alarm_mgr.wheel);
+    alarm_journal_shutdown();
 
+    pthread_mutex_destroy(&g_alarm_mgr.active.mutex);
+    pthread_mutex_destroy(&g_alarm_mgr.rebuild_mutex);
     pthread_mutex_destroy(&g_alarm_mgr.mutex);
     g_alarm_mgr.initialized = false;
     LOG_INFO("Alarm manager shutdown");
@@ -403,38 +1142,53 @@ result_t alarm_manager_set_callbacks(alarm_callback_t on_raised, alarm_callback_
 
 result_t alarm_manager_check_value(int module_id, float value) {
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
-    
-    pthread_mutex_lock(&g_alarm_mgr.mutex);
-    
-    db_alarm_rule_t *rules = NULL;
-    int count = 0;
-    
-    if (db_alarm_rule_list_by_module(g_alarm_mgr.db, module_id, &rules, &count) == RESULT_OK && rules) {
-        for (int i = 0; i < count; i++) check_rule(&rules[i], value);
-        free(rules);
+
+    int parity = index_read_lock();
+    alarm_rule_index_t *index = atomic_load(&g_alarm_mgr.index);
+    const alarm_module_bucket_t *bucket = index ? index_find_module(index, module_id) : NULL;
+
+    /* Modules without rules never take the mutex */
+    if (bucket) {
+        pthread_mutex_lock(&g_alarm_mgr.mutex);
+        for (int i = bucket->first; i < bucket->first + bucket->count; i++) {
+            check_rule(&index->rules[i], index->states[i], value, true);
+        }
+        pthread_mutex_unlock(&g_alarm_mgr.mutex);
+        atomic_fetch_add_explicit(&g_alarm_mgr.evaluations, (uint64_t)bucket->count,
+                                  memory_order_relaxed);
     }
-    
-    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+
+    index_read_unlock(parity);
     return RESULT_OK;
 }
 
+result_t alarm_manager_reload_rules(void) {
+    if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
+    return rebuild_rule_index();
+}
+
 result_t alarm_manager_acknowledge(int alarm_id, const char *user) {
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
-    return db_alarm_acknowledge(g_alarm_mgr.db, alarm_id, user);
+    /* Journal order puts the ack row behind the alarm's own insert */
+    return active_acknowledge(alarm_id, user);
 }
 
 result_t alarm_manager_acknowledge_all(const char *user) {
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
-    
-    db_alarm_history_t *alarms = NULL;
+
+    int ids[MAX_ACTIVE_ALARMS];
     int count = 0;
-    
-    if (db_alarm_list_active(g_alarm_mgr.db, &alarms, &count) == RESULT_OK && alarms) {
-        for (int i = 0; i < count; i++) {
-            if (alarms[i].state == ALARM_STATE_ACTIVE)
-                db_alarm_acknowledge(g_alarm_mgr.db, alarms[i].id, user);
+
+    pthread_mutex_lock(&g_alarm_mgr.active.mutex);
+    for (int i = 0; i < g_alarm_mgr.active.count; i++) {
+        if (g_alarm_mgr.active.entries[i].state == ALARM_STATE_ACTIVE) {
+            ids[count++] = g_alarm_mgr.active.entries[i].id;
         }
-        free(alarms);
+    }
+    pthread_mutex_unlock(&g_alarm_mgr.active.mutex);
+
+    for (int i = 0; i < count; i++) {
+        active_acknowledge(ids[i], user);
     }
     return RESULT_OK;
 }
@@ -442,13 +1196,41 @@ result_t alarm_manager_acknowledge_all(const char *user) {
 result_t alarm_manager_get_active_count(int *count) {
     CHECK_NULL(count);
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
-    return db_alarm_count_active(g_alarm_mgr.db, count);
+    *count = atomic_load(&g_alarm_mgr.active.total);
+    return RESULT_OK;
 }
 
 result_t alarm_manager_get_active_by_severity(alarm_severity_t severity, int *count) {
     CHECK_NULL(count);
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
-    return db_alarm_count_by_severity(g_alarm_mgr.db, severity, count);
+    if (severity < ALARM_SEVERITY_LOW || severity > ALARM_SEVERITY_CRITICAL) return RESULT_INVALID_PARAM;
+    *count = atomic_load(&g_alarm_mgr.active.by_severity[severity]);
+    return RESULT_OK;
+}
+
+result_t alarm_manager_list_active(db_alarm_history_t **alarms, int *count) {
+    CHECK_NULL(alarms); CHECK_NULL(count);
+    if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
+
+    *alarms = NULL;
+    *count = 0;
+
+    pthread_mutex_lock(&g_alarm_mgr.active.mutex);
+    int n = g_alarm_mgr.active.count;
+    if (n > 0) {
+        *alarms = malloc((size_t)n * sizeof(db_alarm_history_t));
+        if (!*alarms) {
+            pthread_mutex_unlock(&g_alarm_mgr.active.mutex);
+            return RESULT_NO_MEMORY;
+        }
+        memcpy(*alarms, g_alarm_mgr.active.entries, (size_t)n * sizeof(db_alarm_history_t));
+    }
+    pthread_mutex_unlock(&g_alarm_mgr.active.mutex);
+
+    /* Same order as db_alarm_list_active() */
+    if (n > 1) qsort(*alarms, (size_t)n, sizeof(db_alarm_history_t), compare_active);
+    *count = n;
+    return RESULT_OK;
 }
 
 result_t alarm_manager_create_rule(int module_id, const char *name, alarm_condition_t condition,
@@ -467,10 +1249,12 @@ result_t alarm_manager_create_rule(int module_id, const char *name, alarm_condit
     rule.enabled = true;
     rule.auto_clear = true;
     rule.hysteresis_percent = 5;
+    rule.window_seconds = WT_ALARM_WINDOW_SEC;
+    rule.chatter_window_seconds = 60;
 
     result_t r = db_alarm_rule_create(g_alarm_mgr.db, &rule, rule_id);
     if (r == RESULT_OK) {
-        invalidate_rule_cache();  /* New rule added, refresh cache on next check */
+        rebuild_rule_index();  /* New rule is evaluated from the next sample on */
     }
     return r;
 }
@@ -479,22 +1263,26 @@ result_t alarm_manager_delete_rule(int rule_id) {
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
 
     pthread_mutex_lock(&g_alarm_mgr.mutex);
-    db_alarm_clear_by_rule(g_alarm_mgr.db, rule_id);
 
-    for (int i = 0; i < g_alarm_mgr.state_count; i++) {
-        if (g_alarm_mgr.states[i].rule_id == rule_id) {
-            memmove(&g_alarm_mgr.states[i], &g_alarm_mgr.states[i + 1],
-                    (g_alarm_mgr.state_count - i - 1) * sizeof(alarm_rule_state_t));
-            g_alarm_mgr.state_count--;
-            break;
+    /* Release the state slot in place: the published index points into states[] */
+    alarm_rule_state_t *state = find_state(rule_id);
+    if (state) {
+        /* A standing alarm leaves the active table and the journal first;
+         * the rule comes from the index, not a query under the mutex */
+        if (state->in_alarm && state->rule) {
+            clear_alarm(state->rule, state);
         }
+        release_state(state);
     }
+    /* Queued, not direct: a raise still in the journal must not outlive the rule */
+    alarm_journal_clear_rule(rule_id);
 
     result_t r = db_alarm_rule_delete(g_alarm_mgr.db, rule_id);
+    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+
     if (r == RESULT_OK) {
-        invalidate_rule_cache();  /* Rule deleted, refresh cache on next check */
+        rebuild_rule_index();
     }
-    pthread_mutex_unlock(&g_alarm_mgr.mutex);
     return r;
 }
 
@@ -505,21 +1293,118 @@ result_t alarm_manager_enable_rule(int rule_id, bool enabled) {
 
     if (!enabled) {
         alarm_rule_state_t *state = find_state(rule_id);
-        if (state && state->in_alarm) {
-            db_alarm_rule_t rule;
-            if (db_alarm_rule_get(g_alarm_mgr.db, rule_id, &rule) == RESULT_OK)
-                clear_alarm(&rule, state);
+        if (state) {
+            /* No pending on-delay may raise after the disable */
+            alarm_timer_cancel(&g_alarm_mgr.wheel, &state->delay_timer);
+            state->raw = false;
+        }
+        if (state && state->in_alarm && state->rule) {
+            clear_alarm(state->rule, state);
         }
     }
 
     result_t r = db_alarm_rule_set_enabled(g_alarm_mgr.db, rule_id, enabled);
+    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+
     if (r == RESULT_OK) {
-        invalidate_rule_cache();  /* Rule enabled/disabled, refresh cache on next check */
+        rebuild_rule_index();
     }
-    pthread_mutex_unlock(&g_alarm_mgr.mutex);
     return r;
 }
 
+result_t alarm_manager_shelve(int rule_id, int duration_seconds, const char *user) {
+    if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
+    if (duration_seconds <= 0) duration_seconds = WT_ALARM_SHELVE_DEFAULT_SEC;
+    if (duration_seconds > WT_ALARM_SHELVE_MAX_SEC) return RESULT_OUT_OF_RANGE;
+
+    pthread_mutex_lock(&g_alarm_mgr.mutex);
+
+    alarm_rule_state_t *state = find_state(rule_id);
+    if (!state || !state->rule) {
+        pthread_mutex_unlock(&g_alarm_mgr.mutex);
+        return RESULT_NOT_FOUND;
+    }
+    db_alarm_rule_t *rule = state->rule;
+
+    /* Safety alarms stay visible: an interlocked rule is never shelvable */
+    if (rule->interlock_enabled) {
+        pthread_mutex_unlock(&g_alarm_mgr.mutex);
+        LOG_WARNING("Refusing to shelve interlocked alarm rule '%s'", rule->name);
+        return RESULT_NOT_SUPPORTED;
+    }
+
+    uint64_t now = get_time_ms();
+    if (state->in_alarm) {
+        clear_alarm(rule, state);
+        state->raw = false;
+    }
+    if (!state->shelved) g_alarm_mgr.shelved_count++;
+    state->shelved = true;
+    state->shelved_until_ms = now + (uint64_t)duration_seconds * 1000;
+    alarm_timer_arm(&g_alarm_mgr.wheel, &state->shelve_timer, now, (uint64_t)duration_seconds * 1000);
+
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%s: shelved for %d s by %s", rule->name, duration_seconds,
+             user ? user : "operator");
+    LOG_INFO("%s", msg);
+    alarm_journal_event("alarm", "info", msg);
+
+    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+    return RESULT_OK;
+}
+
+result_t alarm_manager_unshelve(int rule_id, const char *user) {
+    if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_alarm_mgr.mutex);
+
+    alarm_rule_state_t *state = find_state(rule_id);
+    if (!state) {
+        pthread_mutex_unlock(&g_alarm_mgr.mutex);
+        return RESULT_NOT_FOUND;
+    }
+
+    if (state->shelved) {
+        char why[96];
+        snprintf(why, sizeof(why), "by %s", user ? user : "operator");
+        alarm_timer_cancel(&g_alarm_mgr.wheel, &state->shelve_timer);
+        set_unshelved(state, state->rule ? state->rule->name : "alarm", why);
+        if (state->rule && state->rule->enabled) {
+            apply_transition(state->rule, state, get_time_ms());
+        }
+    }
+
+    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+    return RESULT_OK;
+}
+
+result_t alarm_manager_get_rule_status(int rule_id, alarm_rule_status_t *status) {
+    CHECK_NULL(status);
+    if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
+
+    memset(status, 0, sizeof(*status));
+    pthread_mutex_lock(&g_alarm_mgr.mutex);
+
+    alarm_rule_state_t *state = find_state(rule_id);
+    if (!state) {
+        pthread_mutex_unlock(&g_alarm_mgr.mutex);
+        return RESULT_NOT_FOUND;
+    }
+
+    status->in_alarm = state->in_alarm;
+    status->delay_pending = alarm_timer_armed(&state->delay_timer);
+    status->chatter_latched = state->chatter_latched;
+    status->shelved = state->shelved;
+    if (state->shelved) {
+        uint64_t now = get_time_ms();
+        status->shelve_remaining_s = state->shelved_until_ms > now ?
+            (int)((state->shelved_until_ms - now + 999) / 1000) : 0;
+    }
+
+    pthread_mutex_unlock(&g_alarm_mgr.mutex);
+    return RESULT_OK;
+}
+
 bool alarm_manager_is_running(void) {
     return g_alarm_mgr.running;
 }
@@ -528,12 +1413,40 @@ result_t alarm_manager_get_stats(alarm_manager_stats_t *stats) {
     CHECK_NULL(stats);
     if (!g_alarm_mgr.initialized) return RESULT_NOT_INITIALIZED;
 
+    int parity = index_read_lock();
+    alarm_rule_index_t *index = atomic_load(&g_alarm_mgr.index);
+    stats->cached_rule_count = index ? index->rule_count : 0;
+    stats->indexed_modules = index ? index->bucket_count : 0;
+    index_read_unlock(parity);
+
     pthread_mutex_lock(&g_alarm_mgr.mutex);
     stats->cache_hits = g_alarm_mgr.cache_hits;
-    stats->cache_refreshes = g_alarm_mgr.cache_refreshes;
+    stats->cache_refreshes = atomic_load_explicit(&g_alarm_mgr.cache_refreshes, memory_order_relaxed);
     stats->total_checks = g_alarm_mgr.total_checks;
-    stats->cached_rule_count = g_alarm_mgr.cached_rule_count;
+    stats->evaluations = atomic_load_explicit(&g_alarm_mgr.evaluations, memory_order_relaxed);
+
+    /* Rate over the interval since the previous sample (at least 1 s) */
+    uint64_t now = get_time_ms();
+    uint64_t elapsed = now - g_alarm_mgr.rate_last_ms;
+    if (elapsed >= 1000) {
+        g_alarm_mgr.evaluations_per_sec =
+            (double)(stats->evaluations - g_alarm_mgr.rate_last_count) * 1000.0 / (double)elapsed;
+        g_alarm_mgr.rate_last_count = stats->evaluations;
+        g_alarm_mgr.rate_last_ms = now;
+    }
+    stats->evaluations_per_sec = g_alarm_mgr.evaluations_per_sec;
+    stats->shelved_rules = g_alarm_mgr.shelved_count;
+    stats->chatter_latches = g_alarm_mgr.chatter_latches;
+    stats->timers_armed = g_alarm_mgr.wheel.armed;
+    stats->timers_fired = g_alarm_mgr.timers_fired;
     pthread_mutex_unlock(&g_alarm_mgr.mutex);
 
+    alarm_journal_stats_t journal;
+    if (alarm_journal_get_stats(&journal) == RESULT_OK) {
+        stats->journal_pending = journal.queue_count;
+        stats->journal_written = journal.written;
+        stats->journal_dropped = journal.dropped;
+    }
+
     return RESULT_OK;
 }
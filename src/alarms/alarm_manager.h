@@ -13,26 +13,79 @@ result_t alarm_manager_stop(void);
 void alarm_manager_shutdown(void);
 
 result_t alarm_manager_set_callbacks(alarm_callback_t on_raised, alarm_callback_t on_cleared, void *ctx);
+/**
+ * @brief Evaluate a new sample against the module's alarm rules
+ *
+ * Uses the in-memory rule index: no SQLite access and no allocation
+ * unless an alarm is raised or cleared.
+ */
 result_t alarm_manager_check_value(int module_id, float value);
+
+/**
+ * @brief Rebuild the rule index after rules were edited directly in the DB
+ */
+result_t alarm_manager_reload_rules(void);
 result_t alarm_manager_acknowledge(int alarm_id, const char *user);
 result_t alarm_manager_acknowledge_all(const char *user);
+
+/* Active alarm queries are served from memory (no SQLite) */
 result_t alarm_manager_get_active_count(int *count);
 result_t alarm_manager_get_active_by_severity(alarm_severity_t severity, int *count);
 
+/**
+ * @brief Copy of all active/acknowledged alarms, most severe first
+ * @param alarms Receives a malloc'd array (free() it; NULL when empty)
+ * @param count Receives the number of entries
+ */
+result_t alarm_manager_list_active(db_alarm_history_t **alarms, int *count);
+
 result_t alarm_manager_create_rule(int module_id, const char *name, alarm_condition_t condition,
                                    float threshold_high, float threshold_low,
                                    alarm_severity_t severity, int *rule_id);
 result_t alarm_manager_delete_rule(int rule_id);
 result_t alarm_manager_enable_rule(int rule_id, bool enabled);
 
+/**
+ * @brief Shelve a rule: its alarm is cleared and not raised again until expiry
+ *
+ * Rules with a safety interlock cannot be shelved.
+ *
+ * @param duration_seconds Shelve time, 0 for WT_ALARM_SHELVE_DEFAULT_SEC
+ * @return RESULT_OK, RESULT_NOT_FOUND, RESULT_NOT_SUPPORTED (interlocked),
+ *         RESULT_OUT_OF_RANGE (longer than WT_ALARM_SHELVE_MAX_SEC)
+ */
+result_t alarm_manager_shelve(int rule_id, int duration_seconds, const char *user);
+result_t alarm_manager_unshelve(int rule_id, const char *user);
+
+/* Damping state of one rule, for display */
+typedef struct {
+    bool in_alarm;
+    bool delay_pending;        /* On- or off-delay running */
+    bool chatter_latched;
+    bool shelved;
+    int shelve_remaining_s;
+} alarm_rule_status_t;
+
+result_t alarm_manager_get_rule_status(int rule_id, alarm_rule_status_t *status);
+
 bool alarm_manager_is_running(void);
 
 /* Performance metrics for observability */
 typedef struct {
     uint64_t cache_hits;       /* Check cycles using cached rules */
-    uint64_t cache_refreshes;  /* Times cache was refreshed from DB */
+    uint64_t cache_refreshes;  /* Times the rule index was rebuilt from DB */
     uint64_t total_checks;     /* Total rule checks performed */
     int cached_rule_count;     /* Current number of cached rules */
+    int indexed_modules;       /* Modules with at least one rule */
+    uint64_t evaluations;      /* Sample-path rule evaluations */
+    double evaluations_per_sec;
+    int journal_pending;       /* Alarm/event rows not yet committed */
+    uint64_t journal_written;  /* Rows committed by the journal */
+    uint64_t journal_dropped;  /* Rows lost to a full journal queue */
+    int shelved_rules;
+    uint64_t chatter_latches;  /* Times a rule was latched for chattering */
+    int timers_armed;          /* Pending delay/chatter/shelve timers */
+    uint64_t timers_fired;
 } alarm_manager_stats_t;
 
 result_t alarm_manager_get_stats(alarm_manager_stats_t *stats);
@@ -0,0 +1,141 @@
+/**
+ * @file alarm_timer.c
+ * @brief Hashed timer wheel
+ *
+ * A timer lives in slot (expires & mask). Timers further out than one
+ * revolution share slots with nearer ones and simply stay put when their
+ * slot is visited early; the expires check decides.
+ */
+
+#include "alarm_timer.h"
+
+static void list_unlink(alarm_timer_t *timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+static void list_push(alarm_timer_t *head, alarm_timer_t *timer) {
+    timer->next = head->next;
+    timer->prev = head;
+    head->next->prev = timer;
+    head->next = timer;
+}
+
+static void list_init(alarm_timer_t *head) {
+    head->next = head;
+    head->prev = head;
+}
+
+result_t alarm_timer_wheel_init(alarm_timer_wheel_t *wheel, uint32_t slot_count,
+                                uint32_t tick_ms, uint64_t now_ms) {
+    CHECK_NULL(wheel);
+    if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 || tick_ms == 0) {
+        return RESULT_INVALID_PARAM;
+    }
+
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->slots = calloc(slot_count, sizeof(alarm_timer_t));
+    if (!wheel->slots) return RESULT_NO_MEMORY;
+
+    for (uint32_t i = 0; i < slot_count; i++) {
+        list_init(&wheel->slots[i]);
+    }
+    wheel->slot_count = slot_count;
+    wheel->tick_ms = tick_ms;
+    wheel->origin_ms = now_ms;
+    return RESULT_OK;
+}
+
+void alarm_timer_wheel_destroy(alarm_timer_wheel_t *wheel) {
+    if (!wheel || !wheel->slots) return;
+
+    /* Leave owners' nodes in a consistent unarmed state */
+    for (uint32_t i = 0; i < wheel->slot_count; i++) {
+        alarm_timer_t *head = &wheel->slots[i];
+        while (head->next != head) {
+            list_unlink(head->next);
+        }
+    }
+    free(wheel->slots);
+    memset(wheel, 0, sizeof(*wheel));
+}
+
+void alarm_timer_init(alarm_timer_t *timer, int kind) {
+    memset(timer, 0, sizeof(*timer));
+    timer->kind = kind;
+}
+
+static uint64_t tick_of(const alarm_timer_wheel_t *wheel, uint64_t ms) {
+    return ms > wheel->origin_ms ? (ms - wheel->origin_ms) / wheel->tick_ms : 0;
+}
+
+void alarm_timer_arm(alarm_timer_wheel_t *wheel, alarm_timer_t *timer,
+                     uint64_t now_ms, uint64_t delay_ms) {
+    if (alarm_timer_armed(timer)) {
+        list_unlink(timer);
+        wheel->armed--;
+    }
+
+    /* First tick boundary at or after the deadline, never one already processed */
+    uint64_t deadline = now_ms + delay_ms;
+    uint64_t expires = deadline > wheel->origin_ms ?
+        (deadline - wheel->origin_ms + wheel->tick_ms - 1) / wheel->tick_ms : 0;
+    if (expires <= wheel->current) expires = wheel->current + 1;
+
+    timer->expires = expires;
+    list_push(&wheel->slots[expires & (wheel->slot_count - 1)], timer);
+    wheel->armed++;
+}
+
+void alarm_timer_cancel(alarm_timer_wheel_t *wheel, alarm_timer_t *timer) {
+    if (!alarm_timer_armed(timer)) return;
+    list_unlink(timer);
+    wheel->armed--;
+}
+
+int alarm_timer_advance(alarm_timer_wheel_t *wheel, uint64_t now_ms,
+                        alarm_timer_fn fn, void *ctx) {
+    uint64_t target = tick_of(wheel, now_ms);
+    if (target <= wheel->current) return 0;
+
+    /* After a long stall one revolution visits every slot */
+    uint64_t base = wheel->current;
+    uint64_t steps = target - base;
+    if (steps > wheel->slot_count) steps = wheel->slot_count;
+
+    /* Handlers arm relative to target, so nothing lands behind the walk */
+    wheel->current = target;
+
+    int fired = 0;
+    for (uint64_t s = 1; s <= steps; s++) {
+        alarm_timer_t *head = &wheel->slots[(base + s) & (wheel->slot_count - 1)];
+        if (head->next == head) continue;
+
+        /*
+         * Detach the slot so handlers can arm into it (or cancel a node
+         * still waiting here) without disturbing this walk.
+         */
+        alarm_timer_t pending;
+        pending.next = head->next;
+        pending.prev = head->prev;
+        pending.next->prev = &pending;
+        pending.prev->next = &pending;
+        list_init(head);
+
+        while (pending.next != &pending) {
+            alarm_timer_t *timer = pending.next;
+            list_unlink(timer);
+            if (timer->expires <= target) {
+                wheel->armed--;
+                fired++;
+                fn(timer, ctx);
+            } else {
+                list_push(head, timer);
+            }
+        }
+    }
+
+    return fired;
+}
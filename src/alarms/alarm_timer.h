@@ -0,0 +1,69 @@
+/**
+ * @file alarm_timer.h
+ * @brief Hashed timer wheel for alarm on/off delays, chatter and shelving
+ *
+ * Timers are intrusive nodes embedded in their owner, so arming and
+ * cancelling are O(1) list operations with no allocation. The wheel is
+ * advanced from one thread; expiry work is proportional to the slots
+ * crossed and the timers actually due, not to the number of rules.
+ * Not thread-safe: the caller serializes every call on one wheel.
+ */
+
+#ifndef ALARM_TIMER_H
+#define ALARM_TIMER_H
+
+#include "common.h"
+
+typedef struct alarm_timer {
+    struct alarm_timer *next;
+    struct alarm_timer *prev;
+    uint64_t expires;           /* Absolute tick */
+    int kind;                   /* Owner-defined tag for the expiry handler */
+} alarm_timer_t;
+
+typedef struct {
+    alarm_timer_t *slots;       /* Sentinel heads, slot_count of them */
+    uint32_t slot_count;        /* Power of two */
+    uint32_t tick_ms;
+    uint64_t origin_ms;         /* Time of tick 0 */
+    uint64_t current;           /* Last tick processed */
+    int armed;
+} alarm_timer_wheel_t;
+
+typedef void (*alarm_timer_fn)(alarm_timer_t *timer, void *ctx);
+
+result_t alarm_timer_wheel_init(alarm_timer_wheel_t *wheel, uint32_t slot_count,
+                                uint32_t tick_ms, uint64_t now_ms);
+void alarm_timer_wheel_destroy(alarm_timer_wheel_t *wheel);
+
+/**
+ * @brief Prepare a timer node for use (unarmed)
+ */
+void alarm_timer_init(alarm_timer_t *timer, int kind);
+
+/**
+ * @brief Arm (or re-arm) a timer to fire delay_ms from now_ms
+ *
+ * The delay is rounded up to whole ticks, so a timer never fires early.
+ */
+void alarm_timer_arm(alarm_timer_wheel_t *wheel, alarm_timer_t *timer,
+                     uint64_t now_ms, uint64_t delay_ms);
+
+void alarm_timer_cancel(alarm_timer_wheel_t *wheel, alarm_timer_t *timer);
+
+static inline bool alarm_timer_armed(const alarm_timer_t *timer) {
+    return timer->next != NULL;
+}
+
+/**
+ * @brief Fire every timer due at now_ms
+ *
+ * Each timer is disarmed before its handler runs; the handler may re-arm
+ * it or arm and cancel any other timer on the wheel.
+ *
+ * @return Number of timers fired
+ */
+int alarm_timer_advance(alarm_timer_wheel_t *wheel, uint64_t now_ms,
+                        alarm_timer_fn fn, void *ctx);
+
+#endif
@@ -21,7 +21,8 @@ typedef enum {
     CFG_TYPE_INT,
     CFG_TYPE_BOOL,
     CFG_TYPE_UINT16,
-    CFG_TYPE_UINT32
+    CFG_TYPE_UINT32,
+    CFG_TYPE_FLOAT
 } config_field_type_t;
 
 typedef struct {
@@ -32,7 +33,7 @@ typedef struct {
     size_t size;  /* For strings: buffer size. For others: 0 */
 } config_field_t;
 
-/* Field descriptor table - all 37 config entries */
+/* Field descriptor table - all config entries */
 static const config_field_t config_fields[] = {
     /* System section */
     { "system", "device_name", CFG_TYPE_STRING,
@@ -78,6 +79,16 @@ static const config_field_t config_fields[] = {
       offsetof(app_config_t, profinet.min_device_interval), 0 },
     { "profinet", "enabled", CFG_TYPE_BOOL,
       offsetof(app_config_t, profinet.enabled), 0 },
+    { "profinet", "packed_channels", CFG_TYPE_INT,
+      offsetof(app_config_t, profinet.packed_channels), 0 },
+    { "profinet", "alarm_window_ms", CFG_TYPE_INT,
+      offsetof(app_config_t, profinet.alarm_window_ms), 0 },
+    { "profinet", "alarm_rate", CFG_TYPE_INT,
+      offsetof(app_config_t, profinet.alarm_rate), 0 },
+    { "profinet", "alarm_burst", CFG_TYPE_INT,
+      offsetof(app_config_t, profinet.alarm_burst), 0 },
+    { "profinet", "alarm_aggregate", CFG_TYPE_INT,
+      offsetof(app_config_t, profinet.alarm_aggregate), 0 },
 
     /* Database section */
     { "database", "path", CFG_TYPE_STRING,
@@ -87,6 +98,9 @@ static const config_field_t config_fields[] = {
       offsetof(app_config_t, database.create_if_missing), 0 },
     { "database", "busy_timeout_ms", CFG_TYPE_INT,
       offsetof(app_config_t, database.busy_timeout_ms), 0 },
+    { "database", "storage_profile", CFG_TYPE_STRING,
+      offsetof(app_config_t, database.storage_profile),
+      sizeof(((app_config_t*)0)->database.storage_profile) },
 
     /* Logging section */
     { "logging", "enabled", CFG_TYPE_BOOL,
@@ -102,6 +116,33 @@ static const config_field_t config_fields[] = {
       sizeof(((app_config_t*)0)->logging.remote_url) },
     { "logging", "remote_enabled", CFG_TYPE_BOOL,
       offsetof(app_config_t, logging.remote_enabled), 0 },
+    { "logging", "spool_dir", CFG_TYPE_STRING,
+      offsetof(app_config_t, logging.spool_dir),
+      sizeof(((app_config_t*)0)->logging.spool_dir) },
+    { "logging", "spool_max_mb", CFG_TYPE_INT,
+      offsetof(app_config_t, logging.spool_max_mb), 0 },
+    { "logging", "remote_format", CFG_TYPE_STRING,
+      offsetof(app_config_t, logging.remote_format),
+      sizeof(((app_config_t*)0)->logging.remote_format) },
+    { "logging", "remote_compress", CFG_TYPE_BOOL,
+      offsetof(app_config_t, logging.remote_compress), 0 },
+    { "logging", "remote_window", CFG_TYPE_INT,
+      offsetof(app_config_t, logging.remote_window), 0 },
+    { "logging", "remote_topics", CFG_TYPE_STRING,
+      offsetof(app_config_t, logging.remote_topics),
+      sizeof(((app_config_t*)0)->logging.remote_topics) },
+    { "logging", "mqtt_version", CFG_TYPE_INT,
+      offsetof(app_config_t, logging.mqtt_version), 0 },
+    { "logging", "compression", CFG_TYPE_STRING,
+      offsetof(app_config_t, logging.compression),
+      sizeof(((app_config_t*)0)->logging.compression) },
+    { "logging", "compression_dev", CFG_TYPE_FLOAT,
+      offsetof(app_config_t, logging.compression_dev), 0 },
+    { "logging", "compression_heartbeat_s", CFG_TYPE_INT,
+      offsetof(app_config_t, logging.compression_heartbeat_s), 0 },
+    { "logging", "compression_devs", CFG_TYPE_STRING,
+      offsetof(app_config_t, logging.compression_devs),
+      sizeof(((app_config_t*)0)->logging.compression_devs) },
 
     /* Health section */
     { "health", "enabled", CFG_TYPE_BOOL,
@@ -193,6 +234,15 @@ static void config_load_field(
                 *(uint32_t*)target = (uint32_t)int_val;
             }
             break;
+
+        case CFG_TYPE_FLOAT:
+            if (config_get_string(m, field->section, field->key,
+                                  str_buf, sizeof(str_buf)) == RESULT_OK) {
+                char *end;
+                float f = strtof(str_buf, &end);
+                if (end != str_buf) *(float*)target = f;
+            }
+            break;
     }
 }
 
@@ -348,11 +398,17 @@ void config_get_defaults(app_config_t *c) {
     c->profinet.device_id=0x0001;
     c->profinet.min_device_interval=32;
     c->profinet.enabled=true;
+    c->profinet.packed_channels=WT_PROFINET_PACKED_CHANNELS;
+    c->profinet.alarm_window_ms=WT_PROFINET_ALARM_WINDOW_MS;
+    c->profinet.alarm_rate=WT_PROFINET_ALARM_RATE;
+    c->profinet.alarm_burst=WT_PROFINET_ALARM_BURST;
+    c->profinet.alarm_aggregate=WT_PROFINET_ALARM_AGGREGATE;
 
     /* Database defaults */
     SAFE_STRNCPY(c->database.path,"/var/lib/water-treat/data.db",sizeof(c->database.path));
     c->database.create_if_missing=true;
     c->database.busy_timeout_ms=5000;
+    SAFE_STRNCPY(c->database.storage_profile,WT_STORAGE_PROFILE,sizeof(c->database.storage_profile));
 
     /* Logging defaults */
     c->logging.enabled=true;
@@ -360,6 +416,16 @@ void config_get_defaults(app_config_t *c) {
     c->logging.retention_days=30;
     c->logging.destination=1; /* Local */
     c->logging.remote_enabled=false;
+    SAFE_STRNCPY(c->logging.spool_dir,WT_SPOOL_DIR,sizeof(c->logging.spool_dir));
+    c->logging.spool_max_mb=WT_SPOOL_MAX_MB;
+    SAFE_STRNCPY(c->logging.remote_format,WT_UPLINK_FORMAT,sizeof(c->logging.remote_format));
+    c->logging.remote_compress=WT_UPLINK_COMPRESS;
+    c->logging.remote_window=WT_UPLINK_WINDOW;
+    SAFE_STRNCPY(c->logging.remote_topics,WT_UPLINK_TOPICS,sizeof(c->logging.remote_topics));
+    c->logging.mqtt_version=WT_MQTT_VERSION;
+    SAFE_STRNCPY(c->logging.compression,WT_COMPRESSION,sizeof(c->logging.compression));
+    c->logging.compression_dev=WT_COMPRESSION_DEV;
+    c->logging.compression_heartbeat_s=WT_COMPRESSION_HEARTBEAT_S;
 
     /* Health check defaults - see docs/decisions/DR-001-port-allocation.md */
     c->health.enabled=true;
@@ -10,9 +10,9 @@ typedef struct { config_entry_t entries[MAX_CONFIG_ENTRIES]; int entry_count; ch
 
 typedef struct { char device_name[MAX_NAME_LEN]; char log_level[16]; char log_file[MAX_PATH_LEN]; bool daemon_mode; } system_config_t;
 typedef struct { char interface[32]; char ip_address[16]; char netmask[16]; char gateway[16]; bool dhcp_enabled; } network_config_t;
-typedef struct { char station_name[MAX_NAME_LEN]; uint16_t vendor_id; uint16_t device_id; char product_name[64]; uint32_t min_device_interval; bool enabled; } profinet_config_t;
-typedef struct { char path[MAX_PATH_LEN]; bool create_if_missing; int busy_timeout_ms; } database_config_t;
-typedef struct { bool enabled; int interval_seconds; int retention_days; int destination; char remote_url[MAX_PATH_LEN]; bool remote_enabled; } logging_config_t;
+typedef struct { char station_name[MAX_NAME_LEN]; uint16_t vendor_id; uint16_t device_id; char product_name[64]; uint32_t min_device_interval; bool enabled; int packed_channels; int alarm_window_ms; int alarm_rate; int alarm_burst; int alarm_aggregate; } profinet_config_t;
+typedef struct { char path[MAX_PATH_LEN]; bool create_if_missing; int busy_timeout_ms; char storage_profile[16]; } database_config_t;
+typedef struct { bool enabled; int interval_seconds; int retention_days; int destination; char remote_url[MAX_PATH_LEN]; bool remote_enabled; char spool_dir[MAX_PATH_LEN]; int spool_max_mb; char remote_format[16]; bool remote_compress; int remote_window; char remote_topics[16]; int mqtt_version; char compression[16]; float compression_dev; int compression_heartbeat_s; char compression_devs[MAX_CONFIG_VALUE_LEN]; } logging_config_t;
 typedef struct { bool enabled; bool http_enabled; uint16_t http_port; char file_path[MAX_PATH_LEN]; int update_interval_seconds; } health_config_t;
 typedef struct { bool enabled; int led_count; int brightness; char backend[16]; char spi_device[32]; uint32_t spi_speed_hz; int gpio_pin; int dma_channel; } led_config_app_t;
 typedef struct { int watchdog_interval_ms; int command_timeout_ms; int degraded_alarm_delay_ms; } watchdog_config_t;
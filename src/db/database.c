@@ -1,5 +1,9 @@
 #include "database.h"
+#include "db_partition.h"
+#include "db_storage.h"
+#include "config_defaults.h"
 #include "utils/logger.h"
+#include <unistd.h>
 
 /* Schema split into individual statements to avoid overlength string literals */
 static const char *SCHEMA_STATEMENTS[] = {
@@ -46,11 +50,20 @@ static const char *SCHEMA_STATEMENTS[] = {
 
     "CREATE INDEX IF NOT EXISTS idx_sensor_log_time ON sensor_data_log(module_id, timestamp)",
 
+    "CREATE TABLE IF NOT EXISTS sensor_rollups (module_id INTEGER NOT NULL, "
+    "tier INTEGER NOT NULL, bucket_start INTEGER NOT NULL, sample_count INTEGER NOT NULL, "
+    "min_value REAL, max_value REAL, sum_value REAL, first_value REAL, last_value REAL, "
+    "PRIMARY KEY (module_id, tier, bucket_start), "
+    "FOREIGN KEY (module_id) REFERENCES modules(id) ON DELETE CASCADE) WITHOUT ROWID",
+
     "CREATE TABLE IF NOT EXISTS alarm_rules (id INTEGER PRIMARY KEY AUTOINCREMENT, "
     "module_id INTEGER NOT NULL, name TEXT, condition INTEGER NOT NULL, threshold_high REAL, "
     "threshold_low REAL, severity INTEGER DEFAULT 2, enabled INTEGER DEFAULT 1, auto_clear INTEGER DEFAULT 1, "
     "hysteresis_percent INTEGER DEFAULT 5, interlock_enabled INTEGER DEFAULT 0, interlock_slot INTEGER DEFAULT 0, "
     "interlock_action INTEGER DEFAULT 0, interlock_pwm_duty INTEGER DEFAULT 0, release_on_clear INTEGER DEFAULT 1, "
+    "window_seconds INTEGER DEFAULT 60, "
+    "on_delay_seconds INTEGER DEFAULT 0, off_delay_seconds INTEGER DEFAULT 0, "
+    "chatter_count INTEGER DEFAULT 0, chatter_window_seconds INTEGER DEFAULT 60, "
     "FOREIGN KEY (module_id) REFERENCES modules(id) ON DELETE CASCADE)",
 
     "CREATE INDEX IF NOT EXISTS idx_alarm_rules_module ON alarm_rules(module_id)",
@@ -63,9 +76,6 @@ static const char *SCHEMA_STATEMENTS[] = {
 
     "CREATE INDEX IF NOT EXISTS idx_alarm_state ON alarm_history(state)",
 
-    "CREATE TABLE IF NOT EXISTS events (id INTEGER PRIMARY KEY AUTOINCREMENT, "
-    "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP, source TEXT, level TEXT DEFAULT 'info', message TEXT)",
-
     "CREATE TABLE IF NOT EXISTS logging_config (id INTEGER PRIMARY KEY CHECK (id = 1), "
     "enabled INTEGER DEFAULT 0, interval_seconds INTEGER DEFAULT 60, retention_days INTEGER DEFAULT 30, "
     "remote_url TEXT, remote_enabled INTEGER DEFAULT 0)",
@@ -89,13 +99,77 @@ static const char *SCHEMA_STATEMENTS[] = {
     NULL  /* Sentinel */
 };
 
+/* Columns added to existing tables; ALTER fails harmlessly once applied */
+static const char *SCHEMA_UPGRADES[] = {
+    "ALTER TABLE alarm_rules ADD COLUMN window_seconds INTEGER DEFAULT 60",
+    "ALTER TABLE alarm_rules ADD COLUMN on_delay_seconds INTEGER DEFAULT 0",
+    "ALTER TABLE alarm_rules ADD COLUMN off_delay_seconds INTEGER DEFAULT 0",
+    "ALTER TABLE alarm_rules ADD COLUMN chatter_count INTEGER DEFAULT 0",
+    "ALTER TABLE alarm_rules ADD COLUMN chatter_window_seconds INTEGER DEFAULT 60",
+
+    NULL  /* Sentinel */
+};
+
+/* Time-partitioned tables (see db_partition.h); read through a view of this name */
+const db_partition_set_t DB_PARTITION_HISTORY = {
+    .name = "sensor_history_blocks",
+    .columns = "module_id INTEGER NOT NULL, block_start INTEGER NOT NULL, "
+               "block_end INTEGER NOT NULL, sample_count INTEGER NOT NULL, data BLOB NOT NULL, "
+               "PRIMARY KEY (module_id, block_start), "
+               "FOREIGN KEY (module_id) REFERENCES modules(id) ON DELETE CASCADE",
+    .key_ms_sql = "block_start",
+    .period_days = WT_HISTORY_PARTITION_DAYS,
+    .slack_ms = (int64_t)WT_HISTORY_BLOCK_SPAN_S * 1000,
+};
+
+const db_partition_set_t DB_PARTITION_EVENTS = {
+    .name = "events",
+    .columns = "id INTEGER PRIMARY KEY AUTOINCREMENT, timestamp DATETIME DEFAULT CURRENT_TIMESTAMP, "
+               "source TEXT, level TEXT DEFAULT 'info', message TEXT",
+    .key_ms_sql = "CAST(strftime('%s', timestamp) AS INTEGER) * 1000",
+    .period_days = WT_EVENT_PARTITION_DAYS,
+};
+
+static const db_partition_set_t *PARTITIONED_TABLES[] = {
+    &DB_PARTITION_HISTORY,
+    &DB_PARTITION_EVENTS,
+    NULL  /* Sentinel */
+};
+
+/*
+ * Busy handler with the back-off sqlite3_busy_timeout() uses, bounded by
+ * WT_DATABASE_TIMEOUT_MS, that also counts how often and how long each
+ * connection waited for a lock.
+ */
+static int busy_handler(void *arg, int count) {
+    static const uint8_t delays_ms[] = { 1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100 };
+    const int n_delays = (int)(sizeof(delays_ms) / sizeof(delays_ms[0]));
+    database_t *db = arg;
+
+    int waited = 0;
+    for (int i = 0; i < count; i++) waited += i < n_delays ? delays_ms[i] : 100;
+    int delay = count < n_delays ? delays_ms[count] : 100;
+    if (waited + delay > WT_DATABASE_TIMEOUT_MS) delay = WT_DATABASE_TIMEOUT_MS - waited;
+    if (delay <= 0) {
+        atomic_fetch_add(&db->busy_timeouts, 1);
+        return 0;
+    }
+
+    if (count == 0) atomic_fetch_add(&db->busy_waits, 1);
+    usleep((useconds_t)delay * 1000);
+    atomic_fetch_add(&db->busy_wait_ms, (uint64_t)delay);
+    return 1;
+}
+
 result_t database_init(database_t *db, const char *path) {
     CHECK_NULL(db); CHECK_NULL(path);
     memset(db,0,sizeof(*db)); SAFE_STRNCPY(db->db_path,path,sizeof(db->db_path));
+    pthread_mutex_init(&db->stmt_lock, NULL);
     int rc = sqlite3_open(path, &db->db);
     if (rc != SQLITE_OK) { LOG_ERROR("Failed to open database: %s", sqlite3_errmsg(db->db)); sqlite3_close(db->db); db->db=NULL; return RESULT_IO_ERROR; }
     sqlite3_exec(db->db, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL);
-    sqlite3_busy_timeout(db->db, 5000);
+    sqlite3_busy_handler(db->db, busy_handler, db);
+    db_storage_configure(db, false);
     sqlite3_exec(db->db, "PRAGMA journal_mode = WAL;", NULL, NULL, NULL);
     /* Execute each schema statement */
     for (int i = 0; SCHEMA_STATEMENTS[i] != NULL; i++) {
@@ -103,10 +177,37 @@ result_t database_init(database_t *db, const char *path) {
         rc = sqlite3_exec(db->db, SCHEMA_STATEMENTS[i], NULL, NULL, &err);
         if (rc != SQLITE_OK) { LOG_ERROR("Schema error: %s", err); sqlite3_free(err); sqlite3_close(db->db); db->db=NULL; return RESULT_ERROR; }
     }
+    for (int i = 0; SCHEMA_UPGRADES[i] != NULL; i++) {
+        sqlite3_exec(db->db, SCHEMA_UPGRADES[i], NULL, NULL, NULL);
+    }
+    for (int i = 0; PARTITIONED_TABLES[i] != NULL; i++) {
+        if (db_partition_setup(db, PARTITIONED_TABLES[i]) != RESULT_OK) { sqlite3_close(db->db); db->db=NULL; return RESULT_ERROR; }
+    }
     db->initialized = true; LOG_INFO("Database initialized: %s", path); return RESULT_OK;
 }
 
-void database_close(database_t *db) { if (db && db->db) { sqlite3_close(db->db); db->db=NULL; db->initialized=false; LOG_INFO("Database closed"); } }
+result_t database_open_reader(database_t *db, const char *path) {
+    CHECK_NULL(db); CHECK_NULL(path);
+    memset(db,0,sizeof(*db)); SAFE_STRNCPY(db->db_path,path,sizeof(db->db_path));
+    pthread_mutex_init(&db->stmt_lock, NULL);
+    int rc = sqlite3_open_v2(path, &db->db, SQLITE_OPEN_READONLY, NULL);
+    if (rc != SQLITE_OK) { LOG_ERROR("Failed to open database reader: %s", sqlite3_errmsg(db->db)); sqlite3_close(db->db); db->db=NULL; return RESULT_IO_ERROR; }
+    sqlite3_busy_handler(db->db, busy_handler, db);
+    db_storage_configure(db, true);
+    db->initialized = true; return RESULT_OK;
+}
+
+static void stmt_cache_clear(database_t *db) {
+    pthread_mutex_lock(&db->stmt_lock);
+    for (int i = 0; i < WT_DATABASE_STMT_CACHE; i++) {
+        if (db->stmts[i].stmt) sqlite3_finalize(db->stmts[i].stmt);
+        memset(&db->stmts[i], 0, sizeof(db->stmts[i]));
+    }
+    db->stats.stmt_cached = 0;
+    pthread_mutex_unlock(&db->stmt_lock);
+}
+
+void database_close(database_t *db) { if (db && db->db) { stmt_cache_clear(db); sqlite3_close(db->db); db->db=NULL; db->initialized=false; LOG_INFO("Database closed"); } }
 bool database_is_connected(database_t *db) { return db && db->db && db->initialized; }
 result_t database_execute(database_t *db, const char *sql) { CHECK_NULL(db); CHECK_NULL(sql); if (!db->db) return RESULT_NOT_INITIALIZED; char *err=NULL; int rc=sqlite3_exec(db->db,sql,NULL,NULL,&err); if(rc!=SQLITE_OK) { LOG_ERROR("SQL: %s",err); sqlite3_free(err); return RESULT_ERROR; } return RESULT_OK; }
 result_t database_begin_transaction(database_t *db) { return database_execute(db, "BEGIN TRANSACTION;"); }
@@ -115,3 +216,88 @@ result_t database_rollback(database_t *db) { return database_execute(db, "ROLLBA
 int64_t database_last_insert_id(database_t *db) { return db && db->db ? sqlite3_last_insert_rowid(db->db) : 0; }
 int database_changes(database_t *db) { return db && db->db ? sqlite3_changes(db->db) : 0; }
 const char* database_error_message(database_t *db) { return db && db->db ? sqlite3_errmsg(db->db) : "Not initialized"; }
+
+/* ============================================================================
+ * Statement Cache
+ * ========================================================================== */
+
+static uint32_t sql_hash(const char *sql) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)sql; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+sqlite3_stmt* database_prepare(database_t *db, const char *sql) {
+    if (!db || !db->db || !sql) return NULL;
+    uint32_t hash = sql_hash(sql);
+
+    pthread_mutex_lock(&db->stmt_lock);
+    db_stmt_slot_t *slot = NULL;
+    for (int i = 0; i < WT_DATABASE_STMT_CACHE; i++) {
+        db_stmt_slot_t *s = &db->stmts[i];
+        if (s->stmt && !s->in_use && s->hash == hash && strcmp(sqlite3_sql(s->stmt), sql) == 0) {
+            s->in_use = true;
+            s->last_used = ++db->stmt_clock;
+            db->stats.stmt_hits++;
+            pthread_mutex_unlock(&db->stmt_lock);
+            return s->stmt;
+        }
+        /* Room for a new one: an empty slot, else the least recently used idle one */
+        if (s->in_use) continue;
+        if (!slot || (slot->stmt && (!s->stmt || s->last_used < slot->last_used))) slot = s;
+    }
+
+    db->stats.stmt_misses++;
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        pthread_mutex_unlock(&db->stmt_lock);
+        return NULL;
+    }
+
+    /* Every slot out at once: the statement is the caller's alone */
+    if (slot) {
+        if (slot->stmt) {
+            sqlite3_finalize(slot->stmt);
+            db->stats.stmt_evictions++;
+        } else {
+            db->stats.stmt_cached++;
+        }
+        *slot = (db_stmt_slot_t){ .stmt = stmt, .hash = hash, .in_use = true,
+                                  .last_used = ++db->stmt_clock };
+    }
+    pthread_mutex_unlock(&db->stmt_lock);
+    return stmt;
+}
+
+void database_release(database_t *db, sqlite3_stmt *stmt) {
+    if (!db || !stmt) return;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    pthread_mutex_lock(&db->stmt_lock);
+    bool cached = false;
+    for (int i = 0; i < WT_DATABASE_STMT_CACHE && !cached; i++) {
+        if (db->stmts[i].stmt == stmt) {
+            db->stmts[i].in_use = false;
+            cached = true;
+        }
+    }
+    pthread_mutex_unlock(&db->stmt_lock);
+
+    if (!cached) sqlite3_finalize(stmt);
+}
+
+void database_get_stats(database_t *db, database_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!db) return;
+    pthread_mutex_lock(&db->stmt_lock);
+    *stats = db->stats;
+    pthread_mutex_unlock(&db->stmt_lock);
+    stats->busy_waits = atomic_load(&db->busy_waits);
+    stats->busy_wait_ms = atomic_load(&db->busy_wait_ms);
+    stats->busy_timeouts = atomic_load(&db->busy_timeouts);
+}
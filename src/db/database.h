@@ -2,11 +2,37 @@
 #define DATABASE_H
 
 #include "common.h"
+#include "config_defaults.h"
+#include <pthread.h>
 #include <sqlite3.h>
+#include <stdatomic.h>
 
-typedef struct { sqlite3 *db; char db_path[MAX_PATH_LEN]; bool initialized; } database_t;
+/* A prepared statement kept for reuse; the key is its SQL text */
+typedef struct { sqlite3_stmt *stmt; uint32_t hash; bool in_use; uint64_t last_used; } db_stmt_slot_t;
+
+typedef struct {
+    uint64_t stmt_hits;         /* Statements handed out from the cache */
+    uint64_t stmt_misses;       /* Statements that had to be prepared */
+    uint64_t stmt_evictions;    /* Cached statements finalized to make room */
+    int stmt_cached;
+    uint64_t busy_waits;        /* Statements that found the database locked */
+    uint64_t busy_wait_ms;      /* Time spent waiting for those locks */
+    uint64_t busy_timeouts;     /* Waits that gave up (SQLITE_BUSY returned) */
+} database_stats_t;
+
+typedef struct {
+    sqlite3 *db; char db_path[MAX_PATH_LEN]; bool initialized;
+    pthread_mutex_t stmt_lock;
+    db_stmt_slot_t stmts[WT_DATABASE_STMT_CACHE];
+    uint64_t stmt_clock;
+    database_stats_t stats;
+    /* Lock contention, counted from the busy handler (no stmt_lock there) */
+    atomic_uint_least64_t busy_waits, busy_wait_ms, busy_timeouts;
+} database_t;
 
 result_t database_init(database_t *db, const char *path);
+/* Extra read-only connection to an initialized database (WAL: never blocks the writer) */
+result_t database_open_reader(database_t *db, const char *path);
 void database_close(database_t *db);
 bool database_is_connected(database_t *db);
 result_t database_execute(database_t *db, const char *sql);
@@ -17,4 +43,22 @@ int64_t database_last_insert_id(database_t *db);
 int database_changes(database_t *db);
 const char* database_error_message(database_t *db);
 
+/**
+ * @brief Prepared statement for sql, reused from the connection's cache
+ *
+ * The statement comes reset with no bindings and belongs to the caller
+ * until database_release(). If the cached copy is out with another caller
+ * a second one is prepared. The SQL text is the key, so values belong in
+ * bindings, not in the text.
+ * @return NULL if it does not prepare (database_error_message() says why)
+ */
+sqlite3_stmt* database_prepare(database_t *db, const char *sql);
+
+/**
+ * @brief Reset a statement from database_prepare() and hand it back
+ */
+void database_release(database_t *db, sqlite3_stmt *stmt);
+
+void database_get_stats(database_t *db, database_stats_t *stats);
+
 #endif
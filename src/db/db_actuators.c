@@ -53,7 +53,7 @@ result_t db_actuator_create(database_t *db, db_actuator_t *actuator, int *actuat
                       "status, enabled) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         LOG_ERROR("Prepare failed: %s", sqlite3_errmsg(db->db));
         return RESULT_ERROR;
     }
@@ -73,7 +73,7 @@ result_t db_actuator_create(database_t *db, db_actuator_t *actuator, int *actuat
     sqlite3_bind_int(stmt, 13, actuator->enabled ? 1 : 0);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("Insert actuator failed: %s", sqlite3_errmsg(db->db));
@@ -86,10 +86,10 @@ result_t db_actuator_create(database_t *db, db_actuator_t *actuator, int *actuat
     // Create actuator_state entry
     const char *state_sql = "INSERT INTO actuator_state (actuator_id, state, pwm_duty) VALUES (?, 0, 0);";
     sqlite3_stmt *state_stmt;
-    if (sqlite3_prepare_v2(db->db, state_sql, -1, &state_stmt, NULL) == SQLITE_OK) {
+    if ((state_stmt = database_prepare(db, state_sql))) {
         sqlite3_bind_int(state_stmt, 1, *actuator_id);
         sqlite3_step(state_stmt);
-        sqlite3_finalize(state_stmt);
+        database_release(db, state_stmt);
     }
 
     LOG_INFO("Created actuator %d: %s (slot %d, gpio %d)", *actuator_id, actuator->name,
@@ -106,7 +106,7 @@ result_t db_actuator_update(database_t *db, db_actuator_t *actuator) {
                       "pwm_frequency_hz=?, status=?, enabled=?, updated_at=datetime('now') WHERE id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
 
     sqlite3_bind_int(stmt, 1, actuator->slot);
     sqlite3_bind_int(stmt, 2, actuator->subslot);
@@ -124,7 +124,7 @@ result_t db_actuator_update(database_t *db, db_actuator_t *actuator) {
     sqlite3_bind_int(stmt, 14, actuator->id);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
@@ -136,11 +136,11 @@ result_t db_actuator_delete(database_t *db, int actuator_id) {
     const char *sql = "DELETE FROM actuators WHERE id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, actuator_id);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     if (rc == SQLITE_DONE && sqlite3_changes(db->db) > 0) {
         LOG_INFO("Deleted actuator %d", actuator_id);
@@ -158,11 +158,11 @@ result_t db_actuator_get(database_t *db, int actuator_id, db_actuator_t *actuato
                       "FROM actuators WHERE id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, actuator_id);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
 
@@ -181,7 +181,7 @@ result_t db_actuator_get(database_t *db, int actuator_id, db_actuator_t *actuato
     SAFE_STRNCPY(actuator->status, (const char*)sqlite3_column_text(stmt, 12), sizeof(actuator->status));
     actuator->enabled = sqlite3_column_int(stmt, 13) != 0;
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -194,11 +194,11 @@ result_t db_actuator_get_by_slot(database_t *db, int slot, db_actuator_t *actuat
                       "FROM actuators WHERE slot=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, slot);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
 
@@ -217,7 +217,7 @@ result_t db_actuator_get_by_slot(database_t *db, int slot, db_actuator_t *actuat
     SAFE_STRNCPY(actuator->status, (const char*)sqlite3_column_text(stmt, 12), sizeof(actuator->status));
     actuator->enabled = sqlite3_column_int(stmt, 13) != 0;
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -231,11 +231,11 @@ result_t db_actuator_list(database_t *db, db_actuator_t **actuators, int *count)
     // Count first
     const char *count_sql = "SELECT COUNT(*) FROM actuators;";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db->db, count_sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, count_sql))) return RESULT_ERROR;
 
     int total = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) total = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     if (total == 0) return RESULT_OK;
 
@@ -245,7 +245,7 @@ result_t db_actuator_list(database_t *db, db_actuator_t **actuators, int *count)
     const char *sql = "SELECT id, slot, subslot, name, type, gpio_pin, gpio_chip, active_low, "
                       "safe_state, min_on_time_ms, max_on_time_ms, pwm_frequency_hz, status, enabled "
                       "FROM actuators ORDER BY slot;";
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         free(*actuators);
         *actuators = NULL;
         return RESULT_ERROR;
@@ -270,7 +270,7 @@ result_t db_actuator_list(database_t *db, db_actuator_t **actuators, int *count)
         idx++;
     }
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -281,13 +281,13 @@ result_t db_actuator_count(database_t *db, int *count) {
 
     const char *sql = "SELECT COUNT(*) FROM actuators;";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
 
     *count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         *count = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -303,14 +303,14 @@ result_t db_actuator_state_update(database_t *db, int actuator_id, bool state, i
                       "WHERE actuator_id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
 
     sqlite3_bind_int(stmt, 1, state ? 1 : 0);
     sqlite3_bind_int(stmt, 2, pwm_duty);
     sqlite3_bind_int(stmt, 3, actuator_id);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
@@ -323,11 +323,11 @@ result_t db_actuator_state_get(database_t *db, int actuator_id, db_actuator_stat
                       "FROM actuator_state WHERE actuator_id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, actuator_id);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
 
@@ -337,7 +337,7 @@ result_t db_actuator_state_get(database_t *db, int actuator_id, db_actuator_stat
     state->total_on_time_ms = sqlite3_column_int64(stmt, 3);
     state->cycle_count = sqlite3_column_int(stmt, 4);
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -348,11 +348,11 @@ result_t db_actuator_state_increment_cycle(database_t *db, int actuator_id) {
     const char *sql = "UPDATE actuator_state SET cycle_count = cycle_count + 1 WHERE actuator_id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, actuator_id);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
@@ -390,7 +390,7 @@ result_t db_actuator_gpio_conflict_check(database_t *db, int gpio_pin,
                       "WHERE gpio_pin = ? AND gpio_chip = ? AND id != ?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         LOG_ERROR("Prepare failed: %s", sqlite3_errmsg(db->db));
         return RESULT_ERROR;
     }
@@ -410,10 +410,10 @@ result_t db_actuator_gpio_conflict_check(database_t *db, int gpio_pin,
         }
         LOG_DEBUG("GPIO conflict: pin %d on %s already used by actuator %d (%s)",
                   gpio_pin, chip, conflict->conflicting_actuator_id, conflict->conflicting_name);
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_OK;
     }
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     /* Also check sensors that use GPIO (DHT22, float switches, etc.)
      * Sensors store GPIO pin in 'address' field when interface is GPIO-based */
@@ -422,7 +422,7 @@ result_t db_actuator_gpio_conflict_check(database_t *db, int gpio_pin,
         "JOIN modules m ON ps.module_id = m.id "
         "WHERE ps.address = ? AND ps.sensor_type IN ('DHT22', 'DHT11', 'FLOAT_SWITCH', 'GPIO');";
 
-    if (sqlite3_prepare_v2(db->db, sensor_sql, -1, &stmt, NULL) == SQLITE_OK) {
+    if ((stmt = database_prepare(db, sensor_sql))) {
         sqlite3_bind_text(stmt, 1, gpio_str, -1, SQLITE_TRANSIENT);
 
         if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -437,7 +437,7 @@ result_t db_actuator_gpio_conflict_check(database_t *db, int gpio_pin,
             LOG_DEBUG("GPIO conflict: pin %d already used by sensor %s",
                       gpio_pin, conflict->conflicting_name);
         }
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
     }
 
     return RESULT_OK;
@@ -14,10 +14,10 @@ result_t db_alarm_rule_create(database_t *db, db_alarm_rule_t *rule, int *rule_i
     CHECK_NULL(db); CHECK_NULL(rule); CHECK_NULL(rule_id);
     if (!db->db) return RESULT_NOT_INITIALIZED;
 
-    const char *sql = "INSERT INTO alarm_rules (module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+    const char *sql = "INSERT INTO alarm_rules (module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear, window_seconds, on_delay_seconds, off_delay_seconds, chatter_count, chatter_window_seconds) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         LOG_ERROR("Prepare failed: %s", sqlite3_errmsg(db->db));
         return RESULT_ERROR;
     }
@@ -36,9 +36,14 @@ result_t db_alarm_rule_create(database_t *db, db_alarm_rule_t *rule, int *rule_i
     sqlite3_bind_int(stmt, 12, (int)rule->interlock_action);
     sqlite3_bind_int(stmt, 13, rule->interlock_pwm_duty);
     sqlite3_bind_int(stmt, 14, rule->release_on_clear ? 1 : 0);
+    sqlite3_bind_int(stmt, 15, rule->window_seconds);
+    sqlite3_bind_int(stmt, 16, rule->on_delay_seconds);
+    sqlite3_bind_int(stmt, 17, rule->off_delay_seconds);
+    sqlite3_bind_int(stmt, 18, rule->chatter_count);
+    sqlite3_bind_int(stmt, 19, rule->chatter_window_seconds);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("Insert alarm rule failed: %s", sqlite3_errmsg(db->db));
@@ -57,10 +62,10 @@ result_t db_alarm_rule_update(database_t *db, db_alarm_rule_t *rule) {
     CHECK_NULL(db); CHECK_NULL(rule);
     if (!db->db) return RESULT_NOT_INITIALIZED;
 
-    const char *sql = "UPDATE alarm_rules SET module_id=?, name=?, condition=?, threshold_high=?, threshold_low=?, severity=?, enabled=?, auto_clear=?, hysteresis_percent=?, interlock_enabled=?, interlock_slot=?, interlock_action=?, interlock_pwm_duty=?, release_on_clear=? WHERE id=?;";
+    const char *sql = "UPDATE alarm_rules SET module_id=?, name=?, condition=?, threshold_high=?, threshold_low=?, severity=?, enabled=?, auto_clear=?, hysteresis_percent=?, interlock_enabled=?, interlock_slot=?, interlock_action=?, interlock_pwm_duty=?, release_on_clear=?, window_seconds=?, on_delay_seconds=?, off_delay_seconds=?, chatter_count=?, chatter_window_seconds=? WHERE id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
 
     sqlite3_bind_int(stmt, 1, rule->module_id);
     sqlite3_bind_text(stmt, 2, rule->name, -1, SQLITE_TRANSIENT);
@@ -76,10 +81,15 @@ result_t db_alarm_rule_update(database_t *db, db_alarm_rule_t *rule) {
     sqlite3_bind_int(stmt, 12, (int)rule->interlock_action);
     sqlite3_bind_int(stmt, 13, rule->interlock_pwm_duty);
     sqlite3_bind_int(stmt, 14, rule->release_on_clear ? 1 : 0);
-    sqlite3_bind_int(stmt, 15, rule->id);
+    sqlite3_bind_int(stmt, 15, rule->window_seconds);
+    sqlite3_bind_int(stmt, 16, rule->on_delay_seconds);
+    sqlite3_bind_int(stmt, 17, rule->off_delay_seconds);
+    sqlite3_bind_int(stmt, 18, rule->chatter_count);
+    sqlite3_bind_int(stmt, 19, rule->chatter_window_seconds);
+    sqlite3_bind_int(stmt, 20, rule->id);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
@@ -91,11 +101,11 @@ result_t db_alarm_rule_delete(database_t *db, int rule_id) {
     const char *sql = "DELETE FROM alarm_rules WHERE id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, rule_id);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE && sqlite3_changes(db->db) > 0) {
         LOG_INFO("Deleted alarm rule %d", rule_id);
@@ -108,14 +118,14 @@ result_t db_alarm_rule_get(database_t *db, int rule_id, db_alarm_rule_t *rule) {
     CHECK_NULL(db); CHECK_NULL(rule);
     if (!db->db) return RESULT_NOT_INITIALIZED;
 
-    const char *sql = "SELECT id, module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear FROM alarm_rules WHERE id=?;";
+    const char *sql = "SELECT id, module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear, window_seconds, on_delay_seconds, off_delay_seconds, chatter_count, chatter_window_seconds FROM alarm_rules WHERE id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, rule_id);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
 
@@ -134,8 +144,13 @@ result_t db_alarm_rule_get(database_t *db, int rule_id, db_alarm_rule_t *rule) {
     rule->interlock_action = (interlock_action_t)sqlite3_column_int(stmt, 12);
     rule->interlock_pwm_duty = (uint8_t)sqlite3_column_int(stmt, 13);
     rule->release_on_clear = sqlite3_column_int(stmt, 14) != 0;
+    rule->window_seconds = sqlite3_column_int(stmt, 15);
+    rule->on_delay_seconds = sqlite3_column_int(stmt, 16);
+    rule->off_delay_seconds = sqlite3_column_int(stmt, 17);
+    rule->chatter_count = sqlite3_column_int(stmt, 18);
+    rule->chatter_window_seconds = sqlite3_column_int(stmt, 19);
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -148,19 +163,19 @@ result_t db_alarm_rule_list(database_t *db, db_alarm_rule_t **rules, int *count)
 
     const char *count_sql = "SELECT COUNT(*) FROM alarm_rules;";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db->db, count_sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, count_sql))) return RESULT_ERROR;
 
     int total = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) total = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     if (total == 0) return RESULT_OK;
 
     *rules = calloc(total, sizeof(db_alarm_rule_t));
     if (!*rules) return RESULT_NO_MEMORY;
 
-    const char *sql = "SELECT id, module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear FROM alarm_rules ORDER BY module_id, id;";
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    const char *sql = "SELECT id, module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear, window_seconds, on_delay_seconds, off_delay_seconds, chatter_count, chatter_window_seconds FROM alarm_rules ORDER BY module_id, id;";
+    if (!(stmt = database_prepare(db, sql))) {
         free(*rules);
         *rules = NULL;
         return RESULT_ERROR;
@@ -183,10 +198,15 @@ result_t db_alarm_rule_list(database_t *db, db_alarm_rule_t **rules, int *count)
         (*rules)[idx].interlock_action = (interlock_action_t)sqlite3_column_int(stmt, 12);
         (*rules)[idx].interlock_pwm_duty = (uint8_t)sqlite3_column_int(stmt, 13);
         (*rules)[idx].release_on_clear = sqlite3_column_int(stmt, 14) != 0;
+        (*rules)[idx].window_seconds = sqlite3_column_int(stmt, 15);
+        (*rules)[idx].on_delay_seconds = sqlite3_column_int(stmt, 16);
+        (*rules)[idx].off_delay_seconds = sqlite3_column_int(stmt, 17);
+        (*rules)[idx].chatter_count = sqlite3_column_int(stmt, 18);
+        (*rules)[idx].chatter_window_seconds = sqlite3_column_int(stmt, 19);
         idx++;
     }
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -198,10 +218,10 @@ result_t db_alarm_rule_list_by_module(database_t *db, int module_id, db_alarm_ru
     *rules = NULL;
     *count = 0;
 
-    const char *sql = "SELECT id, module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear FROM alarm_rules WHERE module_id=? ORDER BY id;";
+    const char *sql = "SELECT id, module_id, name, condition, threshold_high, threshold_low, severity, enabled, auto_clear, hysteresis_percent, interlock_enabled, interlock_slot, interlock_action, interlock_pwm_duty, release_on_clear, window_seconds, on_delay_seconds, off_delay_seconds, chatter_count, chatter_window_seconds FROM alarm_rules WHERE module_id=? ORDER BY id;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
 
     int row_count = 0;
@@ -209,13 +229,13 @@ result_t db_alarm_rule_list_by_module(database_t *db, int module_id, db_alarm_ru
     sqlite3_reset(stmt);
 
     if (row_count == 0) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_OK;
     }
 
     *rules = calloc(row_count, sizeof(db_alarm_rule_t));
     if (!*rules) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NO_MEMORY;
     }
 
@@ -236,10 +256,15 @@ result_t db_alarm_rule_list_by_module(database_t *db, int module_id, db_alarm_ru
         (*rules)[idx].interlock_action = (interlock_action_t)sqlite3_column_int(stmt, 12);
         (*rules)[idx].interlock_pwm_duty = (uint8_t)sqlite3_column_int(stmt, 13);
         (*rules)[idx].release_on_clear = sqlite3_column_int(stmt, 14) != 0;
+        (*rules)[idx].window_seconds = sqlite3_column_int(stmt, 15);
+        (*rules)[idx].on_delay_seconds = sqlite3_column_int(stmt, 16);
+        (*rules)[idx].off_delay_seconds = sqlite3_column_int(stmt, 17);
+        (*rules)[idx].chatter_count = sqlite3_column_int(stmt, 18);
+        (*rules)[idx].chatter_window_seconds = sqlite3_column_int(stmt, 19);
         idx++;
     }
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -251,12 +276,12 @@ result_t db_alarm_rule_set_enabled(database_t *db, int rule_id, bool enabled) {
     const char *sql = "UPDATE alarm_rules SET enabled=? WHERE id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, enabled ? 1 : 0);
     sqlite3_bind_int(stmt, 2, rule_id);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
@@ -272,7 +297,7 @@ result_t db_alarm_raise(database_t *db, db_alarm_history_t *alarm, int *alarm_id
     const char *sql = "INSERT INTO alarm_history (rule_id, module_id, severity, state, message, trigger_value) VALUES (?, ?, ?, 'active', ?, ?);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_int(stmt, 1, alarm->rule_id);
     sqlite3_bind_int(stmt, 2, alarm->module_id);
@@ -281,7 +306,7 @@ result_t db_alarm_raise(database_t *db, db_alarm_history_t *alarm, int *alarm_id
     sqlite3_bind_double(stmt, 5, alarm->trigger_value);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc != SQLITE_DONE) return RESULT_ERROR;
     
@@ -293,47 +318,104 @@ result_t db_alarm_raise(database_t *db, db_alarm_history_t *alarm, int *alarm_id
     return RESULT_OK;
 }
 
+result_t db_alarm_insert(database_t *db, const db_alarm_history_t *alarm) {
+    CHECK_NULL(db); CHECK_NULL(alarm);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+    if (alarm->id <= 0) return RESULT_INVALID_PARAM;
+
+    const char *sql = "INSERT INTO alarm_history (id, rule_id, module_id, severity, state, message, trigger_value, raised_time) "
+                      "VALUES (?, ?, ?, ?, 'active', ?, ?, datetime(?, 'unixepoch'));";
+    sqlite3_stmt *stmt;
+
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
+
+    sqlite3_bind_int(stmt, 1, alarm->id);
+    sqlite3_bind_int(stmt, 2, alarm->rule_id);
+    sqlite3_bind_int(stmt, 3, alarm->module_id);
+    sqlite3_bind_int(stmt, 4, (int)alarm->severity);
+    sqlite3_bind_text(stmt, 5, alarm->message, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, 6, alarm->trigger_value);
+    sqlite3_bind_int64(stmt, 7, (sqlite3_int64)(alarm->raised_time ? alarm->raised_time : time(NULL)));
+
+    int rc = sqlite3_step(stmt);
+    database_release(db, stmt);
+
+    if (rc != SQLITE_DONE) return rc == SQLITE_CONSTRAINT ? RESULT_ALREADY_EXISTS : RESULT_ERROR;
+    return RESULT_OK;
+}
+
+result_t db_alarm_next_id(database_t *db, int *next_id) {
+    CHECK_NULL(db); CHECK_NULL(next_id);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+
+    /* AUTOINCREMENT never reuses IDs, so sqlite_sequence can exceed MAX(id) */
+    const char *sql = "SELECT MAX(COALESCE((SELECT MAX(id) FROM alarm_history), 0), "
+                      "COALESCE((SELECT seq FROM sqlite_sequence WHERE name='alarm_history'), 0));";
+    sqlite3_stmt *stmt;
+
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
+
+    result_t result = RESULT_ERROR;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *next_id = sqlite3_column_int(stmt, 0) + 1;
+        result = RESULT_OK;
+    }
+    database_release(db, stmt);
+    return result;
+}
+
 result_t db_alarm_acknowledge(database_t *db, int alarm_id, const char *acknowledged_by) {
+    return db_alarm_acknowledge_at(db, alarm_id, acknowledged_by, time(NULL));
+}
+
+result_t db_alarm_acknowledge_at(database_t *db, int alarm_id, const char *acknowledged_by,
+                                 time_t acknowledged_time) {
     CHECK_NULL(db);
     if (!db->db) return RESULT_NOT_INITIALIZED;
     
-    const char *sql = "UPDATE alarm_history SET state='acknowledged', acknowledged_time=datetime('now'), acknowledged_by=? WHERE id=? AND state='active';";
+    const char *sql = "UPDATE alarm_history SET state='acknowledged', acknowledged_time=datetime(?, 'unixepoch'), acknowledged_by=? WHERE id=? AND state='active';";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
-    sqlite3_bind_text(stmt, 1, acknowledged_by ? acknowledged_by : "operator", -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 2, alarm_id);
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)acknowledged_time);
+    sqlite3_bind_text(stmt, 2, acknowledged_by ? acknowledged_by : "operator", -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 3, alarm_id);
     
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db->db);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE && changes > 0) {
         LOG_INFO("Alarm %d acknowledged by %s", alarm_id, acknowledged_by ? acknowledged_by : "operator");
         return RESULT_OK;
     }
-    return RESULT_NOT_FOUND;
+    return rc == SQLITE_DONE ? RESULT_NOT_FOUND : RESULT_ERROR;
 }
 
 result_t db_alarm_clear(database_t *db, int alarm_id) {
+    return db_alarm_clear_at(db, alarm_id, time(NULL));
+}
+
+result_t db_alarm_clear_at(database_t *db, int alarm_id, time_t cleared_time) {
     CHECK_NULL(db);
     if (!db->db) return RESULT_NOT_INITIALIZED;
     
-    const char *sql = "UPDATE alarm_history SET state='cleared', cleared_time=datetime('now') WHERE id=? AND state IN ('active', 'acknowledged');";
+    const char *sql = "UPDATE alarm_history SET state='cleared', cleared_time=datetime(?, 'unixepoch') WHERE id=? AND state IN ('active', 'acknowledged');";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
-    sqlite3_bind_int(stmt, 1, alarm_id);
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)cleared_time);
+    sqlite3_bind_int(stmt, 2, alarm_id);
     
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db->db);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE && changes > 0) {
         LOG_INFO("Alarm %d cleared", alarm_id);
         return RESULT_OK;
     }
-    return RESULT_NOT_FOUND;
+    return rc == SQLITE_DONE ? RESULT_NOT_FOUND : RESULT_ERROR;
 }
 
 result_t db_alarm_clear_by_rule(database_t *db, int rule_id) {
@@ -343,12 +425,12 @@ result_t db_alarm_clear_by_rule(database_t *db, int rule_id) {
     const char *sql = "UPDATE alarm_history SET state='cleared', cleared_time=datetime('now') WHERE rule_id=? AND state IN ('active', 'acknowledged');";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, rule_id);
     
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db->db);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (changes > 0) LOG_INFO("Cleared %d alarms for rule %d", changes, rule_id);
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
@@ -361,11 +443,11 @@ result_t db_alarm_get(database_t *db, int alarm_id, db_alarm_history_t *alarm) {
     const char *sql = "SELECT id, rule_id, module_id, severity, state, message, trigger_value, strftime('%s', raised_time), strftime('%s', acknowledged_time), strftime('%s', cleared_time), acknowledged_by FROM alarm_history WHERE id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, alarm_id);
     
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
     
@@ -386,7 +468,7 @@ result_t db_alarm_get(database_t *db, int alarm_id, db_alarm_history_t *alarm) {
     alarm->cleared_time = (time_t)sqlite3_column_int64(stmt, 9);
     SAFE_STRNCPY(alarm->acknowledged_by, (const char*)sqlite3_column_text(stmt, 10), sizeof(alarm->acknowledged_by));
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -400,20 +482,20 @@ result_t db_alarm_list_active(database_t *db, db_alarm_history_t **alarms, int *
     const char *sql = "SELECT id, rule_id, module_id, severity, state, message, trigger_value, strftime('%s', raised_time), strftime('%s', acknowledged_time), strftime('%s', cleared_time), acknowledged_by FROM alarm_history WHERE state IN ('active', 'acknowledged') ORDER BY severity DESC, raised_time DESC;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     int row_count = 0;
     while (sqlite3_step(stmt) == SQLITE_ROW) row_count++;
     sqlite3_reset(stmt);
     
     if (row_count == 0) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_OK;
     }
     
     *alarms = calloc(row_count, sizeof(db_alarm_history_t));
     if (!*alarms) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NO_MEMORY;
     }
     
@@ -437,7 +519,7 @@ result_t db_alarm_list_active(database_t *db, db_alarm_history_t **alarms, int *
         idx++;
     }
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -449,11 +531,11 @@ result_t db_alarm_count_active(database_t *db, int *count) {
     const char *sql = "SELECT COUNT(*) FROM alarm_history WHERE state IN ('active', 'acknowledged');";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     *count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) *count = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -464,12 +546,12 @@ result_t db_alarm_count_by_severity(database_t *db, alarm_severity_t severity, i
     const char *sql = "SELECT COUNT(*) FROM alarm_history WHERE state IN ('active', 'acknowledged') AND severity=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, (int)severity);
     
     *count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) *count = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -480,12 +562,12 @@ result_t db_alarm_has_active_for_rule(database_t *db, int rule_id, bool *has_act
     const char *sql = "SELECT COUNT(*) FROM alarm_history WHERE rule_id=? AND state IN ('active', 'acknowledged');";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, rule_id);
     
     *has_active = false;
     if (sqlite3_step(stmt) == SQLITE_ROW) *has_active = sqlite3_column_int(stmt, 0) > 0;
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -529,6 +611,9 @@ const char* alarm_condition_to_string(alarm_condition_t condition) {
         case ALARM_CONDITION_BELOW_THRESHOLD: return "Below Threshold";
         case ALARM_CONDITION_OUT_OF_RANGE: return "Out of Range";
         case ALARM_CONDITION_RATE_OF_CHANGE: return "Rate of Change";
+        case ALARM_CONDITION_DEVIATION: return "Baseline Deviation";
+        case ALARM_CONDITION_STALE: return "Stale/Flatline";
+        case ALARM_CONDITION_SIGMA: return "Sigma Deviation";
         default: return "Unknown";
     }
 }
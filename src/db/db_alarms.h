@@ -11,12 +11,22 @@ typedef enum {
     ALARM_SEVERITY_CRITICAL
 } alarm_severity_t;
 
+/*
+ * Windowed conditions use window_seconds as their time constant:
+ *   RATE_OF_CHANGE  regression slope (units/min) outside [low, high];
+ *                   low >= 0 means [-high, high]
+ *   DEVIATION       |value - moving baseline| above high
+ *   STALE           value moved no more than low for window_seconds
+ *   SIGMA           |value - mean| above high standard deviations
+ */
 typedef enum {
     ALARM_CONDITION_ABOVE_THRESHOLD = 0,
     ALARM_CONDITION_BELOW_THRESHOLD,
     ALARM_CONDITION_OUT_OF_RANGE,
     ALARM_CONDITION_RATE_OF_CHANGE,
-    ALARM_CONDITION_DEVIATION
+    ALARM_CONDITION_DEVIATION,
+    ALARM_CONDITION_STALE,
+    ALARM_CONDITION_SIGMA
 } alarm_condition_t;
 
 typedef enum {
@@ -53,6 +63,14 @@ typedef struct {
     interlock_action_t interlock_action;  /* Action to take on alarm */
     uint8_t interlock_pwm_duty;       /* PWM duty if action=PWM (0-100) */
     bool release_on_clear;            /* Release to controller when alarm clears */
+
+    int window_seconds;               /* Time constant for windowed conditions */
+
+    /* Flood damping, applied by the alarm manager's timer wheel */
+    int on_delay_seconds;             /* Condition must hold this long to raise */
+    int off_delay_seconds;            /* Clear condition must hold this long to clear */
+    int chatter_count;                /* Onsets within chatter_window_seconds that */
+    int chatter_window_seconds;       /*   latch the alarm (0 = detection off) */
 } db_alarm_rule_t;
 
 typedef struct {
@@ -82,7 +100,13 @@ result_t db_alarm_rule_set_enabled(database_t *db, int rule_id, bool enabled);
 result_t db_alarm_raise(database_t *db, db_alarm_history_t *alarm, int *alarm_id);
 result_t db_alarm_get(database_t *db, int alarm_id, db_alarm_history_t *alarm);
 result_t db_alarm_acknowledge(database_t *db, int alarm_id, const char *user);
+result_t db_alarm_acknowledge_at(database_t *db, int alarm_id, const char *user, time_t acknowledged_time);
 result_t db_alarm_clear(database_t *db, int alarm_id);
+result_t db_alarm_clear_at(database_t *db, int alarm_id, time_t cleared_time);
+
+// Pre-allocated IDs: insert with alarm->id and raised_time already set
+result_t db_alarm_insert(database_t *db, const db_alarm_history_t *alarm);
+result_t db_alarm_next_id(database_t *db, int *next_id);
 result_t db_alarm_clear_by_rule(database_t *db, int rule_id);
 result_t db_alarm_list_active(database_t *db, db_alarm_history_t **alarms, int *count);
 result_t db_alarm_list_history(database_t *db, int limit, db_alarm_history_t **alarms, int *count);
@@ -4,30 +4,104 @@
  */
 
 #include "db_events.h"
+#include "db_partition.h"
+#include "db_writer.h"
 #include "utils/logger.h"
 
 result_t db_event_insert(database_t *db, const char *source, const char *level, const char *message) {
-    CHECK_NULL(db);
-    if (!db->db) return RESULT_NOT_INITIALIZED;
-    
-    const char *sql = "INSERT INTO events (source, level, message) VALUES (?, ?, ?);";
+    return db_event_insert_at(db, time(NULL), source, level, message);
+}
+
+/* db_writer request: one event row */
+typedef struct {
+    time_t timestamp;
+    const char *source;
+    const char *level;
+    const char *message;
+} event_insert_t;
+
+/*
+ * Each partition has its own AUTOINCREMENT counter, so ids are handed out
+ * here, past the highest any partition has used. The counter is seeded
+ * from sqlite_sequence when the connection or the partition changes (open,
+ * a new period) and after a failed insert; the INSERT text is rebuilt only
+ * then too.
+ */
+static struct {
+    pthread_mutex_t mutex;
+    sqlite3 *conn;              /* Connection next_id was seeded on */
+    char table[MAX_NAME_LEN + 32];
+    char sql[MAX_NAME_LEN + 160];
+    int64_t next_id;            /* 0 = seed before the next insert */
+} g_event_ids = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static int64_t seed_event_id(database_t *db) {
+    const char *sql = "SELECT IFNULL(MAX(seq), 0) + 1 FROM sqlite_sequence WHERE name GLOB 'events_p*';";
     sqlite3_stmt *stmt;
-    
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) return 0;
+
+    int64_t next = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) next = sqlite3_column_int64(stmt, 0);
+    database_release(db, stmt);
+    return next;
+}
+
+static result_t event_insert_request(database_t *db, void *arg) {
+    const event_insert_t *ev = arg;
+
+    /* Rows go to the partition for their time; reads use the events view */
+    char table[MAX_NAME_LEN + 32];
+    if (db_partition_table(db, &DB_PARTITION_EVENTS, (int64_t)ev->timestamp * 1000,
+                           table, sizeof(table)) != RESULT_OK) {
+        return RESULT_ERROR;
+    }
+
+    pthread_mutex_lock(&g_event_ids.mutex);
+    if (g_event_ids.conn != db->db || strcmp(g_event_ids.table, table) != 0) {
+        g_event_ids.conn = db->db;
+        SAFE_STRNCPY(g_event_ids.table, table, sizeof(g_event_ids.table));
+        snprintf(g_event_ids.sql, sizeof(g_event_ids.sql),
+                 "INSERT INTO %s (id, timestamp, source, level, message) "
+                 "VALUES (?, datetime(?, 'unixepoch'), ?, ?, ?);", table);
+        g_event_ids.next_id = 0;
+    }
+    if (g_event_ids.next_id == 0) g_event_ids.next_id = seed_event_id(db);
+
+    sqlite3_stmt *stmt;
+    if (g_event_ids.next_id == 0 || !(stmt = database_prepare(db, g_event_ids.sql))) {
+        pthread_mutex_unlock(&g_event_ids.mutex);
         LOG_ERROR("Failed to prepare event insert: %s", sqlite3_errmsg(db->db));
         return RESULT_ERROR;
     }
     
-    sqlite3_bind_text(stmt, 1, source ? source : "system", -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, level ? level : "info", -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, message ? message : "", -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)g_event_ids.next_id);
+    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)ev->timestamp);
+    sqlite3_bind_text(stmt, 3, ev->source ? ev->source : "system", -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 4, ev->level ? ev->level : "info", -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 5, ev->message ? ev->message : "", -1, SQLITE_TRANSIENT);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
+
+    /* A rolled-back insert only leaves a gap; a failed one may mean the seed is stale */
+    g_event_ids.next_id = rc == SQLITE_DONE ? g_event_ids.next_id + 1 : 0;
+    pthread_mutex_unlock(&g_event_ids.mutex);
     
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
 
+result_t db_event_insert_at(database_t *db, time_t timestamp, const char *source,
+                            const char *level, const char *message) {
+    CHECK_NULL(db);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+
+    /* Events come from every thread; only the writer's connection writes */
+    event_insert_t ev = {
+        .timestamp = timestamp, .source = source, .level = level, .message = message,
+    };
+    return db_writer_call(db, event_insert_request, &ev);
+}
+
 result_t db_event_insert_formatted(database_t *db, const char *source, const char *level, const char *fmt, ...) {
     CHECK_NULL(db); CHECK_NULL(fmt);
     
@@ -53,11 +127,11 @@ result_t db_event_list(database_t *db, int limit, db_event_t **events, int *coun
     // Count first
     const char *count_sql = "SELECT COUNT(*) FROM events;";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db->db, count_sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, count_sql))) return RESULT_ERROR;
     
     int total = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) total = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (total == 0) return RESULT_OK;
     
@@ -66,7 +140,7 @@ result_t db_event_list(database_t *db, int limit, db_event_t **events, int *coun
     if (!*events) return RESULT_NO_MEMORY;
     
     const char *sql = "SELECT id, strftime('%s', timestamp), source, level, message FROM events ORDER BY timestamp DESC LIMIT ?;";
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         free(*events);
         *events = NULL;
         return RESULT_ERROR;
@@ -84,7 +158,7 @@ result_t db_event_list(database_t *db, int limit, db_event_t **events, int *coun
         idx++;
     }
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -101,7 +175,7 @@ result_t db_event_list_by_source(database_t *db, const char *source, int limit,
     const char *sql = "SELECT id, strftime('%s', timestamp), source, level, message FROM events WHERE source=? ORDER BY timestamp DESC LIMIT ?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_text(stmt, 1, source, -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 2, limit);
     
@@ -111,13 +185,13 @@ result_t db_event_list_by_source(database_t *db, const char *source, int limit,
     sqlite3_reset(stmt);
     
     if (row_count == 0) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_OK;
     }
     
     *events = calloc(row_count, sizeof(db_event_t));
     if (!*events) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NO_MEMORY;
     }
     
@@ -131,7 +205,7 @@ result_t db_event_list_by_source(database_t *db, const char *source, int limit,
         idx++;
     }
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -148,7 +222,7 @@ result_t db_event_list_by_level(database_t *db, const char *level, int limit, db
     const char *sql = "SELECT id, strftime('%s', timestamp), source, level, message FROM events WHERE level=? ORDER BY timestamp DESC LIMIT ?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_text(stmt, 1, level, -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 2, limit);
     
@@ -157,13 +231,13 @@ result_t db_event_list_by_level(database_t *db, const char *level, int limit, db
     sqlite3_reset(stmt);
     
     if (row_count == 0) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_OK;
     }
     
     *events = calloc(row_count, sizeof(db_event_t));
     if (!*events) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NO_MEMORY;
     }
     
@@ -177,7 +251,7 @@ result_t db_event_list_by_level(database_t *db, const char *level, int limit, db
         idx++;
     }
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -191,26 +265,28 @@ result_t db_event_list_recent(database_t *db, int minutes, db_event_t **events,
     
     if (minutes <= 0) minutes = 60;
     
-    char sql[256];
-    snprintf(sql, sizeof(sql), 
-        "SELECT id, strftime('%%s', timestamp), source, level, message FROM events "
-        "WHERE timestamp >= datetime('now', '-%d minutes') ORDER BY timestamp DESC;", minutes);
+    const char *sql = "SELECT id, strftime('%s', timestamp), source, level, message FROM events "
+                      "WHERE timestamp >= datetime('now', ?) ORDER BY timestamp DESC;";
     
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
+    
+    char since[32];
+    snprintf(since, sizeof(since), "-%d minutes", minutes);
+    sqlite3_bind_text(stmt, 1, since, -1, SQLITE_TRANSIENT);
     
     int row_count = 0;
     while (sqlite3_step(stmt) == SQLITE_ROW) row_count++;
     sqlite3_reset(stmt);
     
     if (row_count == 0) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_OK;
     }
     
     *events = calloc(row_count, sizeof(db_event_t));
     if (!*events) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NO_MEMORY;
     }
     
@@ -224,7 +300,7 @@ result_t db_event_list_recent(database_t *db, int minutes, db_event_t **events,
         idx++;
     }
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     *count = idx;
     return RESULT_OK;
 }
@@ -234,21 +310,9 @@ result_t db_event_cleanup(database_t *db, int retention_days) {
     if (!db->db) return RESULT_NOT_INITIALIZED;
     if (retention_days <= 0) return RESULT_OK;
     
-    char sql[128];
-    snprintf(sql, sizeof(sql), "DELETE FROM events WHERE timestamp < datetime('now', '-%d days');", retention_days);
-    
-    char *err = NULL;
-    int rc = sqlite3_exec(db->db, sql, NULL, NULL, &err);
-    
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Event cleanup failed: %s", err);
-        sqlite3_free(err);
-        return RESULT_ERROR;
-    }
-    
-    int deleted = sqlite3_changes(db->db);
-    if (deleted > 0) LOG_INFO("Cleaned up %d old events", deleted);
-    return RESULT_OK;
+    // Whole partitions only: events may outlive retention by up to one partition
+    int64_t cutoff = ((int64_t)time(NULL) - (int64_t)retention_days * 86400) * 1000;
+    return db_partition_drop_before(db, &DB_PARTITION_EVENTS, cutoff, NULL);
 }
 
 result_t db_event_count(database_t *db, int *count) {
@@ -258,11 +322,11 @@ result_t db_event_count(database_t *db, int *count) {
     const char *sql = "SELECT COUNT(*) FROM events;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     *count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) *count = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -273,12 +337,12 @@ result_t db_event_count_by_level(database_t *db, const char *level, int *count)
     const char *sql = "SELECT COUNT(*) FROM events WHERE level=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_text(stmt, 1, level, -1, SQLITE_TRANSIENT);
     
     *count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) *count = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
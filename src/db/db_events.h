@@ -13,8 +13,10 @@ typedef struct {
     char message[512];
 } db_event_t;
 
-// Event logging operations
+// Event logging operations (run on the database writer; db is its fallback)
 result_t db_event_insert(database_t *db, const char *source, const char *level, const char *message);
+result_t db_event_insert_at(database_t *db, time_t timestamp, const char *source,
+                            const char *level, const char *message);
 result_t db_event_insert_formatted(database_t *db, const char *source, const char *level, const char *fmt, ...);
 
 // Event retrieval operations
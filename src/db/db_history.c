@@ -0,0 +1,341 @@
+/**
+ * @file db_history.c
+ * @brief Compressed sensor history stored as per-sensor blocks
+ */
+
+#include "db_history.h"
+#include "db_partition.h"
+#include "utils/logger.h"
+
+#define BLOCK_SPAN_MS   ((int64_t)WT_HISTORY_BLOCK_SPAN_S * 1000)
+
+/* ============================================================================
+ * Writer
+ * ============================================================================ */
+
+void db_history_writer_init(db_history_writer_t *writer) {
+    memset(writer, 0, sizeof(*writer));
+    db_rollup_writer_init(&writer->rollups);
+}
+
+void db_history_writer_free(db_history_writer_t *writer) {
+    if (!writer) return;
+    for (int i = 0; i < writer->open_count; i++) {
+        free(writer->open[i]);
+    }
+    free(writer->open);
+    for (int i = 0; i < writer->sealed_count; i++) {
+        free(writer->sealed[(writer->sealed_head + i) % WT_HISTORY_PENDING_BLOCKS].data);
+    }
+    db_rollup_writer_free(&writer->rollups);
+    memset(writer, 0, sizeof(*writer));
+}
+
+static db_history_open_block_t* find_open(db_history_writer_t *writer, int module_id) {
+    for (int i = 0; i < writer->open_count; i++) {
+        if (writer->open[i]->module_id == module_id) return writer->open[i];
+    }
+
+    if (writer->open_count == writer->open_cap) {
+        int cap = writer->open_cap ? writer->open_cap * 2 : 16;
+        db_history_open_block_t **grown = realloc(writer->open, (size_t)cap * sizeof(*grown));
+        if (!grown) return NULL;
+        writer->open = grown;
+        writer->open_cap = cap;
+    }
+
+    db_history_open_block_t *block = calloc(1, sizeof(*block));
+    if (!block) return NULL;
+    block->module_id = module_id;
+    ts_encoder_init(&block->enc, block->buf, sizeof(block->buf));
+    writer->open[writer->open_count++] = block;
+    return block;
+}
+
+/* Move a full open block to the write queue and start a new one */
+static void seal(db_history_writer_t *writer, db_history_open_block_t *block) {
+    if (block->enc.count == 0) return;
+
+    if (writer->sealed_count == WT_HISTORY_PENDING_BLOCKS) {
+        db_history_sealed_block_t *old = &writer->sealed[writer->sealed_head];
+        LOG_WARNING("History: write queue full, dropping block of module %d (%u samples)",
+                    old->module_id, old->count);
+        free(old->data);
+        writer->sealed_head = (writer->sealed_head + 1) % WT_HISTORY_PENDING_BLOCKS;
+        writer->sealed_count--;
+        writer->stats.blocks_dropped++;
+    }
+
+    uint32_t len = ts_encoder_size(&block->enc);
+    uint8_t *data = malloc(len);
+    if (data) {
+        memcpy(data, block->buf, len);
+        int idx = (writer->sealed_head + writer->sealed_count) % WT_HISTORY_PENDING_BLOCKS;
+        writer->sealed[idx] = (db_history_sealed_block_t){
+            .module_id = block->module_id,
+            .start_ms = block->enc.first_ts,
+            .end_ms = block->enc.last_ts,
+            .count = block->enc.count,
+            .len = len,
+            .data = data,
+        };
+        writer->sealed_count++;
+        writer->stats.blocks_sealed++;
+    } else {
+        writer->stats.blocks_dropped++;
+    }
+
+    ts_encoder_init(&block->enc, block->buf, sizeof(block->buf));
+    block->dirty = false;
+}
+
+result_t db_history_store(db_history_writer_t *writer, int module_id, int64_t ts_ms,
+                          float value, data_quality_t quality) {
+    CHECK_NULL(writer);
+
+    db_history_open_block_t *block = find_open(writer, module_id);
+    if (!block) return RESULT_NO_MEMORY;
+
+    /* Blocks are time-ordered and bounded in span, so range reads stay cheap */
+    if (block->enc.count > 0 &&
+        (ts_ms < block->enc.last_ts || ts_ms - block->enc.first_ts >= BLOCK_SPAN_MS)) {
+        seal(writer, block);
+    }
+    if (!ts_encoder_append(&block->enc, ts_ms, value, quality)) {
+        seal(writer, block);
+        ts_encoder_append(&block->enc, ts_ms, value, quality);
+    }
+
+    block->dirty = true;
+    writer->stats.samples++;
+    return RESULT_OK;
+}
+
+void db_history_observe(db_history_writer_t *writer, int module_id, int64_t ts_ms,
+                        float value, data_quality_t quality) {
+    if (writer && quality < QUALITY_BAD) db_rollup_add(&writer->rollups, module_id, ts_ms, value);
+}
+
+result_t db_history_append(db_history_writer_t *writer, int module_id, int64_t ts_ms,
+                           float value, data_quality_t quality) {
+    result_t r = db_history_store(writer, module_id, ts_ms, value, quality);
+    if (r == RESULT_OK) db_history_observe(writer, module_id, ts_ms, value, quality);
+    return r;
+}
+
+/* Insert statement for the partition of the block being written */
+typedef struct {
+    sqlite3_stmt *stmt;
+    char table[MAX_NAME_LEN + 32];
+} block_sink_t;
+
+static int put_block(database_t *db, block_sink_t *sink, int module_id, int64_t start,
+                     int64_t end, int count, const uint8_t *data, uint32_t len) {
+    char table[sizeof(sink->table)];
+    db_partition_name(&DB_PARTITION_HISTORY, start, table, sizeof(table));
+
+    /* An open block's checkpoint row is replaced by its sealed version (same key) */
+    if (!sink->stmt || strcmp(table, sink->table) != 0) {
+        if (db_partition_table(db, &DB_PARTITION_HISTORY, start, table, sizeof(table)) != RESULT_OK) {
+            return SQLITE_ERROR;
+        }
+        sqlite3_finalize(sink->stmt);
+        sink->stmt = NULL;
+
+        char sql[256];
+        snprintf(sql, sizeof(sql), "INSERT OR REPLACE INTO %s "
+                 "(module_id, block_start, block_end, sample_count, data) VALUES (?, ?, ?, ?, ?);",
+                 table);
+        if (sqlite3_prepare_v2(db->db, sql, -1, &sink->stmt, NULL) != SQLITE_OK) return SQLITE_ERROR;
+        SAFE_STRNCPY(sink->table, table, sizeof(sink->table));
+    }
+
+    sqlite3_stmt *stmt = sink->stmt;
+    sqlite3_reset(stmt);
+    sqlite3_bind_int(stmt, 1, module_id);
+    sqlite3_bind_int64(stmt, 2, start);
+    sqlite3_bind_int64(stmt, 3, end);
+    sqlite3_bind_int(stmt, 4, count);
+    sqlite3_bind_blob(stmt, 5, data, (int)len, SQLITE_STATIC);
+    return sqlite3_step(stmt);
+}
+
+/* A block rejected by a constraint (module deleted) is discarded, not retried */
+static bool block_stored(db_history_writer_t *writer, int rc, int module_id) {
+    if (rc == SQLITE_DONE) return true;
+    if ((rc & 0xFF) != SQLITE_CONSTRAINT) return false;
+
+    LOG_WARNING("History: block for module %d rejected, discarding", module_id);
+    writer->stats.blocks_dropped++;
+    return true;
+}
+
+result_t db_history_flush(database_t *db, db_history_writer_t *writer, bool checkpoint) {
+    CHECK_NULL(db); CHECK_NULL(writer);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+
+    bool dirty = false;
+    for (int i = 0; checkpoint && i < writer->open_count && !dirty; i++) {
+        dirty = writer->open[i]->dirty;
+    }
+    bool rollups = db_rollup_pending(&writer->rollups, checkpoint);
+    if (writer->sealed_count == 0 && !dirty && !rollups) return RESULT_OK;
+
+    char *err = NULL;
+    if (sqlite3_exec(db->db, "BEGIN TRANSACTION", NULL, NULL, &err) != SQLITE_OK) {
+        LOG_ERROR("Begin transaction failed: %s", err);
+        sqlite3_free(err);
+        return RESULT_ERROR;
+    }
+
+    block_sink_t sink = {0};
+    bool ok = true;
+    uint64_t bytes = 0, written = 0;
+    for (int i = 0; ok && i < writer->sealed_count; i++) {
+        db_history_sealed_block_t *b = &writer->sealed[(writer->sealed_head + i) % WT_HISTORY_PENDING_BLOCKS];
+        int rc = put_block(db, &sink, b->module_id, b->start_ms, b->end_ms, b->count,
+                           b->data, b->len);
+        ok = block_stored(writer, rc, b->module_id);
+        if (rc == SQLITE_DONE) {
+            bytes += b->len;
+            written++;
+        }
+    }
+    for (int i = 0; ok && dirty && i < writer->open_count; i++) {
+        db_history_open_block_t *b = writer->open[i];
+        if (!b->dirty || b->enc.count == 0) continue;
+        int rc = put_block(db, &sink, b->module_id, b->enc.first_ts, b->enc.last_ts,
+                           b->enc.count, b->buf, ts_encoder_size(&b->enc));
+        ok = block_stored(writer, rc, b->module_id);
+    }
+    sqlite3_finalize(sink.stmt);
+
+    if (ok && rollups) ok = db_rollup_write(db, &writer->rollups, checkpoint);
+
+    if (!ok || sqlite3_exec(db->db, "COMMIT", NULL, NULL, &err) != SQLITE_OK) {
+        LOG_ERROR("History flush failed: %s", err ? err : sqlite3_errmsg(db->db));
+        sqlite3_free(err);
+        sqlite3_exec(db->db, "ROLLBACK", NULL, NULL, NULL);
+        return RESULT_ERROR;
+    }
+
+    writer->stats.blocks_written += written;
+    writer->stats.bytes_written += bytes;
+    if (rollups) {
+        db_rollup_committed(&writer->rollups, checkpoint);
+        writer->stats.rollup_buckets = writer->rollups.buckets_written;
+    }
+    while (writer->sealed_count > 0) {
+        free(writer->sealed[writer->sealed_head].data);
+        writer->sealed_head = (writer->sealed_head + 1) % WT_HISTORY_PENDING_BLOCKS;
+        writer->sealed_count--;
+    }
+    if (dirty) {
+        for (int i = 0; i < writer->open_count; i++) {
+            writer->open[i]->dirty = false;
+        }
+        writer->stats.checkpoints++;
+    }
+    return RESULT_OK;
+}
+
+/* ============================================================================
+ * Queries
+ * ============================================================================ */
+
+data_quality_t db_history_status_quality(const char *status) {
+    switch (status_classify(status)) {
+        case STATUS_TYPE_OK:        return QUALITY_GOOD;
+        case STATUS_TYPE_WARNING:   return QUALITY_UNCERTAIN;
+        default:
+            break;
+    }
+    if (status && strcmp(status, STATUS_DISCONNECTED) == 0) return QUALITY_NOT_CONNECTED;
+    return QUALITY_BAD;
+}
+
+/* Rows written by the pre-block logger; all older than any block */
+static bool query_legacy(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                         db_history_cb cb, void *ctx) {
+    const char *sql = "SELECT CAST(strftime('%s', timestamp) AS INTEGER), value, status "
+                      "FROM sensor_data_log WHERE module_id = ? "
+                      "AND timestamp >= datetime(?, 'unixepoch') "
+                      "AND timestamp <= datetime(?, 'unixepoch') ORDER BY timestamp;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return true;
+
+    sqlite3_bind_int(stmt, 1, module_id);
+    sqlite3_bind_int64(stmt, 2, from_ms / 1000);
+    sqlite3_bind_int64(stmt, 3, to_ms / 1000);
+
+    bool more = true;
+    while (more && sqlite3_step(stmt) == SQLITE_ROW) {
+        int64_t ts_ms = sqlite3_column_int64(stmt, 0) * 1000;
+        if (ts_ms < from_ms || ts_ms > to_ms) continue;
+        more = cb(ctx, ts_ms, (float)sqlite3_column_double(stmt, 1),
+                  db_history_status_quality((const char *)sqlite3_column_text(stmt, 2)));
+    }
+    sqlite3_finalize(stmt);
+    return more;
+}
+
+result_t db_history_query(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                          db_history_cb cb, void *ctx) {
+    return db_history_query_filtered(db, module_id, from_ms, to_ms, NULL, cb, ctx);
+}
+
+result_t db_history_query_filtered(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                                   db_history_block_filter filter, db_history_cb cb, void *ctx) {
+    CHECK_NULL(db); CHECK_NULL(cb);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+    if (to_ms < from_ms) return RESULT_INVALID_PARAM;
+
+    if (!query_legacy(db, module_id, from_ms, to_ms, cb, ctx)) return RESULT_OK;
+
+    /* block_start lower bound lets the primary key bound the scan */
+    const char *sql = "SELECT data, block_start, block_end FROM sensor_history_blocks "
+                      "WHERE module_id = ? "
+                      "AND block_start >= ? AND block_start <= ? AND block_end >= ? "
+                      "ORDER BY block_start;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+
+    sqlite3_bind_int(stmt, 1, module_id);
+    sqlite3_bind_int64(stmt, 2, from_ms - BLOCK_SPAN_MS);
+    sqlite3_bind_int64(stmt, 3, to_ms);
+    sqlite3_bind_int64(stmt, 4, from_ms);
+
+    bool more = true;
+    while (more && sqlite3_step(stmt) == SQLITE_ROW) {
+        if (filter && !filter(ctx, sqlite3_column_int64(stmt, 1), sqlite3_column_int64(stmt, 2))) {
+            continue;
+        }
+
+        const uint8_t *data = sqlite3_column_blob(stmt, 0);
+        int len = sqlite3_column_bytes(stmt, 0);
+
+        ts_decoder_t dec;
+        if (!data || ts_decoder_init(&dec, data, (uint32_t)len) != RESULT_OK) {
+            LOG_WARNING("History: undecodable block for module %d", module_id);
+            continue;
+        }
+
+        int64_t ts;
+        float value;
+        uint8_t quality;
+        while (more && ts_decoder_next(&dec, &ts, &value, &quality)) {
+            if (ts > to_ms) break;
+            if (ts >= from_ms) more = cb(ctx, ts, value, (data_quality_t)quality);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return RESULT_OK;
+}
+
+result_t db_history_cleanup(database_t *db, int retention_days) {
+    CHECK_NULL(db);
+    if (!db->db || retention_days <= 0) return RESULT_INVALID_PARAM;
+
+    int64_t cutoff = ((int64_t)time(NULL) - (int64_t)retention_days * 86400) * 1000;
+    return db_partition_drop_before(db, &DB_PARTITION_HISTORY, cutoff, NULL);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file db_history.h
+ * @brief Compressed sensor history stored as per-sensor blocks
+ *
+ * Samples are packed into ts_block BLOBs in sensor_history_blocks, keyed
+ * by (module_id, block_start), instead of one sensor_data_log row each.
+ * The table is partitioned by day of block_start (db_partition.h).
+ * The writer keeps one open block per sensor in memory; full blocks are
+ * sealed and queued, and open blocks are checkpointed (rewritten in place
+ * under the same key) on request, so a crash loses at most the samples
+ * since the last checkpoint.
+ *
+ * Usable samples also feed the rollup tiers (db_rollup.h), merged in the
+ * same transaction as the blocks.
+ *
+ * Rows logged before the block format existed stay in sensor_data_log and
+ * are returned by db_history_query() ahead of block data.
+ */
+
+#ifndef DB_HISTORY_H
+#define DB_HISTORY_H
+
+#include "common.h"
+#include "database.h"
+#include "ts_block.h"
+#include "db_rollup.h"
+#include "config_defaults.h"
+
+typedef struct {
+    int module_id;
+    bool dirty;                         /* Samples not yet checkpointed */
+    ts_encoder_t enc;
+    uint8_t buf[WT_HISTORY_BLOCK_BYTES];
+} db_history_open_block_t;
+
+typedef struct {
+    int module_id;
+    int64_t start_ms;
+    int64_t end_ms;
+    uint16_t count;
+    uint32_t len;
+    uint8_t *data;
+} db_history_sealed_block_t;
+
+typedef struct {
+    uint64_t samples;                   /* Samples appended */
+    uint64_t blocks_sealed;
+    uint64_t blocks_written;            /* Sealed blocks committed */
+    uint64_t blocks_dropped;            /* Sealed blocks lost, write queue full */
+    uint64_t checkpoints;
+    uint64_t bytes_written;             /* BLOB bytes of committed sealed blocks */
+    uint64_t rollup_buckets;            /* Closed rollup buckets committed */
+} db_history_stats_t;
+
+/* Per-writer state; owned by one thread */
+typedef struct {
+    db_history_open_block_t **open;
+    int open_count;
+    int open_cap;
+    db_history_sealed_block_t sealed[WT_HISTORY_PENDING_BLOCKS];
+    int sealed_head;
+    int sealed_count;
+    db_rollup_writer_t rollups;
+    db_history_stats_t stats;
+} db_history_writer_t;
+
+typedef bool (*db_history_cb)(void *ctx, int64_t ts_ms, float value, data_quality_t quality);
+
+/* Returns false to skip decoding a block covering [start_ms, end_ms] */
+typedef bool (*db_history_block_filter)(void *ctx, int64_t start_ms, int64_t end_ms);
+
+void db_history_writer_init(db_history_writer_t *writer);
+void db_history_writer_free(db_history_writer_t *writer);
+
+/**
+ * @brief Add one sample to its sensor's open block and to the rollups
+ *        (memory only, never blocks)
+ */
+result_t db_history_append(db_history_writer_t *writer, int module_id, int64_t ts_ms,
+                           float value, data_quality_t quality);
+
+/**
+ * @brief db_history_append() for the block only, when rollups are fed separately
+ */
+result_t db_history_store(db_history_writer_t *writer, int module_id, int64_t ts_ms,
+                          float value, data_quality_t quality);
+
+/**
+ * @brief db_history_append() for the rollups only (samples not stored in blocks)
+ */
+void db_history_observe(db_history_writer_t *writer, int module_id, int64_t ts_ms,
+                        float value, data_quality_t quality);
+
+/**
+ * @brief Write sealed blocks, plus open blocks if checkpoint, in one transaction
+ *
+ * Rollup deltas (closed buckets, plus open ones if checkpoint) are merged
+ * in the same transaction.
+ *
+ * On failure everything stays queued for the next call.
+ */
+result_t db_history_flush(database_t *db, db_history_writer_t *writer, bool checkpoint);
+
+/**
+ * @brief Stream samples of one sensor in [from_ms, to_ms], oldest first
+ *
+ * Blocks are decoded on the fly; the callback returns false to stop.
+ */
+result_t db_history_query(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                          db_history_cb cb, void *ctx);
+
+/**
+ * @brief db_history_query() that lets the caller skip whole blocks
+ *
+ * filter and cb share ctx. Legacy rows are always returned.
+ */
+result_t db_history_query_filtered(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                                   db_history_block_filter filter, db_history_cb cb, void *ctx);
+
+/**
+ * @brief Drop history partitions whose blocks all end before retention_days
+ */
+result_t db_history_cleanup(database_t *db, int retention_days);
+
+/**
+ * @brief Map a logged status string to the quality stored in blocks
+ */
+data_quality_t db_history_status_quality(const char *status);
+
+#endif
@@ -4,6 +4,8 @@
  */
 
 #include "db_modules.h"
+#include "db_writer.h"
+#include "config_defaults.h"
 #include "utils/logger.h"
 
 /* ============================================================================
@@ -49,7 +51,7 @@ result_t db_module_create(database_t *db, db_module_t *module, int *module_id) {
     const char *sql = "INSERT INTO modules (slot, subslot, name, module_type, module_ident, submodule_ident, status) VALUES (?, ?, ?, ?, ?, ?, ?);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         LOG_ERROR("Prepare failed: %s", sqlite3_errmsg(db->db));
         return RESULT_ERROR;
     }
@@ -63,7 +65,7 @@ result_t db_module_create(database_t *db, db_module_t *module, int *module_id) {
     sqlite3_bind_text(stmt, 7, module->status[0] ? module->status : STATUS_INACTIVE, -1, SQLITE_TRANSIENT);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc != SQLITE_DONE) {
         LOG_ERROR("Insert module failed: %s", sqlite3_errmsg(db->db));
@@ -76,10 +78,10 @@ result_t db_module_create(database_t *db, db_module_t *module, int *module_id) {
     // Create sensor_status entry
     const char *status_sql = "INSERT INTO sensor_status (module_id, status) VALUES (?, 'unknown');";
     sqlite3_stmt *status_stmt;
-    if (sqlite3_prepare_v2(db->db, status_sql, -1, &status_stmt, NULL) == SQLITE_OK) {
+    if ((status_stmt = database_prepare(db, status_sql))) {
         sqlite3_bind_int(status_stmt, 1, *module_id);
         sqlite3_step(status_stmt);
-        sqlite3_finalize(status_stmt);
+        database_release(db, status_stmt);
     }
     
     LOG_INFO("Created module %d: %s (slot %d)", *module_id, module->name, module->slot);
@@ -93,7 +95,7 @@ result_t db_module_update(database_t *db, db_module_t *module) {
     const char *sql = "UPDATE modules SET slot=?, subslot=?, name=?, module_type=?, module_ident=?, submodule_ident=?, status=?, updated_at=datetime('now') WHERE id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_int(stmt, 1, module->slot);
     sqlite3_bind_int(stmt, 2, module->subslot);
@@ -105,7 +107,7 @@ result_t db_module_update(database_t *db, db_module_t *module) {
     sqlite3_bind_int(stmt, 8, module->id);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
@@ -117,11 +119,11 @@ result_t db_module_delete(database_t *db, int module_id) {
     const char *sql = "DELETE FROM modules WHERE id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE && sqlite3_changes(db->db) > 0) {
         LOG_INFO("Deleted module %d", module_id);
@@ -137,16 +139,16 @@ result_t db_module_get(database_t *db, int module_id, db_module_t *module) {
     const char *sql = MODULE_SELECT " WHERE id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
 
     map_row_to_module(stmt, module);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -157,16 +159,16 @@ result_t db_module_get_by_slot(database_t *db, int slot, db_module_t *module) {
     const char *sql = MODULE_SELECT " WHERE slot=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, slot);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
 
     map_row_to_module(stmt, module);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -182,7 +184,7 @@ result_t db_module_list(database_t *db, db_module_t **modules, int *count) {
 
     const char *sql = MODULE_SELECT " ORDER BY slot;";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         return RESULT_ERROR;
     }
 
@@ -191,7 +193,7 @@ result_t db_module_list(database_t *db, db_module_t **modules, int *count) {
     int idx = 0;
     db_module_t *arr = calloc(capacity, sizeof(db_module_t));
     if (!arr) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NO_MEMORY;
     }
 
@@ -202,7 +204,7 @@ result_t db_module_list(database_t *db, db_module_t **modules, int *count) {
             db_module_t *new_arr = realloc(arr, capacity * sizeof(db_module_t));
             if (!new_arr) {
                 free(arr);
-                sqlite3_finalize(stmt);
+                database_release(db, stmt);
                 return RESULT_NO_MEMORY;
             }
             arr = new_arr;
@@ -213,7 +215,7 @@ result_t db_module_list(database_t *db, db_module_t **modules, int *count) {
         idx++;
     }
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     if (idx == 0) {
         free(arr);
@@ -238,11 +240,11 @@ result_t db_module_count(database_t *db, int *count) {
     const char *sql = "SELECT COUNT(*) FROM modules;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     *count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) *count = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -257,7 +259,7 @@ result_t db_physical_sensor_create(database_t *db, db_physical_sensor_t *sensor)
     const char *sql = "INSERT INTO physical_sensors (module_id, sensor_type, hardware_type, interface, address, bus, channel, resolution, unit, min_value, max_value, poll_rate_ms, timeout_ms) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_int(stmt, 1, sensor->module_id);
     sqlite3_bind_text(stmt, 2, sensor->sensor_type, -1, SQLITE_TRANSIENT);
@@ -274,7 +276,7 @@ result_t db_physical_sensor_create(database_t *db, db_physical_sensor_t *sensor)
     sqlite3_bind_int(stmt, 13, sensor->timeout_ms);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE) {
         sensor->id = (int)sqlite3_last_insert_rowid(db->db);
@@ -290,11 +292,11 @@ result_t db_physical_sensor_get(database_t *db, int module_id, db_physical_senso
     const char *sql = "SELECT id, module_id, sensor_type, hardware_type, interface, address, bus, channel, resolution, unit, min_value, max_value, poll_rate_ms, timeout_ms FROM physical_sensors WHERE module_id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
     
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
     
@@ -313,7 +315,7 @@ result_t db_physical_sensor_get(database_t *db, int module_id, db_physical_senso
     sensor->poll_rate_ms = sqlite3_column_int(stmt, 12);
     sensor->timeout_ms = sqlite3_column_int(stmt, 13);
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -324,7 +326,7 @@ result_t db_physical_sensor_update(database_t *db, db_physical_sensor_t *sensor)
     const char *sql = "UPDATE physical_sensors SET sensor_type=?, hardware_type=?, interface=?, address=?, bus=?, channel=?, resolution=?, unit=?, min_value=?, max_value=?, poll_rate_ms=?, timeout_ms=? WHERE module_id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_text(stmt, 1, sensor->sensor_type, -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 2, sensor->hardware_type, -1, SQLITE_TRANSIENT);
@@ -341,7 +343,7 @@ result_t db_physical_sensor_update(database_t *db, db_physical_sensor_t *sensor)
     sqlite3_bind_int(stmt, 13, sensor->module_id);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
 
@@ -356,7 +358,7 @@ result_t db_adc_sensor_create(database_t *db, db_adc_sensor_t *sensor) {
     const char *sql = "INSERT INTO adc_sensors (module_id, adc_type, interface, address, bus, channel, gain, reference_voltage, unit, raw_min, raw_max, eng_min, eng_max, poll_rate_ms) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_int(stmt, 1, sensor->module_id);
     sqlite3_bind_text(stmt, 2, sensor->adc_type, -1, SQLITE_TRANSIENT);
@@ -374,7 +376,7 @@ result_t db_adc_sensor_create(database_t *db, db_adc_sensor_t *sensor) {
     sqlite3_bind_int(stmt, 14, sensor->poll_rate_ms);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE) {
         sensor->id = (int)sqlite3_last_insert_rowid(db->db);
@@ -390,11 +392,11 @@ result_t db_adc_sensor_get(database_t *db, int module_id, db_adc_sensor_t *senso
     const char *sql = "SELECT id, module_id, adc_type, interface, address, bus, channel, gain, reference_voltage, unit, raw_min, raw_max, eng_min, eng_max, poll_rate_ms FROM adc_sensors WHERE module_id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
     
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
     
@@ -414,7 +416,7 @@ result_t db_adc_sensor_get(database_t *db, int module_id, db_adc_sensor_t *senso
     sensor->eng_max = sqlite3_column_double(stmt, 13);
     sensor->poll_rate_ms = sqlite3_column_int(stmt, 14);
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -429,7 +431,7 @@ result_t db_web_poll_sensor_create(database_t *db, db_web_poll_sensor_t *sensor)
     const char *sql = "INSERT INTO web_poll_sensors (module_id, url, method, headers, json_path, poll_rate_ms, timeout_ms) VALUES (?, ?, ?, ?, ?, ?, ?);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_int(stmt, 1, sensor->module_id);
     sqlite3_bind_text(stmt, 2, sensor->url, -1, SQLITE_TRANSIENT);
@@ -440,7 +442,7 @@ result_t db_web_poll_sensor_create(database_t *db, db_web_poll_sensor_t *sensor)
     sqlite3_bind_int(stmt, 7, sensor->timeout_ms);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE) {
         sensor->id = (int)sqlite3_last_insert_rowid(db->db);
@@ -456,11 +458,11 @@ result_t db_web_poll_sensor_get(database_t *db, int module_id, db_web_poll_senso
     const char *sql = "SELECT id, module_id, url, method, headers, json_path, poll_rate_ms, timeout_ms FROM web_poll_sensors WHERE module_id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
     
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
     
@@ -473,7 +475,7 @@ result_t db_web_poll_sensor_get(database_t *db, int module_id, db_web_poll_senso
     sensor->poll_rate_ms = sqlite3_column_int(stmt, 6);
     sensor->timeout_ms = sqlite3_column_int(stmt, 7);
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -488,7 +490,7 @@ result_t db_calculated_sensor_create(database_t *db, db_calculated_sensor_t *sen
     const char *sql = "INSERT INTO calculated_sensors (module_id, formula, input_sensors, unit, update_rate_ms) VALUES (?, ?, ?, ?, ?);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_int(stmt, 1, sensor->module_id);
     sqlite3_bind_text(stmt, 2, sensor->formula, -1, SQLITE_TRANSIENT);
@@ -497,7 +499,7 @@ result_t db_calculated_sensor_create(database_t *db, db_calculated_sensor_t *sen
     sqlite3_bind_int(stmt, 5, sensor->update_rate_ms);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE) {
         sensor->id = (int)sqlite3_last_insert_rowid(db->db);
@@ -513,11 +515,11 @@ result_t db_calculated_sensor_get(database_t *db, int module_id, db_calculated_s
     const char *sql = "SELECT id, module_id, formula, input_sensors, unit, update_rate_ms FROM calculated_sensors WHERE module_id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
     
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
     
@@ -528,7 +530,7 @@ result_t db_calculated_sensor_get(database_t *db, int module_id, db_calculated_s
     SAFE_STRNCPY(sensor->unit, (const char*)sqlite3_column_text(stmt, 4), sizeof(sensor->unit));
     sensor->update_rate_ms = sqlite3_column_int(stmt, 5);
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -543,7 +545,7 @@ result_t db_static_sensor_create(database_t *db, db_static_sensor_t *sensor) {
     const char *sql = "INSERT INTO static_sensors (module_id, value, unit, writable) VALUES (?, ?, ?, ?);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
     sqlite3_bind_int(stmt, 1, sensor->module_id);
     sqlite3_bind_double(stmt, 2, sensor->value);
@@ -551,7 +553,7 @@ result_t db_static_sensor_create(database_t *db, db_static_sensor_t *sensor) {
     sqlite3_bind_int(stmt, 4, sensor->writable ? 1 : 0);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     if (rc == SQLITE_DONE) {
         sensor->id = (int)sqlite3_last_insert_rowid(db->db);
@@ -567,11 +569,11 @@ result_t db_static_sensor_get(database_t *db, int module_id, db_static_sensor_t
     const char *sql = "SELECT id, module_id, value, unit, writable FROM static_sensors WHERE module_id=?;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
     
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
     
@@ -581,7 +583,7 @@ result_t db_static_sensor_get(database_t *db, int module_id, db_static_sensor_t
     SAFE_STRNCPY(sensor->unit, (const char*)sqlite3_column_text(stmt, 3), sizeof(sensor->unit));
     sensor->writable = sqlite3_column_int(stmt, 4) != 0;
     
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -592,13 +594,13 @@ result_t db_static_sensor_set_value(database_t *db, int module_id, float value)
     const char *sql = "UPDATE static_sensors SET value=? WHERE module_id=? AND writable=1;";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_double(stmt, 1, value);
     sqlite3_bind_int(stmt, 2, module_id);
     
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db->db);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     
     return (rc == SQLITE_DONE && changes > 0) ? RESULT_OK : RESULT_ERROR;
 }
@@ -607,26 +609,42 @@ result_t db_static_sensor_set_value(database_t *db, int module_id, float value)
  * Sensor Status Operations
  * ========================================================================== */
 
-result_t db_sensor_status_update(database_t *db, int module_id, float value, const char *status) {
-    CHECK_NULL(db);
-    if (!db->db) return RESULT_NOT_INITIALIZED;
-    
+/* db_writer request: one sensor_status row */
+typedef struct {
+    int module_id;
+    float value;
+    const char *status;
+} status_update_t;
+
+static result_t sensor_status_request(database_t *db, void *arg) {
+    const status_update_t *st = arg;
+    const char *status = st->status ? st->status : STATUS_OK;
+
     const char *sql = "INSERT OR REPLACE INTO sensor_status (module_id, value, status, last_update, consecutive_failures) VALUES (?, ?, ?, datetime('now'), CASE WHEN ? = 'ok' THEN 0 ELSE COALESCE((SELECT consecutive_failures FROM sensor_status WHERE module_id = ?) + 1, 1) END);";
     sqlite3_stmt *stmt;
     
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     
-    sqlite3_bind_int(stmt, 1, module_id);
-    sqlite3_bind_double(stmt, 2, value);
-    sqlite3_bind_text(stmt, 3, status ? status : STATUS_OK, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, status ? status : STATUS_OK, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 5, module_id);
+    sqlite3_bind_int(stmt, 1, st->module_id);
+    sqlite3_bind_double(stmt, 2, st->value);
+    sqlite3_bind_text(stmt, 3, status, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 4, status, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 5, st->module_id);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
 
+result_t db_sensor_status_update(database_t *db, int module_id, float value, const char *status) {
+    CHECK_NULL(db);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+
+    /* Written from the sensor threads: go through the writer, not db's connection */
+    status_update_t st = { .module_id = module_id, .value = value, .status = status };
+    return db_writer_call(db, sensor_status_request, &st);
+}
+
 result_t db_sensor_status_get(database_t *db, int module_id, float *value, char *status, size_t status_size) {
     CHECK_NULL(db);
     if (!db->db) return RESULT_NOT_INITIALIZED;
@@ -634,18 +652,18 @@ result_t db_sensor_status_get(database_t *db, int module_id, float *value, char
     const char *sql = "SELECT value, status FROM sensor_status WHERE module_id=?;";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
     sqlite3_bind_int(stmt, 1, module_id);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NOT_FOUND;
     }
 
     if (value) *value = sqlite3_column_double(stmt, 0);
     if (status) SAFE_STRNCPY(status, (const char*)sqlite3_column_text(stmt, 1), status_size);
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return RESULT_OK;
 }
 
@@ -670,7 +688,7 @@ result_t db_module_list_with_status(database_t *db, db_module_with_status_t **mo
         "ORDER BY m.slot;";
 
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         LOG_ERROR("Prepare failed: %s", sqlite3_errmsg(db->db));
         return RESULT_ERROR;
     }
@@ -680,7 +698,7 @@ result_t db_module_list_with_status(database_t *db, db_module_with_status_t **mo
     int idx = 0;
     db_module_with_status_t *arr = calloc(capacity, sizeof(db_module_with_status_t));
     if (!arr) {
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return RESULT_NO_MEMORY;
     }
 
@@ -691,7 +709,7 @@ result_t db_module_list_with_status(database_t *db, db_module_with_status_t **mo
             db_module_with_status_t *new_arr = realloc(arr, capacity * sizeof(db_module_with_status_t));
             if (!new_arr) {
                 free(arr);
-                sqlite3_finalize(stmt);
+                database_release(db, stmt);
                 return RESULT_NO_MEMORY;
             }
             arr = new_arr;
@@ -718,7 +736,7 @@ result_t db_module_list_with_status(database_t *db, db_module_with_status_t **mo
         idx++;
     }
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     if (idx == 0) {
         free(arr);
@@ -747,14 +765,14 @@ result_t db_sensor_log_insert(database_t *db, int module_id, float value, const
     const char *sql = "INSERT INTO sensor_data_log (module_id, value, status) VALUES (?, ?, ?);";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return RESULT_ERROR;
+    if (!(stmt = database_prepare(db, sql))) return RESULT_ERROR;
 
     sqlite3_bind_int(stmt, 1, module_id);
     sqlite3_bind_double(stmt, 2, value);
     sqlite3_bind_text(stmt, 3, status ? status : STATUS_OK, -1, SQLITE_TRANSIENT);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return rc == SQLITE_DONE ? RESULT_OK : RESULT_ERROR;
 }
 
@@ -775,7 +793,7 @@ result_t db_sensor_log_insert_batch(database_t *db, const int *module_ids,
     const char *sql = "INSERT INTO sensor_data_log (module_id, value, status) VALUES (?, ?, ?);";
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (!(stmt = database_prepare(db, sql))) {
         sqlite3_exec(db->db, "ROLLBACK", NULL, NULL, NULL);
         return RESULT_ERROR;
     }
@@ -793,7 +811,7 @@ result_t db_sensor_log_insert_batch(database_t *db, const int *module_ids,
         }
     }
 
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
 
     /* Commit transaction */
     if (sqlite3_exec(db->db, "COMMIT", NULL, NULL, &err) != SQLITE_OK) {
@@ -814,19 +832,33 @@ result_t db_sensor_log_cleanup(database_t *db, int retention_days) {
     CHECK_NULL(db);
     if (!db->db || retention_days <= 0) return RESULT_INVALID_PARAM;
     
+    /*
+     * The logger no longer writes this table (history lives in partitioned
+     * blocks), so it only drains. Delete oldest-first in short autocommit
+     * chunks so live ingest never waits behind one long transaction.
+     */
     char sql[256];
-    snprintf(sql, sizeof(sql), "DELETE FROM sensor_data_log WHERE timestamp < datetime('now', '-%d days');", retention_days);
-    
-    char *err = NULL;
-    int rc = sqlite3_exec(db->db, sql, NULL, NULL, &err);
-    
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Log cleanup failed: %s", err);
-        sqlite3_free(err);
-        return RESULT_ERROR;
+    snprintf(sql, sizeof(sql),
+             "DELETE FROM sensor_data_log WHERE id IN (SELECT id FROM sensor_data_log "
+             "WHERE timestamp < datetime('now', '-%d days') ORDER BY id LIMIT %d);",
+             retention_days, WT_LOG_CLEANUP_CHUNK);
+    
+    int deleted = 0;
+    for (;;) {
+        char *err = NULL;
+        int rc = sqlite3_exec(db->db, sql, NULL, NULL, &err);
+        
+        if (rc != SQLITE_OK) {
+            LOG_ERROR("Log cleanup failed: %s", err);
+            sqlite3_free(err);
+            return RESULT_ERROR;
+        }
+        
+        int n = sqlite3_changes(db->db);
+        deleted += n;
+        if (n < WT_LOG_CLEANUP_CHUNK) break;
     }
     
-    int deleted = sqlite3_changes(db->db);
     if (deleted > 0) LOG_INFO("Cleaned up %d old log entries", deleted);
     return RESULT_OK;
 }
@@ -111,7 +111,7 @@ result_t db_calculated_sensor_get(database_t *db, int module_id, db_calculated_s
 result_t db_static_sensor_create(database_t *db, db_static_sensor_t *sensor);
 result_t db_static_sensor_get(database_t *db, int module_id, db_static_sensor_t *sensor);
 
-// Sensor status operations
+// Sensor status operations (updates run on the database writer)
 result_t db_sensor_status_update(database_t *db, int module_id, float value, const char *status);
 result_t db_sensor_status_get(database_t *db, int module_id, float *value, char *status, size_t status_size);
 
@@ -0,0 +1,331 @@
+/**
+ * @file db_partition.c
+ * @brief Time-partitioned tables behind a UNION ALL view
+ */
+
+#include "db_partition.h"
+#include "utils/logger.h"
+
+/* SQLite caps a compound SELECT at 500 terms; larger views nest chunks */
+#define VIEW_CHUNK          256
+#define KNOWN_SLOTS         8
+
+/*
+ * Partition last seen in sqlite_master, per set and connection, so an
+ * insert into the current partition skips the lookup. Reset by setup (a
+ * new connection) and by drops.
+ */
+static struct {
+    const db_partition_set_t *set;
+    sqlite3 *conn;
+    int64_t idx;
+} g_known[KNOWN_SLOTS];
+static int g_known_next;
+static pthread_mutex_t g_known_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool known_partition(database_t *db, const db_partition_set_t *set, int64_t idx) {
+    bool found = false;
+    pthread_mutex_lock(&g_known_mutex);
+    for (int i = 0; i < KNOWN_SLOTS && !found; i++) {
+        found = g_known[i].set == set && g_known[i].conn == db->db && g_known[i].idx == idx;
+    }
+    pthread_mutex_unlock(&g_known_mutex);
+    return found;
+}
+
+static void remember_partition(database_t *db, const db_partition_set_t *set, int64_t idx) {
+    pthread_mutex_lock(&g_known_mutex);
+    int slot = -1;
+    for (int i = 0; i < KNOWN_SLOTS && slot < 0; i++) {
+        if (g_known[i].set == set && g_known[i].conn == db->db) slot = i;
+    }
+    if (slot < 0) {
+        slot = g_known_next;
+        g_known_next = (g_known_next + 1) % KNOWN_SLOTS;
+    }
+    g_known[slot].set = set;
+    g_known[slot].conn = db->db;
+    g_known[slot].idx = idx;
+    pthread_mutex_unlock(&g_known_mutex);
+}
+
+/* Forget set's partitions on conn, or on every connection if conn is NULL */
+static void forget_partitions(const db_partition_set_t *set, sqlite3 *conn) {
+    pthread_mutex_lock(&g_known_mutex);
+    for (int i = 0; i < KNOWN_SLOTS; i++) {
+        if (g_known[i].set == set && (!conn || g_known[i].conn == conn)) {
+            g_known[i].set = NULL;
+            g_known[i].conn = NULL;
+        }
+    }
+    pthread_mutex_unlock(&g_known_mutex);
+}
+
+static int64_t period_ms(const db_partition_set_t *set) {
+    return (int64_t)set->period_days * 86400 * 1000;
+}
+
+static int64_t index_of(const db_partition_set_t *set, int64_t ts_ms) {
+    int64_t p = period_ms(set);
+    int64_t idx = ts_ms / p;
+    return (ts_ms % p < 0) ? idx - 1 : idx;
+}
+
+static void partition_name(const db_partition_set_t *set, int64_t idx, char *buf, size_t len) {
+    snprintf(buf, len, "%s_p%lld", set->name, (long long)idx);
+}
+
+static bool exec_sql(database_t *db, const char *sql) {
+    char *err = NULL;
+    if (sqlite3_exec(db->db, sql, NULL, NULL, &err) == SQLITE_OK) return true;
+    LOG_ERROR("Partition: %s", err ? err : sqlite3_errmsg(db->db));
+    sqlite3_free(err);
+    return false;
+}
+
+static bool object_exists(database_t *db, const char *type, const char *name) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, "SELECT 1 FROM sqlite_master WHERE type = ? AND name = ?;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, type, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, name, -1, SQLITE_STATIC);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+/* Indexes of existing partitions; caller frees */
+static int list_partitions(database_t *db, const db_partition_set_t *set, int64_t **out) {
+    *out = NULL;
+
+    char pattern[MAX_NAME_LEN + 16];
+    snprintf(pattern, sizeof(pattern), "%s_p[0-9]*", set->name);
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, "SELECT name FROM sqlite_master WHERE type = 'table' "
+                           "AND name GLOB ?;", -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_STATIC);
+
+    size_t prefix = strlen(set->name) + 2;
+    int count = 0, cap = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *name = (const char *)sqlite3_column_text(stmt, 0);
+        if (!name || strlen(name) <= prefix) continue;
+        if (count == cap) {
+            cap = cap ? cap * 2 : 32;
+            int64_t *grown = realloc(*out, (size_t)cap * sizeof(*grown));
+            if (!grown) {
+                count = -1;
+                break;
+            }
+            *out = grown;
+        }
+        (*out)[count++] = strtoll(name + prefix, NULL, 10);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+static bool rebuild_view(database_t *db, const db_partition_set_t *set) {
+    int64_t *parts;
+    int count = list_partitions(db, set, &parts);
+    if (count <= 0) {
+        free(parts);
+        return false;
+    }
+
+    /* "SELECT * FROM <partition> UNION ALL " per term, plus nesting */
+    size_t cap = 64 + (size_t)count * (strlen(set->name) + 48);
+    char *sql = malloc(cap);
+    if (!sql) {
+        free(parts);
+        return false;
+    }
+
+    size_t pos = (size_t)snprintf(sql, cap, "CREATE VIEW %s AS ", set->name);
+    for (int i = 0; i < count; i++) {
+        char name[MAX_NAME_LEN + 32];
+        partition_name(set, parts[i], name, sizeof(name));
+        bool chunked = count > VIEW_CHUNK;
+        bool chunk_start = i % VIEW_CHUNK == 0;
+        bool chunk_end = i % VIEW_CHUNK == VIEW_CHUNK - 1 || i == count - 1;
+
+        if (i > 0) pos += (size_t)snprintf(sql + pos, cap - pos, " UNION ALL ");
+        if (chunked && chunk_start) pos += (size_t)snprintf(sql + pos, cap - pos, "SELECT * FROM (");
+        pos += (size_t)snprintf(sql + pos, cap - pos, "SELECT * FROM %s", name);
+        if (chunked && chunk_end) pos += (size_t)snprintf(sql + pos, cap - pos, ")");
+    }
+    free(parts);
+
+    char drop[MAX_NAME_LEN + 32];
+    snprintf(drop, sizeof(drop), "DROP VIEW IF EXISTS %s;", set->name);
+    bool ok = exec_sql(db, drop) && exec_sql(db, sql);
+    free(sql);
+    return ok;
+}
+
+static bool create_partition(database_t *db, const db_partition_set_t *set, int64_t idx) {
+    char name[MAX_NAME_LEN + 32];
+    partition_name(set, idx, name, sizeof(name));
+    if (object_exists(db, "table", name)) return true;
+
+    size_t len = strlen(name) + strlen(set->columns) + 64;
+    char *sql = malloc(len);
+    if (!sql) return false;
+    snprintf(sql, len, "CREATE TABLE %s (%s);", name, set->columns);
+    bool ok = exec_sql(db, sql);
+    free(sql);
+    return ok;
+}
+
+/* DDL runs in a savepoint so it nests inside a caller's transaction */
+static bool savepoint_end(database_t *db, bool ok) {
+    if (!ok) exec_sql(db, "ROLLBACK TO db_partition;");
+    exec_sql(db, "RELEASE db_partition;");
+    return ok;
+}
+
+/* ============================================================================
+ * Migration
+ * ============================================================================ */
+
+/* Move rows of a pre-partitioning table of the same name into partitions */
+static bool migrate_table(database_t *db, const db_partition_set_t *set) {
+    char old[MAX_NAME_LEN + 32];
+    snprintf(old, sizeof(old), "%s_unpartitioned", set->name);
+
+    char sql[512];
+    snprintf(sql, sizeof(sql), "ALTER TABLE %s RENAME TO %s;", set->name, old);
+    if (!exec_sql(db, sql)) return false;
+
+    snprintf(sql, sizeof(sql), "SELECT DISTINCT IFNULL(%s, 0) / %lld FROM %s;",
+             set->key_ms_sql, (long long)period_ms(set), old);
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return false;
+
+    bool ok = true;
+    int moved = 0;
+    int64_t *parts = NULL;
+    int count = 0, cap = 0;
+    while (ok && sqlite3_step(stmt) == SQLITE_ROW) {
+        if (count == cap) {
+            cap = cap ? cap * 2 : 32;
+            int64_t *grown = realloc(parts, (size_t)cap * sizeof(*grown));
+            if (!grown) ok = false;
+            else parts = grown;
+        }
+        if (ok) parts[count++] = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    for (int i = 0; ok && i < count; i++) {
+        char name[MAX_NAME_LEN + 32];
+        partition_name(set, parts[i], name, sizeof(name));
+        ok = create_partition(db, set, parts[i]);
+        if (!ok) break;
+
+        snprintf(sql, sizeof(sql), "INSERT INTO %s SELECT * FROM %s WHERE IFNULL(%s, 0) / %lld = %lld;",
+                 name, old, set->key_ms_sql, (long long)period_ms(set), (long long)parts[i]);
+        ok = exec_sql(db, sql);
+        moved += sqlite3_changes(db->db);
+    }
+    free(parts);
+
+    if (ok) {
+        snprintf(sql, sizeof(sql), "DROP TABLE %s;", old);
+        ok = exec_sql(db, sql);
+    }
+    if (ok) LOG_INFO("Partitioned %s: %d rows into %d tables", set->name, moved, count);
+    return ok;
+}
+
+/* ============================================================================
+ * API
+ * ============================================================================ */
+
+void db_partition_name(const db_partition_set_t *set, int64_t ts_ms, char *table, size_t len) {
+    partition_name(set, index_of(set, ts_ms), table, len);
+}
+
+result_t db_partition_setup(database_t *db, const db_partition_set_t *set) {
+    CHECK_NULL(db); CHECK_NULL(set);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+
+    forget_partitions(set, db->db);
+    if (!exec_sql(db, "SAVEPOINT db_partition;")) return RESULT_ERROR;
+
+    bool ok = true;
+    if (object_exists(db, "table", set->name)) ok = migrate_table(db, set);
+    if (ok) ok = create_partition(db, set, index_of(set, (int64_t)time(NULL) * 1000));
+    if (ok) ok = rebuild_view(db, set);
+
+    if (!savepoint_end(db, ok)) {
+        LOG_ERROR("Partition setup failed for %s", set->name);
+        return RESULT_ERROR;
+    }
+    return RESULT_OK;
+}
+
+result_t db_partition_table(database_t *db, const db_partition_set_t *set, int64_t ts_ms,
+                            char *table, size_t len) {
+    CHECK_NULL(db); CHECK_NULL(set); CHECK_NULL(table);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+
+    int64_t idx = index_of(set, ts_ms);
+    partition_name(set, idx, table, len);
+    if (known_partition(db, set, idx)) return RESULT_OK;
+
+    /* One created below is remembered only once a later call finds it, so
+     * a caller that rolls the creation straight back leaves no stale entry */
+    if (object_exists(db, "table", table)) {
+        remember_partition(db, set, idx);
+        return RESULT_OK;
+    }
+
+    if (!exec_sql(db, "SAVEPOINT db_partition;")) return RESULT_ERROR;
+    bool ok = create_partition(db, set, idx) && rebuild_view(db, set);
+    if (!savepoint_end(db, ok)) return RESULT_ERROR;
+
+    LOG_DEBUG("Created partition %s", table);
+    return RESULT_OK;
+}
+
+result_t db_partition_drop_before(database_t *db, const db_partition_set_t *set,
+                                  int64_t cutoff_ms, int *dropped) {
+    CHECK_NULL(db); CHECK_NULL(set);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+    if (dropped) *dropped = 0;
+
+    int64_t *parts;
+    int count = list_partitions(db, set, &parts);
+    if (count < 0) return RESULT_ERROR;
+
+    int64_t p = period_ms(set);
+    int64_t current = index_of(set, (int64_t)time(NULL) * 1000);
+    int n = 0;
+    bool ok = exec_sql(db, "SAVEPOINT db_partition;");
+
+    for (int i = 0; ok && i < count; i++) {
+        if (parts[i] == current || (parts[i] + 1) * p + set->slack_ms > cutoff_ms) continue;
+
+        char sql[MAX_NAME_LEN + 48];
+        char name[MAX_NAME_LEN + 32];
+        partition_name(set, parts[i], name, sizeof(name));
+        snprintf(sql, sizeof(sql), "DROP TABLE %s;", name);
+        ok = exec_sql(db, sql);
+        n++;
+    }
+    free(parts);
+
+    if (n > 0) forget_partitions(set, NULL);
+    if (ok && n > 0) ok = create_partition(db, set, current) && rebuild_view(db, set);
+    if (!savepoint_end(db, ok)) return RESULT_ERROR;
+
+    if (n > 0) LOG_INFO("Dropped %d old %s partitions", n, set->name);
+    if (dropped) *dropped = n;
+    return RESULT_OK;
+}
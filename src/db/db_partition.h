@@ -0,0 +1,54 @@
+/**
+ * @file db_partition.h
+ * @brief Time-partitioned tables behind a UNION ALL view
+ *
+ * A partitioned table is stored as one table per period, named
+ * <name>_p<index> where index = key_ms / period, and read through a view
+ * called <name> that unions every partition. Writers insert into the
+ * partition for the row's time; retention drops whole partitions, so its
+ * cost does not grow with the number of rows and it never rewrites pages
+ * that live data shares.
+ */
+
+#ifndef DB_PARTITION_H
+#define DB_PARTITION_H
+
+#include "common.h"
+#include "database.h"
+
+typedef struct {
+    const char *name;               /* View name; partitions are <name>_p<index> */
+    const char *columns;            /* Column and constraint list of a partition */
+    const char *key_ms_sql;         /* SQL expression giving a row's time in ms */
+    int period_days;
+    int64_t slack_ms;               /* Rows may reach this far past their period */
+} db_partition_set_t;
+
+extern const db_partition_set_t DB_PARTITION_HISTORY;
+extern const db_partition_set_t DB_PARTITION_EVENTS;
+
+/**
+ * @brief Create the view and the current partition; migrate an old
+ *        unpartitioned table of the same name into partitions
+ */
+result_t db_partition_setup(database_t *db, const db_partition_set_t *set);
+
+/**
+ * @brief Name of the partition holding ts_ms (no database access)
+ */
+void db_partition_name(const db_partition_set_t *set, int64_t ts_ms, char *table, size_t len);
+
+/**
+ * @brief Name of the partition holding ts_ms, created if missing
+ */
+result_t db_partition_table(database_t *db, const db_partition_set_t *set, int64_t ts_ms,
+                            char *table, size_t len);
+
+/**
+ * @brief Drop every partition whose rows all end before cutoff_ms
+ * @param dropped Number of partitions dropped (optional)
+ */
+result_t db_partition_drop_before(database_t *db, const db_partition_set_t *set,
+                                  int64_t cutoff_ms, int *dropped);
+
+#endif
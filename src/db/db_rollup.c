@@ -0,0 +1,454 @@
+/**
+ * @file db_rollup.c
+ * @brief Continuous min/max/avg aggregates of sensor history
+ */
+
+#include "db_rollup.h"
+#include "db_history.h"
+#include "utils/logger.h"
+
+static const int64_t TIER_WIDTH_MS[DB_ROLLUP_TIERS] = {
+    60LL * 1000,
+    3600LL * 1000,
+    86400LL * 1000,
+};
+
+static const int TIER_RETENTION_DAYS[DB_ROLLUP_TIERS] = {
+    WT_ROLLUP_MINUTE_DAYS,
+    WT_ROLLUP_HOUR_DAYS,
+    WT_ROLLUP_DAY_DAYS,
+};
+
+int64_t db_rollup_tier_width_ms(db_rollup_tier_t tier) {
+    if ((int)tier < 0 || tier >= DB_ROLLUP_TIERS) return 0;
+    return TIER_WIDTH_MS[tier];
+}
+
+int db_rollup_tier_retention_days(db_rollup_tier_t tier) {
+    if ((int)tier < 0 || tier >= DB_ROLLUP_TIERS) return 0;
+    return TIER_RETENTION_DAYS[tier];
+}
+
+int db_rollup_tier_for(int64_t resolution_ms) {
+    for (int t = DB_ROLLUP_TIERS - 1; t >= 0; t--) {
+        if (TIER_WIDTH_MS[t] <= resolution_ms) return t;
+    }
+    return -1;
+}
+
+static int64_t bucket_floor(int64_t ts_ms, int64_t width) {
+    int64_t rem = ts_ms % width;
+    return ts_ms - (rem < 0 ? rem + width : rem);
+}
+
+/* A lone minute sample is left to the raw blocks, if they hold every sample */
+static bool sparse_single(const db_rollup_writer_t *writer, const db_rollup_bucket_t *b) {
+    return !writer->store_single && b->tier == DB_ROLLUP_MINUTE && !b->stored && b->count == 1;
+}
+
+/* ============================================================================
+ * Writer
+ * ============================================================================ */
+
+void db_rollup_writer_init(db_rollup_writer_t *writer) {
+    memset(writer, 0, sizeof(*writer));
+}
+
+void db_rollup_writer_free(db_rollup_writer_t *writer) {
+    if (!writer) return;
+    free(writer->modules);
+    free(writer->closed);
+    memset(writer, 0, sizeof(*writer));
+}
+
+static db_rollup_module_t* find_module(db_rollup_writer_t *writer, int module_id) {
+    for (int i = 0; i < writer->module_count; i++) {
+        if (writer->modules[i].module_id == module_id) return &writer->modules[i];
+    }
+
+    if (writer->module_count == writer->module_cap) {
+        int cap = writer->module_cap ? writer->module_cap * 2 : 16;
+        db_rollup_module_t *grown = realloc(writer->modules, (size_t)cap * sizeof(*grown));
+        if (!grown) return NULL;
+        writer->modules = grown;
+        writer->module_cap = cap;
+    }
+
+    db_rollup_module_t *mod = &writer->modules[writer->module_count++];
+    memset(mod, 0, sizeof(*mod));
+    mod->module_id = module_id;
+    for (int t = 0; t < DB_ROLLUP_TIERS; t++) {
+        mod->cur[t].module_id = module_id;
+        mod->cur[t].tier = (db_rollup_tier_t)t;
+    }
+    return mod;
+}
+
+/* Park a bucket the samples have moved past until the next write */
+static void close_bucket(db_rollup_writer_t *writer, const db_rollup_bucket_t *b) {
+    if (writer->closed_count == writer->closed_cap) {
+        int cap = writer->closed_cap ? writer->closed_cap * 2 : 64;
+        db_rollup_bucket_t *grown = NULL;
+        if (cap <= WT_ROLLUP_PENDING_BUCKETS) {
+            grown = realloc(writer->closed, (size_t)cap * sizeof(*grown));
+        }
+        if (!grown) {
+            if (writer->buckets_dropped++ == 0) {
+                LOG_WARNING("Rollups: write backlog full, dropping buckets");
+            }
+            return;
+        }
+        writer->closed = grown;
+        writer->closed_cap = cap;
+    }
+    writer->closed[writer->closed_count++] = *b;
+}
+
+void db_rollup_add(db_rollup_writer_t *writer, int module_id, int64_t ts_ms, float value) {
+    if (!writer) return;
+
+    db_rollup_module_t *mod = find_module(writer, module_id);
+    if (!mod) return;
+
+    for (int t = 0; t < DB_ROLLUP_TIERS; t++) {
+        db_rollup_bucket_t *b = &mod->cur[t];
+        int64_t bucket = bucket_floor(ts_ms, TIER_WIDTH_MS[t]);
+
+        if (b->bucket_ms != bucket) {
+            if (b->count > 0 && !sparse_single(writer, b)) close_bucket(writer, b);
+            b->bucket_ms = bucket;
+            b->count = 0;
+            b->stored = false;
+        }
+
+        if (b->count == 0) {
+            b->min = b->max = b->first = value;
+            b->sum = 0.0;
+        } else {
+            if (value < b->min) b->min = value;
+            if (value > b->max) b->max = value;
+        }
+        b->last = value;
+        b->sum += value;
+        b->count++;
+    }
+}
+
+bool db_rollup_pending(const db_rollup_writer_t *writer, bool checkpoint) {
+    if (writer->closed_count > 0) return true;
+    for (int i = 0; checkpoint && i < writer->module_count; i++) {
+        for (int t = 0; t < DB_ROLLUP_TIERS; t++) {
+            const db_rollup_bucket_t *b = &writer->modules[i].cur[t];
+            if (b->count > 0 && !sparse_single(writer, b)) return true;
+        }
+    }
+    return false;
+}
+
+/* Adds a delta to the stored bucket; columns on the right are the old row */
+static const char *MERGE_SQL =
+    "INSERT INTO sensor_rollups (module_id, tier, bucket_start, sample_count, "
+    "min_value, max_value, sum_value, first_value, last_value) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT (module_id, tier, bucket_start) DO UPDATE SET "
+    "sample_count = sample_count + excluded.sample_count, "
+    "min_value = MIN(min_value, excluded.min_value), "
+    "max_value = MAX(max_value, excluded.max_value), "
+    "sum_value = sum_value + excluded.sum_value, "
+    "last_value = excluded.last_value;";
+
+/* Returns false on a hard error; a bucket of a deleted module is discarded */
+static bool merge_bucket(sqlite3_stmt *stmt, db_rollup_writer_t *writer, db_rollup_bucket_t *b) {
+    if (b->count == 0 || sparse_single(writer, b)) return true;
+
+    sqlite3_reset(stmt);
+    sqlite3_bind_int(stmt, 1, b->module_id);
+    sqlite3_bind_int(stmt, 2, (int)b->tier);
+    sqlite3_bind_int64(stmt, 3, b->bucket_ms);
+    sqlite3_bind_int(stmt, 4, (int)b->count);
+    sqlite3_bind_double(stmt, 5, b->min);
+    sqlite3_bind_double(stmt, 6, b->max);
+    sqlite3_bind_double(stmt, 7, b->sum);
+    sqlite3_bind_double(stmt, 8, b->first);
+    sqlite3_bind_double(stmt, 9, b->last);
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) return true;
+    if ((rc & 0xFF) != SQLITE_CONSTRAINT) return false;
+
+    b->count = 0;
+    writer->buckets_dropped++;
+    return true;
+}
+
+bool db_rollup_write(database_t *db, db_rollup_writer_t *writer, bool checkpoint) {
+    if (!db_rollup_pending(writer, checkpoint)) return true;
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, MERGE_SQL, -1, &stmt, NULL) != SQLITE_OK) {
+        LOG_ERROR("Rollups: prepare failed: %s", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; ok && i < writer->closed_count; i++) {
+        ok = merge_bucket(stmt, writer, &writer->closed[i]);
+    }
+    for (int i = 0; ok && checkpoint && i < writer->module_count; i++) {
+        for (int t = 0; ok && t < DB_ROLLUP_TIERS; t++) {
+            ok = merge_bucket(stmt, writer, &writer->modules[i].cur[t]);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+void db_rollup_committed(db_rollup_writer_t *writer, bool checkpoint) {
+    for (int i = 0; i < writer->closed_count; i++) {
+        if (writer->closed[i].count > 0) writer->buckets_written++;
+    }
+    writer->closed_count = 0;
+
+    if (!checkpoint) return;
+
+    /* Open buckets keep their key; later samples merge as a new delta */
+    for (int i = 0; i < writer->module_count; i++) {
+        for (int t = 0; t < DB_ROLLUP_TIERS; t++) {
+            db_rollup_bucket_t *b = &writer->modules[i].cur[t];
+            if (b->count == 0 || sparse_single(writer, b)) continue;
+            b->count = 0;
+            b->stored = true;
+        }
+    }
+}
+
+/* ============================================================================
+ * Queries
+ * ============================================================================ */
+
+static void read_point(sqlite3_stmt *stmt, int64_t width, db_rollup_point_t *p) {
+    int count = sqlite3_column_int(stmt, 1);
+    *p = (db_rollup_point_t){
+        .bucket_ms = sqlite3_column_int64(stmt, 0),
+        .width_ms = width,
+        .count = (uint32_t)count,
+        .min = (float)sqlite3_column_double(stmt, 2),
+        .max = (float)sqlite3_column_double(stmt, 3),
+        .avg = count > 0 ? (float)(sqlite3_column_double(stmt, 4) / count) : 0.0f,
+        .first = (float)sqlite3_column_double(stmt, 5),
+        .last = (float)sqlite3_column_double(stmt, 6),
+    };
+}
+
+static sqlite3_stmt* prepare_tier(database_t *db, int module_id, int tier,
+                                  int64_t from_ms, int64_t to_ms) {
+    const char *sql = "SELECT bucket_start, sample_count, min_value, max_value, sum_value, "
+                      "first_value, last_value FROM sensor_rollups "
+                      "WHERE module_id = ? AND tier = ? AND bucket_start >= ? AND bucket_start <= ? "
+                      "ORDER BY bucket_start;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return NULL;
+
+    sqlite3_bind_int(stmt, 1, module_id);
+    sqlite3_bind_int(stmt, 2, tier);
+    sqlite3_bind_int64(stmt, 3, bucket_floor(from_ms, TIER_WIDTH_MS[tier]));
+    sqlite3_bind_int64(stmt, 4, to_ms);
+    return stmt;
+}
+
+/* ----------------------------------------------------------------------------
+ * Minute tier: stored rows merged with buckets rebuilt from raw samples
+ * ---------------------------------------------------------------------------- */
+
+typedef struct {
+    db_rollup_point_t *items;
+    int count;
+    int cap;
+} point_list_t;
+
+typedef struct {
+    point_list_t rows;                  /* Stored buckets, ascending */
+    point_list_t raw;                   /* Rebuilt buckets; avg holds the sum until done */
+    bool failed;
+} sparse_ctx_t;
+
+static db_rollup_point_t* point_push(point_list_t *list) {
+    if (list->count == list->cap) {
+        int cap = list->cap ? list->cap * 2 : 256;
+        db_rollup_point_t *grown = realloc(list->items, (size_t)cap * sizeof(*grown));
+        if (!grown) return NULL;
+        list->items = grown;
+        list->cap = cap;
+    }
+    return &list->items[list->count++];
+}
+
+/* First stored bucket at or after bucket_ms */
+static int row_lower_bound(const point_list_t *rows, int64_t bucket_ms) {
+    int lo = 0, hi = rows->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (rows->items[mid].bucket_ms < bucket_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Decode a block only if some minute it spans has no stored row */
+static bool sparse_block_filter(void *ctx, int64_t start_ms, int64_t end_ms) {
+    sparse_ctx_t *sc = ctx;
+    int64_t width = TIER_WIDTH_MS[DB_ROLLUP_MINUTE];
+    int64_t first = bucket_floor(start_ms, width);
+    int64_t last = bucket_floor(end_ms, width);
+
+    int covered = row_lower_bound(&sc->rows, last + width) - row_lower_bound(&sc->rows, first);
+    return covered < (last - first) / width + 1;
+}
+
+static bool sparse_sample(void *ctx, int64_t ts_ms, float value, data_quality_t quality) {
+    sparse_ctx_t *sc = ctx;
+    if (quality >= QUALITY_BAD) return true;
+
+    int64_t width = TIER_WIDTH_MS[DB_ROLLUP_MINUTE];
+    int64_t bucket = bucket_floor(ts_ms, width);
+    int idx = row_lower_bound(&sc->rows, bucket);
+    if (idx < sc->rows.count && sc->rows.items[idx].bucket_ms == bucket) return true;
+
+    db_rollup_point_t *p = sc->raw.count > 0 ? &sc->raw.items[sc->raw.count - 1] : NULL;
+    if (p && p->bucket_ms == bucket) {
+        p->min = MIN(p->min, value);
+        p->max = MAX(p->max, value);
+        p->last = value;
+        p->avg += value;
+        p->count++;
+        return true;
+    }
+
+    p = point_push(&sc->raw);
+    if (!p) {
+        sc->failed = true;
+        return false;
+    }
+    *p = (db_rollup_point_t){
+        .bucket_ms = bucket, .width_ms = width, .count = 1,
+        .min = value, .max = value, .avg = value, .first = value, .last = value,
+    };
+    return true;
+}
+
+static result_t query_minutes(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                              db_rollup_cb cb, void *ctx) {
+    sqlite3_stmt *stmt = prepare_tier(db, module_id, DB_ROLLUP_MINUTE, from_ms, to_ms);
+    if (!stmt) return RESULT_ERROR;
+
+    sparse_ctx_t sc = {0};
+    while (!sc.failed && sqlite3_step(stmt) == SQLITE_ROW) {
+        db_rollup_point_t *p = point_push(&sc.rows);
+        if (p) read_point(stmt, TIER_WIDTH_MS[DB_ROLLUP_MINUTE], p);
+        else sc.failed = true;
+    }
+    sqlite3_finalize(stmt);
+
+    result_t result = RESULT_NO_MEMORY;
+    if (!sc.failed) {
+        result = db_history_query_filtered(db, module_id, from_ms, to_ms,
+                                           sparse_block_filter, sparse_sample, &sc);
+    }
+
+    int i = 0, j = 0;
+    bool more = true;
+    while (result == RESULT_OK && !sc.failed && more && (i < sc.rows.count || j < sc.raw.count)) {
+        if (j == sc.raw.count ||
+            (i < sc.rows.count && sc.rows.items[i].bucket_ms <= sc.raw.items[j].bucket_ms)) {
+            more = cb(ctx, &sc.rows.items[i++]);
+        } else {
+            db_rollup_point_t *p = &sc.raw.items[j++];
+            p->avg /= (float)p->count;
+            more = cb(ctx, p);
+        }
+    }
+    if (sc.failed) result = RESULT_NO_MEMORY;
+
+    free(sc.rows.items);
+    free(sc.raw.items);
+    return result;
+}
+
+/* ----------------------------------------------------------------------------
+ * Query API
+ * ---------------------------------------------------------------------------- */
+
+typedef struct {
+    db_rollup_cb cb;
+    void *ctx;
+} raw_ctx_t;
+
+static bool raw_point(void *ctx, int64_t ts_ms, float value, data_quality_t quality) {
+    raw_ctx_t *raw = ctx;
+    if (quality >= QUALITY_BAD) return true;
+
+    db_rollup_point_t p = {
+        .bucket_ms = ts_ms,
+        .count = 1,
+        .min = value, .max = value, .avg = value,
+        .first = value, .last = value,
+    };
+    return raw->cb(raw->ctx, &p);
+}
+
+result_t db_rollup_query(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                         int64_t resolution_ms, db_rollup_cb cb, void *ctx) {
+    CHECK_NULL(db); CHECK_NULL(cb);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+    if (to_ms < from_ms) return RESULT_INVALID_PARAM;
+
+    int tier = db_rollup_tier_for(resolution_ms);
+    if (tier < 0) {
+        raw_ctx_t raw = { .cb = cb, .ctx = ctx };
+        return db_history_query(db, module_id, from_ms, to_ms, raw_point, &raw);
+    }
+    if (tier == DB_ROLLUP_MINUTE) {
+        return query_minutes(db, module_id, from_ms, to_ms, cb, ctx);
+    }
+
+    sqlite3_stmt *stmt = prepare_tier(db, module_id, tier, from_ms, to_ms);
+    if (!stmt) return RESULT_ERROR;
+
+    bool more = true;
+    while (more && sqlite3_step(stmt) == SQLITE_ROW) {
+        db_rollup_point_t p;
+        read_point(stmt, TIER_WIDTH_MS[tier], &p);
+        if (p.count > 0) more = cb(ctx, &p);
+    }
+    sqlite3_finalize(stmt);
+    return RESULT_OK;
+}
+
+result_t db_rollup_cleanup(database_t *db) {
+    CHECK_NULL(db);
+    if (!db->db) return RESULT_NOT_INITIALIZED;
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, "DELETE FROM sensor_rollups WHERE tier = ? AND bucket_start < ?;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        return RESULT_ERROR;
+    }
+
+    int64_t now_ms = (int64_t)time(NULL) * 1000;
+    int deleted = 0;
+    result_t result = RESULT_OK;
+    for (int t = 0; t < DB_ROLLUP_TIERS; t++) {
+        sqlite3_reset(stmt);
+        sqlite3_bind_int(stmt, 1, t);
+        sqlite3_bind_int64(stmt, 2, now_ms - (int64_t)TIER_RETENTION_DAYS[t] * 86400 * 1000);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            result = RESULT_ERROR;
+            break;
+        }
+        deleted += sqlite3_changes(db->db);
+    }
+    sqlite3_finalize(stmt);
+
+    if (deleted > 0) LOG_INFO("Cleaned up %d old rollup buckets", deleted);
+    return result;
+}
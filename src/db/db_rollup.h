@@ -0,0 +1,131 @@
+/**
+ * @file db_rollup.h
+ * @brief Continuous min/max/avg aggregates of sensor history
+ *
+ * Every usable sample (GOOD or UNCERTAIN quality) is folded into 1-minute,
+ * 1-hour and 1-day buckets as it is logged. The writer keeps per-bucket
+ * deltas in memory and merges them into sensor_rollups with an upsert
+ * inside the history flush transaction, so the aggregates always match
+ * the blocks that were committed with them.
+ *
+ * A 1-minute bucket holding a single sample is not stored: it would cost
+ * a row per sample for sensors logged once a minute or slower. Minute
+ * queries rebuild those buckets from the raw blocks, decoding only blocks
+ * the stored rows do not fully cover. When the blocks hold only the points
+ * a compressor kept (store_single), every minute bucket is stored.
+ *
+ * first/last are in arrival order; min/max/sum/count are exact.
+ */
+
+#ifndef DB_ROLLUP_H
+#define DB_ROLLUP_H
+
+#include "common.h"
+#include "database.h"
+
+typedef enum {
+    DB_ROLLUP_MINUTE = 0,
+    DB_ROLLUP_HOUR,
+    DB_ROLLUP_DAY,
+    DB_ROLLUP_TIERS
+} db_rollup_tier_t;
+
+typedef struct {
+    int module_id;
+    db_rollup_tier_t tier;
+    int64_t bucket_ms;
+    uint32_t count;                     /* 0 = nothing to merge */
+    bool stored;                        /* Bucket already has a row */
+    float min;
+    float max;
+    float first;
+    float last;
+    double sum;
+} db_rollup_bucket_t;
+
+typedef struct {
+    int module_id;
+    db_rollup_bucket_t cur[DB_ROLLUP_TIERS];
+} db_rollup_module_t;
+
+/* Per-writer state; owned by the history writer's thread */
+typedef struct {
+    db_rollup_module_t *modules;
+    int module_count;
+    int module_cap;
+    db_rollup_bucket_t *closed;         /* Buckets left behind, not yet written */
+    int closed_count;
+    int closed_cap;
+    uint64_t buckets_written;
+    uint64_t buckets_dropped;
+    bool store_single;                  /* Raw blocks miss samples: store lone minutes too */
+} db_rollup_writer_t;
+
+/* One aggregated point; a raw sample has count 1 and width_ms 0 */
+typedef struct {
+    int64_t bucket_ms;
+    int64_t width_ms;
+    uint32_t count;
+    float min;
+    float max;
+    float avg;
+    float first;
+    float last;
+} db_rollup_point_t;
+
+typedef bool (*db_rollup_cb)(void *ctx, const db_rollup_point_t *point);
+
+void db_rollup_writer_init(db_rollup_writer_t *writer);
+void db_rollup_writer_free(db_rollup_writer_t *writer);
+
+/**
+ * @brief Fold one sample into its buckets (memory only)
+ */
+void db_rollup_add(db_rollup_writer_t *writer, int module_id, int64_t ts_ms, float value);
+
+/**
+ * @brief True if db_rollup_write() has anything to merge
+ */
+bool db_rollup_pending(const db_rollup_writer_t *writer, bool checkpoint);
+
+/**
+ * @brief Merge closed buckets, plus open ones if checkpoint, into sensor_rollups
+ *
+ * Must run inside the caller's transaction. Call db_rollup_committed()
+ * once that transaction commits; on rollback the deltas are kept.
+ * @return false on a database error
+ */
+bool db_rollup_write(database_t *db, db_rollup_writer_t *writer, bool checkpoint);
+void db_rollup_committed(db_rollup_writer_t *writer, bool checkpoint);
+
+/**
+ * @brief Bucket width of a tier in milliseconds
+ */
+int64_t db_rollup_tier_width_ms(db_rollup_tier_t tier);
+
+/**
+ * @brief Days a tier is kept (WT_ROLLUP_*_DAYS)
+ */
+int db_rollup_tier_retention_days(db_rollup_tier_t tier);
+
+/**
+ * @brief Coarsest tier no wider than resolution_ms, or -1 for raw samples
+ */
+int db_rollup_tier_for(int64_t resolution_ms);
+
+/**
+ * @brief Stream a sensor's trend over [from_ms, to_ms], oldest first
+ *
+ * Served from the coarsest tier that satisfies resolution_ms; below one
+ * minute, usable raw samples are returned as single-sample points.
+ * The callback returns false to stop.
+ */
+result_t db_rollup_query(database_t *db, int module_id, int64_t from_ms, int64_t to_ms,
+                         int64_t resolution_ms, db_rollup_cb cb, void *ctx);
+
+/**
+ * @brief Expire each tier after its WT_ROLLUP_*_DAYS retention
+ */
+result_t db_rollup_cleanup(database_t *db);
+
+#endif
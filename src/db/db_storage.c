@@ -0,0 +1,363 @@
+/**
+ * @file db_storage.c
+ * @brief Storage profiles and background WAL checkpointing
+ */
+
+#include "db_storage.h"
+#include "db_writer.h"
+#include "utils/logger.h"
+#include "config_defaults.h"
+#include <pthread.h>
+#include <sys/stat.h>
+
+#define AUTO_VACUUM_INCREMENTAL 2
+
+typedef struct {
+    const char *name;
+    const char *synchronous;
+    int cache_kib;              /* Page cache per connection */
+    int64_t mmap_bytes;
+    int checkpoint_s;           /* PASSIVE period */
+    int wake_pages;             /* WAL pages that bring the checkpoint forward */
+    int64_t wal_limit_bytes;    /* RESTART above this; also journal_size_limit */
+    int vacuum_s;
+    int vacuum_pages;           /* Most pages freed per step */
+} storage_profile_t;
+
+/*
+ * SD cards wear per erase block and stall on small random writes, so the
+ * WAL is allowed to grow and checkpointed rarely: a page rewritten by
+ * every commit reaches the main file once per checkpoint. tmpfs has no
+ * wear and nothing survives power loss anyway, so durability is off and
+ * the WAL kept small to save RAM.
+ */
+static const storage_profile_t PROFILES[] = {
+    [DB_STORAGE_SD] = {
+        .name = "sd", .synchronous = "NORMAL", .cache_kib = 8192, .mmap_bytes = 64LL << 20,
+        .checkpoint_s = 300, .wake_pages = 4000, .wal_limit_bytes = 32LL << 20,
+        .vacuum_s = 3600, .vacuum_pages = 256,
+    },
+    [DB_STORAGE_EMMC] = {
+        .name = "emmc", .synchronous = "NORMAL", .cache_kib = 16384, .mmap_bytes = 128LL << 20,
+        .checkpoint_s = 60, .wake_pages = 2000, .wal_limit_bytes = 16LL << 20,
+        .vacuum_s = 1800, .vacuum_pages = 512,
+    },
+    [DB_STORAGE_TMPFS] = {
+        .name = "tmpfs", .synchronous = "OFF", .cache_kib = 2048, .mmap_bytes = 256LL << 20,
+        .checkpoint_s = 30, .wake_pages = 1000, .wal_limit_bytes = 8LL << 20,
+        .vacuum_s = 600, .vacuum_pages = 2048,
+    },
+};
+
+#define PROFILE_COUNT ((int)(sizeof(PROFILES) / sizeof(PROFILES[0])))
+
+typedef struct {
+    const storage_profile_t *profile;
+    database_t *main;
+    database_t conn;            /* Checkpoint connection */
+    char wal_path[MAX_PATH_LEN + 8];
+
+    /* Frames in the current WAL, as last reported by a commit / checkpoint */
+    int wal_frames_now;
+    int backfilled_now;
+
+    db_storage_stats_t stats;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;        /* WAL over wake_pages / stop requested */
+    bool wake_pending;
+    bool running;
+} db_storage_t;
+
+static db_storage_t g_storage = {
+    .profile = &PROFILES[DB_STORAGE_SD],
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+};
+
+/* ============================================================================
+ * Internal Functions
+ * ============================================================================ */
+
+static bool is_memory_database(const char *path) {
+    return path[0] == '\0' || strcmp(path, ":memory:") == 0 ||
+           strncmp(path, "file::memory:", 13) == 0;
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static int pragma_int(sqlite3 *conn, const char *sql) {
+    sqlite3_stmt *stmt;
+    int value = -1;
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL) != SQLITE_OK) return -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) value = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+/* Caller holds g_storage.mutex; ckpt is cumulative for the current WAL */
+static void count_backfill(int log, int ckpt) {
+    if (log < 0 || ckpt < 0) return;
+    int done = ckpt >= g_storage.backfilled_now ? ckpt - g_storage.backfilled_now : ckpt;
+    g_storage.stats.checkpoint_frames += (uint64_t)done;
+    g_storage.backfilled_now = ckpt;
+}
+
+/*
+ * Commit hook on every read-write connection (replaces SQLite's
+ * auto-checkpoint). Counts the frames each commit appended and wakes the
+ * checkpoint thread; checkpoints here only as a last resort.
+ */
+static int wal_hook(void *arg, sqlite3 *conn, const char *name, int frames) {
+    UNUSED(arg);
+    const storage_profile_t *p = g_storage.profile;
+
+    pthread_mutex_lock(&g_storage.mutex);
+    if (frames < g_storage.wal_frames_now) {
+        /* WAL rewound after a full checkpoint */
+        g_storage.stats.wal_frames += (uint64_t)frames;
+        g_storage.backfilled_now = 0;
+    } else {
+        g_storage.stats.wal_frames += (uint64_t)(frames - g_storage.wal_frames_now);
+    }
+    g_storage.wal_frames_now = frames;
+    bool inline_checkpoint = frames >= p->wake_pages * 4;
+    if (frames >= p->wake_pages && !g_storage.wake_pending) {
+        g_storage.wake_pending = true;
+        pthread_cond_signal(&g_storage.wake);
+    }
+    pthread_mutex_unlock(&g_storage.mutex);
+
+    if (inline_checkpoint) {
+        int log = -1, ckpt = -1;
+        sqlite3_wal_checkpoint_v2(conn, name, SQLITE_CHECKPOINT_PASSIVE, &log, &ckpt);
+        pthread_mutex_lock(&g_storage.mutex);
+        g_storage.stats.checkpoints_inline++;
+        count_backfill(log, ckpt);
+        pthread_mutex_unlock(&g_storage.mutex);
+    }
+    return SQLITE_OK;
+}
+
+static int64_t wal_file_size(void) {
+    struct stat st;
+    return stat(g_storage.wal_path, &st) == 0 ? (int64_t)st.st_size : 0;
+}
+
+static void run_checkpoint(int mode) {
+    int log = -1, ckpt = -1;
+    uint64_t start_us = monotonic_us();
+    int rc = sqlite3_wal_checkpoint_v2(g_storage.conn.db, NULL, mode, &log, &ckpt);
+    uint64_t took = monotonic_us() - start_us;
+
+    pthread_mutex_lock(&g_storage.mutex);
+    db_storage_stats_t *s = &g_storage.stats;
+    if (mode == SQLITE_CHECKPOINT_RESTART) s->checkpoints_restart++;
+    else s->checkpoints_passive++;
+    if (rc == SQLITE_BUSY || (log >= 0 && ckpt < log)) s->checkpoints_busy++;
+    s->checkpoint_us_total += took;
+    if (took > s->checkpoint_us_max) s->checkpoint_us_max = took;
+    count_backfill(log, ckpt);
+    pthread_mutex_unlock(&g_storage.mutex);
+
+    if (rc != SQLITE_OK && rc != SQLITE_BUSY) {
+        LOG_WARNING("Checkpoint failed: %s", sqlite3_errmsg(g_storage.conn.db));
+    }
+}
+
+/* db_writer request: free at most *arg pages from the freelist */
+static result_t vacuum_request(database_t *db, void *arg) {
+    int *pages = arg;
+    int before = pragma_int(db->db, "PRAGMA freelist_count;");
+    char sql[64];
+    snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%d);", *pages);
+    result_t r = database_execute(db, sql);
+    int after = pragma_int(db->db, "PRAGMA freelist_count;");
+    *pages = before >= 0 && after >= 0 ? MAX(before - after, 0) : 0;
+    return r;
+}
+
+static void run_vacuum(void) {
+    int free_pages = pragma_int(g_storage.conn.db, "PRAGMA freelist_count;");
+    if (free_pages <= 0) return;
+
+    int pages = MIN(free_pages, g_storage.profile->vacuum_pages);
+    if (db_writer_call(g_storage.main, vacuum_request, &pages) != RESULT_OK) {
+        LOG_WARNING("Incremental vacuum failed");
+        return;
+    }
+
+    pthread_mutex_lock(&g_storage.mutex);
+    g_storage.stats.vacuum_runs++;
+    g_storage.stats.vacuum_pages += (uint64_t)pages;
+    pthread_mutex_unlock(&g_storage.mutex);
+}
+
+static void* checkpoint_thread(void *arg) {
+    UNUSED(arg);
+    const storage_profile_t *p = g_storage.profile;
+    uint64_t next_checkpoint_ms = get_time_ms() + (uint64_t)p->checkpoint_s * 1000;
+    uint64_t next_vacuum_ms = get_time_ms() + (uint64_t)p->vacuum_s * 1000;
+
+    pthread_mutex_lock(&g_storage.mutex);
+    while (g_storage.running) {
+        /* Sleep until the next periodic task, a busy WAL, or stop */
+        uint64_t next_ms = MIN(next_checkpoint_ms, next_vacuum_ms);
+        uint64_t now_ms = get_time_ms();
+        if (!g_storage.wake_pending && next_ms > now_ms) {
+            uint64_t wait_ms = MIN(next_ms - now_ms, 1000);
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += (time_t)(wait_ms / 1000);
+            deadline.tv_nsec += (long)(wait_ms % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_storage.wake, &g_storage.mutex, &deadline);
+            continue;
+        }
+        bool woken = g_storage.wake_pending;
+        g_storage.wake_pending = false;
+        bool incremental = g_storage.stats.incremental_vacuum;
+        bool unbackfilled = g_storage.wal_frames_now > g_storage.backfilled_now;
+        pthread_mutex_unlock(&g_storage.mutex);
+
+        now_ms = get_time_ms();
+        if (woken || now_ms >= next_checkpoint_ms) {
+            /* An idle period with nothing new in the WAL needs no checkpoint */
+            if (woken || unbackfilled) {
+                run_checkpoint(wal_file_size() > p->wal_limit_bytes ?
+                               SQLITE_CHECKPOINT_RESTART : SQLITE_CHECKPOINT_PASSIVE);
+            }
+            next_checkpoint_ms = now_ms + (uint64_t)p->checkpoint_s * 1000;
+        }
+        if (now_ms >= next_vacuum_ms) {
+            if (incremental) run_vacuum();
+            next_vacuum_ms = now_ms + (uint64_t)p->vacuum_s * 1000;
+        }
+
+        pthread_mutex_lock(&g_storage.mutex);
+    }
+    pthread_mutex_unlock(&g_storage.mutex);
+    return NULL;
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+result_t db_storage_profile_parse(const char *name, db_storage_profile_t *out) {
+    CHECK_NULL(name); CHECK_NULL(out);
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        if (strcasecmp(name, PROFILES[i].name) == 0) {
+            *out = (db_storage_profile_t)i;
+            return RESULT_OK;
+        }
+    }
+    return RESULT_INVALID_PARAM;
+}
+
+const char* db_storage_profile_name(db_storage_profile_t profile) {
+    return (int)profile >= 0 && (int)profile < PROFILE_COUNT ? PROFILES[profile].name : "unknown";
+}
+
+void db_storage_set_profile(db_storage_profile_t profile) {
+    if ((int)profile < 0 || (int)profile >= PROFILE_COUNT) return;
+    pthread_mutex_lock(&g_storage.mutex);
+    g_storage.profile = &PROFILES[profile];
+    pthread_mutex_unlock(&g_storage.mutex);
+}
+
+void db_storage_configure(database_t *db, bool read_only) {
+    if (!db || !db->db) return;
+    const storage_profile_t *p = g_storage.profile;
+    char sql[96];
+
+    snprintf(sql, sizeof(sql), "PRAGMA cache_size = -%d;", p->cache_kib);
+    sqlite3_exec(db->db, sql, NULL, NULL, NULL);
+    snprintf(sql, sizeof(sql), "PRAGMA mmap_size = %lld;", (long long)p->mmap_bytes);
+    sqlite3_exec(db->db, sql, NULL, NULL, NULL);
+    sqlite3_exec(db->db, "PRAGMA temp_store = MEMORY;", NULL, NULL, NULL);
+    if (read_only) return;
+
+    snprintf(sql, sizeof(sql), "PRAGMA synchronous = %s;", p->synchronous);
+    sqlite3_exec(db->db, sql, NULL, NULL, NULL);
+    snprintf(sql, sizeof(sql), "PRAGMA journal_size_limit = %lld;", (long long)p->wal_limit_bytes);
+    sqlite3_exec(db->db, sql, NULL, NULL, NULL);
+    sqlite3_wal_hook(db->db, wal_hook, NULL);
+
+    /* auto_vacuum can only change on a database with no tables, before WAL mode */
+    int auto_vacuum = pragma_int(db->db, "PRAGMA auto_vacuum;");
+    if (auto_vacuum == 0 && pragma_int(db->db, "SELECT COUNT(*) FROM sqlite_master;") == 0) {
+        sqlite3_exec(db->db, "PRAGMA auto_vacuum = INCREMENTAL;", NULL, NULL, NULL);
+        auto_vacuum = pragma_int(db->db, "PRAGMA auto_vacuum;");
+    }
+
+    int page_size = pragma_int(db->db, "PRAGMA page_size;");
+
+    pthread_mutex_lock(&g_storage.mutex);
+    g_storage.stats.incremental_vacuum = auto_vacuum == AUTO_VACUUM_INCREMENTAL;
+    g_storage.stats.page_size = page_size;
+    pthread_mutex_unlock(&g_storage.mutex);
+}
+
+result_t db_storage_start(database_t *main) {
+    CHECK_NULL(main);
+    if (g_storage.running) return RESULT_OK;
+    if (is_memory_database(main->db_path)) return RESULT_OK;
+
+    result_t r = database_init(&g_storage.conn, main->db_path);
+    if (r != RESULT_OK) {
+        LOG_ERROR("Checkpoint connection failed, checkpoints fall back to committing threads");
+        return r;
+    }
+    g_storage.main = main;
+    snprintf(g_storage.wal_path, sizeof(g_storage.wal_path), "%s-wal", main->db_path);
+
+    g_storage.running = true;
+    if (pthread_create(&g_storage.thread, NULL, checkpoint_thread, NULL) != 0) {
+        LOG_ERROR("Failed to create checkpoint thread");
+        g_storage.running = false;
+        database_close(&g_storage.conn);
+        return RESULT_ERROR;
+    }
+
+    if (!g_storage.stats.incremental_vacuum) {
+        LOG_INFO("Database predates auto_vacuum = INCREMENTAL; run VACUUM once to enable it");
+    }
+    LOG_INFO("Storage profile %s: checkpoint every %d s, RESTART above %lld KiB",
+             g_storage.profile->name, g_storage.profile->checkpoint_s,
+             (long long)(g_storage.profile->wal_limit_bytes >> 10));
+    return RESULT_OK;
+}
+
+void db_storage_stop(void) {
+    if (!g_storage.running) return;
+
+    pthread_mutex_lock(&g_storage.mutex);
+    g_storage.running = false;
+    pthread_cond_signal(&g_storage.wake);
+    pthread_mutex_unlock(&g_storage.mutex);
+
+    pthread_join(g_storage.thread, NULL);
+    database_close(&g_storage.conn);
+}
+
+void db_storage_get_stats(db_storage_stats_t *stats) {
+    if (!stats) return;
+
+    pthread_mutex_lock(&g_storage.mutex);
+    *stats = g_storage.stats;
+    stats->profile = (db_storage_profile_t)(g_storage.profile - PROFILES);
+    pthread_mutex_unlock(&g_storage.mutex);
+
+    stats->wal_bytes = g_storage.wal_path[0] ? (uint64_t)wal_file_size() : 0;
+    stats->write_amplification = stats->wal_frames ?
+        (double)(stats->wal_frames + stats->checkpoint_frames) / (double)stats->wal_frames : 0.0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file db_storage.h
+ * @brief Storage profiles and background WAL checkpointing
+ *
+ * A profile tunes every connection for the medium under the database:
+ * synchronous level, page cache, mmap, WAL size limit. SQLite's own
+ * auto-checkpoint, which runs on whichever thread happens to commit, is
+ * replaced by a checkpoint thread:
+ *
+ *  - PASSIVE every profile period, or sooner once the WAL holds the
+ *    profile's page count; never waits on readers or the writer
+ *  - RESTART when the WAL file grows past the profile limit, so the
+ *    next commit rewinds it instead of growing it further
+ *  - incremental_vacuum in small steps through the database writer, on
+ *    databases created with auto_vacuum = INCREMENTAL
+ *
+ * A committing connection only checkpoints itself if the WAL reaches
+ * four times the early-wake size (checkpoint thread stalled or absent).
+ *
+ * Write amplification is reported as database page writes (WAL frames
+ * plus pages checkpointed into the main file) per WAL frame committed.
+ */
+
+#ifndef DB_STORAGE_H
+#define DB_STORAGE_H
+
+#include "common.h"
+#include "db/database.h"
+
+typedef enum {
+    DB_STORAGE_SD = 0,          /* SD card: few, large checkpoints */
+    DB_STORAGE_EMMC,            /* eMMC / SSD */
+    DB_STORAGE_TMPFS            /* RAM-backed, no durability */
+} db_storage_profile_t;
+
+typedef struct {
+    db_storage_profile_t profile;
+    uint64_t checkpoints_passive;
+    uint64_t checkpoints_restart;
+    uint64_t checkpoints_busy;      /* Left frames behind (readers/writer in the way) */
+    uint64_t checkpoints_inline;    /* Run by a committing connection */
+    uint64_t checkpoint_us_total;
+    uint64_t checkpoint_us_max;
+    uint64_t wal_frames;            /* Pages appended to the WAL by commits */
+    uint64_t checkpoint_frames;     /* Pages copied into the database file */
+    uint64_t wal_bytes;             /* Current WAL file size */
+    uint64_t vacuum_runs;
+    uint64_t vacuum_pages;          /* Pages returned to the filesystem */
+    int page_size;
+    bool incremental_vacuum;        /* Database has auto_vacuum = INCREMENTAL */
+    double write_amplification;
+} db_storage_stats_t;
+
+/**
+ * @brief Profile by name: "sd", "emmc" or "tmpfs"
+ * @return RESULT_OK, RESULT_INVALID_PARAM (out unchanged)
+ */
+result_t db_storage_profile_parse(const char *name, db_storage_profile_t *out);
+const char* db_storage_profile_name(db_storage_profile_t profile);
+
+/**
+ * @brief Select the profile for connections opened from now on
+ */
+void db_storage_set_profile(db_storage_profile_t profile);
+
+/**
+ * @brief Apply the profile to a freshly opened connection (database.c)
+ *
+ * Runs before WAL mode and the schema, so a new database file gets
+ * auto_vacuum = INCREMENTAL.
+ */
+void db_storage_configure(database_t *db, bool read_only);
+
+/**
+ * @brief Start the checkpoint thread for main's file (none for in-memory)
+ */
+result_t db_storage_start(database_t *main);
+void db_storage_stop(void);
+
+void db_storage_get_stats(db_storage_stats_t *stats);
+
+#endif
@@ -0,0 +1,391 @@
+/**
+ * @file db_writer.c
+ * @brief Single writer thread with group commit, and pooled read connections
+ */
+
+#include "db_writer.h"
+#include "utils/logger.h"
+#include "config_defaults.h"
+#include <pthread.h>
+
+#define WRITER_BATCH_SIZE   WT_DATABASE_WRITER_BATCH
+#define READER_POOL_SIZE    WT_DATABASE_READERS
+
+/* Lives on the calling thread's stack until done is set */
+typedef struct db_write_req {
+    db_write_fn fn;
+    void *arg;
+    bool exclusive;
+    bool done;
+    result_t result;
+    uint64_t queued_us;
+    struct db_write_req *next;
+} db_write_req_t;
+
+typedef struct {
+    database_t *db;             /* Connection the writer uses */
+    database_t own_db;
+    bool own_connection;
+
+    db_write_req_t *head;       /* FIFO of waiting requests */
+    db_write_req_t *tail;
+    int depth;
+
+    db_writer_stats_t stats;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;        /* Request queued / stop requested */
+    pthread_cond_t done;        /* A batch finished */
+    bool running;
+    bool initialized;
+} db_writer_t;
+
+typedef struct {
+    database_t conns[READER_POOL_SIZE];
+    bool in_use[READER_POOL_SIZE];
+    int size;
+
+    db_readers_stats_t stats;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t released;
+} db_readers_t;
+
+static db_writer_t g_writer = {0};
+static db_readers_t g_readers = {0};
+static __thread bool t_on_writer;
+
+/* ============================================================================
+ * Internal Functions
+ * ============================================================================ */
+
+static bool is_memory_database(const char *path) {
+    return path[0] == '\0' || strcmp(path, ":memory:") == 0 ||
+           strncmp(path, "file::memory:", 13) == 0;
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/* Run fn in a transaction of its own on db (writer not running) */
+static result_t run_direct(database_t *db, db_write_fn fn, void *arg, bool exclusive) {
+    /* Called from a request already running on db: join its transaction */
+    if (exclusive || !sqlite3_get_autocommit(db->db)) return fn(db, arg);
+
+    if (database_execute(db, "BEGIN IMMEDIATE;") != RESULT_OK) return RESULT_ERROR;
+    result_t r = fn(db, arg);
+    if (r != RESULT_OK) {
+        database_rollback(db);
+        return r;
+    }
+    if (database_commit(db) != RESULT_OK) {
+        database_rollback(db);
+        return RESULT_ERROR;
+    }
+    return RESULT_OK;
+}
+
+/*
+ * One transaction for the whole batch, a savepoint per request: a request
+ * that fails is undone alone, the others still commit together.
+ */
+static bool run_group(db_write_req_t *batch) {
+    database_t *db = g_writer.db;
+    bool ok = database_execute(db, "BEGIN IMMEDIATE;") == RESULT_OK;
+
+    for (db_write_req_t *req = batch; req; req = req->next) {
+        if (!ok) {
+            req->result = RESULT_ERROR;
+            continue;
+        }
+        database_execute(db, "SAVEPOINT request;");
+        req->result = req->fn(db, req->arg);
+        if (req->result != RESULT_OK) database_execute(db, "ROLLBACK TO request;");
+        database_execute(db, "RELEASE request;");
+    }
+
+    if (ok && database_commit(db) != RESULT_OK) {
+        database_rollback(db);
+        ok = false;
+        for (db_write_req_t *req = batch; req; req = req->next) req->result = RESULT_ERROR;
+    }
+    return ok;
+}
+
+static void* writer_thread(void *arg) {
+    UNUSED(arg);
+    t_on_writer = true;
+
+    for (;;) {
+        pthread_mutex_lock(&g_writer.mutex);
+        while (!g_writer.head && g_writer.running) {
+            pthread_cond_wait(&g_writer.cond, &g_writer.mutex);
+        }
+        if (!g_writer.head) {
+            pthread_mutex_unlock(&g_writer.mutex);
+            break;
+        }
+
+        /* An exclusive request runs alone; otherwise take the queued run of shared ones */
+        db_write_req_t *batch = g_writer.head;
+        db_write_req_t *last = batch;
+        int count = 1;
+        if (!batch->exclusive) {
+            while (last->next && !last->next->exclusive && count < WRITER_BATCH_SIZE) {
+                last = last->next;
+                count++;
+            }
+        }
+        g_writer.head = last->next;
+        if (!g_writer.head) g_writer.tail = NULL;
+        last->next = NULL;
+        g_writer.depth -= count;
+        pthread_mutex_unlock(&g_writer.mutex);
+
+        uint64_t start_us = monotonic_us();
+        bool committed = true;
+        if (batch->exclusive) {
+            batch->result = batch->fn(g_writer.db, batch->arg);
+        } else {
+            committed = run_group(batch);
+        }
+        uint64_t end_us = monotonic_us();
+
+        pthread_mutex_lock(&g_writer.mutex);
+        db_writer_stats_t *s = &g_writer.stats;
+        s->requests += (uint64_t)count;
+        if (!batch->exclusive) {
+            if (committed) s->batches++;
+            else s->failures++;
+            s->commit_us_total += end_us - start_us;
+            if (end_us - start_us > s->commit_us_max) s->commit_us_max = end_us - start_us;
+            if (count > s->max_batch) s->max_batch = count;
+        }
+        for (db_write_req_t *req = batch; req; ) {
+            db_write_req_t *next = req->next;
+            uint64_t waited = end_us - req->queued_us;
+            s->wait_us_total += waited;
+            if (waited > s->wait_us_max) s->wait_us_max = waited;
+            req->done = true;   /* req may be gone once the mutex is released */
+            req = next;
+        }
+        pthread_cond_broadcast(&g_writer.done);
+        pthread_mutex_unlock(&g_writer.mutex);
+    }
+
+    return NULL;
+}
+
+static result_t writer_call(database_t *db, db_write_fn fn, void *arg, bool exclusive) {
+    CHECK_NULL(fn);
+
+    /* A request that writes through another request is already in a transaction */
+    if (t_on_writer) return fn(g_writer.db, arg);
+
+    if (g_writer.initialized) {
+        db_write_req_t req = {
+            .fn = fn, .arg = arg, .exclusive = exclusive,
+            .result = RESULT_ERROR, .queued_us = monotonic_us(),
+        };
+
+        pthread_mutex_lock(&g_writer.mutex);
+        if (g_writer.running) {
+            if (g_writer.tail) g_writer.tail->next = &req;
+            else g_writer.head = &req;
+            g_writer.tail = &req;
+            g_writer.depth++;
+            pthread_cond_signal(&g_writer.cond);
+            while (!req.done) pthread_cond_wait(&g_writer.done, &g_writer.mutex);
+            pthread_mutex_unlock(&g_writer.mutex);
+            return req.result;
+        }
+        pthread_mutex_unlock(&g_writer.mutex);
+    }
+
+    CHECK_NULL(db);
+    return run_direct(db, fn, arg, exclusive);
+}
+
+static void readers_open(const char *path) {
+    pthread_mutex_init(&g_readers.mutex, NULL);
+    pthread_cond_init(&g_readers.released, NULL);
+    if (is_memory_database(path)) return;
+
+    for (int i = 0; i < READER_POOL_SIZE; i++) {
+        if (database_open_reader(&g_readers.conns[g_readers.size], path) != RESULT_OK) break;
+        g_readers.size++;
+    }
+    if (g_readers.size < READER_POOL_SIZE) {
+        LOG_WARNING("Database: %d of %d read connections opened", g_readers.size, READER_POOL_SIZE);
+    }
+}
+
+static void readers_close(void) {
+    pthread_mutex_lock(&g_readers.mutex);
+    while (g_readers.stats.in_use > 0) {
+        pthread_cond_wait(&g_readers.released, &g_readers.mutex);
+    }
+    for (int i = 0; i < g_readers.size; i++) database_close(&g_readers.conns[i]);
+    g_readers.size = 0;
+    pthread_mutex_unlock(&g_readers.mutex);
+
+    pthread_cond_destroy(&g_readers.released);
+    pthread_mutex_destroy(&g_readers.mutex);
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+result_t db_writer_init(database_t *main) {
+    CHECK_NULL(main);
+    if (g_writer.initialized) return RESULT_OK;
+
+    memset(&g_writer, 0, sizeof(g_writer));
+    memset(&g_readers, 0, sizeof(g_readers));
+
+    if (is_memory_database(main->db_path)) {
+        g_writer.db = main;
+    } else if (database_init(&g_writer.own_db, main->db_path) != RESULT_OK) {
+        LOG_WARNING("Database writer: dedicated connection failed, sharing main connection");
+        g_writer.db = main;
+    } else {
+        g_writer.db = &g_writer.own_db;
+        g_writer.own_connection = true;
+    }
+
+    readers_open(main->db_path);
+
+    pthread_mutex_init(&g_writer.mutex, NULL);
+    pthread_cond_init(&g_writer.cond, NULL);
+    pthread_cond_init(&g_writer.done, NULL);
+    g_writer.initialized = true;
+
+    LOG_INFO("Database writer initialized (%s connection, %d readers)",
+             g_writer.own_connection ? "dedicated" : "shared", g_readers.size);
+    return RESULT_OK;
+}
+
+result_t db_writer_start(void) {
+    if (!g_writer.initialized) return RESULT_NOT_INITIALIZED;
+    if (g_writer.running) return RESULT_OK;
+
+    g_writer.running = true;
+    if (pthread_create(&g_writer.thread, NULL, writer_thread, NULL) != 0) {
+        LOG_ERROR("Failed to create database writer thread");
+        g_writer.running = false;
+        return RESULT_ERROR;
+    }
+    return RESULT_OK;
+}
+
+result_t db_writer_stop(void) {
+    if (!g_writer.running) return RESULT_OK;
+
+    pthread_mutex_lock(&g_writer.mutex);
+    g_writer.running = false;
+    pthread_cond_signal(&g_writer.cond);
+    pthread_mutex_unlock(&g_writer.mutex);
+
+    /* Thread exits once the queue is drained */
+    pthread_join(g_writer.thread, NULL);
+    return RESULT_OK;
+}
+
+void db_writer_shutdown(void) {
+    if (!g_writer.initialized) return;
+    db_writer_stop();
+
+    readers_close();
+    if (g_writer.own_connection) database_close(&g_writer.own_db);
+    pthread_cond_destroy(&g_writer.done);
+    pthread_cond_destroy(&g_writer.cond);
+    pthread_mutex_destroy(&g_writer.mutex);
+    g_writer.initialized = false;
+}
+
+result_t db_writer_call(database_t *db, db_write_fn fn, void *arg) {
+    return writer_call(db, fn, arg, false);
+}
+
+result_t db_writer_call_exclusive(database_t *db, db_write_fn fn, void *arg) {
+    return writer_call(db, fn, arg, true);
+}
+
+void db_writer_get_stats(db_writer_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!g_writer.initialized) return;
+
+    pthread_mutex_lock(&g_writer.mutex);
+    *stats = g_writer.stats;
+    stats->queue_depth = g_writer.depth;
+    pthread_mutex_unlock(&g_writer.mutex);
+    stats->dedicated = g_writer.own_connection;
+    database_get_stats(g_writer.db, &stats->conn);
+}
+
+database_t* db_reader_acquire(database_t *fallback) {
+    if (!g_writer.initialized || g_readers.size == 0) return fallback;
+
+    uint64_t start_us = 0;
+    pthread_mutex_lock(&g_readers.mutex);
+    g_readers.stats.acquires++;
+    for (;;) {
+        for (int i = 0; i < g_readers.size; i++) {
+            if (g_readers.in_use[i]) continue;
+            g_readers.in_use[i] = true;
+            g_readers.stats.in_use++;
+            if (start_us) {
+                uint64_t waited = monotonic_us() - start_us;
+                g_readers.stats.wait_us_total += waited;
+                if (waited > g_readers.stats.wait_us_max) g_readers.stats.wait_us_max = waited;
+            }
+            pthread_mutex_unlock(&g_readers.mutex);
+            return &g_readers.conns[i];
+        }
+        if (!start_us) {
+            g_readers.stats.waits++;
+            start_us = monotonic_us();
+        }
+        pthread_cond_wait(&g_readers.released, &g_readers.mutex);
+    }
+}
+
+void db_reader_release(database_t *reader) {
+    if (!reader || reader < &g_readers.conns[0] || reader >= &g_readers.conns[READER_POOL_SIZE]) {
+        return;     /* The fallback connection */
+    }
+
+    pthread_mutex_lock(&g_readers.mutex);
+    g_readers.in_use[reader - g_readers.conns] = false;
+    g_readers.stats.in_use--;
+    pthread_cond_broadcast(&g_readers.released);
+    pthread_mutex_unlock(&g_readers.mutex);
+}
+
+void db_readers_get_stats(db_readers_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!g_writer.initialized) return;
+
+    pthread_mutex_lock(&g_readers.mutex);
+    *stats = g_readers.stats;
+    stats->size = g_readers.size;
+    for (int i = 0; i < g_readers.size; i++) {
+        database_stats_t c;
+        database_get_stats(&g_readers.conns[i], &c);
+        stats->conn.stmt_hits += c.stmt_hits;
+        stats->conn.stmt_misses += c.stmt_misses;
+        stats->conn.stmt_evictions += c.stmt_evictions;
+        stats->conn.stmt_cached += c.stmt_cached;
+        stats->conn.busy_waits += c.busy_waits;
+        stats->conn.busy_wait_ms += c.busy_wait_ms;
+        stats->conn.busy_timeouts += c.busy_timeouts;
+    }
+    pthread_mutex_unlock(&g_readers.mutex);
+}
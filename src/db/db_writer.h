@@ -0,0 +1,99 @@
+/**
+ * @file db_writer.h
+ * @brief Single writer thread with group commit, and pooled read connections
+ *
+ * Background writes (alarm journal, historian flushes, retention) go
+ * through one thread on one connection, so they never wait on each other
+ * for SQLite's write lock. Requests queued while a transaction runs are
+ * committed together in the next one: one WAL sync for the whole group.
+ *
+ * Readers borrow one of WT_DATABASE_READERS read-only connections; in WAL
+ * mode a reader sees the last commit and neither blocks nor waits for the
+ * writer.
+ *
+ * In-memory databases cannot be opened twice; the writer and the pool then
+ * fall back to the main connection, as does a call made while the writer
+ * is not running.
+ */
+
+#ifndef DB_WRITER_H
+#define DB_WRITER_H
+
+#include "common.h"
+#include "db/database.h"
+
+/**
+ * @brief Write request, run on the writer's connection
+ * @return RESULT_OK to keep the changes; anything else undoes them
+ */
+typedef result_t (*db_write_fn)(database_t *db, void *arg);
+
+typedef struct {
+    uint64_t requests;          /* Requests run */
+    uint64_t batches;           /* Transactions committed */
+    uint64_t failures;          /* Transactions that did not commit */
+    uint64_t wait_us_total;     /* Queue + run time over all requests */
+    uint64_t wait_us_max;
+    uint64_t commit_us_total;   /* Transaction time over all batches */
+    uint64_t commit_us_max;
+    int queue_depth;
+    int max_batch;              /* Most requests in one transaction */
+    bool dedicated;             /* Own connection (not the main one) */
+    database_stats_t conn;      /* Writer connection counters */
+} db_writer_stats_t;
+
+typedef struct {
+    uint64_t acquires;
+    uint64_t waits;             /* Acquires that found every reader busy */
+    uint64_t wait_us_total;
+    uint64_t wait_us_max;
+    int size;                   /* 0: readers share the main connection */
+    int in_use;
+    database_stats_t conn;      /* Reader connection counters, summed */
+} db_readers_stats_t;
+
+/**
+ * @brief Open the writer connection and the reader pool for main's file
+ */
+result_t db_writer_init(database_t *main);
+result_t db_writer_start(void);
+
+/**
+ * @brief Stop the writer after running every queued request
+ *
+ * Later calls run on the caller's thread.
+ */
+result_t db_writer_stop(void);
+void db_writer_shutdown(void);
+
+/**
+ * @brief Run fn on the writer thread and wait for its transaction to commit
+ *
+ * fn must not begin or end a transaction; it runs under a savepoint in a
+ * transaction shared with other queued requests, so a failing fn undoes
+ * only its own changes.
+ * @param db Connection to use when the writer is not running
+ * @return fn's result, RESULT_ERROR if the transaction did not commit
+ */
+result_t db_writer_call(database_t *db, db_write_fn fn, void *arg);
+
+/**
+ * @brief Run fn alone on the writer thread, outside any transaction
+ *
+ * For work that manages its own transactions (historian flush, partition
+ * drops).
+ */
+result_t db_writer_call_exclusive(database_t *db, db_write_fn fn, void *arg);
+
+void db_writer_get_stats(db_writer_stats_t *stats);
+
+/**
+ * @brief Borrow a read-only connection, waiting if all are out
+ * @param fallback Returned when there is no pool
+ */
+database_t* db_reader_acquire(database_t *fallback);
+void db_reader_release(database_t *reader);
+
+void db_readers_get_stats(db_readers_stats_t *stats);
+
+#endif
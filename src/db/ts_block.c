@@ -0,0 +1,261 @@
+/**
+ * @file ts_block.c
+ * @brief Compressed time-series block codec
+ */
+
+#include "ts_block.h"
+
+/* Largest encoding of one sample: 4+64 timestamp, 2+5+5+32 value, 3 quality */
+#define MAX_SAMPLE_BITS     115
+
+/* ============================================================================
+ * Bit I/O (MSB first)
+ * ============================================================================ */
+
+static void put_bits(uint8_t *out, uint32_t *pos, uint64_t v, int n) {
+    while (n > 0) {
+        int room = 8 - (int)(*pos & 7);
+        int take = n < room ? n : room;
+        uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+        out[*pos >> 3] |= (uint8_t)(chunk << (room - take));
+        *pos += (uint32_t)take;
+        n -= take;
+    }
+}
+
+static bool get_bits(ts_decoder_t *dec, int n, uint64_t *v) {
+    if (dec->bits + (uint32_t)n > dec->bits_total) return false;
+
+    uint64_t r = 0;
+    while (n > 0) {
+        int room = 8 - (int)(dec->bits & 7);
+        int take = n < room ? n : room;
+        uint8_t byte = dec->data[dec->bits >> 3];
+        r = (r << take) | ((byte >> (room - take)) & ((1u << take) - 1));
+        dec->bits += (uint32_t)take;
+        n -= take;
+    }
+    *v = r;
+    return true;
+}
+
+static bool fits_signed(int64_t v, int n) {
+    int64_t lim = (int64_t)1 << (n - 1);
+    return v >= -lim && v < lim;
+}
+
+static int64_t sign_extend(uint64_t v, int n) {
+    uint64_t m = (uint64_t)1 << (n - 1);
+    return (int64_t)((v ^ m) - m);
+}
+
+static uint32_t float_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static float bits_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/* ============================================================================
+ * Encoder
+ * ============================================================================ */
+
+void ts_encoder_init(ts_encoder_t *enc, uint8_t *buf, uint32_t cap) {
+    memset(enc, 0, sizeof(*enc));
+    memset(buf, 0, cap);
+    enc->buf = buf;
+    enc->cap = cap;
+    buf[0] = TS_BLOCK_VERSION;
+}
+
+static void encode_timestamp(ts_encoder_t *enc, uint8_t *out, int64_t ts) {
+    int64_t delta = ts - enc->last_ts;
+    int64_t dod = delta - enc->last_delta;
+
+    if (dod == 0) {
+        put_bits(out, &enc->bits, 0x0, 1);
+    } else if (fits_signed(dod, 7)) {
+        put_bits(out, &enc->bits, 0x2, 2);
+        put_bits(out, &enc->bits, (uint64_t)dod, 7);
+    } else if (fits_signed(dod, 12)) {
+        put_bits(out, &enc->bits, 0x6, 3);
+        put_bits(out, &enc->bits, (uint64_t)dod, 12);
+    } else if (fits_signed(dod, 20)) {
+        put_bits(out, &enc->bits, 0xE, 4);
+        put_bits(out, &enc->bits, (uint64_t)dod, 20);
+    } else {
+        put_bits(out, &enc->bits, 0xF, 4);
+        put_bits(out, &enc->bits, (uint64_t)ts, 64);
+    }
+    enc->last_delta = delta;
+}
+
+static void encode_value(ts_encoder_t *enc, uint8_t *out, uint32_t v) {
+    uint32_t x = v ^ enc->last_value;
+    if (x == 0) {
+        put_bits(out, &enc->bits, 0x0, 1);
+        return;
+    }
+
+    int lead = __builtin_clz(x);
+    int trail = __builtin_ctz(x);
+
+    if (enc->count > 1 && lead >= enc->lead && trail >= enc->trail) {
+        int len = 32 - enc->lead - enc->trail;
+        put_bits(out, &enc->bits, 0x2, 2);
+        put_bits(out, &enc->bits, x >> enc->trail, len);
+    } else {
+        int len = 32 - lead - trail;
+        put_bits(out, &enc->bits, 0x3, 2);
+        put_bits(out, &enc->bits, (uint64_t)lead, 5);
+        put_bits(out, &enc->bits, (uint64_t)(len - 1), 5);
+        put_bits(out, &enc->bits, x >> trail, len);
+        enc->lead = (uint8_t)lead;
+        enc->trail = (uint8_t)trail;
+    }
+}
+
+bool ts_encoder_append(ts_encoder_t *enc, int64_t ts_ms, float value, uint8_t quality) {
+    if (enc->count == TS_BLOCK_MAX_SAMPLES) return false;
+    if (TS_BLOCK_HEADER_BYTES + (enc->bits + MAX_SAMPLE_BITS + 7) / 8 > enc->cap) return false;
+
+    uint8_t *out = enc->buf + TS_BLOCK_HEADER_BYTES;
+    uint32_t v = float_bits(value);
+    uint8_t q = (uint8_t)(quality >> 6);
+
+    if (enc->count == 0) {
+        put_bits(out, &enc->bits, (uint64_t)ts_ms, 64);
+        put_bits(out, &enc->bits, v, 32);
+        put_bits(out, &enc->bits, q, 2);
+        enc->first_ts = ts_ms;
+        enc->last_delta = 0;
+    } else {
+        encode_timestamp(enc, out, ts_ms);
+        encode_value(enc, out, v);
+        if (q == enc->quality) {
+            put_bits(out, &enc->bits, 0x0, 1);
+        } else {
+            put_bits(out, &enc->bits, 0x1, 1);
+            put_bits(out, &enc->bits, q, 2);
+        }
+    }
+
+    enc->last_ts = ts_ms;
+    enc->last_value = v;
+    enc->quality = q;
+    enc->count++;
+    enc->buf[1] = (uint8_t)(enc->count & 0xFF);
+    enc->buf[2] = (uint8_t)(enc->count >> 8);
+    return true;
+}
+
+/* ============================================================================
+ * Decoder
+ * ============================================================================ */
+
+result_t ts_decoder_init(ts_decoder_t *dec, const uint8_t *data, uint32_t len) {
+    CHECK_NULL(dec); CHECK_NULL(data);
+    if (len < TS_BLOCK_HEADER_BYTES || data[0] != TS_BLOCK_VERSION) return RESULT_INVALID_PARAM;
+
+    memset(dec, 0, sizeof(*dec));
+    dec->data = data + TS_BLOCK_HEADER_BYTES;
+    dec->bits_total = (len - TS_BLOCK_HEADER_BYTES) * 8;
+    dec->count = (uint16_t)(data[1] | (data[2] << 8));
+    return RESULT_OK;
+}
+
+static bool decode_timestamp(ts_decoder_t *dec) {
+    uint64_t b, v;
+    int64_t dod;
+
+    if (!get_bits(dec, 1, &b)) return false;
+    if (b == 0) {
+        dod = 0;
+    } else {
+        if (!get_bits(dec, 1, &b)) return false;
+        if (b == 0) {
+            if (!get_bits(dec, 7, &v)) return false;
+            dod = sign_extend(v, 7);
+        } else {
+            if (!get_bits(dec, 1, &b)) return false;
+            if (b == 0) {
+                if (!get_bits(dec, 12, &v)) return false;
+                dod = sign_extend(v, 12);
+            } else {
+                if (!get_bits(dec, 1, &b)) return false;
+                if (b == 0) {
+                    if (!get_bits(dec, 20, &v)) return false;
+                    dod = sign_extend(v, 20);
+                } else {
+                    if (!get_bits(dec, 64, &v)) return false;
+                    dec->delta = (int64_t)v - dec->ts;
+                    dec->ts = (int64_t)v;
+                    return true;
+                }
+            }
+        }
+    }
+
+    dec->delta += dod;
+    dec->ts += dec->delta;
+    return true;
+}
+
+static bool decode_value(ts_decoder_t *dec) {
+    uint64_t b, v;
+
+    if (!get_bits(dec, 1, &b)) return false;
+    if (b == 0) return true;
+
+    if (!get_bits(dec, 1, &b)) return false;
+    if (b == 0) {
+        int len = 32 - dec->lead - dec->trail;
+        if (len <= 0 || !get_bits(dec, len, &v)) return false;
+        dec->value ^= (uint32_t)v << dec->trail;
+        return true;
+    }
+
+    uint64_t lead, len;
+    if (!get_bits(dec, 5, &lead) || !get_bits(dec, 5, &len)) return false;
+    len += 1;
+    if (lead + len > 32 || !get_bits(dec, (int)len, &v)) return false;
+
+    dec->lead = (uint8_t)lead;
+    dec->trail = (uint8_t)(32 - lead - len);
+    dec->value ^= (uint32_t)v << dec->trail;
+    return true;
+}
+
+bool ts_decoder_next(ts_decoder_t *dec, int64_t *ts_ms, float *value, uint8_t *quality) {
+    if (dec->index >= dec->count) return false;
+
+    uint64_t v;
+    if (dec->index == 0) {
+        if (!get_bits(dec, 64, &v)) return false;
+        dec->ts = (int64_t)v;
+        dec->delta = 0;
+        if (!get_bits(dec, 32, &v)) return false;
+        dec->value = (uint32_t)v;
+        if (!get_bits(dec, 2, &v)) return false;
+        dec->quality = (uint8_t)v;
+    } else {
+        if (!decode_timestamp(dec) || !decode_value(dec)) return false;
+        uint64_t changed;
+        if (!get_bits(dec, 1, &changed)) return false;
+        if (changed) {
+            if (!get_bits(dec, 2, &v)) return false;
+            dec->quality = (uint8_t)v;
+        }
+    }
+
+    dec->index++;
+    if (ts_ms) *ts_ms = dec->ts;
+    if (value) *value = bits_float(dec->value);
+    if (quality) *quality = (uint8_t)(dec->quality << 6);
+    return true;
+}
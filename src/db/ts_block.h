@@ -0,0 +1,89 @@
+/**
+ * @file ts_block.h
+ * @brief Compressed time-series block codec (one sensor, one block)
+ *
+ * A block is a 3-byte header (version, little-endian sample count)
+ * followed by a bitstream, one entry per sample:
+ *
+ *   timestamp  first: 64 raw bits (ms since epoch); then delta-of-delta,
+ *              '0' = same interval, '10'+7, '110'+12, '1110'+20 bits
+ *              signed, '1111'+64 raw bits
+ *   value      first: 32 raw bits (IEEE float); then XOR with the previous
+ *              value, '0' = unchanged, '10' + meaningful bits inside the
+ *              previous leading/trailing-zero window, '11' + 5 bits
+ *              leading zeros + 5 bits (length - 1) + meaningful bits
+ *   quality    first: 2 bits (quality >> 6); then '0' = unchanged,
+ *              '1' + 2 bits
+ *
+ * A steady sensor sampled at a fixed interval costs a few bits per sample
+ * instead of a SQLite row.
+ */
+
+#ifndef TS_BLOCK_H
+#define TS_BLOCK_H
+
+#include "common.h"
+
+#define TS_BLOCK_VERSION        1
+#define TS_BLOCK_HEADER_BYTES   3
+#define TS_BLOCK_MAX_SAMPLES    UINT16_MAX
+
+typedef struct {
+    uint8_t *buf;               /* Zeroed by ts_encoder_init() */
+    uint32_t cap;
+    uint32_t bits;              /* Bits written after the header */
+    uint16_t count;
+    int64_t first_ts;
+    int64_t last_ts;
+    int64_t last_delta;
+    uint32_t last_value;
+    uint8_t lead;               /* XOR window of the last explicit value */
+    uint8_t trail;
+    uint8_t quality;
+} ts_encoder_t;
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t bits_total;
+    uint32_t bits;
+    uint16_t count;
+    uint16_t index;
+    int64_t ts;
+    int64_t delta;
+    uint32_t value;
+    uint8_t lead;
+    uint8_t trail;
+    uint8_t quality;
+} ts_decoder_t;
+
+/**
+ * @brief Start an empty block in buf (cap bytes, header included)
+ */
+void ts_encoder_init(ts_encoder_t *enc, uint8_t *buf, uint32_t cap);
+
+/**
+ * @brief Append one sample
+ * @return false if the block is full (worst-case sample would not fit)
+ */
+bool ts_encoder_append(ts_encoder_t *enc, int64_t ts_ms, float value, uint8_t quality);
+
+/**
+ * @brief Encoded size in bytes, header included
+ */
+static inline uint32_t ts_encoder_size(const ts_encoder_t *enc) {
+    return TS_BLOCK_HEADER_BYTES + (enc->bits + 7) / 8;
+}
+
+/**
+ * @brief Open an encoded block for reading
+ * @return RESULT_OK, RESULT_INVALID_PARAM for an unknown version or short block
+ */
+result_t ts_decoder_init(ts_decoder_t *dec, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Decode the next sample
+ * @return false at the end of the block or on a truncated stream
+ */
+bool ts_decoder_next(ts_decoder_t *dec, int64_t *ts_ms, float *value, uint8_t *quality);
+
+#endif
@@ -4,14 +4,19 @@
  */
 
 #include "health_check.h"
+#include "history_api.h"
+#include "db/db_storage.h"
+#include "db/db_writer.h"
 #include "utils/logger.h"
 #include "sensors/sensor_manager.h"
 #include "sensors/sensor_instance.h"
+#include "sensors/sample_bus.h"
 #include "actuators/actuator_manager.h"
 #include "alarms/alarm_manager.h"
 #include "profinet/profinet_manager.h"
 #include "logging/data_logger.h"
 #include "config/config.h"
+#include "config_defaults.h"
 
 #ifdef LED_SUPPORT
 #include "hal/led_status.h"
@@ -27,6 +32,7 @@ static int config_to_json(char *buffer, size_t buffer_size);
 #include <arpa/inet.h>
 #include <sys/sysinfo.h>
 #include <fcntl.h>
+#include <stdarg.h>
 
 /* ============================================================================
  * Module State
@@ -285,6 +291,17 @@ int health_check_to_json(char *buffer, size_t buffer_size) {
         snap.active_actuators, snap.cpu_usage_percent, snap.memory_usage_percent);
 }
 
+/* Append to the metrics text; once the buffer is full, only the length grows */
+__attribute__((format(printf, 4, 5)))
+static void prom_append(char *buffer, size_t buffer_size, int *len, const char *fmt, ...) {
+    size_t used = MIN((size_t)*len, buffer_size - 1);
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buffer + used, buffer_size - used, fmt, ap);
+    va_end(ap);
+    if (n > 0) *len += n;
+}
+
 int health_check_to_prometheus(char *buffer, size_t buffer_size) {
     health_snapshot_t snap;
     pthread_mutex_lock(&g_health.snapshot_mutex);
@@ -342,7 +359,7 @@ int health_check_to_prometheus(char *buffer, size_t buffer_size) {
         snap.memory_usage_percent);
 
     /* Add data logger observability metrics (P2 operator request) */
-    len += snprintf(buffer + len, buffer_size - len,
+    prom_append(buffer, buffer_size, &len,
         "# HELP water_treat_logger_total_logged Total entries logged locally\n"
         "# TYPE water_treat_logger_total_logged counter\n"
         "water_treat_logger_total_logged %lu\n"
@@ -352,6 +369,30 @@ int health_check_to_prometheus(char *buffer, size_t buffer_size) {
         "# HELP water_treat_logger_remote_failed Total entries that failed to send to remote\n"
         "# TYPE water_treat_logger_remote_failed counter\n"
         "water_treat_logger_remote_failed %lu\n"
+        "# HELP water_treat_logger_remote_bytes Request bytes accepted by the remote end\n"
+        "# TYPE water_treat_logger_remote_bytes counter\n"
+        "water_treat_logger_remote_bytes %lu\n"
+        "# HELP water_treat_logger_dropped Entries rejected because the queue was full\n"
+        "# TYPE water_treat_logger_dropped counter\n"
+        "water_treat_logger_dropped %lu\n"
+        "# HELP water_treat_logger_dropped_age Entries expired before they were written\n"
+        "# TYPE water_treat_logger_dropped_age counter\n"
+        "water_treat_logger_dropped_age %lu\n"
+        "# HELP water_treat_logger_compression_in Points offered to historian compression\n"
+        "# TYPE water_treat_logger_compression_in counter\n"
+        "water_treat_logger_compression_in %lu\n"
+        "# HELP water_treat_logger_compression_out Points kept by historian compression\n"
+        "# TYPE water_treat_logger_compression_out counter\n"
+        "water_treat_logger_compression_out %lu\n"
+        "# HELP water_treat_logger_spool_backlog Records spooled on disk awaiting upload\n"
+        "# TYPE water_treat_logger_spool_backlog gauge\n"
+        "water_treat_logger_spool_backlog %lu\n"
+        "# HELP water_treat_logger_spool_bytes Disk space used by the upload spool\n"
+        "# TYPE water_treat_logger_spool_bytes gauge\n"
+        "water_treat_logger_spool_bytes %lu\n"
+        "# HELP water_treat_logger_spool_dropped Spooled records lost to size or age caps\n"
+        "# TYPE water_treat_logger_spool_dropped counter\n"
+        "water_treat_logger_spool_dropped %lu\n"
         "# HELP water_treat_logger_queue_depth Current entries queued for remote transmission\n"
         "# TYPE water_treat_logger_queue_depth gauge\n"
         "water_treat_logger_queue_depth %d\n"
@@ -367,6 +408,14 @@ int health_check_to_prometheus(char *buffer, size_t buffer_size) {
         (unsigned long)logger_stats.total_logged,
         (unsigned long)logger_stats.total_remote_sent,
         (unsigned long)logger_stats.total_remote_failed,
+        (unsigned long)logger_stats.total_remote_bytes,
+        (unsigned long)logger_stats.total_dropped,
+        (unsigned long)logger_stats.total_dropped_age,
+        (unsigned long)logger_stats.compression_in,
+        (unsigned long)logger_stats.compression_out,
+        (unsigned long)logger_stats.spool_backlog,
+        (unsigned long)logger_stats.spool_bytes,
+        (unsigned long)logger_stats.spool_dropped,
         logger_stats.queue_count,
         logger_stats.queue_capacity,
         logger_stats.remote_available ? 1 : 0,
@@ -375,7 +424,7 @@ int health_check_to_prometheus(char *buffer, size_t buffer_size) {
     /* Add alarm rule capacity metrics (P2 operator request for capacity planning) */
     alarm_manager_stats_t alarm_stats = {0};
     if (alarm_manager_get_stats(&alarm_stats) == RESULT_OK) {
-        len += snprintf(buffer + len, buffer_size - len,
+        prom_append(buffer, buffer_size, &len,
             "# HELP water_treat_alarm_rules_configured Number of configured alarm rules\n"
             "# TYPE water_treat_alarm_rules_configured gauge\n"
             "water_treat_alarm_rules_configured %d\n"
@@ -387,45 +436,244 @@ int health_check_to_prometheus(char *buffer, size_t buffer_size) {
             "water_treat_alarm_cache_hits %lu\n"
             "# HELP water_treat_alarm_total_checks Total alarm rule checks performed\n"
             "# TYPE water_treat_alarm_total_checks counter\n"
-            "water_treat_alarm_total_checks %lu\n",
+            "water_treat_alarm_total_checks %lu\n"
+            "# HELP water_treat_alarm_evaluations Sample-path alarm rule evaluations\n"
+            "# TYPE water_treat_alarm_evaluations counter\n"
+            "water_treat_alarm_evaluations %lu\n"
+            "# HELP water_treat_alarm_evaluations_per_sec Alarm rule evaluation rate\n"
+            "# TYPE water_treat_alarm_evaluations_per_sec gauge\n"
+            "water_treat_alarm_evaluations_per_sec %.1f\n"
+            "# HELP water_treat_alarm_index_rebuilds Alarm rule index rebuilds\n"
+            "# TYPE water_treat_alarm_index_rebuilds counter\n"
+            "water_treat_alarm_index_rebuilds %lu\n"
+            "# HELP water_treat_alarm_journal_pending Alarm/event rows awaiting commit\n"
+            "# TYPE water_treat_alarm_journal_pending gauge\n"
+            "water_treat_alarm_journal_pending %d\n"
+            "# HELP water_treat_alarm_journal_dropped Alarm/event rows dropped, journal full\n"
+            "# TYPE water_treat_alarm_journal_dropped counter\n"
+            "water_treat_alarm_journal_dropped %lu\n"
+            "# HELP water_treat_alarm_shelved_rules Alarm rules currently shelved\n"
+            "# TYPE water_treat_alarm_shelved_rules gauge\n"
+            "water_treat_alarm_shelved_rules %d\n"
+            "# HELP water_treat_alarm_chatter_latches Alarms latched for chattering\n"
+            "# TYPE water_treat_alarm_chatter_latches counter\n"
+            "water_treat_alarm_chatter_latches %lu\n",
             alarm_stats.cached_rule_count,
-            256,  /* MAX_ALARM_RULES from alarm_manager.c */
+            WT_ALARM_MAX_RULES,
             (unsigned long)alarm_stats.cache_hits,
-            (unsigned long)alarm_stats.total_checks);
+            (unsigned long)alarm_stats.total_checks,
+            (unsigned long)alarm_stats.evaluations,
+            alarm_stats.evaluations_per_sec,
+            (unsigned long)alarm_stats.cache_refreshes,
+            alarm_stats.journal_pending,
+            (unsigned long)alarm_stats.journal_dropped,
+            alarm_stats.shelved_rules,
+            (unsigned long)alarm_stats.chatter_latches);
+    }
+
+    /* Prepared-statement reuse on the main connection */
+    if (g_health.db && g_health.db->db) {
+        database_stats_t db_stats;
+        database_get_stats(g_health.db, &db_stats);
+        prom_append(buffer, buffer_size, &len,
+            "# HELP water_treat_db_stmt_cache_hits Statements reused from the cache\n"
+            "# TYPE water_treat_db_stmt_cache_hits counter\n"
+            "water_treat_db_stmt_cache_hits %lu\n"
+            "# HELP water_treat_db_stmt_cache_misses Statements prepared\n"
+            "# TYPE water_treat_db_stmt_cache_misses counter\n"
+            "water_treat_db_stmt_cache_misses %lu\n"
+            "# HELP water_treat_db_stmt_cache_evictions Cached statements finalized to make room\n"
+            "# TYPE water_treat_db_stmt_cache_evictions counter\n"
+            "water_treat_db_stmt_cache_evictions %lu\n"
+            "# HELP water_treat_db_stmt_cache_size Statements held in the cache\n"
+            "# TYPE water_treat_db_stmt_cache_size gauge\n"
+            "water_treat_db_stmt_cache_size %d\n",
+            (unsigned long)db_stats.stmt_hits,
+            (unsigned long)db_stats.stmt_misses,
+            (unsigned long)db_stats.stmt_evictions,
+            db_stats.stmt_cached);
+    }
+
+    /* Writer queue, read pool and lock waits per connection role */
+    db_writer_stats_t wr;
+    db_readers_stats_t rd;
+    db_writer_get_stats(&wr);
+    db_readers_get_stats(&rd);
+    database_stats_t main_stats = {0};
+    if (g_health.db && g_health.db->db) database_get_stats(g_health.db, &main_stats);
+    prom_append(buffer, buffer_size, &len,
+        "# HELP water_treat_db_writer_requests Write requests run by the writer thread\n"
+        "# TYPE water_treat_db_writer_requests counter\n"
+        "water_treat_db_writer_requests %lu\n"
+        "# HELP water_treat_db_writer_batches Group transactions committed\n"
+        "# TYPE water_treat_db_writer_batches counter\n"
+        "water_treat_db_writer_batches %lu\n"
+        "# HELP water_treat_db_writer_failures Group transactions that did not commit\n"
+        "# TYPE water_treat_db_writer_failures counter\n"
+        "water_treat_db_writer_failures %lu\n"
+        "# HELP water_treat_db_writer_queue_depth Write requests waiting for the writer\n"
+        "# TYPE water_treat_db_writer_queue_depth gauge\n"
+        "water_treat_db_writer_queue_depth %d\n"
+        "# HELP water_treat_db_writer_max_batch Most requests committed in one transaction\n"
+        "# TYPE water_treat_db_writer_max_batch gauge\n"
+        "water_treat_db_writer_max_batch %d\n"
+        "# HELP water_treat_db_writer_wait_seconds Time from submit to commit, all requests\n"
+        "# TYPE water_treat_db_writer_wait_seconds counter\n"
+        "water_treat_db_writer_wait_seconds %.6f\n"
+        "# HELP water_treat_db_writer_wait_max_seconds Longest submit-to-commit time\n"
+        "# TYPE water_treat_db_writer_wait_max_seconds gauge\n"
+        "water_treat_db_writer_wait_max_seconds %.6f\n"
+        "# HELP water_treat_db_writer_commit_seconds Time spent in group transactions\n"
+        "# TYPE water_treat_db_writer_commit_seconds counter\n"
+        "water_treat_db_writer_commit_seconds %.6f\n"
+        "# HELP water_treat_db_readers Pooled read-only connections\n"
+        "# TYPE water_treat_db_readers gauge\n"
+        "water_treat_db_readers %d\n"
+        "# HELP water_treat_db_readers_in_use Read connections lent out\n"
+        "# TYPE water_treat_db_readers_in_use gauge\n"
+        "water_treat_db_readers_in_use %d\n"
+        "# HELP water_treat_db_reader_acquires Read connections lent\n"
+        "# TYPE water_treat_db_reader_acquires counter\n"
+        "water_treat_db_reader_acquires %lu\n"
+        "# HELP water_treat_db_reader_waits Acquires that found every reader busy\n"
+        "# TYPE water_treat_db_reader_waits counter\n"
+        "water_treat_db_reader_waits %lu\n"
+        "# HELP water_treat_db_reader_wait_seconds Time spent waiting for a reader\n"
+        "# TYPE water_treat_db_reader_wait_seconds counter\n"
+        "water_treat_db_reader_wait_seconds %.6f\n",
+        (unsigned long)wr.requests, (unsigned long)wr.batches, (unsigned long)wr.failures,
+        wr.queue_depth, wr.max_batch,
+        (double)wr.wait_us_total / 1e6, (double)wr.wait_us_max / 1e6,
+        (double)wr.commit_us_total / 1e6,
+        rd.size, rd.in_use, (unsigned long)rd.acquires, (unsigned long)rd.waits,
+        (double)rd.wait_us_total / 1e6);
+
+    const struct { const char *role; const database_stats_t *s; } conns[] = {
+        { "main", &main_stats }, { "writer", &wr.conn }, { "readers", &rd.conn },
+    };
+    prom_append(buffer, buffer_size, &len,
+        "# HELP water_treat_db_busy_waits Statements that found the database locked\n"
+        "# TYPE water_treat_db_busy_waits counter\n");
+    for (int i = 0; i < 3; i++) {
+        prom_append(buffer, buffer_size, &len, "water_treat_db_busy_waits{connection=\"%s\"} %lu\n",
+                    conns[i].role, (unsigned long)conns[i].s->busy_waits);
+    }
+    prom_append(buffer, buffer_size, &len,
+        "# HELP water_treat_db_busy_wait_seconds Time spent waiting for database locks\n"
+        "# TYPE water_treat_db_busy_wait_seconds counter\n");
+    for (int i = 0; i < 3; i++) {
+        prom_append(buffer, buffer_size, &len, "water_treat_db_busy_wait_seconds{connection=\"%s\"} %.3f\n",
+                    conns[i].role, (double)conns[i].s->busy_wait_ms / 1000.0);
+    }
+    prom_append(buffer, buffer_size, &len,
+        "# HELP water_treat_db_busy_timeouts Lock waits that gave up with SQLITE_BUSY\n"
+        "# TYPE water_treat_db_busy_timeouts counter\n");
+    for (int i = 0; i < 3; i++) {
+        prom_append(buffer, buffer_size, &len, "water_treat_db_busy_timeouts{connection=\"%s\"} %lu\n",
+                    conns[i].role, (unsigned long)conns[i].s->busy_timeouts);
+    }
+
+    /* Storage profile: checkpoints, WAL size and write amplification */
+    db_storage_stats_t st;
+    db_storage_get_stats(&st);
+    prom_append(buffer, buffer_size, &len,
+        "# HELP water_treat_db_storage_profile Storage profile in use\n"
+        "# TYPE water_treat_db_storage_profile gauge\n"
+        "water_treat_db_storage_profile{profile=\"%s\"} 1\n"
+        "# HELP water_treat_db_checkpoints WAL checkpoints run\n"
+        "# TYPE water_treat_db_checkpoints counter\n"
+        "water_treat_db_checkpoints{mode=\"passive\"} %lu\n"
+        "water_treat_db_checkpoints{mode=\"restart\"} %lu\n"
+        "water_treat_db_checkpoints{mode=\"inline\"} %lu\n"
+        "# HELP water_treat_db_checkpoints_busy Checkpoints that left frames behind\n"
+        "# TYPE water_treat_db_checkpoints_busy counter\n"
+        "water_treat_db_checkpoints_busy %lu\n"
+        "# HELP water_treat_db_checkpoint_seconds Time spent in background checkpoints\n"
+        "# TYPE water_treat_db_checkpoint_seconds counter\n"
+        "water_treat_db_checkpoint_seconds %.6f\n"
+        "# HELP water_treat_db_checkpoint_max_seconds Longest background checkpoint\n"
+        "# TYPE water_treat_db_checkpoint_max_seconds gauge\n"
+        "water_treat_db_checkpoint_max_seconds %.6f\n"
+        "# HELP water_treat_db_wal_bytes_written Bytes committed to the WAL\n"
+        "# TYPE water_treat_db_wal_bytes_written counter\n"
+        "water_treat_db_wal_bytes_written %lu\n"
+        "# HELP water_treat_db_checkpoint_bytes_written Bytes checkpointed into the database file\n"
+        "# TYPE water_treat_db_checkpoint_bytes_written counter\n"
+        "water_treat_db_checkpoint_bytes_written %lu\n"
+        "# HELP water_treat_db_write_amplification Page writes per page committed\n"
+        "# TYPE water_treat_db_write_amplification gauge\n"
+        "water_treat_db_write_amplification %.3f\n"
+        "# HELP water_treat_db_wal_bytes Current WAL file size\n"
+        "# TYPE water_treat_db_wal_bytes gauge\n"
+        "water_treat_db_wal_bytes %lu\n"
+        "# HELP water_treat_db_vacuum_pages Pages freed by incremental vacuum\n"
+        "# TYPE water_treat_db_vacuum_pages counter\n"
+        "water_treat_db_vacuum_pages %lu\n",
+        db_storage_profile_name(st.profile),
+        (unsigned long)st.checkpoints_passive, (unsigned long)st.checkpoints_restart,
+        (unsigned long)st.checkpoints_inline, (unsigned long)st.checkpoints_busy,
+        (double)st.checkpoint_us_total / 1e6, (double)st.checkpoint_us_max / 1e6,
+        (unsigned long)(st.wal_frames * (uint64_t)MAX(st.page_size, 0)),
+        (unsigned long)(st.checkpoint_frames * (uint64_t)MAX(st.page_size, 0)),
+        st.write_amplification, (unsigned long)st.wal_bytes, (unsigned long)st.vacuum_pages);
+
+    /* Sample bus: per-consumer backlog and overflow losses */
+    sample_bus_stats_t bus_stats;
+    if (sample_bus_get_stats(&bus_stats) == RESULT_OK) {
+        prom_append(buffer, buffer_size, &len,
+            "# HELP water_treat_samples_published Sensor samples published on the sample bus\n"
+            "# TYPE water_treat_samples_published counter\n"
+            "water_treat_samples_published %lu\n"
+            "# HELP water_treat_sample_subscriber_depth Samples queued per subscriber\n"
+            "# TYPE water_treat_sample_subscriber_depth gauge\n",
+            (unsigned long)bus_stats.published);
+        for (int i = 0; i < bus_stats.subscriber_count && (size_t)len < buffer_size - 256; i++) {
+            prom_append(buffer, buffer_size, &len,
+                "water_treat_sample_subscriber_depth{subscriber=\"%s\"} %u\n",
+                bus_stats.subscribers[i].name, bus_stats.subscribers[i].depth);
+        }
+        prom_append(buffer, buffer_size, &len,
+            "# HELP water_treat_sample_subscriber_dropped Samples lost to subscriber overflow\n"
+            "# TYPE water_treat_sample_subscriber_dropped counter\n");
+        for (int i = 0; i < bus_stats.subscriber_count && (size_t)len < buffer_size - 256; i++) {
+            prom_append(buffer, buffer_size, &len,
+                "water_treat_sample_subscriber_dropped{subscriber=\"%s\"} %lu\n",
+                bus_stats.subscribers[i].name, (unsigned long)bus_stats.subscribers[i].dropped);
+        }
     }
 
     /* Add per-sensor health metrics (P2 operator request for predictive maintenance) */
     extern sensor_manager_t g_sensor_mgr;
     if (g_sensor_mgr.running && g_sensor_mgr.instance_count > 0) {
-        len += snprintf(buffer + len, buffer_size - len,
+        prom_append(buffer, buffer_size, &len,
             "# HELP water_treat_sensor_total_reads Total read attempts per sensor\n"
             "# TYPE water_treat_sensor_total_reads counter\n");
         for (int i = 0; i < g_sensor_mgr.instance_count && (size_t)len < buffer_size - 256; i++) {
             sensor_instance_t *s = g_sensor_mgr.instances[i];
             if (!s) continue;
-            len += snprintf(buffer + len, buffer_size - len,
+            prom_append(buffer, buffer_size, &len,
                 "water_treat_sensor_total_reads{sensor=\"%s\",slot=\"%d\"} %lu\n",
                 s->name, s->slot, (unsigned long)s->total_reads);
         }
 
-        len += snprintf(buffer + len, buffer_size - len,
+        prom_append(buffer, buffer_size, &len,
             "# HELP water_treat_sensor_total_failures Total failed reads per sensor\n"
             "# TYPE water_treat_sensor_total_failures counter\n");
         for (int i = 0; i < g_sensor_mgr.instance_count && (size_t)len < buffer_size - 256; i++) {
             sensor_instance_t *s = g_sensor_mgr.instances[i];
             if (!s) continue;
-            len += snprintf(buffer + len, buffer_size - len,
+            prom_append(buffer, buffer_size, &len,
                 "water_treat_sensor_total_failures{sensor=\"%s\",slot=\"%d\"} %lu\n",
                 s->name, s->slot, (unsigned long)s->total_failures);
         }
 
-        len += snprintf(buffer + len, buffer_size - len,
+        prom_append(buffer, buffer_size, &len,
             "# HELP water_treat_sensor_consecutive_failures Current consecutive failures per sensor\n"
             "# TYPE water_treat_sensor_consecutive_failures gauge\n");
         for (int i = 0; i < g_sensor_mgr.instance_count && (size_t)len < buffer_size - 256; i++) {
             sensor_instance_t *s = g_sensor_mgr.instances[i];
             if (!s) continue;
-            len += snprintf(buffer + len, buffer_size - len,
+            prom_append(buffer, buffer_size, &len,
                 "water_treat_sensor_consecutive_failures{sensor=\"%s\",slot=\"%d\"} %d\n",
                 s->name, s->slot, s->consecutive_failures);
         }
@@ -449,7 +697,7 @@ result_t health_check_write_file(const char *path) {
         return RESULT_IO_ERROR;
     }
 
-    char buffer[4096];
+    char buffer[32768];
     int len = health_check_to_prometheus(buffer, sizeof(buffer));
     if (len < 0 || (size_t)len >= sizeof(buffer)) {
         fclose(fp);
@@ -576,8 +824,14 @@ static void handle_http_request(int client_fd) {
         return;
     }
 
-    char response_body[8192];
-    char response[16384];
+    /* History is streamed in chunks from a worker, not built in the buffers below */
+    if (strncmp(path, "/api/history", 12) == 0 && (path[12] == '\0' || path[12] == '?')) {
+        history_api_serve(client_fd, path[12] ? path + 13 : "", g_health.db);
+        return;
+    }
+
+    char response_body[32768];
+    char response[32768 + 512];
     const char *content_type;
     int status_code = 200;
 
@@ -656,7 +910,7 @@ static void handle_http_request(int client_fd) {
     } else {
         /* 404 Not Found */
         snprintf(response_body, sizeof(response_body),
-                "{\"error\": \"Not Found\", \"endpoints\": [\"/health\", \"/metrics\", \"/ready\", \"/live\", \"/config\""
+                "{\"error\": \"Not Found\", \"endpoints\": [\"/health\", \"/metrics\", \"/ready\", \"/live\", \"/config\", \"/api/history\""
 #ifdef LED_SUPPORT
                 ", \"/led/test\", \"/led/status\""
 #endif
@@ -737,6 +991,7 @@ static void* http_thread_func(void *arg) {
 
     close(g_health.http_socket);
     g_health.http_socket = -1;
+    history_api_stop();
 
     return NULL;
 }
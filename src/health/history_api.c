@@ -0,0 +1,519 @@
+/**
+ * @file history_api.c
+ * @brief Sensor history over HTTP (/api/history on the health server)
+ */
+
+#include "history_api.h"
+#include "db/db_rollup.h"
+#include "db/db_writer.h"
+#include "utils/logger.h"
+#include "config_defaults.h"
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+typedef enum {
+    AGG_AVG = 0,
+    AGG_MIN,
+    AGG_MAX,
+    AGG_FIRST,
+    AGG_LAST,
+    AGG_COUNT,
+    AGG_ALL,
+    AGG_KINDS
+} history_agg_t;
+
+static const char *AGG_NAMES[AGG_KINDS] = { "avg", "min", "max", "first", "last", "count", "all" };
+
+typedef struct {
+    int module_id;
+    int64_t from_ms;
+    int64_t to_ms;
+    int64_t step_ms;                    /* 0 = raw samples */
+    history_agg_t agg;
+    bool csv;
+} history_request_t;
+
+/* One detached thread per request; the HTTP thread only hands over */
+typedef struct {
+    int fd;
+    database_t *db;
+    char query[256];
+} history_job_t;
+
+static pthread_mutex_t g_workers_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_workers_done = PTHREAD_COND_INITIALIZER;
+static int g_workers;
+static atomic_bool g_stopping;
+
+/* Steps picked when the request leaves it open, finest first */
+static const int64_t AUTO_STEPS_MS[] = {
+    60LL * 1000, 300LL * 1000, 900LL * 1000, 3600LL * 1000,
+    6 * 3600LL * 1000, 86400LL * 1000, 7 * 86400LL * 1000,
+};
+
+/* ============================================================================
+ * Request Parsing
+ * ========================================================================== */
+
+static bool parse_duration_ms(const char *s, int64_t *out) {
+    char *end;
+    errno = 0;
+    long long v = strtoll(s, &end, 10);
+    if (end == s || errno != 0 || v < 0) return false;
+
+    int64_t unit;
+    switch (*end) {
+        case '\0':
+        case 's': unit = 1000; break;
+        case 'm': unit = 60LL * 1000; break;
+        case 'h': unit = 3600LL * 1000; break;
+        case 'd': unit = 86400LL * 1000; break;
+        case 'w': unit = 7 * 86400LL * 1000; break;
+        default:  return false;
+    }
+    if (*end && end[1]) return false;
+    if (v > INT64_MAX / unit) return false;
+
+    *out = (int64_t)v * unit;
+    return true;
+}
+
+static bool parse_time_ms(const char *s, int64_t now_ms, int64_t *out) {
+    if (strcmp(s, "now") == 0) {
+        *out = now_ms;
+        return true;
+    }
+    if (s[0] == '-') {
+        int64_t ago;
+        if (!parse_duration_ms(s + 1, &ago)) return false;
+        *out = now_ms - ago;
+        return true;
+    }
+
+    char *end;
+    errno = 0;
+    long long v = strtoll(s, &end, 10);
+    if (end == s || *end || errno != 0 || v < 0 || v > INT64_MAX / 1000) return false;
+    *out = (int64_t)v * 1000;
+    return true;
+}
+
+static bool parse_request(const char *query, int64_t now_ms, history_request_t *req,
+                          char *err, size_t err_len) {
+    memset(req, 0, sizeof(*req));
+    req->to_ms = now_ms;
+    bool has_from = false, has_step = false;
+
+    char buf[256];
+    SAFE_STRNCPY(buf, query, sizeof(buf));
+
+    char *save = NULL;
+    for (char *tok = strtok_r(buf, "&", &save); tok; tok = strtok_r(NULL, "&", &save)) {
+        char *value = strchr(tok, '=');
+        if (!value) continue;
+        *value++ = '\0';
+
+        bool ok = true;
+        if (strcmp(tok, "module") == 0) {
+            char *end;
+            long id = strtol(value, &end, 10);
+            ok = end != value && *end == '\0' && id > 0 && id <= INT32_MAX;
+            req->module_id = (int)id;
+        } else if (strcmp(tok, "from") == 0) {
+            ok = parse_time_ms(value, now_ms, &req->from_ms);
+            has_from = true;
+        } else if (strcmp(tok, "to") == 0) {
+            ok = parse_time_ms(value, now_ms, &req->to_ms);
+        } else if (strcmp(tok, "step") == 0) {
+            if (strcmp(value, "raw") == 0) req->step_ms = 0;
+            else ok = parse_duration_ms(value, &req->step_ms);
+            has_step = true;
+        } else if (strcmp(tok, "agg") == 0) {
+            int a = 0;
+            while (a < AGG_KINDS && strcmp(value, AGG_NAMES[a]) != 0) a++;
+            ok = a < AGG_KINDS;
+            req->agg = (history_agg_t)a;
+        } else if (strcmp(tok, "format") == 0) {
+            ok = strcmp(value, "json") == 0 || strcmp(value, "csv") == 0;
+            req->csv = strcmp(value, "csv") == 0;
+        }
+
+        if (!ok) {
+            snprintf(err, err_len, "Invalid value for '%s'", tok);
+            return false;
+        }
+    }
+
+    if (req->module_id == 0) {
+        snprintf(err, err_len, "Missing 'module'");
+        return false;
+    }
+    if (!has_from) req->from_ms = req->to_ms - (int64_t)WT_HISTORY_API_RANGE_S * 1000;
+    if (req->to_ms < req->from_ms) {
+        snprintf(err, err_len, "'to' is before 'from'");
+        return false;
+    }
+
+    if (!has_step) {
+        int64_t want = (req->to_ms - req->from_ms) / WT_HISTORY_API_POINTS;
+        int n = (int)(sizeof(AUTO_STEPS_MS) / sizeof(AUTO_STEPS_MS[0]));
+        int i = 0;
+        while (i < n - 1 && AUTO_STEPS_MS[i] < want) i++;
+        req->step_ms = want < AUTO_STEPS_MS[0] ? 0 : AUTO_STEPS_MS[i];
+    }
+    return true;
+}
+
+/* Coarsest tier no wider than the step that still holds the start of the range */
+static int plan_tier(history_request_t *req, int64_t now_ms) {
+    int tier = db_rollup_tier_for(req->step_ms);
+    while (tier >= 0 && tier < DB_ROLLUP_DAY &&
+           req->from_ms < now_ms - (int64_t)db_rollup_tier_retention_days(tier) * 86400 * 1000) {
+        tier++;
+    }
+    if (tier >= 0) req->step_ms = MAX(req->step_ms, db_rollup_tier_width_ms(tier));
+    return tier;
+}
+
+/* ============================================================================
+ * Chunked Output
+ * ========================================================================== */
+
+typedef struct {
+    int fd;
+    bool failed;                        /* Client gone or stalled; stop reading */
+    size_t len;
+    char buf[WT_HISTORY_API_CHUNK_BYTES];
+} http_stream_t;
+
+static bool send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static void stream_flush(http_stream_t *s) {
+    if (s->failed || s->len == 0) return;
+
+    char head[24];
+    int n = snprintf(head, sizeof(head), "%zx\r\n", s->len);
+    s->failed = !send_all(s->fd, head, (size_t)n) ||
+                !send_all(s->fd, s->buf, s->len) ||
+                !send_all(s->fd, "\r\n", 2);
+    s->len = 0;
+}
+
+__attribute__((format(printf, 2, 3)))
+static void stream_printf(http_stream_t *s, const char *fmt, ...) {
+    /* A line that does not fit goes out first thing in the next chunk */
+    for (int attempt = 0; attempt < 2 && !s->failed; attempt++) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(s->buf + s->len, sizeof(s->buf) - s->len, fmt, ap);
+        va_end(ap);
+        if (n < 0) return;
+        if ((size_t)n < sizeof(s->buf) - s->len) {
+            s->len += (size_t)n;
+            return;
+        }
+        stream_flush(s);
+    }
+}
+
+static void stream_end(http_stream_t *s) {
+    stream_flush(s);
+    if (!s->failed) s->failed = !send_all(s->fd, "0\r\n\r\n", 5);
+}
+
+static void send_error(int fd, int code, const char *text, const char *message) {
+    char body[256];
+    int body_len = snprintf(body, sizeof(body), "{\"error\": \"%s\"}", message);
+
+    char response[512];
+    int len = snprintf(response, sizeof(response),
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: close\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n%s",
+        code, text, body_len, body);
+    send_all(fd, response, (size_t)len);
+}
+
+/* ============================================================================
+ * Rows
+ * ========================================================================== */
+
+typedef struct {
+    http_stream_t out;
+    const history_request_t *req;
+    uint64_t rows;
+    bool open;                          /* cur holds a bucket not yet written */
+    db_rollup_point_t cur;
+    double sum;
+} history_ctx_t;
+
+/* Seconds, with milliseconds only when there are some */
+static const char* format_time(int64_t ms, char *buf, size_t len) {
+    int64_t rem = ms % 1000;
+    if (rem == 0) snprintf(buf, len, "%lld", (long long)(ms / 1000));
+    else snprintf(buf, len, "%lld.%03d", (long long)((ms - rem) / 1000), (int)rem);
+    return buf;
+}
+
+static const char* format_value(double v, bool csv, char *buf, size_t len) {
+    if (!isfinite(v)) snprintf(buf, len, "%s", csv ? "" : "null");
+    else snprintf(buf, len, "%.7g", v);
+    return buf;
+}
+
+static void write_head(history_ctx_t *ctx, int tier) {
+    const history_request_t *req = ctx->req;
+    const char *columns = req->agg == AGG_ALL ? "min,max,avg,count" : AGG_NAMES[req->agg];
+
+    if (req->csv) {
+        stream_printf(&ctx->out, "t,%s\n", columns);
+        return;
+    }
+
+    static const char *TIER_NAMES[DB_ROLLUP_TIERS] = { "1m", "1h", "1d" };
+    char from[32], to[32], step[32];
+    stream_printf(&ctx->out,
+        "{\"module\": %d, \"from\": %s, \"to\": %s, \"step\": %s, \"tier\": \"%s\", "
+        "\"agg\": \"%s\", \"columns\": [\"t\"",
+        req->module_id, format_time(req->from_ms, from, sizeof(from)),
+        format_time(req->to_ms, to, sizeof(to)), format_time(req->step_ms, step, sizeof(step)),
+        tier < 0 ? "raw" : TIER_NAMES[tier], AGG_NAMES[req->agg]);
+    if (req->agg == AGG_ALL) {
+        stream_printf(&ctx->out, ", \"min\", \"max\", \"avg\", \"count\"");
+    } else {
+        stream_printf(&ctx->out, ", \"%s\"", AGG_NAMES[req->agg]);
+    }
+    stream_printf(&ctx->out, "], \"points\": [");
+}
+
+static void write_row(history_ctx_t *ctx) {
+    const history_request_t *req = ctx->req;
+    const db_rollup_point_t *p = &ctx->cur;
+    double avg = p->count > 0 ? ctx->sum / p->count : NAN;
+    char t[32], a[32], b[32], c[32];
+    const char *sep = req->csv ? "," : ", ";
+
+    format_time(p->bucket_ms, t, sizeof(t));
+    if (req->agg == AGG_ALL) {
+        format_value(p->min, req->csv, a, sizeof(a));
+        format_value(p->max, req->csv, b, sizeof(b));
+        format_value(avg, req->csv, c, sizeof(c));
+        if (req->csv) {
+            stream_printf(&ctx->out, "%s,%s,%s,%s,%u\n", t, a, b, c, p->count);
+        } else {
+            stream_printf(&ctx->out, "%s\n[%s, %s, %s, %s, %u]",
+                          ctx->rows ? "," : "", t, a, b, c, p->count);
+        }
+    } else {
+        double v;
+        switch (req->agg) {
+            case AGG_MIN:   v = p->min; break;
+            case AGG_MAX:   v = p->max; break;
+            case AGG_FIRST: v = p->first; break;
+            case AGG_LAST:  v = p->last; break;
+            case AGG_COUNT: v = p->count; break;
+            default:        v = avg; break;
+        }
+        format_value(v, req->csv, a, sizeof(a));
+        if (req->csv) stream_printf(&ctx->out, "%s%s%s\n", t, sep, a);
+        else stream_printf(&ctx->out, "%s\n[%s%s%s]", ctx->rows ? "," : "", t, sep, a);
+    }
+    ctx->rows++;
+}
+
+static void write_tail(history_ctx_t *ctx, bool failed) {
+    if (ctx->req->csv) {
+        if (failed) stream_printf(&ctx->out, "# error: query failed\n");
+        return;
+    }
+    stream_printf(&ctx->out, "\n], \"count\": %llu%s}\n", (unsigned long long)ctx->rows,
+                  failed ? ", \"error\": \"query failed\"" : "");
+}
+
+static int64_t step_floor(int64_t ts_ms, int64_t step_ms) {
+    int64_t rem = ts_ms % step_ms;
+    return ts_ms - (rem < 0 ? rem + step_ms : rem);
+}
+
+/* Merge tier points (or raw samples) into step buckets, writing each as it closes */
+static bool on_point(void *arg, const db_rollup_point_t *p) {
+    history_ctx_t *ctx = arg;
+    if (atomic_load(&g_stopping)) {
+        ctx->out.failed = true;
+        return false;
+    }
+    int64_t step = ctx->req->step_ms;
+    int64_t key = step > p->width_ms ? step_floor(p->bucket_ms, step) : p->bucket_ms;
+
+    if (ctx->open && ctx->cur.bucket_ms != key) {
+        write_row(ctx);
+        ctx->open = false;
+    }
+
+    if (!ctx->open) {
+        ctx->cur = *p;
+        ctx->cur.bucket_ms = key;
+        ctx->sum = (double)p->avg * p->count;
+        ctx->open = true;
+    } else {
+        ctx->cur.count += p->count;
+        ctx->cur.min = MIN(ctx->cur.min, p->min);
+        ctx->cur.max = MAX(ctx->cur.max, p->max);
+        ctx->cur.last = p->last;
+        ctx->sum += (double)p->avg * p->count;
+    }
+    return !ctx->out.failed;
+}
+
+/* ============================================================================
+ * Request Handling
+ * ========================================================================== */
+
+static void handle_request(int client_fd, const char *query, database_t *db) {
+    int64_t now_ms = (int64_t)time(NULL) * 1000;
+
+    history_request_t req;
+    char err[128];
+    if (!parse_request(query, now_ms, &req, err, sizeof(err))) {
+        send_error(client_fd, 400, "Bad Request", err);
+        return;
+    }
+
+    if (!db || !db->db_path[0]) {
+        send_error(client_fd, 503, "Service Unavailable", "No database");
+        return;
+    }
+    /* A client that stops reading must not hold the health server */
+    struct timeval tv = { .tv_sec = WT_HISTORY_API_SEND_TIMEOUT_S, .tv_usec = 0 };
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    int tier = plan_tier(&req, now_ms);
+
+    char head[256];
+    int head_len = snprintf(head, sizeof(head),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %s\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Cache-Control: no-store\r\n"
+        "Connection: close\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n",
+        req.csv ? "text/csv; charset=utf-8" : "application/json");
+    if (!send_all(client_fd, head, (size_t)head_len)) return;
+
+    history_ctx_t ctx = { .out = { .fd = client_fd }, .req = &req };
+    uint64_t start_ms = get_time_ms();
+    write_head(&ctx, tier);
+
+    /* Pooled connection, held only while rows are streamed */
+    result_t r = RESULT_NOT_INITIALIZED;
+    database_t *reader = db_reader_acquire(db);
+    if (!database_is_connected(reader)) goto done;
+
+    int64_t resolution = tier >= 0 ? db_rollup_tier_width_ms((db_rollup_tier_t)tier) : req.step_ms;
+    r = db_rollup_query(reader, req.module_id, req.from_ms, req.to_ms, resolution, on_point, &ctx);
+    if (ctx.open && !ctx.out.failed) write_row(&ctx);
+
+done:
+    write_tail(&ctx, r != RESULT_OK);
+    stream_end(&ctx.out);
+    db_reader_release(reader);
+
+    if (r != RESULT_OK) {
+        LOG_WARNING("History API: query for module %d failed (%d)", req.module_id, r);
+    }
+    LOG_DEBUG("History API: module %d, %llu rows in %llu ms%s", req.module_id,
+              (unsigned long long)ctx.rows, (unsigned long long)(get_time_ms() - start_ms),
+              ctx.out.failed ? " (client gone)" : "");
+}
+
+static void* history_worker(void *arg) {
+    history_job_t *job = arg;
+    handle_request(job->fd, job->query, job->db);
+    close(job->fd);
+    free(job);
+
+    pthread_mutex_lock(&g_workers_lock);
+    g_workers--;
+    pthread_cond_broadcast(&g_workers_done);
+    pthread_mutex_unlock(&g_workers_lock);
+    return NULL;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+void history_api_serve(int client_fd, const char *query, database_t *db) {
+    history_job_t *job = calloc(1, sizeof(*job));
+    if (!job) {
+        send_error(client_fd, 503, "Service Unavailable", "Out of memory");
+        close(client_fd);
+        return;
+    }
+    job->fd = client_fd;
+    job->db = db;
+    SAFE_STRNCPY(job->query, query ? query : "", sizeof(job->query));
+
+    pthread_mutex_lock(&g_workers_lock);
+    bool full = g_workers >= WT_HISTORY_API_WORKERS || atomic_load(&g_stopping);
+    if (!full) g_workers++;
+    pthread_mutex_unlock(&g_workers_lock);
+    if (full) {
+        free(job);
+        send_error(client_fd, 503, "Service Unavailable", "History requests busy, retry later");
+        close(client_fd);
+        return;
+    }
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int rc = pthread_create(&thread, &attr, history_worker, job);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        pthread_mutex_lock(&g_workers_lock);
+        g_workers--;
+        pthread_mutex_unlock(&g_workers_lock);
+        free(job);
+        send_error(client_fd, 503, "Service Unavailable", "No worker available");
+        close(client_fd);
+    }
+}
+
+void history_api_stop(void) {
+    atomic_store(&g_stopping, true);
+
+    /* Workers stop at the next row; a stalled send gives up after the timeout */
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += WT_HISTORY_API_SEND_TIMEOUT_S + 1;
+
+    pthread_mutex_lock(&g_workers_lock);
+    while (g_workers > 0) {
+        if (pthread_cond_timedwait(&g_workers_done, &g_workers_lock, &deadline) != 0) {
+            LOG_WARNING("History API: %d requests still running at shutdown", g_workers);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_workers_lock);
+}
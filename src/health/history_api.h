@@ -0,0 +1,50 @@
+/**
+ * @file history_api.h
+ * @brief Sensor history over HTTP (/api/history on the health server)
+ *
+ * GET /api/history?module=ID[&from=T][&to=T][&step=D][&agg=A][&format=F]
+ *
+ *  - from, to: unix seconds, "now", or "-D" for D before now
+ *    (default: the last WT_HISTORY_API_RANGE_S up to now)
+ *  - step: bucket width D, "raw" (or 0) for the stored samples
+ *    (default: about WT_HISTORY_API_POINTS buckets over the range)
+ *  - agg: avg, min, max, first, last, count or all (default avg)
+ *  - format: json or csv (default json)
+ *
+ * Durations D are a number with an optional s, m, h, d or w suffix.
+ *
+ * Buckets are served from the coarsest rollup tier no wider than the step
+ * and merged up to the step, so a month at 1 h reads ~720 rows. A tier
+ * that has already expired at the start of the range is replaced by the
+ * next coarser one; the step actually used is reported. Bad-quality
+ * samples are left out, as in the rollups. Raw samples are those the
+ * historian kept (see compressor.h).
+ *
+ * Rows are written as they are read, in HTTP chunks of at most
+ * WT_HISTORY_API_CHUNK_BYTES, over a pooled read-only connection
+ * (db_reader_acquire()).
+ *
+ * Each request runs on a thread of its own, at most WT_HISTORY_API_WORKERS
+ * at a time, so a long export never holds /live, /ready or /metrics on
+ * the health HTTP thread. Requests beyond that get 503.
+ */
+
+#ifndef HISTORY_API_H
+#define HISTORY_API_H
+
+#include "common.h"
+#include "db/database.h"
+
+/**
+ * @brief Answer one request on a worker thread, which closes client_fd
+ * @param query Text after '?' in the request path, or ""
+ * @param db Daemon database, NULL if there is none
+ */
+void history_api_serve(int client_fd, const char *query, database_t *db);
+
+/**
+ * @brief Stop new requests and wait for running ones (HTTP thread exit)
+ */
+void history_api_stop(void);
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ * @file compressor.c
+ * @brief Per-sensor lossy compression of logged values (historian style)
+ */
+
+#include "compressor.h"
+#include "utils/logger.h"
+#include <math.h>
+#include <string.h>
+#include <strings.h>
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+result_t compress_mode_parse(const char *name, compress_mode_t *mode) {
+    CHECK_NULL(name); CHECK_NULL(mode);
+    if (strcasecmp(name, "off") == 0 || strcasecmp(name, "none") == 0) {
+        *mode = COMPRESS_OFF;
+    } else if (strcasecmp(name, "deadband") == 0) {
+        *mode = COMPRESS_DEADBAND;
+    } else if (strcasecmp(name, "swinging_door") == 0 || strcasecmp(name, "sdt") == 0) {
+        *mode = COMPRESS_SWINGING_DOOR;
+    } else {
+        return RESULT_INVALID_PARAM;
+    }
+    return RESULT_OK;
+}
+
+const char* compress_mode_name(compress_mode_t mode) {
+    switch (mode) {
+        case COMPRESS_DEADBAND:         return "deadband";
+        case COMPRESS_SWINGING_DOOR:    return "swinging_door";
+        default:                        return "off";
+    }
+}
+
+void compressor_init(compressor_t *c, const compress_config_t *config) {
+    memset(c, 0, sizeof(*c));
+    c->config = *config;
+    if (c->config.dev < 0) c->config.dev = 0;
+}
+
+static compress_track_t* find_track(compressor_t *c, int module_id) {
+    for (int i = 0; i < c->track_count; i++) {
+        if (c->tracks[i].module_id == module_id) return &c->tracks[i];
+    }
+    if (c->track_count == MAX_SENSOR_INSTANCES) return NULL;
+
+    compress_track_t *t = &c->tracks[c->track_count++];
+    memset(t, 0, sizeof(*t));
+    t->module_id = module_id;
+    t->dev = -1.0f;
+    return t;
+}
+
+result_t compressor_set_dev(compressor_t *c, int module_id, float dev) {
+    CHECK_NULL(c);
+    compress_track_t *t = find_track(c, module_id);
+    if (!t) return RESULT_NO_MEMORY;
+    t->dev = dev;
+    return RESULT_OK;
+}
+
+result_t compressor_set_devs(compressor_t *c, const char *list) {
+    CHECK_NULL(c);
+    const char *p = list ? list : "";
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+
+        char *end;
+        long module_id = strtol(p, &end, 10);
+        if (end == p || *end != ':') return RESULT_PARSE_ERROR;
+        p = end + 1;
+        float dev = strtof(p, &end);
+        if (end == p || !isfinite(dev)) return RESULT_PARSE_ERROR;
+        p = end;
+
+        result_t r = compressor_set_dev(c, (int)module_id, dev);
+        if (r != RESULT_OK) return r;
+    }
+    return RESULT_OK;
+}
+
+/* ============================================================================
+ * Compression
+ * ============================================================================ */
+
+/* Archive a point and open the doors from it */
+static int archive(compressor_t *c, compress_track_t *t, const uplink_entry_t *point,
+                   uplink_entry_t *out) {
+    t->archived = *point;
+    t->active = true;
+    t->has_held = false;
+    t->slope_min = -INFINITY;
+    t->slope_max = INFINITY;
+    *out = *point;
+    c->stats.points_out++;
+    return 1;
+}
+
+/* The line from the archived point to this one passes within dev of every
+ * point since (so this one may end the segment); if so, narrow the doors */
+static bool door_admits(compress_track_t *t, const uplink_entry_t *point, double dev) {
+    double dt = (double)(point->timestamp - t->archived.timestamp);
+    double dv = (double)point->value - (double)t->archived.value;
+    double slope = dv / dt;
+    if (!(slope >= t->slope_min && slope <= t->slope_max)) return false;   /* Also catches NaN */
+    t->slope_min = MAX(t->slope_min, (dv - dev) / dt);
+    t->slope_max = MIN(t->slope_max, (dv + dev) / dt);
+    return true;
+}
+
+int compressor_push(compressor_t *c, const uplink_entry_t *point, uplink_entry_t *out) {
+    if (!c || !point || !out) return 0;
+    c->stats.points_in++;
+
+    compress_track_t *t = c->config.mode == COMPRESS_OFF ? NULL : find_track(c, point->module_id);
+    if (!t) {
+        *out = *point;
+        c->stats.points_out++;
+        return 1;
+    }
+    if (!t->active) return archive(c, t, point, out);
+
+    double dev = t->dev >= 0 ? t->dev : c->config.dev;
+    time_t since = point->timestamp - t->archived.timestamp;
+    bool beat = c->config.heartbeat_s > 0 && since >= c->config.heartbeat_s;
+    int n = 0;
+
+    /* A new status, a clock step back or a value that cannot be compared
+     * starts over: keep both sides of the discontinuity */
+    if (strcmp(point->status, t->archived.status) != 0 || since < 0 ||
+        !isfinite(point->value) || !isfinite(t->archived.value)) {
+        if (t->has_held) n += archive(c, t, &t->held, out + n);
+        return n + archive(c, t, point, out + n);
+    }
+
+    /* Same second as the last archived point: nothing to add unless it moved */
+    if (since == 0) {
+        if (fabs((double)point->value - (double)t->archived.value) <= dev) {
+            return 0;
+        }
+        if (t->has_held) n += archive(c, t, &t->held, out + n);
+        return n + archive(c, t, point, out + n);
+    }
+
+    if (c->config.mode == COMPRESS_DEADBAND) {
+        if (beat || fabs((double)point->value - (double)t->archived.value) > dev) {
+            return archive(c, t, point, out);
+        }
+        t->held = *point;
+        t->has_held = true;
+        return 0;
+    }
+
+    if (door_admits(t, point, dev)) {
+        /* The line to this point still covers everything since the last one */
+        if (beat) return archive(c, t, point, out);
+        t->held = *point;
+        t->has_held = true;
+        return 0;
+    }
+
+    /* The doors closed: the previous point ends the segment, this one opens the next */
+    if (!t->has_held) return archive(c, t, point, out);
+    uplink_entry_t held = t->held;
+    n += archive(c, t, &held, out);
+    if (point->timestamp <= held.timestamp || !door_admits(t, point, dev)) {
+        return n + archive(c, t, point, out + n);
+    }
+    t->held = *point;
+    t->has_held = true;
+    return n;
+}
+
+int compressor_sweep(compressor_t *c, time_t now, uplink_entry_t *out, int max) {
+    if (!c || !out || c->config.heartbeat_s <= 0) return 0;
+    int n = 0;
+    for (int i = 0; i < c->track_count && n < max; i++) {
+        compress_track_t *t = &c->tracks[i];
+        if (t->has_held && now - t->archived.timestamp >= c->config.heartbeat_s) {
+            n += archive(c, t, &t->held, out + n);
+        }
+    }
+    return n;
+}
+
+int compressor_flush(compressor_t *c, uplink_entry_t *out, int max) {
+    if (!c || !out) return 0;
+    int n = 0;
+    for (int i = 0; i < c->track_count && n < max; i++) {
+        compress_track_t *t = &c->tracks[i];
+        if (t->has_held) n += archive(c, t, &t->held, out + n);
+    }
+    return n;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file compressor.h
+ * @brief Per-sensor lossy compression of logged values (historian style)
+ *
+ * Decides which logged points are archived. A dropped point can be rebuilt
+ * from the archived points around it to within the sensor's deviation:
+ *
+ *  - Swinging door: read history by linear interpolation between archived
+ *    points. A point is archived when the line from the last archived point
+ *    to the newest one would stray more than the deviation from a point in
+ *    between; the point before the newest (whose line still fit) is kept.
+ *    Unlike textbook swinging door, which only asks that some line fit and
+ *    can miss by up to twice the deviation, this bound holds for the
+ *    points actually stored.
+ *    With a deviation of 0 only points lying exactly on such a line (flat
+ *    or constant-rate stretches) are dropped, so nothing is lost.
+ *
+ *  - Deadband: read history as a step (each archived value holds until the
+ *    next). A point is archived when it differs from the last archived
+ *    value by more than the deviation.
+ *
+ * Either way a change of status archives the last point before it and the
+ * first point after it, and a sensor archives at least one point per
+ * heartbeat while it keeps reporting. The newest point of each sensor is
+ * held back until it is needed, so up to a heartbeat of data (tracked per
+ * sensor, at most one point) is lost on a crash; an orderly stop flushes it.
+ *
+ * Used by the logger thread only.
+ */
+
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include "common.h"
+#include "uplink.h"
+
+typedef enum {
+    COMPRESS_OFF = 0,
+    COMPRESS_DEADBAND,
+    COMPRESS_SWINGING_DOOR
+} compress_mode_t;
+
+typedef struct {
+    compress_mode_t mode;
+    float dev;                  /* Default deviation, engineering units */
+    int heartbeat_s;            /* Longest gap between archived points, 0 = none */
+} compress_config_t;
+
+typedef struct {
+    int module_id;
+    float dev;                  /* < 0: the default */
+    bool active;                /* Something archived yet */
+    bool has_held;
+    uplink_entry_t archived;    /* Last archived point */
+    uplink_entry_t held;        /* Newest point, not archived */
+    double slope_min;           /* Swinging door: slopes from archived that */
+    double slope_max;           /* stay within dev of every point since */
+} compress_track_t;
+
+typedef struct {
+    uint64_t points_in;
+    uint64_t points_out;
+} compress_stats_t;
+
+typedef struct {
+    compress_config_t config;
+    compress_track_t tracks[MAX_SENSOR_INSTANCES];
+    int track_count;
+    compress_stats_t stats;
+} compressor_t;
+
+/**
+ * @brief Parse "off", "deadband" or "swinging_door"
+ * @return RESULT_OK, RESULT_INVALID_PARAM for anything else
+ */
+result_t compress_mode_parse(const char *name, compress_mode_t *mode);
+
+const char* compress_mode_name(compress_mode_t mode);
+
+void compressor_init(compressor_t *c, const compress_config_t *config);
+
+/**
+ * @brief Override the deviation of one sensor (negative restores the default)
+ */
+result_t compressor_set_dev(compressor_t *c, int module_id, float dev);
+
+/**
+ * @brief Parse "module:dev, module:dev, ..." and apply each override
+ * @return RESULT_OK, RESULT_PARSE_ERROR on the first malformed item
+ */
+result_t compressor_set_devs(compressor_t *c, const char *list);
+
+/**
+ * @brief Offer one point; write the points to archive because of it
+ *
+ * Points of a sensor must come oldest first.
+ * @param out Room for 2 points
+ * @return Number of points written (0 to 2)
+ */
+int compressor_push(compressor_t *c, const uplink_entry_t *point, uplink_entry_t *out);
+
+/**
+ * @brief Archive held points whose sensor has had no archived point for a heartbeat
+ * @return Number of points written (at most max)
+ */
+int compressor_sweep(compressor_t *c, time_t now, uplink_entry_t *out, int max);
+
+/**
+ * @brief Archive every held point (orderly stop)
+ * @return Number of points written (at most max)
+ */
+int compressor_flush(compressor_t *c, uplink_entry_t *out, int max);
+
+#endif
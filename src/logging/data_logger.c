@@ -7,340 +7,730 @@
 #include "db/database.h"
 #include "db/db_modules.h"
 #include "db/db_events.h"
+#include "db/db_history.h"
+#include "db/db_writer.h"
 #include "utils/logger.h"
+#include "sensors/sample_bus.h"
+#include "spool.h"
+#include "uplink.h"
+#include "compressor.h"
+#include "config_defaults.h"
 #include <pthread.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
 
-#ifdef HAVE_CURL
-#include <curl/curl.h>
-#else
-typedef void CURL;
-typedef int CURLcode;
-#define CURLE_OK 0
-#define curl_easy_init() NULL
-#define curl_easy_cleanup(x) (void)(x)
-#define curl_easy_setopt(...) (void)0
-#define curl_easy_perform(x) CURLE_OK
-#define curl_easy_getinfo(...) (void)0
-#define curl_easy_strerror(x) "CURL not available"
-#define curl_slist_append(x, y) NULL
-#define curl_slist_free_all(x) (void)(x)
-#define curl_global_init(x) (void)(x)
-#define curl_global_cleanup() (void)0
-#define CURLOPT_WRITEFUNCTION 0
-#define CURLOPT_TIMEOUT 0
-#define CURLOPT_CONNECTTIMEOUT 0
-#define CURLOPT_URL 0
-#define CURLOPT_HTTPHEADER 0
-#define CURLOPT_POSTFIELDS 0
-#define CURLOPT_POST 0
-#define CURLINFO_RESPONSE_CODE 0
-#define CURL_GLOBAL_DEFAULT 0
-struct curl_slist { void *next; };
-#endif
-
-#ifdef HAVE_CJSON
-#include <cjson/cJSON.h>
-#endif
-
-#define MAX_LOG_BATCH_SIZE      100
-#define LOG_QUEUE_SIZE          1000
-#define REMOTE_RETRY_INTERVAL   60000  // 60 seconds
-#define REMOTE_BATCH_SIZE       50
+#define MAX_LOG_BATCH_SIZE      WT_LOG_BATCH_SIZE
+#define LOG_QUEUE_SIZE          WT_LOG_QUEUE_SIZE
+#define LOG_QUEUE_MASK          (LOG_QUEUE_SIZE - 1)
+#define REMOTE_RETRY_INTERVAL   WT_LOG_REMOTE_RETRY_MS
+#define REMOTE_BATCH_SIZE       WT_LOG_REMOTE_BATCH
+#define ENQUEUE_ATTEMPTS        64     // Bounded CAS retries keep producers wait-free
+#define SAMPLE_BATCH_SIZE       64
+#define LOGGER_WAKE_MS          250    // Bounds flush/stop latency while idle
 
+_Static_assert((LOG_QUEUE_SIZE & LOG_QUEUE_MASK) == 0, "WT_LOG_QUEUE_SIZE must be a power of two");
+
+/* On-disk spool record; the timestamp is kept in the spool record header */
 typedef struct {
-    int module_id;
+    int32_t module_id;
     float value;
     char status[16];
-    time_t timestamp;
-} log_entry_t;
+} spool_entry_t;
+
+typedef uplink_entry_t log_entry_t;
+
+/* Ring cell: seq == position when free for that lap, position + 1 when filled */
+typedef struct {
+    atomic_uint_least64_t seq;
+    log_entry_t entry;
+} log_cell_t;
 
 typedef struct {
     database_t *db;
     data_logger_config_t config;
 
-    // Log queue
-    log_entry_t queue[LOG_QUEUE_SIZE];
-    int queue_head;
-    int queue_tail;
-    int queue_count;
-
-    // Remote logging state
-    CURL *curl;
+    /*
+     * Bounded MPSC log queue. Any thread enqueues without a lock; only the
+     * logger thread dequeues. A full queue rejects new entries and counts
+     * them, so producers never wait on the logger's SQLite or HTTP calls.
+     */
+    log_cell_t ring[LOG_QUEUE_SIZE];
+    _Alignas(64) atomic_uint_least64_t enqueue_pos;
+    _Alignas(64) atomic_uint_least64_t dequeue_pos;   // Written by logger thread only
+    atomic_uint_least64_t total_enqueued;
+    atomic_uint_least64_t total_dropped_full;       // Rejected, queue full
+    atomic_uint_least64_t total_dropped_contention; // Rejected, CAS retries exhausted
+
+    // Batch taken from the ring and being written (logger thread)
+    log_entry_t pending[MAX_LOG_BATCH_SIZE];
+    atomic_int pending_count;
+
+    // Remote logging state (logger thread; staged changes applied under mutex)
+    uplink_t *uplink;
+    bool uplink_unsupported;        // Warned once that this build cannot upload
+    time_t session;                 // Distinguishes unspooled batch keys across restarts
+    uint64_t batch_seq;
     char *remote_url;
     char *api_key;
+    char *staged_url;
+    char *staged_api_key;
+    bool remote_staged;
+    bool uplink_reset;              // Link went down: drop the uplink's connections
     bool remote_available;
     uint64_t last_remote_attempt;
-    int remote_failures;
+    atomic_int remote_failures;
 
-    // Store & Forward state
+    // Disk spool for remote delivery (opened and used by logger thread)
+    _Atomic(spool_t *) spool;
+    uint64_t last_spool_attempt;
+
+    // Store & Forward state (guarded by mutex)
     bool network_connected;         // External connection state (from PROFINET)
     bool queue_when_offline;        // Queue entries when remote unavailable
     bool flush_on_reconnect;        // Flush queue when connection restored
     bool flush_pending;             // Flag to trigger immediate flush
     int max_queue_age_seconds;
 
+    // Compressed local history; open blocks checkpointed periodically (logger thread)
+    db_history_writer_t history;
+    uint64_t last_checkpoint_ms;
+
+    // Points worth keeping, chosen per sensor (logger thread)
+    compressor_t compressor;
+    log_entry_t archive[MAX_LOG_BATCH_SIZE + MAX_SENSOR_INSTANCES];
+
+    // Sample bus feed, downsampled to one row per module per interval
+    sample_subscriber_t *samples;
+    struct {
+        int module_id;
+        uint64_t last_logged_ms;
+    } cadence[MAX_SENSOR_INSTANCES];
+    int cadence_count;
+
     // Threading
     pthread_t log_thread;
-    pthread_mutex_t mutex;
+    pthread_mutex_t mutex;          // Settings only; never held across I/O
     pthread_cond_t cond;
+    atomic_bool process_now;        // Drain before the interval elapses
     volatile bool running;
     bool initialized;
 
     // Statistics
-    uint64_t total_logged;
-    uint64_t total_remote_sent;
-    uint64_t total_remote_failed;
-    uint64_t total_dropped_age;     // Entries dropped due to age
+    atomic_uint_least64_t total_logged;
+    atomic_uint_least64_t total_remote_sent;
+    atomic_uint_least64_t total_remote_failed;
+    atomic_uint_least64_t total_remote_bytes;    // Request bodies accepted by the remote end
+    atomic_uint_least64_t total_dropped_age;     // Entries dropped due to age
+    atomic_uint_least64_t compression_in;        // Points offered to the compressor
+    atomic_uint_least64_t compression_out;       // Points it archived
 } data_logger_t;
 
 static data_logger_t g_logger = {0};
 
+/* Remote settings as seen by one processing pass */
+typedef struct {
+    bool local_enabled;
+    bool send_remote;
+    bool flush;
+    bool spool;                     // Route remote delivery through the disk spool
+    int max_age_seconds;
+} process_snapshot_t;
+
 /* ============================================================================
  * Internal Functions
  * ========================================================================== */
 
-#ifdef HAVE_CURL
-static size_t logger_curl_write_cb(void *contents, size_t size, size_t nmemb, void *userp) {
-    UNUSED(contents); UNUSED(userp);
-    return size * nmemb;
+/* Open the uplink on first use, or after the remote settings changed (logger thread) */
+static uplink_t* get_uplink(void) {
+    if (g_logger.uplink || g_logger.uplink_unsupported) return g_logger.uplink;
+    if (!g_logger.remote_url || !g_logger.remote_url[0]) return NULL;
+
+    uplink_config_t cfg = {
+        .format = UPLINK_FORMAT_JSON,
+        .compress = g_logger.config.remote_compress,
+        .window = g_logger.config.remote_window,
+        .timeout_s = WT_UPLINK_TIMEOUT_S,
+        .topics = UPLINK_TOPICS_BATCH,
+        .mqtt_version = g_logger.config.mqtt_version > 0 ? g_logger.config.mqtt_version
+                                                         : WT_MQTT_VERSION,
+    };
+    const char *format = g_logger.config.remote_format[0] ? g_logger.config.remote_format
+                                                          : WT_UPLINK_FORMAT;
+    if (uplink_format_parse(format, &cfg.format) != RESULT_OK) {
+        LOG_WARNING("Unknown remote_format '%s', using json", format);
+    }
+    const char *topics = g_logger.config.remote_topics[0] ? g_logger.config.remote_topics
+                                                          : WT_UPLINK_TOPICS;
+    if (uplink_topics_parse(topics, &cfg.topics) != RESULT_OK) {
+        LOG_WARNING("Unknown remote_topics '%s', using batch", topics);
+    }
+    SAFE_STRNCPY(cfg.url, g_logger.remote_url, sizeof(cfg.url));
+    SAFE_STRNCPY(cfg.api_key, g_logger.api_key ? g_logger.api_key : "", sizeof(cfg.api_key));
+    SAFE_STRNCPY(cfg.device, g_logger.config.device_name, sizeof(cfg.device));
+
+    result_t r = uplink_open(&cfg, &g_logger.uplink);
+    if (r == RESULT_NOT_SUPPORTED) {
+        LOG_WARNING("Remote URL not supported by this build; uploads disabled");
+        g_logger.uplink_unsupported = true;
+    } else if (r != RESULT_OK) {
+        LOG_WARNING("Remote uplink unavailable: %d", r);
+    }
+    return g_logger.uplink;
 }
-#endif
 
-static result_t init_curl(void) {
-    if (g_logger.curl) return RESULT_OK;
-    
-    g_logger.curl = curl_easy_init();
-    if (!g_logger.curl) {
-        LOG_ERROR("Failed to initialize CURL");
-        return RESULT_ERROR;
+/* Account for one finished batch */
+static void note_ack(const uplink_ack_t *ack) {
+    if (ack->ok) {
+        atomic_store(&g_logger.remote_failures, 0);
+        atomic_fetch_add(&g_logger.total_remote_sent, (uint64_t)ack->count);
+        atomic_fetch_add(&g_logger.total_remote_bytes, (uint64_t)ack->bytes);
+        LOG_DEBUG("Sent %d entries to remote (%zu bytes)", ack->count, ack->bytes);
+    } else {
+        atomic_fetch_add(&g_logger.remote_failures, 1);
+        atomic_fetch_add(&g_logger.total_remote_failed, (uint64_t)ack->count);
     }
-    
-    curl_easy_setopt(g_logger.curl, CURLOPT_WRITEFUNCTION, logger_curl_write_cb);
-    curl_easy_setopt(g_logger.curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(g_logger.curl, CURLOPT_CONNECTTIMEOUT, 5L);
-    
-    return RESULT_OK;
 }
 
-static result_t send_to_remote(log_entry_t *entries, int count) {
-    if (!g_logger.config.remote_enabled || !g_logger.remote_url) {
-        return RESULT_NOT_SUPPORTED;
-    }
-    
-    if (init_curl() != RESULT_OK) return RESULT_ERROR;
-    
-#ifdef HAVE_CJSON
-    cJSON *root = cJSON_CreateObject();
-    cJSON *data = cJSON_CreateArray();
-    
-    for (int i = 0; i < count; i++) {
-        cJSON *entry = cJSON_CreateObject();
-        cJSON_AddNumberToObject(entry, "module_id", entries[i].module_id);
-        cJSON_AddNumberToObject(entry, "value", entries[i].value);
-        cJSON_AddStringToObject(entry, "status", entries[i].status);
-        cJSON_AddNumberToObject(entry, "timestamp", entries[i].timestamp);
-        cJSON_AddItemToArray(data, entry);
-    }
-    
-    cJSON_AddItemToObject(root, "data", data);
-    cJSON_AddStringToObject(root, "device", g_logger.config.device_name);
-    
-    char *json_str = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-    
-    if (!json_str) return RESULT_NO_MEMORY;
-    
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    
-    if (g_logger.api_key && strlen(g_logger.api_key) > 0) {
-        char auth_header[256];
-        snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", g_logger.api_key);
-        headers = curl_slist_append(headers, auth_header);
+/* ============================================================================
+ * MPSC Log Queue
+ * ========================================================================== */
+
+static void ring_init(void) {
+    for (uint64_t i = 0; i < LOG_QUEUE_SIZE; i++) {
+        atomic_init(&g_logger.ring[i].seq, i);
     }
-    
-    curl_easy_setopt(g_logger.curl, CURLOPT_URL, g_logger.remote_url);
-    curl_easy_setopt(g_logger.curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(g_logger.curl, CURLOPT_POSTFIELDS, json_str);
-    curl_easy_setopt(g_logger.curl, CURLOPT_POST, 1L);
-    
-    CURLcode res = curl_easy_perform(g_logger.curl);
-    
-    curl_slist_free_all(headers);
-    free(json_str);
-    
-    if (res != CURLE_OK) {
-        LOG_WARNING("Remote log failed: %s", curl_easy_strerror(res));
-        g_logger.remote_failures++;
-        g_logger.total_remote_failed += count;
-        return RESULT_IO_ERROR;
+    atomic_init(&g_logger.enqueue_pos, 0);
+    atomic_init(&g_logger.dequeue_pos, 0);
+}
+
+/* Any thread; bounded steps, never blocks */
+static bool ring_enqueue(int module_id, float value, const char *status, time_t timestamp) {
+    uint64_t pos = atomic_load_explicit(&g_logger.enqueue_pos, memory_order_relaxed);
+
+    for (int attempt = 0; attempt < ENQUEUE_ATTEMPTS; attempt++) {
+        log_cell_t *cell = &g_logger.ring[pos & LOG_QUEUE_MASK];
+        uint64_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_logger.enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->entry.module_id = module_id;
+                cell->entry.value = value;
+                SAFE_STRNCPY(cell->entry.status, status ? status : STATUS_OK,
+                             sizeof(cell->entry.status));
+                cell->entry.timestamp = timestamp;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                atomic_fetch_add_explicit(&g_logger.total_enqueued, 1, memory_order_relaxed);
+                return true;
+            }
+            /* Lost the slot to another producer; pos now holds the new head */
+        } else if (diff < 0) {
+            /* Slot still holds last lap's entry: queue full */
+            atomic_fetch_add_explicit(&g_logger.total_dropped_full, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&g_logger.enqueue_pos, memory_order_relaxed);
+        }
     }
-    
-    long http_code = 0;
-    curl_easy_getinfo(g_logger.curl, CURLINFO_RESPONSE_CODE, &http_code);
-    
-    if (http_code >= 200 && http_code < 300) {
-        g_logger.remote_failures = 0;
-        g_logger.total_remote_sent += count;
-        LOG_DEBUG("Sent %d entries to remote", count);
-        return RESULT_OK;
+
+    atomic_fetch_add_explicit(&g_logger.total_dropped_contention, 1, memory_order_relaxed);
+    return false;
+}
+
+/* Logger thread only */
+static int ring_dequeue(log_entry_t *out, int max) {
+    uint64_t pos = atomic_load_explicit(&g_logger.dequeue_pos, memory_order_relaxed);
+    int n = 0;
+
+    while (n < max) {
+        log_cell_t *cell = &g_logger.ring[pos & LOG_QUEUE_MASK];
+        uint64_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        if ((int64_t)(seq - (pos + 1)) < 0) break;  // Empty, or claimed but not yet written
+
+        out[n++] = cell->entry;
+        atomic_store_explicit(&cell->seq, pos + LOG_QUEUE_SIZE, memory_order_release);
+        pos++;
     }
-    
-    LOG_WARNING("Remote log HTTP error: %ld", http_code);
-    g_logger.remote_failures++;
-    g_logger.total_remote_failed += count;
-    return RESULT_ERROR;
-    
-#else
-    UNUSED(entries); UNUSED(count);
-    LOG_WARNING("Remote logging requires cJSON library");
-    return RESULT_NOT_SUPPORTED;
-#endif
+
+    atomic_store_explicit(&g_logger.dequeue_pos, pos, memory_order_release);
+    return n;
 }
 
-static void drop_old_entries(void) {
-    if (g_logger.max_queue_age_seconds <= 0) return;
+static int ring_depth(void) {
+    uint64_t tail = atomic_load_explicit(&g_logger.dequeue_pos, memory_order_acquire);
+    uint64_t head = atomic_load_explicit(&g_logger.enqueue_pos, memory_order_acquire);
+    return head > tail ? (int)(head - tail) : 0;
+}
+
+/* ============================================================================
+ * Logger Thread
+ * ========================================================================== */
+
+/* Apply settings changed by other threads and capture this pass's view */
+static void take_snapshot(process_snapshot_t *snap) {
+    pthread_mutex_lock(&g_logger.mutex);
+
+    bool reopen = g_logger.remote_staged || g_logger.uplink_reset;
+    g_logger.uplink_reset = false;
+    if (g_logger.remote_staged) {
+        free(g_logger.remote_url);
+        free(g_logger.api_key);
+        g_logger.remote_url = g_logger.staged_url;
+        g_logger.api_key = g_logger.staged_api_key;
+        g_logger.staged_url = NULL;
+        g_logger.staged_api_key = NULL;
+        g_logger.remote_staged = false;
+    }
+
+    snap->local_enabled = g_logger.config.local_enabled;
+    snap->send_remote = g_logger.config.remote_enabled &&
+                        g_logger.remote_available &&
+                        g_logger.network_connected;
+    snap->flush = g_logger.flush_pending;
+    snap->spool = g_logger.config.remote_enabled && g_logger.remote_url &&
+                  g_logger.config.spool_dir[0] != '\0' &&
+                  (g_logger.network_connected || g_logger.queue_when_offline);
+    snap->max_age_seconds = g_logger.max_queue_age_seconds;
 
-    time_t now = time(NULL);
-    time_t cutoff = now - g_logger.max_queue_age_seconds;
-    int dropped = 0;
+    pthread_mutex_unlock(&g_logger.mutex);
 
-    while (g_logger.queue_count > 0) {
-        log_entry_t *entry = &g_logger.queue[g_logger.queue_tail];
-        if (entry->timestamp >= cutoff) break;  // Entry is fresh enough
+    // Nothing is in flight between passes, so the old connections can go
+    if (reopen) {
+        uplink_close(g_logger.uplink);
+        g_logger.uplink = NULL;
+    }
+}
 
-        // Drop old entry
-        g_logger.queue_tail = (g_logger.queue_tail + 1) % LOG_QUEUE_SIZE;
-        g_logger.queue_count--;
-        dropped++;
+/* Drop pending entries older than the store & forward age limit */
+static int drop_old_entries(log_entry_t *batch, int count, int max_age_seconds) {
+    if (max_age_seconds <= 0) return count;
+
+    time_t cutoff = time(NULL) - max_age_seconds;
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (batch[i].timestamp >= cutoff) batch[kept++] = batch[i];
     }
 
+    int dropped = count - kept;
     if (dropped > 0) {
-        g_logger.total_dropped_age += dropped;
+        uint64_t total = atomic_fetch_add(&g_logger.total_dropped_age, (uint64_t)dropped) + dropped;
         LOG_WARNING("Dropped %d entries older than %d seconds (total dropped: %lu)",
-                    dropped, g_logger.max_queue_age_seconds, g_logger.total_dropped_age);
+                    dropped, max_age_seconds, (unsigned long)total);
     }
+    return kept;
 }
 
-static void process_queue(void) {
-    if (g_logger.queue_count == 0) return;
+/* Whether to contact the remote end this pass, honouring the retry throttle */
+static bool remote_attempt_due(process_snapshot_t *snap) {
+    if (!snap->send_remote && !snap->flush) return false;
 
-    // Drop entries that are too old
-    drop_old_entries();
+    uint64_t now = get_time_ms();
 
-    if (g_logger.queue_count == 0) return;
+    // Check if we should retry after failures (unless flush is pending)
+    if (!snap->flush && atomic_load(&g_logger.remote_failures) > 0) {
+        if (now - g_logger.last_remote_attempt < REMOTE_RETRY_INTERVAL) {
+            return false;
+        }
+    }
 
-    log_entry_t batch[MAX_LOG_BATCH_SIZE];
-    int batch_count = 0;
+    g_logger.last_remote_attempt = now;
+    if (snap->flush) {
+        snap->flush = false;
+        pthread_mutex_lock(&g_logger.mutex);
+        g_logger.flush_pending = false;
+        pthread_mutex_unlock(&g_logger.mutex);
+    }
+    return true;
+}
 
-    /*
-     * PEEK entries from queue without removing them yet.
-     * We only advance tail pointer after successful insert to prevent data loss.
-     */
-    int peek_idx = g_logger.queue_tail;
-    int peek_remaining = g_logger.queue_count;
-    while (peek_remaining > 0 && batch_count < MAX_LOG_BATCH_SIZE) {
-        batch[batch_count++] = g_logger.queue[peek_idx];
-        peek_idx = (peek_idx + 1) % LOG_QUEUE_SIZE;
-        peek_remaining--;
+/* Without a spool: one attempt per entry, lost if the remote end is down */
+static void send_batch_remote(log_entry_t *batch, int batch_count, process_snapshot_t *snap) {
+    if (!remote_attempt_due(snap)) return;
+    uplink_t *uplink = get_uplink();
+    if (!uplink) return;
+
+    uplink_ack_t acks[WT_UPLINK_MAX_WINDOW];
+    int next = 0;
+    int sent_ok = 0;
+
+    // Keep the window full; batches are acked independently
+    while (next < batch_count || uplink_in_flight(uplink) > 0) {
+        while (next < batch_count && uplink_in_flight(uplink) < uplink_window(uplink)) {
+            int n = MIN(REMOTE_BATCH_SIZE, batch_count - next);
+            char key[MAX_NAME_LEN + 48];
+            snprintf(key, sizeof(key), "%s-%lld-%llu", g_logger.config.device_name,
+                     (long long)g_logger.session, (unsigned long long)++g_logger.batch_seq);
+            if (uplink_submit(uplink, &batch[next], n, 0, key) != RESULT_OK) {
+                atomic_fetch_add(&g_logger.remote_failures, 1);
+                atomic_fetch_add(&g_logger.total_remote_failed, (uint64_t)n);
+            }
+            next += n;
+        }
+
+        int got = uplink_poll(uplink, LOGGER_WAKE_MS, acks, WT_UPLINK_MAX_WINDOW);
+        for (int i = 0; i < got; i++) {
+            note_ack(&acks[i]);
+            if (acks[i].ok) sent_ok += acks[i].count;
+        }
     }
 
-    // Log to local database using batch insert for efficiency
-    if (g_logger.config.local_enabled && g_logger.db && batch_count > 0) {
-        /* Prepare arrays for batch insert (10-100x faster than individual inserts) */
-        int module_ids[MAX_LOG_BATCH_SIZE];
-        float values[MAX_LOG_BATCH_SIZE];
-        const char *statuses[MAX_LOG_BATCH_SIZE];
+    if (sent_ok > 0) {
+        LOG_DEBUG("Flushed %d entries to remote", sent_ok);
+    }
+}
 
-        for (int i = 0; i < batch_count; i++) {
-            module_ids[i] = batch[i].module_id;
-            values[i] = batch[i].value;
-            statuses[i] = batch[i].status;
+/* ============================================================================
+ * Store & Forward Spool
+ * ========================================================================== */
+
+/* Open the spool on first use; retried at the remote retry interval */
+static spool_t* get_spool(const process_snapshot_t *snap) {
+    spool_t *spool = atomic_load(&g_logger.spool);
+    if (spool || !snap->spool) return spool;
+
+    uint64_t now = get_time_ms();
+    if (g_logger.last_spool_attempt && now - g_logger.last_spool_attempt < REMOTE_RETRY_INTERVAL) {
+        return NULL;
+    }
+    g_logger.last_spool_attempt = now;
+
+    spool_config_t cfg = {
+        .segment_bytes = WT_SPOOL_SEGMENT_BYTES,
+        .max_bytes = (uint64_t)(g_logger.config.spool_max_mb > 0 ?
+                                g_logger.config.spool_max_mb : WT_SPOOL_MAX_MB) * 1024 * 1024,
+        .max_age_seconds = snap->max_age_seconds > 0 ? (uint32_t)snap->max_age_seconds : 0,
+    };
+    SAFE_STRNCPY(cfg.dir, g_logger.config.spool_dir, sizeof(cfg.dir));
+
+    if (spool_open(&cfg, &spool) != RESULT_OK) {
+        LOG_WARNING("Spool unavailable, remote uploads will not survive outages");
+        return NULL;
+    }
+    atomic_store(&g_logger.spool, spool);
+    return spool;
+}
+
+static void spool_batch(spool_t *spool, const log_entry_t *batch, int count) {
+    for (int i = 0; i < count; i++) {
+        spool_entry_t e = {
+            .module_id = batch[i].module_id,
+            .value = batch[i].value,
+        };
+        memcpy(e.status, batch[i].status, sizeof(e.status));
+        if (spool_append(spool, &e, sizeof(e), batch[i].timestamp) != RESULT_OK) {
+            LOG_WARNING("Spool append failed, %d entries not queued for remote", count - i);
+            return;
         }
+    }
+}
 
-        if (db_sensor_log_insert_batch(g_logger.db, module_ids, values, statuses, batch_count) == RESULT_OK) {
-            g_logger.total_logged += batch_count;
-            /* SUCCESS: Now safe to dequeue the entries we just inserted */
-            g_logger.queue_tail = peek_idx;
-            g_logger.queue_count -= batch_count;
-        } else {
-            /* FAILURE: Entries remain in queue for retry on next cycle */
-            LOG_WARNING("Batch insert failed, %d entries remain queued for retry", batch_count);
-            return;  /* Don't proceed to remote - local failed */
+/* Spooled records to upload entries; returns how many were usable */
+static int unpack_records(const spool_record_t *records, int n, log_entry_t *entries) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (records[i].len != sizeof(spool_entry_t)) continue;
+        spool_entry_t e;
+        memcpy(&e, records[i].data, sizeof(e));
+        entries[count].module_id = e.module_id;
+        entries[count].value = e.value;
+        memcpy(entries[count].status, e.status, sizeof(entries[count].status));
+        entries[count].status[sizeof(entries[count].status) - 1] = '\0';
+        entries[count].timestamp = records[i].timestamp;
+        count++;
+    }
+    return count;
+}
+
+/* A spooled batch between peek and commit */
+typedef struct {
+    spool_pos_t end;
+    int records;
+    int entries;
+    bool done;
+    bool ok;
+} spool_batch_t;
+
+/*
+ * Upload the spool from its cursor, keeping up to the uplink window of
+ * batches in flight. Acks may arrive out of order; the cursor only
+ * advances over the acknowledged prefix, so a failure or restart resends
+ * from the first unacknowledged batch. Batch keys are derived from the
+ * spool position and stay the same when a batch is resent.
+ */
+static void drain_spool(spool_t *spool, process_snapshot_t *snap) {
+    if (!g_logger.running || !remote_attempt_due(snap)) return;
+    uplink_t *uplink = get_uplink();
+    if (!uplink) return;
+
+    spool_record_t records[REMOTE_BATCH_SIZE];
+    log_entry_t entries[REMOTE_BATCH_SIZE];
+    spool_batch_t window[WT_UPLINK_MAX_WINDOW];
+    uplink_ack_t acks[WT_UPLINK_MAX_WINDOW];
+    uint64_t head = 0, tail = 0;    // Batch numbers; slot is number % WT_UPLINK_MAX_WINDOW
+    spool_pos_t next = {0};
+    bool exhausted = false;
+    bool failed = false;
+    int sent_ok = 0;
+
+    for (;;) {
+        // Yield to local logging when the queue backs up during a long catch-up
+        while (!failed && !exhausted && g_logger.running &&
+               tail - head < (uint64_t)uplink_window(uplink) &&
+               ring_depth() < LOG_QUEUE_SIZE / 2) {
+            spool_pos_t end;
+            int n = spool_peek_from(spool, tail > 0 ? &next : NULL, records,
+                                    REMOTE_BATCH_SIZE, &end);
+            if (n == 0) {
+                exhausted = true;
+                break;
+            }
+
+            int count = unpack_records(records, n, entries);
+            spool_batch_t *b = &window[tail % WT_UPLINK_MAX_WINDOW];
+            *b = (spool_batch_t){
+                .end = end,
+                .records = n,
+                .entries = count,
+                .done = count == 0,
+                .ok = count == 0,
+            };
+            if (count > 0) {
+                char key[MAX_NAME_LEN + 48];
+                snprintf(key, sizeof(key), "%s-s%llu-%u", g_logger.config.device_name,
+                         (unsigned long long)end.segment, end.offset);
+                if (uplink_submit(uplink, entries, count, tail, key) != RESULT_OK) {
+                    atomic_fetch_add(&g_logger.remote_failures, 1);
+                    failed = true;
+                    break;
+                }
+            }
+            next = end;
+            tail++;
+        }
+
+        // Commit the acknowledged prefix
+        while (head < tail && window[head % WT_UPLINK_MAX_WINDOW].done &&
+               window[head % WT_UPLINK_MAX_WINDOW].ok) {
+            spool_batch_t *b = &window[head % WT_UPLINK_MAX_WINDOW];
+            spool_commit(spool, &b->end, b->records);
+            sent_ok += b->entries;
+            head++;
+        }
+
+        if (head == tail) break;
+        if (!g_logger.running || (failed && window[head % WT_UPLINK_MAX_WINDOW].done)) {
+            // Later batches are resent from the cursor on the next attempt
+            uplink_cancel(uplink);
+            break;
+        }
+
+        int got = uplink_poll(uplink, LOGGER_WAKE_MS, acks, WT_UPLINK_MAX_WINDOW);
+        for (int i = 0; i < got; i++) {
+            spool_batch_t *b = &window[acks[i].tag % WT_UPLINK_MAX_WINDOW];
+            b->done = true;
+            b->ok = acks[i].ok;
+            if (!acks[i].ok) failed = true;
+            note_ack(&acks[i]);
+        }
+    }
+
+    if (sent_ok > 0) {
+        LOG_DEBUG("Uploaded %d spooled entries to remote", sent_ok);
+    }
+}
+
+/* Keep archived points locally and pass them on for remote delivery */
+static void store_entries(log_entry_t *entries, int count, process_snapshot_t *snap,
+                          spool_t *spool, bool *spooled) {
+    if (count == 0) return;
+
+    // Pack into the local history blocks (memory only; written by process_queue)
+    if (snap->local_enabled && g_logger.db) {
+        for (int i = 0; i < count; i++) {
+            db_history_store(&g_logger.history, entries[i].module_id,
+                             (int64_t)entries[i].timestamp * 1000, entries[i].value,
+                             db_history_status_quality(entries[i].status));
         }
-    } else if (!g_logger.config.local_enabled) {
-        /* Local logging disabled - dequeue for remote-only processing */
-        g_logger.queue_tail = peek_idx;
-        g_logger.queue_count -= batch_count;
+        atomic_fetch_add(&g_logger.total_logged, (uint64_t)count);
     }
 
-    // Send to remote if enabled and network is connected
-    bool should_send_remote = g_logger.config.remote_enabled &&
-                              g_logger.remote_available &&
-                              g_logger.network_connected;
+    if (spool && snap->spool) {
+        spool_batch(spool, entries, count);
+        *spooled = true;
+    } else {
+        send_batch_remote(entries, count, snap);
+    }
+}
 
-    // If offline and queue_when_offline is false, we already processed locally
-    // If offline and queue_when_offline is true, entries stay in queue (but we already extracted them)
-    // So we need to handle this differently...
+/* db_writer requests; the caller waits, so g_logger.history is not shared */
+static result_t history_flush_request(database_t *db, void *arg) {
+    return db_history_flush(db, &g_logger.history, *(const bool *)arg);
+}
 
-    if (should_send_remote || g_logger.flush_pending) {
-        uint64_t now = get_time_ms();
+static result_t cleanup_request(database_t *db, void *arg) {
+    int retention_days = *(const int *)arg;
+    result_t r = db_history_cleanup(db, retention_days);
+    result_t legacy = db_sensor_log_cleanup(db, retention_days);
+    result_t rollups = db_rollup_cleanup(db);
+    if (r != RESULT_OK) return r;
+    return legacy != RESULT_OK ? legacy : rollups;
+}
+
+/*
+ * Drain the queue in batches. No lock is held during SQLite or HTTP work.
+ * Every entry feeds the rollups; only the points the compressor archives
+ * are packed into per-sensor history blocks in memory and sent on. Sealed
+ * blocks are written every pass and open blocks on checkpoint. A failed
+ * write keeps the blocks queued for the next pass. With a spool, batches
+ * are appended to disk and remote delivery runs from the spool afterwards.
+ */
+static void process_queue(bool checkpoint) {
+    process_snapshot_t snap;
+    take_snapshot(&snap);
+    spool_t *spool = get_spool(&snap);
+    bool spooled = false;
+
+    for (;;) {
+        int batch_count = atomic_load(&g_logger.pending_count);
+        if (batch_count == 0) {
+            batch_count = ring_dequeue(g_logger.pending, MAX_LOG_BATCH_SIZE);
+            if (batch_count == 0) break;
+        }
+        batch_count = drop_old_entries(g_logger.pending, batch_count, snap.max_age_seconds);
+        atomic_store(&g_logger.pending_count, batch_count);
+        if (batch_count == 0) continue;  // Whole batch expired; take the next one
 
-        // Check if we should retry after failures (unless flush is pending)
-        if (!g_logger.flush_pending && g_logger.remote_failures > 0) {
-            if (now - g_logger.last_remote_attempt < REMOTE_RETRY_INTERVAL) {
-                return;
+        log_entry_t *batch = g_logger.pending;
+        int archived = 0;
+        for (int i = 0; i < batch_count; i++) {
+            if (snap.local_enabled && g_logger.db) {
+                db_history_observe(&g_logger.history, batch[i].module_id,
+                                   (int64_t)batch[i].timestamp * 1000, batch[i].value,
+                                   db_history_status_quality(batch[i].status));
             }
+            archived += compressor_push(&g_logger.compressor, &batch[i], &g_logger.archive[archived]);
         }
+        store_entries(g_logger.archive, archived, &snap, spool, &spooled);
+        atomic_store(&g_logger.pending_count, 0);
+    }
 
-        g_logger.last_remote_attempt = now;
-        g_logger.flush_pending = false;
+    // Heartbeat for sensors gone quiet; everything still held on the way out
+    int held = g_logger.running ?
+        compressor_sweep(&g_logger.compressor, time(NULL), g_logger.archive, MAX_SENSOR_INSTANCES) :
+        compressor_flush(&g_logger.compressor, g_logger.archive, MAX_SENSOR_INSTANCES);
+    store_entries(g_logger.archive, held, &snap, spool, &spooled);
+    atomic_store(&g_logger.compression_in, g_logger.compressor.stats.points_in);
+    atomic_store(&g_logger.compression_out, g_logger.compressor.stats.points_out);
 
-        // Send in smaller batches for remote
-        int sent_ok = 0;
-        for (int i = 0; i < batch_count; i += REMOTE_BATCH_SIZE) {
-            int send_count = MIN(REMOTE_BATCH_SIZE, batch_count - i);
-            if (send_to_remote(&batch[i], send_count) == RESULT_OK) {
-                sent_ok += send_count;
-            }
+    if (g_logger.db) {
+        uint64_t now = get_time_ms();
+        checkpoint = checkpoint ||
+                     now - g_logger.last_checkpoint_ms >= (uint64_t)WT_HISTORY_CHECKPOINT_S * 1000;
+        /* Sealed blocks go in their own transaction on the writer thread */
+        if (db_writer_call_exclusive(g_logger.db, history_flush_request, &checkpoint) != RESULT_OK) {
+            LOG_WARNING("History write failed, blocks remain queued for retry");
+        } else if (checkpoint) {
+            g_logger.last_checkpoint_ms = now;
         }
+    }
+
+    if (spool) {
+        if (spooled) spool_sync(spool);
+        drain_spool(spool, &snap);
+    }
+}
 
-        if (sent_ok > 0) {
-            LOG_DEBUG("Flushed %d entries to remote", sent_ok);
+/* Queue at most one row per module per logging interval (logger thread) */
+static void take_samples(const sensor_sample_t *samples, int count) {
+    if (!g_logger.config.enabled) return;
+
+    uint64_t interval_ms = g_logger.config.interval_seconds > 0 ?
+        (uint64_t)g_logger.config.interval_seconds * 1000 : 0;
+
+    for (int i = 0; i < count; i++) {
+        const sensor_sample_t *sample = &samples[i];
+
+        int c = 0;
+        while (c < g_logger.cadence_count && g_logger.cadence[c].module_id != sample->module_id) c++;
+        if (c == g_logger.cadence_count) {
+            if (c < MAX_SENSOR_INSTANCES) {
+                g_logger.cadence[c].module_id = sample->module_id;
+                g_logger.cadence[c].last_logged_ms = 0;
+                g_logger.cadence_count++;
+            }
+        } else if (sample->timestamp_ms - g_logger.cadence[c].last_logged_ms < interval_ms) {
+            continue;
         }
+        if (c < MAX_SENSOR_INSTANCES) g_logger.cadence[c].last_logged_ms = sample->timestamp_ms;
+
+        ring_enqueue(sample->module_id, sample->value,
+                     sample_bus_quality_status(sample->quality), sample->wall_time);
     }
 }
 
 static void* logger_thread(void *arg) {
     UNUSED(arg);
+    sensor_sample_t samples[SAMPLE_BATCH_SIZE];
+    uint64_t last_process_ms = get_time_ms();
+    g_logger.last_checkpoint_ms = last_process_ms;
     
     while (g_logger.running) {
-        pthread_mutex_lock(&g_logger.mutex);
-        
-        // Wait for data or timeout
-        if (g_logger.queue_count == 0) {
-            struct timespec ts;
-            clock_gettime(CLOCK_REALTIME, &ts);
-            ts.tv_sec += g_logger.config.interval_seconds;
-            pthread_cond_timedwait(&g_logger.cond, &g_logger.mutex, &ts);
+        if (g_logger.samples) {
+            int n = sample_bus_wait(g_logger.samples, samples, SAMPLE_BATCH_SIZE, LOGGER_WAKE_MS);
+            take_samples(samples, n);
+        } else {
+            // No bus feed: wait for a flush request or the next wake-up
+            pthread_mutex_lock(&g_logger.mutex);
+            if (g_logger.running && !atomic_load(&g_logger.process_now)) {
+                struct timespec ts;
+                clock_gettime(CLOCK_REALTIME, &ts);
+                ts.tv_nsec += LOGGER_WAKE_MS * 1000000L;
+                if (ts.tv_nsec >= 1000000000L) {
+                    ts.tv_sec++;
+                    ts.tv_nsec -= 1000000000L;
+                }
+                pthread_cond_timedwait(&g_logger.cond, &g_logger.mutex, &ts);
+            }
+            pthread_mutex_unlock(&g_logger.mutex);
+        }
+
+        // Keep an idle uplink's connection alive between passes
+        uplink_service(g_logger.uplink);
+
+        /* Write once per interval, or sooner when the queue fills or a flush is requested */
+        uint64_t now = get_time_ms();
+        uint64_t interval_ms = (uint64_t)MAX(1, g_logger.config.interval_seconds) * 1000;
+        bool requested = atomic_exchange(&g_logger.process_now, false);
+        if (requested || ring_depth() >= LOG_QUEUE_SIZE / 2 ||
+            now - last_process_ms >= interval_ms) {
+            process_queue(requested);
+            last_process_ms = now;
         }
-        
-        process_queue();
-        
-        pthread_mutex_unlock(&g_logger.mutex);
     }
     
     // Final flush
-    pthread_mutex_lock(&g_logger.mutex);
-    process_queue();
-    pthread_mutex_unlock(&g_logger.mutex);
+    if (g_logger.samples) {
+        int n;
+        while ((n = sample_bus_poll(g_logger.samples, samples, SAMPLE_BATCH_SIZE)) > 0) {
+            take_samples(samples, n);
+        }
+    }
+    process_queue(true);
     
     return NULL;
 }
 
+static void wake_logger(void) {
+    atomic_store(&g_logger.process_now, true);
+    pthread_mutex_lock(&g_logger.mutex);
+    pthread_cond_signal(&g_logger.cond);
+    pthread_mutex_unlock(&g_logger.mutex);
+}
+
 /* ============================================================================
  * Public API
  * ========================================================================== */
@@ -353,6 +743,8 @@ result_t data_logger_init(database_t *db, const data_logger_config_t *config) {
     memset(&g_logger, 0, sizeof(g_logger));
     g_logger.db = db;
     memcpy(&g_logger.config, config, sizeof(data_logger_config_t));
+    ring_init();
+    db_history_writer_init(&g_logger.history);
     
     pthread_mutex_init(&g_logger.mutex, NULL);
     pthread_cond_init(&g_logger.cond, NULL);
@@ -364,7 +756,25 @@ result_t data_logger_init(database_t *db, const data_logger_config_t *config) {
             g_logger.api_key = strdup(config->api_key);
         }
         g_logger.remote_available = true;
-        curl_global_init(CURL_GLOBAL_DEFAULT);
+    }
+    uplink_global_init();
+    g_logger.session = time(NULL);
+
+    compress_config_t compress = {
+        .mode = COMPRESS_SWINGING_DOOR,
+        .dev = MAX(config->compression_dev, 0.0f),
+        .heartbeat_s = config->compression_heartbeat_s > 0 ? config->compression_heartbeat_s
+                                                           : WT_COMPRESSION_HEARTBEAT_S,
+    };
+    const char *mode = config->compression[0] ? config->compression : WT_COMPRESSION;
+    if (compress_mode_parse(mode, &compress.mode) != RESULT_OK) {
+        LOG_WARNING("Unknown compression '%s', using swinging_door", mode);
+    }
+    compressor_init(&g_logger.compressor, &compress);
+    /* Blocks get only archived points; minutes cannot be rebuilt from them */
+    g_logger.history.rollups.store_single = compress.mode != COMPRESS_OFF;
+    if (compressor_set_devs(&g_logger.compressor, config->compression_devs) != RESULT_OK) {
+        LOG_WARNING("Bad compression_devs '%s', expected module:dev,...", config->compression_devs);
     }
 
     // Store & Forward defaults (can be overridden by config)
@@ -374,9 +784,11 @@ result_t data_logger_init(database_t *db, const data_logger_config_t *config) {
     g_logger.network_connected = true;  // Assume connected initially
 
     g_logger.initialized = true;
-    LOG_INFO("Data logger initialized (local=%d, remote=%d, interval=%ds, queue_offline=%d, flush_reconnect=%d)",
+    LOG_INFO("Data logger initialized (local=%d, remote=%d, interval=%ds, queue_offline=%d, flush_reconnect=%d, "
+             "compression=%s dev=%g heartbeat=%ds)",
              config->local_enabled, config->remote_enabled, config->interval_seconds,
-             g_logger.queue_when_offline, g_logger.flush_on_reconnect);
+             g_logger.queue_when_offline, g_logger.flush_on_reconnect,
+             compress_mode_name(compress.mode), (double)compress.dev, compress.heartbeat_s);
     
     return RESULT_OK;
 }
@@ -385,11 +797,21 @@ result_t data_logger_start(void) {
     if (!g_logger.initialized) return RESULT_NOT_INITIALIZED;
     if (g_logger.running) return RESULT_OK;
     
+    /* Lossless up to the ring depth: a stalled writer drops new samples, not history */
+    if (sample_bus_subscribe("logger", WT_SAMPLE_BUS_LOGGER_DEPTH, SAMPLE_BUS_DROP_NEWEST,
+                             &g_logger.samples) != RESULT_OK) {
+        LOG_WARNING("Data logger: sample bus subscription failed, logging explicit calls only");
+        g_logger.samples = NULL;
+    }
+    g_logger.cadence_count = 0;
+
     g_logger.running = true;
     
     if (pthread_create(&g_logger.log_thread, NULL, logger_thread, NULL) != 0) {
         LOG_ERROR("Failed to create logger thread");
         g_logger.running = false;
+        sample_bus_unsubscribe(g_logger.samples);
+        g_logger.samples = NULL;
         return RESULT_ERROR;
     }
     
@@ -401,15 +823,23 @@ result_t data_logger_stop(void) {
     if (!g_logger.running) return RESULT_OK;
     
     g_logger.running = false;
+    wake_logger();
     
+    pthread_join(g_logger.log_thread, NULL);
+
+    sample_bus_unsubscribe(g_logger.samples);
+    g_logger.samples = NULL;
+
+    // get_stats() reads the spool under the mutex
     pthread_mutex_lock(&g_logger.mutex);
-    pthread_cond_signal(&g_logger.cond);
+    spool_t *spool = atomic_exchange(&g_logger.spool, NULL);
     pthread_mutex_unlock(&g_logger.mutex);
+    spool_close(spool);
     
-    pthread_join(g_logger.log_thread, NULL);
-    
-    LOG_INFO("Data logger stopped (total logged: %lu, remote sent: %lu)",
-             g_logger.total_logged, g_logger.total_remote_sent);
+    LOG_INFO("Data logger stopped (total logged: %lu, remote sent: %lu, dropped: %lu)",
+             (unsigned long)atomic_load(&g_logger.total_logged),
+             (unsigned long)atomic_load(&g_logger.total_remote_sent),
+             (unsigned long)atomic_load(&g_logger.total_dropped_full));
     
     return RESULT_OK;
 }
@@ -417,24 +847,21 @@ result_t data_logger_stop(void) {
 void data_logger_shutdown(void) {
     data_logger_stop();
     
-    if (g_logger.curl) {
-        curl_easy_cleanup(g_logger.curl);
-        g_logger.curl = NULL;
-    }
-    
-    if (g_logger.remote_url) {
-        free(g_logger.remote_url);
-        g_logger.remote_url = NULL;
-    }
+    uplink_close(g_logger.uplink);
+    g_logger.uplink = NULL;
     
-    if (g_logger.api_key) {
-        free(g_logger.api_key);
-        g_logger.api_key = NULL;
-    }
+    db_history_writer_free(&g_logger.history);
+
+    free(g_logger.remote_url);
+    free(g_logger.api_key);
+    free(g_logger.staged_url);
+    free(g_logger.staged_api_key);
+    g_logger.remote_url = NULL;
+    g_logger.api_key = NULL;
+    g_logger.staged_url = NULL;
+    g_logger.staged_api_key = NULL;
     
-    if (g_logger.remote_available) {
-        curl_global_cleanup();
-    }
+    uplink_global_cleanup();
     
     pthread_mutex_destroy(&g_logger.mutex);
     pthread_cond_destroy(&g_logger.cond);
@@ -447,31 +874,7 @@ result_t data_logger_log(int module_id, float value, const char *status) {
     if (!g_logger.initialized) return RESULT_NOT_INITIALIZED;
     if (!g_logger.config.enabled) return RESULT_OK;
     
-    pthread_mutex_lock(&g_logger.mutex);
-    
-    if (g_logger.queue_count >= LOG_QUEUE_SIZE) {
-        // Queue full, drop oldest
-        g_logger.queue_tail = (g_logger.queue_tail + 1) % LOG_QUEUE_SIZE;
-        g_logger.queue_count--;
-        LOG_WARNING("Log queue full, dropping oldest entry");
-    }
-    
-    log_entry_t *entry = &g_logger.queue[g_logger.queue_head];
-    entry->module_id = module_id;
-    entry->value = value;
-    SAFE_STRNCPY(entry->status, status ? status : STATUS_OK, sizeof(entry->status));
-    entry->timestamp = time(NULL);
-    
-    g_logger.queue_head = (g_logger.queue_head + 1) % LOG_QUEUE_SIZE;
-    g_logger.queue_count++;
-    
-    // Signal if queue is getting full
-    if (g_logger.queue_count >= LOG_QUEUE_SIZE / 2) {
-        pthread_cond_signal(&g_logger.cond);
-    }
-    
-    pthread_mutex_unlock(&g_logger.mutex);
-    return RESULT_OK;
+    return ring_enqueue(module_id, value, status, time(NULL)) ? RESULT_OK : RESULT_BUSY;
 }
 
 result_t data_logger_log_batch(int *module_ids, float *values, const char **statuses, int count) {
@@ -489,12 +892,13 @@ result_t data_logger_log_batch(int *module_ids, float *values, const char **stat
 result_t data_logger_flush(void) {
     if (!g_logger.initialized) return RESULT_NOT_INITIALIZED;
     
-    pthread_mutex_lock(&g_logger.mutex);
-    pthread_cond_signal(&g_logger.cond);
-    pthread_mutex_unlock(&g_logger.mutex);
+    wake_logger();
     
-    // Wait a bit for flush
-    usleep(100000);
+    // Wait for the logger thread to drain what was queued (bounded)
+    for (int i = 0; i < 100 && g_logger.running; i++) {
+        if (ring_depth() + atomic_load(&g_logger.pending_count) == 0) break;
+        usleep(10000);
+    }
     
     return RESULT_OK;
 }
@@ -504,23 +908,39 @@ result_t data_logger_cleanup(int retention_days) {
     if (retention_days <= 0) retention_days = g_logger.config.retention_days;
     if (retention_days <= 0) return RESULT_OK;
     
-    return db_sensor_log_cleanup(g_logger.db, retention_days);
+    return db_writer_call_exclusive(g_logger.db, cleanup_request, &retention_days);
 }
 
 result_t data_logger_get_stats(data_logger_stats_t *stats) {
     CHECK_NULL(stats);
     if (!g_logger.initialized) return RESULT_NOT_INITIALIZED;
     
-    pthread_mutex_lock(&g_logger.mutex);
-    
-    stats->total_logged = g_logger.total_logged;
-    stats->total_remote_sent = g_logger.total_remote_sent;
-    stats->total_remote_failed = g_logger.total_remote_failed;
-    stats->queue_count = g_logger.queue_count;
+    stats->total_logged = atomic_load(&g_logger.total_logged);
+    stats->total_remote_sent = atomic_load(&g_logger.total_remote_sent);
+    stats->total_remote_failed = atomic_load(&g_logger.total_remote_failed);
+    stats->total_remote_bytes = atomic_load(&g_logger.total_remote_bytes);
+    stats->total_dropped = atomic_load(&g_logger.total_dropped_full) +
+                           atomic_load(&g_logger.total_dropped_contention);
+    stats->total_dropped_age = atomic_load(&g_logger.total_dropped_age);
+    stats->compression_in = atomic_load(&g_logger.compression_in);
+    stats->compression_out = atomic_load(&g_logger.compression_out);
+    stats->queue_count = ring_depth() + atomic_load(&g_logger.pending_count);
     stats->queue_capacity = LOG_QUEUE_SIZE;
-    stats->remote_available = g_logger.remote_available;
-    stats->remote_failures = g_logger.remote_failures;
+    stats->remote_failures = atomic_load(&g_logger.remote_failures);
     
+    pthread_mutex_lock(&g_logger.mutex);
+    stats->remote_available = g_logger.remote_available;
+    spool_stats_t spool_stats;
+    spool_t *spool = atomic_load(&g_logger.spool);
+    if (spool && spool_get_stats(spool, &spool_stats) == RESULT_OK) {
+        stats->spool_backlog = spool_stats.backlog;
+        stats->spool_bytes = spool_stats.disk_bytes;
+        stats->spool_dropped = spool_stats.dropped + spool_stats.expired;
+    } else {
+        stats->spool_backlog = 0;
+        stats->spool_bytes = 0;
+        stats->spool_dropped = 0;
+    }
     pthread_mutex_unlock(&g_logger.mutex);
     return RESULT_OK;
 }
@@ -528,13 +948,14 @@ result_t data_logger_get_stats(data_logger_stats_t *stats) {
 result_t data_logger_set_remote(const char *url, const char *api_key) {
     pthread_mutex_lock(&g_logger.mutex);
     
-    if (g_logger.remote_url) free(g_logger.remote_url);
-    if (g_logger.api_key) free(g_logger.api_key);
-    
-    g_logger.remote_url = url ? strdup(url) : NULL;
-    g_logger.api_key = api_key ? strdup(api_key) : NULL;
+    /* The logger thread swaps these in before its next pass */
+    free(g_logger.staged_url);
+    free(g_logger.staged_api_key);
+    g_logger.staged_url = url ? strdup(url) : NULL;
+    g_logger.staged_api_key = api_key ? strdup(api_key) : NULL;
+    g_logger.remote_staged = true;
     g_logger.remote_available = (url && strlen(url) > 0);
-    g_logger.remote_failures = 0;
+    atomic_store(&g_logger.remote_failures, 0);
     
     pthread_mutex_unlock(&g_logger.mutex);
     
@@ -585,14 +1006,14 @@ result_t data_logger_force_flush(void) {
     if (!g_logger.initialized) return RESULT_NOT_INITIALIZED;
 
     pthread_mutex_lock(&g_logger.mutex);
-
     g_logger.flush_pending = true;
-    g_logger.remote_failures = 0;  // Reset failures to allow immediate retry
-    pthread_cond_signal(&g_logger.cond);
-
     pthread_mutex_unlock(&g_logger.mutex);
 
-    LOG_INFO("Forced flush requested (%d entries in queue)", g_logger.queue_count);
+    atomic_store(&g_logger.remote_failures, 0);  // Reset failures to allow immediate retry
+    wake_logger();
+
+    LOG_INFO("Forced flush requested (%d entries in queue)",
+             ring_depth() + atomic_load(&g_logger.pending_count));
 
     return RESULT_OK;
 }
@@ -604,20 +1025,23 @@ result_t data_logger_notify_connection(bool connected) {
 
     bool was_connected = g_logger.network_connected;
     g_logger.network_connected = connected;
+    // Connections made over the old link may be dead without knowing it
+    if (!connected && was_connected) g_logger.uplink_reset = true;
 
     // If we just reconnected and flush_on_reconnect is enabled, trigger flush
-    if (connected && !was_connected && g_logger.flush_on_reconnect) {
-        g_logger.flush_pending = true;
-        g_logger.remote_failures = 0;  // Reset failures to allow immediate retry
-        pthread_cond_signal(&g_logger.cond);
+    bool flush = connected && !was_connected && g_logger.flush_on_reconnect;
+    if (flush) g_logger.flush_pending = true;
+
+    pthread_mutex_unlock(&g_logger.mutex);
 
+    if (flush) {
+        atomic_store(&g_logger.remote_failures, 0);  // Reset failures to allow immediate retry
+        wake_logger();
         LOG_INFO("Network reconnected - triggering queue flush (%d entries)",
-                 g_logger.queue_count);
+                 ring_depth() + atomic_load(&g_logger.pending_count));
     } else if (!connected && was_connected) {
         LOG_WARNING("Network disconnected - entries will be queued locally");
     }
 
-    pthread_mutex_unlock(&g_logger.mutex);
-
     return RESULT_OK;
 }
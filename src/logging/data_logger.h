@@ -18,16 +18,39 @@ typedef struct {
     bool queue_when_offline;        // Queue entries when remote unavailable (default: true)
     bool flush_on_reconnect;        // Flush queued entries when remote becomes available (default: true)
     int max_queue_age_seconds;      // Drop entries older than this (0=never, default: 3600)
+    char spool_dir[MAX_PATH_LEN];   // Disk spool for remote uploads (empty = send from RAM only)
+    int spool_max_mb;               // Spool backlog cap (default: WT_SPOOL_MAX_MB)
+
+    // Remote upload protocol
+    char remote_format[16];         // "json" or "binary" (default: WT_UPLINK_FORMAT)
+    bool remote_compress;           // gzip request bodies
+    int remote_window;              // Batches in flight (default: WT_UPLINK_WINDOW)
+    char remote_topics[16];         // mqtt:// only: "batch" or "module" (default: WT_UPLINK_TOPICS)
+    int mqtt_version;               // mqtt:// only: 4 (3.1.1) or 5 (default: WT_MQTT_VERSION)
+
+    // Historian compression (see compressor.h)
+    char compression[16];           // "swinging_door", "deadband" or "off" (default: WT_COMPRESSION)
+    float compression_dev;          // Allowed reconstruction error, engineering units
+    int compression_heartbeat_s;    // Longest gap between stored points (default: WT_COMPRESSION_HEARTBEAT_S)
+    char compression_devs[MAX_CONFIG_VALUE_LEN];    // Per-module deviations: "module:dev,..."
 } data_logger_config_t;
 
 typedef struct {
     uint64_t total_logged;
     uint64_t total_remote_sent;
     uint64_t total_remote_failed;
+    uint64_t total_remote_bytes;    // Request bodies accepted by the remote end
+    uint64_t total_dropped;         // Rejected at enqueue (queue full or contended)
+    uint64_t total_dropped_age;     // Expired before they could be written
+    uint64_t compression_in;        // Points offered to the compressor
+    uint64_t compression_out;       // Points stored and sent (the rest are rebuilt within dev)
     int queue_count;
     int queue_capacity;
     bool remote_available;
     int remote_failures;
+    uint64_t spool_backlog;         // Records on disk awaiting upload
+    uint64_t spool_bytes;           // Disk used by the spool
+    uint64_t spool_dropped;         // Records lost to the spool size/age caps
 } data_logger_stats_t;
 
 result_t data_logger_init(database_t *db, const data_logger_config_t *config);
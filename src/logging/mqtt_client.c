@@ -0,0 +1,705 @@
+/**
+ * @file mqtt_client.c
+ * @brief Minimal MQTT 3.1.1 / 5.0 publisher over TCP
+ */
+
+#include "mqtt_client.h"
+#include "utils/logger.h"
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define PKT_CONNECT         0x10
+#define PKT_CONNACK         0x20
+#define PKT_PUBLISH         0x30
+#define PKT_PUBACK          0x40
+#define PKT_PINGREQ         0xC0
+#define PKT_PINGRESP        0xD0
+#define PKT_DISCONNECT      0xE0
+
+#define PUBLISH_DUP         0x08
+#define PUBLISH_QOS1        0x02
+
+#define CONNECT_CLEAN       0x02
+#define CONNECT_PASSWORD    0x40
+#define CONNECT_USERNAME    0x80
+
+/* MQTT 5 property identifiers */
+#define PROP_CONTENT_TYPE   0x03
+#define PROP_SESSION_EXPIRY 0x11
+#define PROP_SERVER_KEEPALIVE 0x13
+#define PROP_RECEIVE_MAX    0x21
+#define PROP_USER           0x26
+
+#define RX_BUF_SIZE         4096
+#define MAX_ATTEMPTS        3       /* Sends of one message before it fails */
+#define REASON_FAILURE      0x80
+
+typedef struct {
+    uint16_t packet_id;
+    bool failed;
+    int attempts;
+    uint64_t sent_ms;
+    uint8_t *packet;            /* Whole PUBLISH packet, resent as is (plus DUP) */
+    size_t len;
+} inflight_t;
+
+struct mqtt_client {
+    mqtt_config_t config;
+    int fd;
+    bool connected;
+    uint16_t next_id;
+    uint16_t receive_max;
+    int keepalive_s;
+
+    inflight_t *inflight;       /* Oldest first */
+    int count;
+    int cap;
+
+    uint8_t rx[RX_BUF_SIZE];
+    size_t rx_len;
+    uint64_t last_send_ms;
+    uint64_t ping_sent_ms;      /* 0 = no PINGREQ outstanding */
+
+    mqtt_stats_t stats;
+};
+
+/* ============================================================================
+ * Packet Building
+ * ============================================================================ */
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} pkt_t;
+
+static void pkt_raw(pkt_t *p, const void *data, size_t len) {
+    if (p->failed) return;
+    if (p->len + len > p->cap) {
+        size_t cap = p->cap ? p->cap : 128;
+        while (cap < p->len + len) cap *= 2;
+        uint8_t *grown = realloc(p->data, cap);
+        if (!grown) {
+            p->failed = true;
+            return;
+        }
+        p->data = grown;
+        p->cap = cap;
+    }
+    if (len) memcpy(p->data + p->len, data, len);
+    p->len += len;
+}
+
+static void pkt_u8(pkt_t *p, uint8_t v) {
+    pkt_raw(p, &v, 1);
+}
+
+static void pkt_u16(pkt_t *p, uint16_t v) {
+    uint8_t b[2] = { (uint8_t)(v >> 8), (uint8_t)v };
+    pkt_raw(p, b, 2);
+}
+
+static void pkt_u32(pkt_t *p, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v };
+    pkt_raw(p, b, 4);
+}
+
+static void pkt_varint(pkt_t *p, uint32_t v) {
+    do {
+        uint8_t b = (uint8_t)(v & 0x7f);
+        v >>= 7;
+        if (v) b |= 0x80;
+        pkt_u8(p, b);
+    } while (v);
+}
+
+static void pkt_string(pkt_t *p, const char *s) {
+    size_t len = MIN(strlen(s), (size_t)UINT16_MAX);
+    pkt_u16(p, (uint16_t)len);
+    pkt_raw(p, s, len);
+}
+
+/* Prefix the fixed header; frees body. Returns NULL on failure */
+static uint8_t* pkt_finish(uint8_t type, pkt_t *body, size_t *len) {
+    pkt_t out = {0};
+    pkt_u8(&out, type);
+    pkt_varint(&out, (uint32_t)body->len);
+    pkt_raw(&out, body->data, body->len);
+    bool failed = body->failed || out.failed || body->len > 268435455u;
+    free(body->data);
+    if (failed) {
+        free(out.data);
+        return NULL;
+    }
+    *len = out.len;
+    return out.data;
+}
+
+/* ============================================================================
+ * Connection
+ * ============================================================================ */
+
+static void drop_connection(mqtt_client_t *c, const char *why) {
+    if (c->connected && why) {
+        LOG_WARNING("MQTT: connection to %s:%u lost: %s", c->config.host, c->config.port, why);
+    }
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+    c->connected = false;
+    c->rx_len = 0;
+    c->ping_sent_ms = 0;
+}
+
+static bool send_all(mqtt_client_t *c, const uint8_t *data, size_t len) {
+    uint64_t deadline = get_time_ms() + (uint64_t)c->config.timeout_ms;
+    while (len > 0) {
+        ssize_t n = send(c->fd, data, len, MSG_NOSIGNAL);
+        if (n > 0) {
+            data += n;
+            len -= (size_t)n;
+            c->stats.bytes_out += (uint64_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            uint64_t now = get_time_ms();
+            if (now >= deadline) return false;
+            struct pollfd pfd = { .fd = c->fd, .events = POLLOUT };
+            poll(&pfd, 1, (int)(deadline - now));
+            continue;
+        }
+        return false;
+    }
+    c->last_send_ms = get_time_ms();
+    return true;
+}
+
+static int tcp_connect(const char *host, uint16_t port, int timeout_ms) {
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res;
+    if (getaddrinfo(host, service, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+
+        int err = 0;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            err = errno;
+            if (err == EINPROGRESS) {
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+                socklen_t elen = sizeof(err);
+                if (poll(&pfd, 1, timeout_ms) == 1 &&
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &elen) == 0) {
+                    /* err now holds the connect result */
+                } else {
+                    err = ETIMEDOUT;
+                }
+            }
+        }
+        if (err != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+/* Read what is available, waiting up to timeout_ms; -1 if the peer closed */
+static int rx_fill(mqtt_client_t *c, int timeout_ms) {
+    if (c->rx_len == sizeof(c->rx)) return 0;
+    if (timeout_ms > 0) {
+        struct pollfd pfd = { .fd = c->fd, .events = POLLIN };
+        if (poll(&pfd, 1, timeout_ms) <= 0) return 0;
+    }
+    ssize_t n = recv(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len, 0);
+    if (n > 0) {
+        c->rx_len += (size_t)n;
+        return (int)n;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    return -1;
+}
+
+/* Next complete packet in rx: 1 if found, 0 if incomplete, -1 if malformed */
+static int rx_packet(mqtt_client_t *c, uint8_t *type, const uint8_t **body, uint32_t *body_len,
+                     size_t *total) {
+    if (c->rx_len < 2) return 0;
+
+    uint32_t rem = 0;
+    size_t i = 1;
+    for (int shift = 0;; shift += 7, i++) {
+        if (shift > 21) return -1;
+        if (i >= c->rx_len) return 0;
+        rem |= (uint32_t)(c->rx[i] & 0x7f) << shift;
+        if (!(c->rx[i] & 0x80)) break;
+    }
+    size_t size = i + 1 + rem;
+    if (size > sizeof(c->rx)) return -1;   /* Nothing a publisher expects is this large */
+    if (c->rx_len < size) return 0;
+
+    *type = c->rx[0];
+    *body = c->rx + i + 1;
+    *body_len = rem;
+    *total = size;
+    return 1;
+}
+
+static void rx_consume(mqtt_client_t *c, size_t n) {
+    memmove(c->rx, c->rx + n, c->rx_len - n);
+    c->rx_len -= n;
+}
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} prop_reader_t;
+
+static bool read_varint(prop_reader_t *r, uint32_t *v) {
+    *v = 0;
+    for (int shift = 0; shift <= 21 && r->p < r->end; shift += 7) {
+        uint8_t b = *r->p++;
+        *v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+/* Apply the MQTT 5 CONNACK properties the client honours; skip the rest */
+static bool parse_connack_props(mqtt_client_t *c, prop_reader_t *r) {
+    uint32_t len;
+    if (!read_varint(r, &len) || len > (uint32_t)(r->end - r->p)) return false;
+    const uint8_t *end = r->p + len;
+
+    while (r->p < end) {
+        uint8_t id = *r->p++;
+        size_t fixed = 0;
+        switch (id) {
+            case 0x01: case 0x17: case 0x19: case 0x24: case 0x25:
+            case 0x28: case 0x29: case 0x2A:
+                fixed = 1; break;
+            case PROP_SERVER_KEEPALIVE: case PROP_RECEIVE_MAX: case 0x22: case 0x23:
+                fixed = 2; break;
+            case 0x02: case PROP_SESSION_EXPIRY: case 0x18: case 0x27:
+                fixed = 4; break;
+            case 0x0B: {
+                uint32_t skip;
+                if (!read_varint(r, &skip)) return false;
+                continue;
+            }
+            case PROP_CONTENT_TYPE: case 0x08: case 0x09: case 0x12: case 0x15: case 0x16:
+            case 0x1A: case 0x1C: case 0x1F: case PROP_USER: {
+                int strings = id == PROP_USER ? 2 : 1;
+                for (int s = 0; s < strings; s++) {
+                    if (end - r->p < 2) return false;
+                    size_t n = (size_t)(r->p[0] << 8 | r->p[1]);
+                    if ((size_t)(end - r->p) < 2 + n) return false;
+                    r->p += 2 + n;
+                }
+                continue;
+            }
+            default:
+                return false;
+        }
+        if ((size_t)(end - r->p) < fixed) return false;
+        if (id == PROP_RECEIVE_MAX) {
+            c->receive_max = (uint16_t)(r->p[0] << 8 | r->p[1]);
+        } else if (id == PROP_SERVER_KEEPALIVE) {
+            c->keepalive_s = r->p[0] << 8 | r->p[1];
+        }
+        r->p += fixed;
+    }
+    return true;
+}
+
+static uint8_t* build_connect(const mqtt_client_t *c, size_t *len) {
+    const mqtt_config_t *cfg = &c->config;
+    bool user = cfg->username[0] != '\0';
+    bool pass = user && cfg->password[0] != '\0';
+
+    pkt_t p = {0};
+    pkt_string(&p, "MQTT");
+    pkt_u8(&p, (uint8_t)cfg->version);
+    pkt_u8(&p, (uint8_t)((cfg->clean_session ? CONNECT_CLEAN : 0) |
+                         (user ? CONNECT_USERNAME : 0) | (pass ? CONNECT_PASSWORD : 0)));
+    pkt_u16(&p, (uint16_t)MAX(cfg->keepalive_s, 0));
+    if (cfg->version == MQTT_V5) {
+        if (cfg->session_expiry_s > 0 && !cfg->clean_session) {
+            pkt_varint(&p, 5);
+            pkt_u8(&p, PROP_SESSION_EXPIRY);
+            pkt_u32(&p, cfg->session_expiry_s);
+        } else {
+            pkt_varint(&p, 0);
+        }
+    }
+    pkt_string(&p, cfg->client_id);
+    if (user) pkt_string(&p, cfg->username);
+    if (pass) pkt_string(&p, cfg->password);
+    return pkt_finish(PKT_CONNECT, &p, len);
+}
+
+/* ============================================================================
+ * In-flight Messages
+ * ============================================================================ */
+
+static int find_inflight(const mqtt_client_t *c, uint16_t packet_id) {
+    for (int i = 0; i < c->count; i++) {
+        if (c->inflight[i].packet_id == packet_id) return i;
+    }
+    return -1;
+}
+
+static void remove_inflight(mqtt_client_t *c, int idx) {
+    free(c->inflight[idx].packet);
+    memmove(&c->inflight[idx], &c->inflight[idx + 1], (size_t)(c->count - idx - 1) * sizeof(inflight_t));
+    c->count--;
+}
+
+static uint16_t next_packet_id(mqtt_client_t *c) {
+    for (;;) {
+        uint16_t id = c->next_id++;
+        if (c->next_id == 0) c->next_id = 1;
+        if (id != 0 && find_inflight(c, id) < 0) return id;
+    }
+}
+
+/* Hand back failed messages as negative acks */
+static int emit_failed(mqtt_client_t *c, mqtt_ack_t *acks, int max) {
+    int n = 0;
+    for (int i = 0; i < c->count && n < max;) {
+        if (!c->inflight[i].failed) {
+            i++;
+            continue;
+        }
+        acks[n++] = (mqtt_ack_t){ .packet_id = c->inflight[i].packet_id, .ok = false };
+        c->stats.rejected++;
+        remove_inflight(c, i);
+    }
+    return n;
+}
+
+static void fail_all(mqtt_client_t *c) {
+    for (int i = 0; i < c->count; i++) c->inflight[i].failed = true;
+}
+
+/* Resend everything unacknowledged after a reconnect */
+static bool resend_inflight(mqtt_client_t *c, bool session_present) {
+    for (int i = 0; i < c->count; i++) {
+        inflight_t *m = &c->inflight[i];
+        if (m->failed) continue;
+        if (++m->attempts > MAX_ATTEMPTS) {
+            m->failed = true;
+            continue;
+        }
+        if (session_present) m->packet[0] |= PUBLISH_DUP;
+        else m->packet[0] &= (uint8_t)~PUBLISH_DUP;
+        if (!send_all(c, m->packet, m->len)) return false;
+        m->sent_ms = c->last_send_ms;
+        c->stats.retransmitted++;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * API
+ * ============================================================================ */
+
+result_t mqtt_client_create(const mqtt_config_t *config, mqtt_client_t **out) {
+    CHECK_NULL(config); CHECK_NULL(out);
+    if (config->host[0] == '\0' || config->client_id[0] == '\0') return RESULT_INVALID_PARAM;
+
+    mqtt_client_t *c = calloc(1, sizeof(*c));
+    if (!c) return RESULT_NO_MEMORY;
+
+    c->config = *config;
+    if (c->config.port == 0) c->config.port = 1883;
+    if (c->config.version != MQTT_V5) c->config.version = MQTT_V311;
+    if (c->config.timeout_ms <= 0) c->config.timeout_ms = 10000;
+    c->fd = -1;
+    c->next_id = 1;
+    *out = c;
+    return RESULT_OK;
+}
+
+void mqtt_client_destroy(mqtt_client_t *client) {
+    if (!client) return;
+    if (client->connected) {
+        static const uint8_t disconnect[2] = { PKT_DISCONNECT, 0 };
+        send_all(client, disconnect, sizeof(disconnect));
+    }
+    drop_connection(client, NULL);
+    mqtt_client_forget(client);
+    free(client->inflight);
+    free(client);
+}
+
+result_t mqtt_client_connect(mqtt_client_t *c) {
+    CHECK_NULL(c);
+    if (c->connected) return RESULT_OK;
+    drop_connection(c, NULL);
+
+    c->fd = tcp_connect(c->config.host, c->config.port, c->config.timeout_ms);
+    if (c->fd < 0) {
+        LOG_WARNING("MQTT: cannot reach %s:%u", c->config.host, c->config.port);
+        return RESULT_IO_ERROR;
+    }
+
+    c->receive_max = UINT16_MAX;
+    c->keepalive_s = c->config.keepalive_s;
+
+    size_t len;
+    uint8_t *connect = build_connect(c, &len);
+    bool sent = connect && send_all(c, connect, len);
+    free(connect);
+    if (!sent) {
+        drop_connection(c, NULL);
+        return RESULT_IO_ERROR;
+    }
+
+    /* Wait for CONNACK */
+    uint64_t deadline = get_time_ms() + (uint64_t)c->config.timeout_ms;
+    uint8_t type;
+    const uint8_t *body;
+    uint32_t body_len;
+    size_t total;
+    int r;
+    while ((r = rx_packet(c, &type, &body, &body_len, &total)) == 0) {
+        uint64_t now = get_time_ms();
+        if (now >= deadline || rx_fill(c, (int)(deadline - now)) < 0) break;
+    }
+    if (r != 1 || (type & 0xF0) != PKT_CONNACK || body_len < 2) {
+        LOG_WARNING("MQTT: no CONNACK from %s:%u", c->config.host, c->config.port);
+        drop_connection(c, NULL);
+        return r == 0 ? RESULT_TIMEOUT : RESULT_IO_ERROR;
+    }
+
+    bool session_present = (body[0] & 0x01) && !c->config.clean_session;
+    uint8_t code = body[1];
+    bool props_ok = true;
+    if (c->config.version == MQTT_V5 && body_len > 2) {
+        prop_reader_t pr = { body + 2, body + body_len };
+        props_ok = parse_connack_props(c, &pr);
+    }
+    rx_consume(c, total);
+
+    if (code != 0 || !props_ok) {
+        LOG_ERROR("MQTT: %s:%u refused the connection (code 0x%02x)",
+                  c->config.host, c->config.port, code);
+        drop_connection(c, NULL);
+        return RESULT_ERROR;
+    }
+    if (c->receive_max == 0) c->receive_max = UINT16_MAX;
+
+    c->connected = true;
+    c->stats.connects++;
+    if (session_present) c->stats.sessions_resumed++;
+    LOG_INFO("MQTT: connected to %s:%u (%s, %s session)", c->config.host, c->config.port,
+             c->config.version == MQTT_V5 ? "v5" : "v3.1.1",
+             session_present ? "resumed" : c->config.clean_session ? "clean" : "new");
+
+    if (!resend_inflight(c, session_present)) {
+        drop_connection(c, "resend failed");
+        return RESULT_IO_ERROR;
+    }
+    return RESULT_OK;
+}
+
+bool mqtt_client_is_connected(const mqtt_client_t *client) {
+    return client && client->connected;
+}
+
+result_t mqtt_client_publish(mqtt_client_t *c, const char *topic, const void *payload,
+                             size_t len, const mqtt_props_t *props, uint16_t *packet_id) {
+    CHECK_NULL(c); CHECK_NULL(topic);
+    if (len > 0 && !payload) return RESULT_INVALID_PARAM;
+    if (c->connected && c->count >= c->receive_max) return RESULT_BUSY;
+    if (!c->connected) {
+        result_t r = mqtt_client_connect(c);
+        if (r != RESULT_OK) return r;
+        if (c->count >= c->receive_max) return RESULT_BUSY;
+    }
+
+    if (c->count == c->cap) {
+        int cap = c->cap ? c->cap * 2 : 32;
+        inflight_t *grown = realloc(c->inflight, (size_t)cap * sizeof(*grown));
+        if (!grown) return RESULT_NO_MEMORY;
+        c->inflight = grown;
+        c->cap = cap;
+    }
+
+    uint16_t id = next_packet_id(c);
+    pkt_t p = {0};
+    pkt_string(&p, topic);
+    pkt_u16(&p, id);
+    if (c->config.version == MQTT_V5) {
+        pkt_t pr = {0};
+        if (props && props->content_type) {
+            pkt_u8(&pr, PROP_CONTENT_TYPE);
+            pkt_string(&pr, props->content_type);
+        }
+        if (props && props->user_key && props->user_value) {
+            pkt_u8(&pr, PROP_USER);
+            pkt_string(&pr, props->user_key);
+            pkt_string(&pr, props->user_value);
+        }
+        pkt_varint(&p, (uint32_t)pr.len);
+        pkt_raw(&p, pr.data, pr.len);
+        if (pr.failed) p.failed = true;
+        free(pr.data);
+    }
+    pkt_raw(&p, payload, len);
+
+    size_t size;
+    uint8_t *packet = pkt_finish(PKT_PUBLISH | PUBLISH_QOS1, &p, &size);
+    if (!packet) return RESULT_NO_MEMORY;
+
+    c->inflight[c->count++] = (inflight_t){
+        .packet_id = id,
+        .attempts = 1,
+        .sent_ms = get_time_ms(),
+        .packet = packet,
+        .len = size,
+    };
+    c->stats.published++;
+
+    /* Kept in flight either way; poll() reconnects and resends */
+    if (!send_all(c, packet, size)) drop_connection(c, "send failed");
+
+    if (packet_id) *packet_id = id;
+    return RESULT_OK;
+}
+
+/* Handle complete packets in rx; returns acks written */
+static int process_rx(mqtt_client_t *c, mqtt_ack_t *acks, int max) {
+    int n = 0;
+    while (c->connected && n < max) {
+        uint8_t type;
+        const uint8_t *body;
+        uint32_t body_len;
+        size_t total;
+        int r = rx_packet(c, &type, &body, &body_len, &total);
+        if (r == 0) break;
+        if (r < 0) {
+            drop_connection(c, "malformed packet");
+            break;
+        }
+
+        switch (type & 0xF0) {
+            case PKT_PUBACK:
+                if (body_len >= 2) {
+                    uint16_t id = (uint16_t)(body[0] << 8 | body[1]);
+                    uint8_t reason = (c->config.version == MQTT_V5 && body_len >= 3) ? body[2] : 0;
+                    int idx = find_inflight(c, id);
+                    if (idx >= 0) {
+                        bool ok = reason < REASON_FAILURE;
+                        acks[n++] = (mqtt_ack_t){ .packet_id = id, .ok = ok, .reason = reason };
+                        if (ok) c->stats.acked++;
+                        else c->stats.rejected++;
+                        remove_inflight(c, idx);
+                    }
+                }
+                break;
+            case PKT_PINGRESP:
+                c->ping_sent_ms = 0;
+                break;
+            case PKT_DISCONNECT:
+                rx_consume(c, total);
+                drop_connection(c, "broker sent DISCONNECT");
+                return n;
+            default:
+                break;      /* Nothing else is expected by a publisher */
+        }
+        rx_consume(c, total);
+    }
+    return n;
+}
+
+/* PINGREQ when idle for half the keep-alive; false if the broker stopped answering */
+static bool keep_alive(mqtt_client_t *c, uint64_t now) {
+    if (c->keepalive_s <= 0) return true;
+    if (c->ping_sent_ms) return now - c->ping_sent_ms <= (uint64_t)c->config.timeout_ms;
+    if (now - c->last_send_ms < (uint64_t)c->keepalive_s * 500) return true;
+
+    static const uint8_t ping[2] = { PKT_PINGREQ, 0 };
+    if (!send_all(c, ping, sizeof(ping))) return false;
+    c->ping_sent_ms = now;
+    return true;
+}
+
+static bool ack_overdue(const mqtt_client_t *c, uint64_t now) {
+    for (int i = 0; i < c->count; i++) {
+        if (!c->inflight[i].failed &&
+            now - c->inflight[i].sent_ms > (uint64_t)c->config.timeout_ms) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int mqtt_client_poll(mqtt_client_t *c, int timeout_ms, mqtt_ack_t *acks, int max) {
+    if (!c || !acks || max <= 0) return 0;
+
+    uint64_t deadline = get_time_ms() + (uint64_t)MAX(timeout_ms, 0);
+    int n = emit_failed(c, acks, max);
+
+    for (;;) {
+        if (!c->connected && c->count > 0 && mqtt_client_connect(c) != RESULT_OK) {
+            fail_all(c);
+        }
+        n += emit_failed(c, acks + n, max - n);
+
+        if (c->connected) {
+            uint64_t now = get_time_ms();
+            if (rx_fill(c, 0) < 0) {
+                drop_connection(c, "closed by broker");
+            } else if (!keep_alive(c, now)) {
+                drop_connection(c, "keep-alive timeout");
+            } else {
+                n += process_rx(c, acks + n, max - n);
+                if (c->connected && ack_overdue(c, now)) drop_connection(c, "ack timeout");
+            }
+            if (!c->connected && c->count > 0) continue;    /* Reconnect and resend */
+        }
+
+        if (n > 0 || c->count == 0 || !c->connected) break;
+
+        uint64_t now = get_time_ms();
+        if (now >= deadline) break;
+        if (rx_fill(c, (int)MIN(deadline - now, (uint64_t)c->config.timeout_ms)) < 0) {
+            drop_connection(c, "closed by broker");
+        }
+    }
+    return n;
+}
+
+int mqtt_client_in_flight(const mqtt_client_t *client) {
+    return client ? client->count : 0;
+}
+
+void mqtt_client_forget(mqtt_client_t *client) {
+    if (!client) return;
+    for (int i = 0; i < client->count; i++) free(client->inflight[i].packet);
+    client->count = 0;
+}
+
+void mqtt_client_get_stats(const mqtt_client_t *client, mqtt_stats_t *stats) {
+    if (!stats) return;
+    if (client) *stats = client->stats;
+    else memset(stats, 0, sizeof(*stats));
+}
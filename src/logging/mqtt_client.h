@@ -0,0 +1,111 @@
+/**
+ * @file mqtt_client.h
+ * @brief Minimal MQTT 3.1.1 / 5.0 publisher over TCP
+ *
+ * Just enough MQTT to publish telemetry: CONNECT with an optional
+ * persistent session, QoS 1 PUBLISH with any number of messages awaiting
+ * PUBACK (up to the broker's Receive Maximum), keep-alive PINGREQ and
+ * DISCONNECT. There are no subscriptions and no TLS.
+ *
+ * The client keeps every unacknowledged message. When the connection
+ * drops or an ack is overdue it reconnects on the next poll and sends
+ * them again with their original packet identifiers, flagged DUP when the
+ * broker resumed the session, so a broken link alone does not fail a
+ * message. Messages fail only when the broker refuses them or cannot be
+ * reached again.
+ *
+ * A client is used by one thread.
+ */
+
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include "common.h"
+
+typedef struct mqtt_client mqtt_client_t;
+
+typedef enum {
+    MQTT_V311 = 4,              /* Protocol level on the wire */
+    MQTT_V5 = 5
+} mqtt_version_t;
+
+typedef struct {
+    char host[MAX_PATH_LEN];
+    uint16_t port;
+    mqtt_version_t version;
+    char client_id[MAX_NAME_LEN + 8];
+    char username[MAX_NAME_LEN];
+    char password[MAX_CONFIG_VALUE_LEN];
+    bool clean_session;
+    uint32_t session_expiry_s;  /* MQTT 5: how long the broker keeps the session */
+    int keepalive_s;
+    int timeout_ms;             /* Connect, and longest wait for an ack */
+} mqtt_config_t;
+
+/* MQTT 5 publish properties; ignored for 3.1.1 */
+typedef struct {
+    const char *content_type;
+    const char *user_key;       /* One user property, e.g. an idempotency key */
+    const char *user_value;
+} mqtt_props_t;
+
+typedef struct {
+    uint16_t packet_id;
+    bool ok;
+    uint8_t reason;             /* PUBACK reason code (MQTT 5), 0 otherwise */
+} mqtt_ack_t;
+
+typedef struct {
+    uint64_t connects;
+    uint64_t sessions_resumed;
+    uint64_t published;
+    uint64_t acked;
+    uint64_t rejected;
+    uint64_t retransmitted;
+    uint64_t bytes_out;
+} mqtt_stats_t;
+
+result_t mqtt_client_create(const mqtt_config_t *config, mqtt_client_t **out);
+
+/**
+ * @brief Disconnect cleanly and free the client and anything unacknowledged
+ */
+void mqtt_client_destroy(mqtt_client_t *client);
+
+/**
+ * @brief Connect (blocking, up to timeout_ms) and resend unacknowledged messages
+ * @return RESULT_OK, RESULT_IO_ERROR, RESULT_TIMEOUT, or RESULT_ERROR if refused
+ */
+result_t mqtt_client_connect(mqtt_client_t *client);
+
+bool mqtt_client_is_connected(const mqtt_client_t *client);
+
+/**
+ * @brief Send a QoS 1 message; connects first if needed
+ * @param packet_id Identifier its ack will carry
+ * @return RESULT_OK, RESULT_BUSY at the broker's Receive Maximum,
+ *         or a connect error
+ */
+result_t mqtt_client_publish(mqtt_client_t *client, const char *topic, const void *payload,
+                             size_t len, const mqtt_props_t *props, uint16_t *packet_id);
+
+/**
+ * @brief Read acks, keep the connection alive, recover a lost connection
+ *
+ * Waits up to timeout_ms for at least one ack while messages are
+ * outstanding. A message that cannot be delivered is returned with ok
+ * false.
+ * @return Number of acks written
+ */
+int mqtt_client_poll(mqtt_client_t *client, int timeout_ms, mqtt_ack_t *acks, int max);
+
+int mqtt_client_in_flight(const mqtt_client_t *client);
+
+/**
+ * @brief Forget every unacknowledged message without failing it
+ */
+void mqtt_client_forget(mqtt_client_t *client);
+
+void mqtt_client_get_stats(const mqtt_client_t *client, mqtt_stats_t *stats);
+
+#endif
@@ -0,0 +1,702 @@
+/**
+ * @file spool.c
+ * @brief Disk-backed, segmented store-and-forward spool
+ *
+ * Layout of the spool directory:
+ *   <seq>.seg   Segment files, 16 hex digits, segment_bytes long with
+ *               every block allocated at creation (posix_fallocate), so
+ *               a full disk fails the create rather than raising SIGBUS
+ *               on a later write through the mapping. A segment header
+ *               is followed by records packed on 8-byte boundaries; a
+ *               zero length field ends the data.
+ *   cursor      Sequence and offset of the next record to deliver,
+ *               replaced atomically (write, fsync, rename).
+ *
+ * Segments form a contiguous sequence range [first_seq, write.seq]. The
+ * newest is mapped read/write for appends; the reader keeps its own
+ * read-only mapping of the cursor's segment, so appends never move data a
+ * caller is holding from spool_peek().
+ */
+
+#include "spool.h"
+#include "utils/logger.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SEGMENT_MAGIC       0x50535457u     /* "WTSP" */
+#define SEGMENT_VERSION     1
+#define CURSOR_MAGIC        0x52435457u     /* "WTCR" */
+#define RECORD_ALIGN        8
+#define MIN_SEGMENT_BYTES   4096
+#define SKIP_SPANS          64
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t segment_bytes;
+    uint32_t reserved;
+    uint64_t sequence;
+    int64_t created;
+} segment_header_t;
+
+typedef struct {
+    uint32_t len;               /* Payload bytes; 0 terminates the segment */
+    uint32_t crc;               /* CRC32 of timestamp and payload */
+    int64_t timestamp;
+} record_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t offset;
+    uint64_t segment;
+    uint32_t crc;               /* CRC32 of the fields above */
+    uint32_t reserved;
+} cursor_file_t;
+
+typedef struct {
+    uint64_t seq;               /* 0 = not mapped */
+    int fd;
+    uint8_t *map;
+    uint32_t size;
+} segment_map_t;
+
+struct spool {
+    spool_config_t config;
+    pthread_mutex_t mutex;
+
+    uint64_t first_seq;         /* Oldest segment on disk */
+    segment_map_t write;        /* Newest segment, appended to */
+    uint32_t write_offset;
+
+    segment_map_t read;         /* Segment the reader is in */
+    spool_pos_t cursor;         /* Persisted delivery position */
+
+    /*
+     * Records skipped by peeks, settled when a commit passes them. Several
+     * batches may be peeked ahead of the cursor before the first commits.
+     */
+    struct {
+        spool_pos_t end;
+        uint64_t expired;
+        uint64_t corrupt;
+    } skips[SKIP_SPANS];
+    int skip_count;
+    spool_pos_t peek_high;      /* Skips before this are already recorded */
+
+    spool_stats_t stats;
+};
+
+#define HEADER_SIZE ((uint32_t)sizeof(segment_header_t))
+
+/* ============================================================================
+ * CRC32 (IEEE 802.3, reflected)
+ * ============================================================================ */
+
+static uint32_t g_crc_table[256];
+static pthread_once_t g_crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        g_crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--) {
+        crc = g_crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t record_crc(int64_t timestamp, const void *data, uint32_t len) {
+    uint32_t crc = crc32_update(0, &timestamp, sizeof(timestamp));
+    return crc32_update(crc, data, len);
+}
+
+/* ============================================================================
+ * Segment Files
+ * ============================================================================ */
+
+static uint32_t record_size(uint32_t len) {
+    uint32_t size = (uint32_t)sizeof(record_header_t) + len;
+    return (size + RECORD_ALIGN - 1) & ~(uint32_t)(RECORD_ALIGN - 1);
+}
+
+static void segment_path(const spool_t *spool, uint64_t seq, char *buf, size_t size) {
+    snprintf(buf, size, "%s/%016llx.seg", spool->config.dir, (unsigned long long)seq);
+}
+
+static void unmap_segment(segment_map_t *m) {
+    if (m->map) munmap(m->map, m->size);
+    if (m->fd >= 0) close(m->fd);
+    memset(m, 0, sizeof(*m));
+    m->fd = -1;
+}
+
+static bool header_valid(const segment_map_t *m, uint64_t seq) {
+    if (m->size < HEADER_SIZE) return false;
+    const segment_header_t *h = (const segment_header_t *)m->map;
+    return h->magic == SEGMENT_MAGIC && h->version == SEGMENT_VERSION &&
+           h->header_size == HEADER_SIZE && h->sequence == seq &&
+           h->segment_bytes == m->size;
+}
+
+/* Map an existing segment read-only */
+static result_t map_segment(const spool_t *spool, uint64_t seq, segment_map_t *m) {
+    char path[MAX_PATH_LEN + 32];
+    segment_path(spool, seq, path, sizeof(path));
+
+    memset(m, 0, sizeof(*m));
+    m->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (m->fd < 0) return errno == ENOENT ? RESULT_NOT_FOUND : RESULT_IO_ERROR;
+
+    struct stat st;
+    if (fstat(m->fd, &st) != 0 || st.st_size < HEADER_SIZE || st.st_size > UINT32_MAX) {
+        unmap_segment(m);
+        return RESULT_IO_ERROR;
+    }
+    m->size = (uint32_t)st.st_size;
+    m->map = mmap(NULL, m->size, PROT_READ, MAP_SHARED, m->fd, 0);
+    if (m->map == MAP_FAILED) {
+        m->map = NULL;
+        unmap_segment(m);
+        return RESULT_IO_ERROR;
+    }
+    if (!header_valid(m, seq)) {
+        unmap_segment(m);
+        return RESULT_ERROR;
+    }
+    m->seq = seq;
+    return RESULT_OK;
+}
+
+/* Map a segment read/write, creating and sizing it if needed */
+static result_t map_segment_rw(const spool_t *spool, uint64_t seq, bool create, segment_map_t *m) {
+    char path[MAX_PATH_LEN + 32];
+    segment_path(spool, seq, path, sizeof(path));
+
+    memset(m, 0, sizeof(*m));
+    m->fd = open(path, O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644);
+    if (m->fd < 0) return RESULT_IO_ERROR;
+
+    uint32_t size = spool->config.segment_bytes;
+    if (!create) {
+        struct stat st;
+        if (fstat(m->fd, &st) != 0 || st.st_size < HEADER_SIZE || st.st_size > UINT32_MAX) {
+            unmap_segment(m);
+            return RESULT_IO_ERROR;
+        }
+        size = (uint32_t)st.st_size;
+    } else {
+        /* Not sparse: ENOSPC must show up here, not as SIGBUS in spool_append() */
+        int err = posix_fallocate(m->fd, 0, size);
+        if (err != 0) {
+            unmap_segment(m);
+            unlink(path);
+            errno = err;    /* Callers report strerror(errno) */
+            return RESULT_IO_ERROR;
+        }
+    }
+
+    m->size = size;
+    m->map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+    if (m->map == MAP_FAILED) {
+        m->map = NULL;
+        unmap_segment(m);
+        if (create) unlink(path);
+        return RESULT_IO_ERROR;
+    }
+    m->seq = seq;
+
+    if (create) {
+        segment_header_t h = {
+            .magic = SEGMENT_MAGIC,
+            .version = SEGMENT_VERSION,
+            .header_size = HEADER_SIZE,
+            .segment_bytes = size,
+            .sequence = seq,
+            .created = (int64_t)time(NULL),
+        };
+        memcpy(m->map, &h, sizeof(h));
+    } else if (!header_valid(m, seq)) {
+        unmap_segment(m);
+        return RESULT_ERROR;
+    }
+    return RESULT_OK;
+}
+
+/* Header of a well-formed record at off, or NULL at the end of valid data */
+static const record_header_t* record_at(const segment_map_t *m, uint32_t off) {
+    if ((uint64_t)off + sizeof(record_header_t) > m->size) return NULL;
+
+    const record_header_t *r = (const record_header_t *)(m->map + off);
+    if (r->len == 0 || r->len > m->size) return NULL;
+    if ((uint64_t)off + record_size(r->len) > m->size) return NULL;
+    if (r->crc != record_crc(r->timestamp, r + 1, r->len)) return NULL;
+    return r;
+}
+
+static bool at_terminator(const segment_map_t *m, uint32_t off) {
+    if ((uint64_t)off + sizeof(uint32_t) > m->size) return true;
+    uint32_t len;
+    memcpy(&len, m->map + off, sizeof(len));
+    return len == 0;
+}
+
+static uint64_t count_records(const segment_map_t *m, uint32_t off) {
+    uint64_t n = 0;
+    const record_header_t *r;
+    while ((r = record_at(m, off)) != NULL) {
+        off += record_size(r->len);
+        n++;
+    }
+    return n;
+}
+
+static void remove_segment(const spool_t *spool, uint64_t seq) {
+    char path[MAX_PATH_LEN + 32];
+    segment_path(spool, seq, path, sizeof(path));
+    if (unlink(path) != 0 && errno != ENOENT) {
+        LOG_WARNING("Spool: cannot remove %s: %s", path, strerror(errno));
+    }
+}
+
+/* ============================================================================
+ * Cursor
+ * ============================================================================ */
+
+static uint32_t cursor_crc(const cursor_file_t *c) {
+    return crc32_update(0, c, offsetof(cursor_file_t, crc));
+}
+
+static bool load_cursor(const spool_t *spool, spool_pos_t *pos) {
+    char path[MAX_PATH_LEN + 32];
+    snprintf(path, sizeof(path), "%s/cursor", spool->config.dir);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    cursor_file_t c;
+    ssize_t n = read(fd, &c, sizeof(c));
+    close(fd);
+
+    if (n != (ssize_t)sizeof(c) || c.magic != CURSOR_MAGIC || c.crc != cursor_crc(&c)) {
+        LOG_WARNING("Spool: cursor file invalid, restarting from oldest segment");
+        return false;
+    }
+    pos->segment = c.segment;
+    pos->offset = c.offset;
+    return true;
+}
+
+static result_t save_cursor(const spool_t *spool) {
+    char path[MAX_PATH_LEN + 32];
+    char tmp[MAX_PATH_LEN + 32];
+    snprintf(path, sizeof(path), "%s/cursor", spool->config.dir);
+    snprintf(tmp, sizeof(tmp), "%s/cursor.tmp", spool->config.dir);
+
+    cursor_file_t c = {
+        .magic = CURSOR_MAGIC,
+        .offset = spool->cursor.offset,
+        .segment = spool->cursor.segment,
+    };
+    c.crc = cursor_crc(&c);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return RESULT_IO_ERROR;
+
+    bool ok = write(fd, &c, sizeof(c)) == (ssize_t)sizeof(c) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmp, path) != 0) {
+        LOG_WARNING("Spool: cannot persist cursor: %s", strerror(errno));
+        return RESULT_IO_ERROR;
+    }
+
+    /* Make the rename itself durable */
+    int dfd = open(spool->config.dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd >= 0) {
+        fsync(dfd);
+        close(dfd);
+    }
+    return RESULT_OK;
+}
+
+/* Point the read mapping at seq; false if the segment is unreadable */
+static bool reader_enter(spool_t *spool, uint64_t seq) {
+    if (spool->read.seq == seq) return true;
+    unmap_segment(&spool->read);
+    return map_segment(spool, seq, &spool->read) == RESULT_OK;
+}
+
+/* Delete segments the cursor has left behind */
+static void release_consumed(spool_t *spool) {
+    while (spool->first_seq < spool->cursor.segment) {
+        if (spool->read.seq == spool->first_seq) unmap_segment(&spool->read);
+        remove_segment(spool, spool->first_seq);
+        spool->first_seq++;
+    }
+}
+
+static int pos_cmp(const spool_pos_t *a, const spool_pos_t *b) {
+    if (a->segment != b->segment) return a->segment < b->segment ? -1 : 1;
+    if (a->offset != b->offset) return a->offset < b->offset ? -1 : 1;
+    return 0;
+}
+
+/* Remember records a peek skipped past the high-water mark */
+static void record_skips(spool_t *spool, const spool_pos_t *end, uint64_t expired, uint64_t corrupt) {
+    if (pos_cmp(end, &spool->peek_high) > 0) spool->peek_high = *end;
+    if (expired + corrupt == 0) return;
+
+    if (spool->skip_count == SKIP_SPANS) {
+        /* Out of spans: fold into the last, settled a little later */
+        spool->skips[SKIP_SPANS - 1].end = *end;
+        spool->skips[SKIP_SPANS - 1].expired += expired;
+        spool->skips[SKIP_SPANS - 1].corrupt += corrupt;
+        return;
+    }
+    spool->skips[spool->skip_count].end = *end;
+    spool->skips[spool->skip_count].expired = expired;
+    spool->skips[spool->skip_count].corrupt = corrupt;
+    spool->skip_count++;
+}
+
+/* Pop the spans that end at or before upto; returns records skipped in them */
+static uint64_t settle_skips(spool_t *spool, const spool_pos_t *upto, bool count) {
+    uint64_t settled = 0;
+    int i = 0;
+    while (i < spool->skip_count && pos_cmp(&spool->skips[i].end, upto) <= 0) {
+        if (count) {
+            spool->stats.expired += spool->skips[i].expired;
+            spool->stats.corrupt += spool->skips[i].corrupt;
+            settled += spool->skips[i].expired + spool->skips[i].corrupt;
+        }
+        i++;
+    }
+    spool->skip_count -= i;
+    memmove(spool->skips, spool->skips + i, (size_t)spool->skip_count * sizeof(spool->skips[0]));
+    return settled;
+}
+
+/* ============================================================================
+ * Caps
+ * ============================================================================ */
+
+static uint64_t disk_bytes(const spool_t *spool) {
+    return (spool->write.seq - spool->first_seq + 1) * (uint64_t)spool->config.segment_bytes;
+}
+
+/* Drop the oldest segments, unsent, until the backlog fits the size cap */
+static void enforce_size_cap(spool_t *spool) {
+    while (spool->first_seq < spool->write.seq && disk_bytes(spool) > spool->config.max_bytes) {
+        uint64_t lost = 0;
+        if (spool->cursor.segment == spool->first_seq && reader_enter(spool, spool->first_seq)) {
+            lost = count_records(&spool->read, spool->cursor.offset);
+        }
+        spool->stats.dropped += lost;
+        spool->stats.backlog -= MIN(lost, spool->stats.backlog);
+
+        if (spool->cursor.segment <= spool->first_seq) {
+            spool->cursor.segment = spool->first_seq + 1;
+            spool->cursor.offset = HEADER_SIZE;
+            settle_skips(spool, &spool->cursor, false);     /* Counted in lost */
+            save_cursor(spool);
+        }
+        LOG_WARNING("Spool: size cap reached, dropped segment %llu (%llu records unsent)",
+                    (unsigned long long)spool->first_seq, (unsigned long long)lost);
+        release_consumed(spool);
+    }
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+result_t spool_open(const spool_config_t *config, spool_t **out) {
+    CHECK_NULL(config); CHECK_NULL(out);
+    pthread_once(&g_crc_once, crc_table_init);
+
+    spool_t *spool = calloc(1, sizeof(*spool));
+    if (!spool) return RESULT_NO_MEMORY;
+
+    spool->config = *config;
+    spool->config.segment_bytes = MAX(config->segment_bytes, MIN_SEGMENT_BYTES) &
+                                  ~(uint32_t)(RECORD_ALIGN - 1);
+    /* The active segment and the one being read must both fit */
+    spool->config.max_bytes = MAX(config->max_bytes, 2 * (uint64_t)spool->config.segment_bytes);
+    spool->write.fd = -1;
+    spool->read.fd = -1;
+    pthread_mutex_init(&spool->mutex, NULL);
+
+    if (mkdir(spool->config.dir, 0755) != 0 && errno != EEXIST) {
+        LOG_ERROR("Spool: cannot create %s: %s", spool->config.dir, strerror(errno));
+        spool_close(spool);
+        return RESULT_IO_ERROR;
+    }
+
+    /* Find the segment range on disk */
+    DIR *dir = opendir(spool->config.dir);
+    if (!dir) {
+        LOG_ERROR("Spool: cannot open %s: %s", spool->config.dir, strerror(errno));
+        spool_close(spool);
+        return RESULT_IO_ERROR;
+    }
+    uint64_t first = 0, last = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        unsigned long long seq;
+        char tail[8];
+        if (strlen(de->d_name) != 20 ||
+            sscanf(de->d_name, "%16llx%7s", &seq, tail) != 2 ||
+            strcmp(tail, ".seg") != 0 || seq == 0) {
+            continue;
+        }
+        if (first == 0 || seq < first) first = seq;
+        if (seq > last) last = seq;
+    }
+    closedir(dir);
+
+    bool have_cursor = load_cursor(spool, &spool->cursor);
+
+    /* Reopen the newest segment for appends, or start a new one */
+    result_t r = RESULT_ERROR;
+    if (last > 0) {
+        r = map_segment_rw(spool, last, false, &spool->write);
+        if (r == RESULT_OK && spool->write.size != spool->config.segment_bytes) {
+            unmap_segment(&spool->write);       /* Resized by config: seal it */
+            r = RESULT_ERROR;
+        }
+    }
+    if (r == RESULT_OK) {
+        uint32_t off = HEADER_SIZE;
+        const record_header_t *rec;
+        while ((rec = record_at(&spool->write, off)) != NULL) {
+            off += record_size(rec->len);
+        }
+        if (!at_terminator(&spool->write, off)) {
+            /* Torn tail from a crash: clear it so appends start clean */
+            spool->stats.corrupt++;
+            memset(spool->write.map + off, 0, spool->write.size - off);
+            LOG_WARNING("Spool: discarded torn tail of segment %llu at offset %u",
+                        (unsigned long long)last, off);
+        }
+        spool->write_offset = off;
+    } else {
+        uint64_t seq = MAX(last + 1, have_cursor ? spool->cursor.segment : 1);
+        if (map_segment_rw(spool, seq, true, &spool->write) != RESULT_OK) {
+            LOG_ERROR("Spool: cannot create segment in %s: %s",
+                      spool->config.dir, strerror(errno));
+            spool_close(spool);
+            return RESULT_IO_ERROR;
+        }
+        spool->write_offset = HEADER_SIZE;
+        if (first == 0) first = seq;
+    }
+    spool->first_seq = first;
+
+    /* Clamp the cursor into the range that exists */
+    if (!have_cursor || spool->cursor.segment < spool->first_seq) {
+        spool->cursor.segment = spool->first_seq;
+        spool->cursor.offset = HEADER_SIZE;
+    } else if (spool->cursor.segment > spool->write.seq) {
+        spool->cursor.segment = spool->write.seq;
+        spool->cursor.offset = HEADER_SIZE;
+    }
+    if (spool->cursor.segment == spool->write.seq) {
+        spool->cursor.offset = MIN(MAX(spool->cursor.offset, HEADER_SIZE), spool->write_offset);
+    }
+
+    /* Remove segments already delivered before the restart */
+    release_consumed(spool);
+
+    /* Count what is still owed to the remote end */
+    for (uint64_t seq = spool->cursor.segment; seq <= spool->write.seq; seq++) {
+        if (!reader_enter(spool, seq)) continue;
+        uint32_t off = seq == spool->cursor.segment ? spool->cursor.offset : HEADER_SIZE;
+        spool->stats.backlog += count_records(&spool->read, off);
+    }
+    unmap_segment(&spool->read);
+
+    enforce_size_cap(spool);
+
+    LOG_INFO("Spool opened at %s (%llu segments, %llu records pending)",
+             spool->config.dir,
+             (unsigned long long)(spool->write.seq - spool->first_seq + 1),
+             (unsigned long long)spool->stats.backlog);
+    *out = spool;
+    return RESULT_OK;
+}
+
+void spool_close(spool_t *spool) {
+    if (!spool) return;
+    if (spool->write.map) {
+        msync(spool->write.map, spool->write.size, MS_SYNC);
+    }
+    unmap_segment(&spool->write);
+    unmap_segment(&spool->read);
+    pthread_mutex_destroy(&spool->mutex);
+    free(spool);
+}
+
+result_t spool_append(spool_t *spool, const void *data, uint32_t len, time_t timestamp) {
+    CHECK_NULL(spool);
+    if (!data || len == 0) return RESULT_INVALID_PARAM;
+
+    uint32_t size = record_size(len);
+    if ((uint64_t)size + HEADER_SIZE > spool->config.segment_bytes) return RESULT_INVALID_PARAM;
+
+    pthread_mutex_lock(&spool->mutex);
+
+    if ((uint64_t)spool->write_offset + size > spool->write.size) {
+        /* Seal the full segment and roll over to the next */
+        msync(spool->write.map, spool->write.size, MS_SYNC);
+        segment_map_t next;
+        if (map_segment_rw(spool, spool->write.seq + 1, true, &next) != RESULT_OK) {
+            pthread_mutex_unlock(&spool->mutex);
+            LOG_ERROR("Spool: cannot create segment %llu: %s",
+                      (unsigned long long)(spool->write.seq + 1), strerror(errno));
+            return RESULT_IO_ERROR;
+        }
+        unmap_segment(&spool->write);
+        spool->write = next;
+        spool->write_offset = HEADER_SIZE;
+        enforce_size_cap(spool);
+    }
+
+    record_header_t hdr = {
+        .len = len,
+        .timestamp = (int64_t)timestamp,
+    };
+    hdr.crc = record_crc(hdr.timestamp, data, len);
+
+    uint8_t *dst = spool->write.map + spool->write_offset;
+    memcpy(dst + sizeof(hdr), data, len);
+    memcpy(dst, &hdr, sizeof(hdr));
+    spool->write_offset += size;
+
+    spool->stats.appended++;
+    spool->stats.backlog++;
+
+    pthread_mutex_unlock(&spool->mutex);
+    return RESULT_OK;
+}
+
+result_t spool_sync(spool_t *spool) {
+    CHECK_NULL(spool);
+
+    pthread_mutex_lock(&spool->mutex);
+    int rc = msync(spool->write.map, spool->write_offset, MS_SYNC);
+    pthread_mutex_unlock(&spool->mutex);
+
+    return rc == 0 ? RESULT_OK : RESULT_IO_ERROR;
+}
+
+static result_t commit_locked(spool_t *spool, const spool_pos_t *end, uint64_t count) {
+    if (pos_cmp(end, &spool->cursor) <= 0) return RESULT_OK;   /* Stale */
+
+    uint64_t skipped = settle_skips(spool, end, true);
+
+    spool->cursor = *end;
+    spool->stats.committed += count;
+    spool->stats.backlog -= MIN(count + skipped, spool->stats.backlog);
+
+    result_t r = save_cursor(spool);
+    release_consumed(spool);
+    return r;
+}
+
+int spool_peek_from(spool_t *spool, const spool_pos_t *from, spool_record_t *out, int max,
+                    spool_pos_t *end) {
+    if (!spool || !out || !end || max <= 0) return 0;
+
+    pthread_mutex_lock(&spool->mutex);
+
+    time_t cutoff = spool->config.max_age_seconds > 0 ?
+        time(NULL) - (time_t)spool->config.max_age_seconds : 0;
+    spool_pos_t pos = spool->cursor;
+    if (from && pos_cmp(from, &pos) > 0) pos = *from;
+    bool at_cursor = pos_cmp(&pos, &spool->cursor) == 0;
+    uint64_t expired = 0, corrupt = 0;
+    int n = 0;
+
+    while (n < max) {
+        bool sealed = pos.segment < spool->write.seq;
+
+        if (!reader_enter(spool, pos.segment)) {
+            if (!sealed) break;
+            LOG_WARNING("Spool: segment %llu unreadable, skipping",
+                        (unsigned long long)pos.segment);
+            pos.segment++;
+            pos.offset = HEADER_SIZE;
+            continue;
+        }
+
+        bool fresh = pos_cmp(&pos, &spool->peek_high) >= 0;
+        const record_header_t *rec = record_at(&spool->read, pos.offset);
+        if (!rec) {
+            if (!sealed) break;
+            if (!at_terminator(&spool->read, pos.offset) && fresh) corrupt++;
+            /* Moving on unmaps this segment, so hand back what we have first */
+            pos.segment++;
+            pos.offset = HEADER_SIZE;
+            if (n > 0) break;
+            continue;
+        }
+
+        pos.offset += record_size(rec->len);
+        if (cutoff && rec->timestamp < cutoff) {
+            if (fresh) expired++;
+            continue;
+        }
+
+        out[n].data = rec + 1;
+        out[n].len = rec->len;
+        out[n].timestamp = (time_t)rec->timestamp;
+        n++;
+    }
+
+    record_skips(spool, &pos, expired, corrupt);
+
+    /* Nothing to deliver, but skipped records can be consumed right away */
+    if (n == 0 && at_cursor) commit_locked(spool, &pos, 0);
+
+    *end = pos;
+    pthread_mutex_unlock(&spool->mutex);
+    return n;
+}
+
+int spool_peek(spool_t *spool, spool_record_t *out, int max, spool_pos_t *end) {
+    return spool_peek_from(spool, NULL, out, max, end);
+}
+
+result_t spool_commit(spool_t *spool, const spool_pos_t *end, int count) {
+    CHECK_NULL(spool); CHECK_NULL(end);
+
+    pthread_mutex_lock(&spool->mutex);
+    result_t r = commit_locked(spool, end, count > 0 ? (uint64_t)count : 0);
+    pthread_mutex_unlock(&spool->mutex);
+    return r;
+}
+
+result_t spool_get_stats(spool_t *spool, spool_stats_t *stats) {
+    CHECK_NULL(spool); CHECK_NULL(stats);
+
+    pthread_mutex_lock(&spool->mutex);
+    *stats = spool->stats;
+    stats->segments = (int)(spool->write.seq - spool->first_seq + 1);
+    stats->disk_bytes = disk_bytes(spool);
+    pthread_mutex_unlock(&spool->mutex);
+    return RESULT_OK;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file spool.h
+ * @brief Disk-backed, segmented store-and-forward spool
+ *
+ * Records are appended to fixed-size, memory-mapped segment files and
+ * consumed in order through a read cursor that is persisted separately.
+ * Delivery therefore resumes where it stopped after an outage or reboot,
+ * and RAM use is two mapped segments whatever the backlog.
+ *
+ * Every record carries a CRC32; on open the tail of the newest segment is
+ * validated and anything torn by a crash is discarded. Segments are deleted
+ * once the cursor has passed them. When the backlog exceeds the size cap
+ * the oldest segments are dropped unsent, and records older than the age
+ * cap are skipped.
+ *
+ * A spool is used by one thread at a time, except spool_get_stats().
+ */
+
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include "common.h"
+
+typedef struct spool spool_t;
+
+typedef struct {
+    char dir[MAX_PATH_LEN];
+    uint32_t segment_bytes;     /* Size of each segment file */
+    uint64_t max_bytes;         /* Backlog cap; oldest segments dropped beyond it */
+    uint32_t max_age_seconds;   /* Skip records older than this (0 = keep) */
+} spool_config_t;
+
+/* Position in the spool: segment sequence number and byte offset */
+typedef struct {
+    uint64_t segment;
+    uint32_t offset;
+} spool_pos_t;
+
+/* Record returned by spool_peek(); data points into the mapped segment */
+typedef struct {
+    const void *data;
+    uint32_t len;
+    time_t timestamp;
+} spool_record_t;
+
+typedef struct {
+    uint64_t appended;          /* Records written since open */
+    uint64_t committed;         /* Records acknowledged since open */
+    uint64_t dropped;           /* Records discarded by the size cap */
+    uint64_t expired;           /* Records skipped by the age cap */
+    uint64_t corrupt;           /* Torn or bad-CRC records discarded */
+    uint64_t backlog;           /* Records waiting to be acknowledged */
+    uint64_t disk_bytes;        /* Segment files on disk */
+    int segments;
+} spool_stats_t;
+
+/**
+ * @brief Open (or create) a spool directory and recover its state
+ * @return RESULT_OK, RESULT_IO_ERROR if the directory cannot be used
+ */
+result_t spool_open(const spool_config_t *config, spool_t **out);
+
+/**
+ * @brief Flush mapped data and release the spool
+ */
+void spool_close(spool_t *spool);
+
+/**
+ * @brief Append one record
+ * @return RESULT_OK, RESULT_INVALID_PARAM if len cannot fit in a segment,
+ *         RESULT_IO_ERROR if a new segment cannot be created
+ */
+result_t spool_append(spool_t *spool, const void *data, uint32_t len, time_t timestamp);
+
+/**
+ * @brief Make appended records durable (msync of the active segment)
+ */
+result_t spool_sync(spool_t *spool);
+
+/**
+ * @brief Read up to max records from the cursor without consuming them
+ *
+ * Record data stays valid until the next peek, spool_commit() or spool_close().
+ * Expired and corrupt records are skipped and do not count towards max.
+ *
+ * @param end Position just past the last record returned, for spool_commit()
+ * @return Number of records in out
+ */
+int spool_peek(spool_t *spool, spool_record_t *out, int max, spool_pos_t *end);
+
+/**
+ * @brief spool_peek() starting at from rather than the cursor
+ *
+ * Lets a caller read ahead of records it has not committed yet, e.g. to
+ * keep several batches in flight. A from behind the cursor (or NULL)
+ * reads from the cursor. Data returned by an earlier peek may be unmapped
+ * by this one.
+ */
+int spool_peek_from(spool_t *spool, const spool_pos_t *from, spool_record_t *out, int max,
+                    spool_pos_t *end);
+
+/**
+ * @brief Durably advance the cursor to end and delete consumed segments
+ * @param count Records being acknowledged (from spool_peek())
+ */
+result_t spool_commit(spool_t *spool, const spool_pos_t *end, int count);
+
+result_t spool_get_stats(spool_t *spool, spool_stats_t *stats);
+
+#endif
@@ -0,0 +1,578 @@
+/**
+ * @file uplink.c
+ * @brief Remote upload protocol: batch encoding and transport selection
+ */
+
+#include "uplink_transport.h"
+#include "config_defaults.h"
+#include "utils/logger.h"
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define BINARY_MAGIC        "WTB1"
+#define BINARY_MAGIC_LEN    4
+#define GZIP_MAGIC_0        0x1f
+#define GZIP_MAGIC_1        0x8b
+#define MAX_VARINT_LEN      10
+
+/* ============================================================================
+ * Buffer
+ * ============================================================================ */
+
+void uplink_buf_free(uplink_buf_t *buf) {
+    if (!buf) return;
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+}
+
+static bool buf_reserve(uplink_buf_t *buf, size_t extra) {
+    if (buf->len + extra <= buf->cap) return true;
+    size_t cap = buf->cap ? buf->cap : 256;
+    while (cap < buf->len + extra) cap *= 2;
+    uint8_t *grown = realloc(buf->data, cap);
+    if (!grown) return false;
+    buf->data = grown;
+    buf->cap = cap;
+    return true;
+}
+
+static bool buf_put(uplink_buf_t *buf, const void *data, size_t len) {
+    if (!buf_reserve(buf, len)) return false;
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return true;
+}
+
+static bool buf_printf(uplink_buf_t *buf, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static bool buf_printf(uplink_buf_t *buf, const char *fmt, ...) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t room = buf->cap - buf->len;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf((char *)buf->data + buf->len, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) return false;
+        if ((size_t)n < room) {
+            buf->len += (size_t)n;
+            return true;
+        }
+        if (!buf_reserve(buf, (size_t)n + 1)) return false;
+    }
+    return false;
+}
+
+static bool put_varint(uplink_buf_t *buf, uint64_t v) {
+    uint8_t tmp[MAX_VARINT_LEN];
+    size_t n = 0;
+    do {
+        tmp[n] = (uint8_t)(v & 0x7f);
+        v >>= 7;
+        if (v) tmp[n] |= 0x80;
+        n++;
+    } while (v);
+    return buf_put(buf, tmp, n);
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/* ============================================================================
+ * JSON
+ * ============================================================================ */
+
+static bool put_json_string(uplink_buf_t *buf, const char *s) {
+    if (!buf_put(buf, "\"", 1)) return false;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        bool ok;
+        if (c == '"' || c == '\\') {
+            char esc[2] = { '\\', (char)c };
+            ok = buf_put(buf, esc, 2);
+        } else if (c < 0x20) {
+            ok = buf_printf(buf, "\\u%04x", c);
+        } else {
+            ok = buf_put(buf, s, 1);
+        }
+        if (!ok) return false;
+    }
+    return buf_put(buf, "\"", 1);
+}
+
+static bool encode_json(const char *device, const uplink_entry_t *entries, int count,
+                        uplink_buf_t *out) {
+    if (!buf_put(out, "{\"data\":[", 9)) return false;
+    for (int i = 0; i < count; i++) {
+        const uplink_entry_t *e = &entries[i];
+        /* %.9g round-trips every float */
+        if (!buf_printf(out, "%s{\"module_id\":%d,\"value\":%.9g,\"status\":",
+                        i ? "," : "", e->module_id, (double)e->value) ||
+            !put_json_string(out, e->status) ||
+            !buf_printf(out, ",\"timestamp\":%lld}", (long long)e->timestamp)) {
+            return false;
+        }
+    }
+    return buf_put(out, "],\"device\":", 11) &&
+           put_json_string(out, device) &&
+           buf_put(out, "}", 1);
+}
+
+/* ============================================================================
+ * Binary
+ * ============================================================================ */
+
+static bool put_bytes(uplink_buf_t *buf, const char *s, size_t len) {
+    return put_varint(buf, len) && buf_put(buf, s, len);
+}
+
+static bool encode_binary(const char *device, const uplink_entry_t *entries, int count,
+                          uplink_buf_t *out) {
+    /* Status dictionary; a batch rarely holds more than a few distinct values */
+    uint32_t *index = malloc((size_t)(count ? count : 1) * sizeof(*index));
+    int *dict = malloc((size_t)(count ? count : 1) * sizeof(*dict));
+    if (!index || !dict) {
+        free(index);
+        free(dict);
+        return false;
+    }
+    int dict_count = 0;
+    for (int i = 0; i < count; i++) {
+        int d = 0;
+        while (d < dict_count &&
+               strncmp(entries[dict[d]].status, entries[i].status, UPLINK_STATUS_LEN) != 0) {
+            d++;
+        }
+        if (d == dict_count) dict[dict_count++] = i;
+        index[i] = (uint32_t)d;
+    }
+
+    uint8_t flags = 0;
+    bool ok = buf_put(out, BINARY_MAGIC, BINARY_MAGIC_LEN) &&
+              buf_put(out, &flags, 1) &&
+              put_bytes(out, device, strlen(device)) &&
+              put_varint(out, (uint64_t)count) &&
+              put_varint(out, (uint64_t)dict_count);
+
+    for (int d = 0; ok && d < dict_count; d++) {
+        const char *s = entries[dict[d]].status;
+        ok = put_bytes(out, s, strnlen(s, UPLINK_STATUS_LEN - 1));
+    }
+
+    int64_t prev = 0;
+    for (int i = 0; ok && i < count; i++) {
+        ok = put_varint(out, zigzag((int64_t)entries[i].module_id - prev));
+        prev = entries[i].module_id;
+    }
+    prev = 0;
+    for (int i = 0; ok && i < count; i++) {
+        ok = put_varint(out, zigzag((int64_t)entries[i].timestamp - prev));
+        prev = (int64_t)entries[i].timestamp;
+    }
+    for (int i = 0; ok && i < count; i++) {
+        ok = put_varint(out, index[i]);
+    }
+
+    if (ok) ok = buf_reserve(out, (size_t)count * 4);
+    if (ok) {
+        uint8_t *planes = out->data + out->len;
+        for (int i = 0; i < count; i++) {
+            uint32_t bits;
+            memcpy(&bits, &entries[i].value, sizeof(bits));
+            for (int b = 0; b < 4; b++) {
+                planes[(size_t)b * (size_t)count + (size_t)i] = (uint8_t)(bits >> (8 * b));
+            }
+        }
+        out->len += (size_t)count * 4;
+    }
+
+    free(index);
+    free(dict);
+    return ok;
+}
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} reader_t;
+
+static bool get_varint(reader_t *r, uint64_t *v) {
+    *v = 0;
+    for (int shift = 0; shift < 64 && r->p < r->end; shift += 7) {
+        uint8_t b = *r->p++;
+        *v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool get_bytes(reader_t *r, const uint8_t **s, size_t *len) {
+    uint64_t n;
+    if (!get_varint(r, &n) || n > (uint64_t)(r->end - r->p)) return false;
+    *s = r->p;
+    *len = (size_t)n;
+    r->p += n;
+    return true;
+}
+
+static result_t decode_binary(const uint8_t *data, size_t len, char *device, size_t device_len,
+                              uplink_entry_t *entries, int max, int *count) {
+    reader_t r = { data, data + len };
+    if (len < BINARY_MAGIC_LEN + 1 || memcmp(data, BINARY_MAGIC, BINARY_MAGIC_LEN) != 0) {
+        return RESULT_PARSE_ERROR;
+    }
+    r.p += BINARY_MAGIC_LEN + 1;
+
+    const uint8_t *s;
+    size_t slen;
+    uint64_t n, dict_count;
+    if (!get_bytes(&r, &s, &slen) || !get_varint(&r, &n) || !get_varint(&r, &dict_count)) {
+        return RESULT_PARSE_ERROR;
+    }
+    if (device && device_len > 0) {
+        size_t copy = MIN(slen, device_len - 1);
+        memcpy(device, s, copy);
+        device[copy] = '\0';
+    }
+    *count = (int)MIN(n, (uint64_t)INT32_MAX);
+    if (n > (uint64_t)max) return RESULT_OUT_OF_RANGE;
+    if (dict_count > n) return RESULT_PARSE_ERROR;
+
+    char (*dict)[UPLINK_STATUS_LEN] = malloc((size_t)(dict_count ? dict_count : 1) * UPLINK_STATUS_LEN);
+    if (!dict) return RESULT_NO_MEMORY;
+
+    bool ok = true;
+    for (uint64_t d = 0; ok && d < dict_count; d++) {
+        ok = get_bytes(&r, &s, &slen);
+        if (ok) {
+            size_t copy = MIN(slen, (size_t)UPLINK_STATUS_LEN - 1);
+            memcpy(dict[d], s, copy);
+            dict[d][copy] = '\0';
+        }
+    }
+
+    int64_t prev = 0;
+    uint64_t v;
+    for (uint64_t i = 0; ok && i < n; i++) {
+        ok = get_varint(&r, &v);
+        prev += unzigzag(v);
+        entries[i].module_id = (int)prev;
+    }
+    prev = 0;
+    for (uint64_t i = 0; ok && i < n; i++) {
+        ok = get_varint(&r, &v);
+        prev += unzigzag(v);
+        entries[i].timestamp = (time_t)prev;
+    }
+    for (uint64_t i = 0; ok && i < n; i++) {
+        ok = get_varint(&r, &v) && v < dict_count;
+        if (ok) memcpy(entries[i].status, dict[v], UPLINK_STATUS_LEN);
+    }
+    free(dict);
+
+    if (!ok || (uint64_t)(r.end - r.p) != n * 4) return RESULT_PARSE_ERROR;
+    for (uint64_t i = 0; i < n; i++) {
+        uint32_t bits = 0;
+        for (int b = 0; b < 4; b++) bits |= (uint32_t)r.p[(size_t)b * n + i] << (8 * b);
+        memcpy(&entries[i].value, &bits, sizeof(bits));
+    }
+    return RESULT_OK;
+}
+
+/* ============================================================================
+ * Compression
+ * ============================================================================ */
+
+#ifdef HAVE_ZLIB
+#define GZIP_WINDOW_BITS    (15 + 16)
+
+static bool gzip_buf(const uplink_buf_t *in, uplink_buf_t *out) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    out->len = 0;
+    bool ok = buf_reserve(out, deflateBound(&zs, (uLong)in->len));
+    if (ok) {
+        zs.next_in = in->data;
+        zs.avail_in = (uInt)in->len;
+        zs.next_out = out->data;
+        zs.avail_out = (uInt)out->cap;
+        ok = deflate(&zs, Z_FINISH) == Z_STREAM_END;
+        out->len = zs.total_out;
+    }
+    deflateEnd(&zs);
+    return ok;
+}
+
+static bool gunzip_buf(const uint8_t *data, size_t len, uplink_buf_t *out) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, GZIP_WINDOW_BITS) != Z_OK) return false;
+
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = (uInt)len;
+    int rc = Z_OK;
+    while (rc == Z_OK) {
+        if (!buf_reserve(out, MAX(len * 4, (size_t)1024))) break;
+        zs.next_out = out->data + out->len;
+        zs.avail_out = (uInt)(out->cap - out->len);
+        rc = inflate(&zs, Z_NO_FLUSH);
+        out->len = out->cap - zs.avail_out;
+    }
+    inflateEnd(&zs);
+    return rc == Z_STREAM_END;
+}
+#endif
+
+bool uplink_compress_available(void) {
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+/* ============================================================================
+ * Encoding API
+ * ============================================================================ */
+
+result_t uplink_format_parse(const char *name, uplink_format_t *format) {
+    CHECK_NULL(name); CHECK_NULL(format);
+    if (strcasecmp(name, "json") == 0) {
+        *format = UPLINK_FORMAT_JSON;
+    } else if (strcasecmp(name, "binary") == 0) {
+        *format = UPLINK_FORMAT_BINARY;
+    } else {
+        return RESULT_INVALID_PARAM;
+    }
+    return RESULT_OK;
+}
+
+const char* uplink_format_name(uplink_format_t format) {
+    return format == UPLINK_FORMAT_BINARY ? "binary" : "json";
+}
+
+/* Encode without compression; raw_len receives the encoded size */
+static result_t encode(uplink_format_t format, bool compress, const char *device,
+                       const uplink_entry_t *entries, int count, uplink_buf_t *out,
+                       size_t *raw_len) {
+    if (!out || (count > 0 && !entries) || count < 0) return RESULT_INVALID_PARAM;
+    if (!device) device = "";
+
+    uplink_buf_t raw = {0};
+    uplink_buf_t *dst = out;
+#ifdef HAVE_ZLIB
+    if (compress) dst = &raw;
+#else
+    UNUSED(compress);
+#endif
+
+    dst->len = 0;
+    bool ok = format == UPLINK_FORMAT_BINARY ? encode_binary(device, entries, count, dst)
+                                             : encode_json(device, entries, count, dst);
+    if (raw_len) *raw_len = dst->len;
+
+#ifdef HAVE_ZLIB
+    if (ok && compress) ok = gzip_buf(&raw, out);
+#endif
+    uplink_buf_free(&raw);
+    return ok ? RESULT_OK : RESULT_NO_MEMORY;
+}
+
+result_t uplink_encode(uplink_format_t format, bool compress, const char *device,
+                       const uplink_entry_t *entries, int count, uplink_buf_t *out) {
+    return encode(format, compress, device, entries, count, out, NULL);
+}
+
+result_t uplink_decode(const void *data, size_t len, char *device, size_t device_len,
+                       uplink_entry_t *entries, int max, int *count) {
+    CHECK_NULL(data); CHECK_NULL(count);
+    if (max > 0 && !entries) return RESULT_INVALID_PARAM;
+    *count = 0;
+
+    const uint8_t *p = data;
+    if (len >= 2 && p[0] == GZIP_MAGIC_0 && p[1] == GZIP_MAGIC_1) {
+#ifdef HAVE_ZLIB
+        uplink_buf_t plain = {0};
+        result_t r = gunzip_buf(p, len, &plain) ?
+            decode_binary(plain.data, plain.len, device, device_len, entries, max, count) :
+            RESULT_PARSE_ERROR;
+        uplink_buf_free(&plain);
+        return r;
+#else
+        return RESULT_NOT_SUPPORTED;
+#endif
+    }
+    return decode_binary(p, len, device, device_len, entries, max, count);
+}
+
+result_t uplink_encode_batch(const uplink_t *uplink, const uplink_entry_t *entries, int count,
+                             uplink_buf_t *out, size_t *raw_len) {
+    return encode(uplink->config.format, uplink->config.compress, uplink->config.device,
+                  entries, count, out, raw_len);
+}
+
+/* ============================================================================
+ * Transport
+ * ============================================================================ */
+
+void uplink_global_init(void) {
+#ifdef HAVE_CURL
+    uplink_http_global_init();
+#endif
+}
+
+void uplink_global_cleanup(void) {
+#ifdef HAVE_CURL
+    uplink_http_global_cleanup();
+#endif
+}
+
+static bool has_scheme(const char *url, const char *scheme) {
+    return strncasecmp(url, scheme, strlen(scheme)) == 0;
+}
+
+/* URL for logs, without any user:password@ */
+static void redact_url(const char *url, char *out, size_t len) {
+    const char *host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    const char *at = strchr(host, '@');
+    const char *slash = strchr(host, '/');
+    if (!at || (slash && slash < at)) {
+        snprintf(out, len, "%s", url);
+        return;
+    }
+    snprintf(out, len, "%.*s%s", (int)(host - url), url, at + 1);
+}
+
+result_t uplink_topics_parse(const char *name, uplink_topics_t *topics) {
+    CHECK_NULL(name); CHECK_NULL(topics);
+    if (strcasecmp(name, "batch") == 0) {
+        *topics = UPLINK_TOPICS_BATCH;
+    } else if (strcasecmp(name, "module") == 0) {
+        *topics = UPLINK_TOPICS_MODULE;
+    } else {
+        return RESULT_INVALID_PARAM;
+    }
+    return RESULT_OK;
+}
+
+result_t uplink_open(const uplink_config_t *config, uplink_t **out) {
+    CHECK_NULL(config); CHECK_NULL(out);
+    *out = NULL;
+    if (config->url[0] == '\0') return RESULT_INVALID_PARAM;
+
+    const uplink_transport_ops_t *ops = NULL;
+    if (has_scheme(config->url, "mqtt://")) {
+        ops = &uplink_mqtt_ops;
+    } else if (has_scheme(config->url, "mqtts://")) {
+        LOG_ERROR("Uplink: the MQTT client has no TLS; bridge through a local broker instead");
+        return RESULT_NOT_SUPPORTED;
+    } else {
+#ifdef HAVE_CURL
+        ops = &uplink_http_ops;
+#else
+        return RESULT_NOT_SUPPORTED;
+#endif
+    }
+
+    uplink_t *uplink = calloc(1, sizeof(*uplink));
+    if (!uplink) return RESULT_NO_MEMORY;
+
+    uplink->config = *config;
+    uplink->ops = ops;
+    if (uplink->config.timeout_s <= 0) uplink->config.timeout_s = WT_UPLINK_TIMEOUT_S;
+    if (uplink->config.compress && !uplink_compress_available()) {
+        LOG_WARNING("Uplink: built without zlib, sending uncompressed");
+        uplink->config.compress = false;
+    }
+    uplink->window = config->window > 0 ? MIN(config->window, WT_UPLINK_MAX_WINDOW)
+                                        : WT_UPLINK_WINDOW;
+
+    result_t r = ops->open(uplink);
+    if (r != RESULT_OK) {
+        free(uplink);
+        return r;
+    }
+
+    char shown[MAX_PATH_LEN];
+    redact_url(uplink->config.url, shown, sizeof(shown));
+    LOG_INFO("Uplink to %s (%s%s, window %d)", shown,
+             uplink_format_name(uplink->config.format),
+             uplink->config.compress ? "+gzip" : "", uplink->window);
+    *out = uplink;
+    return RESULT_OK;
+}
+
+void uplink_close(uplink_t *uplink) {
+    if (!uplink) return;
+    uplink_cancel(uplink);
+    uplink->ops->close(uplink);
+    free(uplink);
+}
+
+result_t uplink_submit(uplink_t *uplink, const uplink_entry_t *entries, int count,
+                       uint64_t tag, const char *key) {
+    CHECK_NULL(uplink);
+    if (count <= 0 || !entries) return RESULT_INVALID_PARAM;
+    if (uplink->in_flight >= uplink->window) return RESULT_BUSY;
+
+    result_t r = uplink->ops->submit(uplink, entries, count, tag, key);
+    if (r == RESULT_OK) uplink->in_flight++;
+    return r;
+}
+
+int uplink_poll(uplink_t *uplink, int timeout_ms, uplink_ack_t *acks, int max) {
+    if (!uplink || !acks || max <= 0 || uplink->in_flight == 0) return 0;
+
+    int n = uplink->ops->poll(uplink, timeout_ms, acks, max);
+    for (int i = 0; i < n; i++) {
+        uplink->in_flight--;
+        if (acks[i].ok) {
+            uplink->stats.batches_sent++;
+            uplink->stats.entries_sent += (uint64_t)acks[i].count;
+        } else {
+            uplink->stats.batches_failed++;
+        }
+    }
+    return n;
+}
+
+void uplink_service(uplink_t *uplink) {
+    if (uplink && uplink->ops->service) uplink->ops->service(uplink);
+}
+
+int uplink_in_flight(const uplink_t *uplink) {
+    return uplink ? uplink->in_flight : 0;
+}
+
+int uplink_window(const uplink_t *uplink) {
+    return uplink ? uplink->window : 0;
+}
+
+void uplink_cancel(uplink_t *uplink) {
+    if (!uplink || uplink->in_flight == 0) return;
+    uplink->ops->cancel(uplink);
+    uplink->stats.batches_failed += (uint64_t)uplink->in_flight;
+    uplink->in_flight = 0;
+}
+
+void uplink_get_stats(const uplink_t *uplink, uplink_stats_t *stats) {
+    if (!stats) return;
+    if (uplink) *stats = uplink->stats;
+    else memset(stats, 0, sizeof(*stats));
+}
@@ -0,0 +1,209 @@
+/**
+ * @file uplink.h
+ * @brief Remote upload protocol: batch encoding and pipelined transports
+ *
+ * Batches are sent to the remote URL in one of two encodings:
+ *
+ *  - JSON (application/json), the original format:
+ *      {"data":[{"module_id":1,"value":7.2,"status":"ok","timestamp":...}],
+ *       "device":"rtu-1"}
+ *
+ *  - Binary (application/vnd.water-treat.batch), columnar and length-prefixed.
+ *    Integers are LEB128 varints; signed ones are zigzag-encoded first.
+ *
+ *      "WTB1"                      magic
+ *      u8 flags                    0, reserved
+ *      varint len, bytes           device name
+ *      varint count                entries
+ *      varint n, n x (varint len, bytes)
+ *                                  status dictionary, in first-use order
+ *      count x zigzag varint       module_id, delta from the previous entry
+ *      count x zigzag varint       timestamp (s), delta from the previous entry
+ *      count x varint              status, index into the dictionary
+ *      4 x count bytes             value as IEEE-754 little-endian, split
+ *                                  into byte planes (all byte 0s, then all
+ *                                  byte 1s, ...) so exponents compress well
+ *
+ * Either encoding may be gzip-compressed (Content-Encoding: gzip).
+ *
+ * The URL scheme picks the transport. Either keeps up to a window of
+ * batches in flight and delivers at-least-once:
+ *
+ *  - http:// and https:// POST each batch over persistent connections:
+ *    multiplexed on one HTTP/2 connection when the server offers it,
+ *    otherwise over parallel keep-alive HTTP/1.1 connections. A batch is
+ *    acknowledged by a 2xx response and carries an Idempotency-Key, so a
+ *    server can discard a batch resent after a lost response.
+ *
+ *  - mqtt://[user[:password]@]host[:port][/prefix] publishes at QoS 1 on a
+ *    persistent session (client id "wt-<device>"), to
+ *    "<prefix>/<device>/batch", or with per-module topics split into one
+ *    message per module on "<prefix>/<device>/<module_id>". A batch is
+ *    acknowledged when the broker has PUBACKed all of its messages. The
+ *    api_key is the password when the URL has none. MQTT 5 adds the
+ *    content type and the idempotency key as a user property. There is no
+ *    TLS: run a local bridging broker for mqtts.
+ *
+ * An uplink_t is used by one thread.
+ */
+
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include "common.h"
+
+#define UPLINK_STATUS_LEN           16
+#define UPLINK_CONTENT_TYPE_JSON    "application/json"
+#define UPLINK_CONTENT_TYPE_BINARY  "application/vnd.water-treat.batch"
+
+typedef struct {
+    int module_id;
+    float value;
+    char status[UPLINK_STATUS_LEN];
+    time_t timestamp;
+} uplink_entry_t;
+
+typedef enum {
+    UPLINK_FORMAT_JSON = 0,
+    UPLINK_FORMAT_BINARY
+} uplink_format_t;
+
+/* Growable byte buffer */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+} uplink_buf_t;
+
+void uplink_buf_free(uplink_buf_t *buf);
+
+/* ============================================================================
+ * Encoding
+ * ============================================================================ */
+
+/**
+ * @brief Parse "json" or "binary"
+ * @return RESULT_OK, RESULT_INVALID_PARAM for anything else
+ */
+result_t uplink_format_parse(const char *name, uplink_format_t *format);
+
+const char* uplink_format_name(uplink_format_t format);
+
+/**
+ * @brief True if this build can gzip batches (zlib present)
+ */
+bool uplink_compress_available(void);
+
+/**
+ * @brief Encode a batch into out (replacing its contents)
+ * @param compress gzip the encoded batch; ignored without zlib
+ */
+result_t uplink_encode(uplink_format_t format, bool compress, const char *device,
+                       const uplink_entry_t *entries, int count, uplink_buf_t *out);
+
+/**
+ * @brief Decode a binary batch, gzip-compressed or not
+ * @param count Entries in the batch; more than max is RESULT_OUT_OF_RANGE
+ * @return RESULT_OK, RESULT_PARSE_ERROR if malformed
+ */
+result_t uplink_decode(const void *data, size_t len, char *device, size_t device_len,
+                       uplink_entry_t *entries, int max, int *count);
+
+/* ============================================================================
+ * Transport
+ * ============================================================================ */
+
+typedef struct uplink uplink_t;
+
+/**
+ * @brief Process-wide HTTP library setup; call before any other thread starts
+ */
+void uplink_global_init(void);
+void uplink_global_cleanup(void);
+
+/* How MQTT messages are split over topics */
+typedef enum {
+    UPLINK_TOPICS_BATCH = 0,    /* One message per batch */
+    UPLINK_TOPICS_MODULE        /* One message per module in the batch */
+} uplink_topics_t;
+
+/**
+ * @brief Parse "batch" or "module"
+ * @return RESULT_OK, RESULT_INVALID_PARAM for anything else
+ */
+result_t uplink_topics_parse(const char *name, uplink_topics_t *topics);
+
+typedef struct {
+    char url[MAX_PATH_LEN];
+    char api_key[MAX_CONFIG_VALUE_LEN];
+    char device[MAX_NAME_LEN];
+    uplink_format_t format;
+    bool compress;
+    int window;                 /* Batches in flight (default WT_UPLINK_WINDOW) */
+    int timeout_s;              /* Per batch, including connect */
+    uplink_topics_t topics;     /* MQTT only */
+    int mqtt_version;           /* MQTT only: 4 (3.1.1) or 5 */
+} uplink_config_t;
+
+/* Outcome of one submitted batch */
+typedef struct {
+    uint64_t tag;
+    int count;
+    size_t bytes;               /* Request body as sent */
+    bool ok;                    /* 2xx response, or every message PUBACKed */
+    long code;                  /* HTTP status or MQTT PUBACK reason; 0 if none */
+} uplink_ack_t;
+
+typedef struct {
+    uint64_t batches_sent;
+    uint64_t batches_failed;
+    uint64_t entries_sent;
+    uint64_t bytes_encoded;     /* Before compression */
+    uint64_t bytes_sent;        /* Request bodies as transmitted */
+} uplink_stats_t;
+
+/**
+ * @brief Create a transport; no connection is made until the first batch
+ * @return RESULT_OK, RESULT_NOT_SUPPORTED for http(s) without libcurl or for mqtts
+ */
+result_t uplink_open(const uplink_config_t *config, uplink_t **out);
+
+/**
+ * @brief Abort anything in flight and close the connections
+ */
+void uplink_close(uplink_t *uplink);
+
+/**
+ * @brief Encode a batch and start sending it
+ * @param tag Returned in the batch's ack
+ * @param key Idempotency key, unique per batch contents (optional)
+ * @return RESULT_OK, RESULT_BUSY if the window is full
+ */
+result_t uplink_submit(uplink_t *uplink, const uplink_entry_t *entries, int count,
+                       uint64_t tag, const char *key);
+
+/**
+ * @brief Drive transfers and collect finished batches
+ *
+ * Waits up to timeout_ms for at least one batch to finish. Batches may
+ * finish in any order.
+ * @return Number of acks written
+ */
+int uplink_poll(uplink_t *uplink, int timeout_ms, uplink_ack_t *acks, int max);
+
+/**
+ * @brief Idle housekeeping (MQTT keep-alive); call regularly from the owning thread
+ */
+void uplink_service(uplink_t *uplink);
+
+int uplink_in_flight(const uplink_t *uplink);
+int uplink_window(const uplink_t *uplink);
+
+/**
+ * @brief Abandon every batch in flight; none of them is acked
+ */
+void uplink_cancel(uplink_t *uplink);
+
+void uplink_get_stats(const uplink_t *uplink, uplink_stats_t *stats);
+
+#endif
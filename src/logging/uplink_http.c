@@ -0,0 +1,231 @@
+/**
+ * @file uplink_http.c
+ * @brief Uplink transport: pipelined HTTP POST over libcurl
+ */
+
+#include "uplink_transport.h"
+#include "utils/logger.h"
+#include <string.h>
+
+#ifdef HAVE_CURL
+
+#include <curl/curl.h>
+
+typedef struct {
+    CURL *easy;
+    struct curl_slist *headers;
+    uplink_buf_t body;
+    uint64_t tag;
+    int count;
+    bool busy;
+} http_slot_t;
+
+typedef struct {
+    CURLM *multi;
+    http_slot_t *slots;         /* One per window position */
+} http_transport_t;
+
+static size_t discard_cb(void *contents, size_t size, size_t nmemb, void *userp) {
+    UNUSED(contents); UNUSED(userp);
+    return size * nmemb;
+}
+
+static CURL* slot_easy(uplink_t *uplink, http_slot_t *slot) {
+    if (slot->easy) return slot->easy;
+
+    CURL *easy = curl_easy_init();
+    if (!easy) return NULL;
+
+    curl_easy_setopt(easy, CURLOPT_URL, uplink->config.url);
+    curl_easy_setopt(easy, CURLOPT_POST, 1L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, discard_cb);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, (long)uplink->config.timeout_s);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, (long)MIN(uplink->config.timeout_s, 5));
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    /* HTTP/2 where TLS negotiates it; prefer a multiplexed stream to a new connection */
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, (void *)slot);
+
+    slot->easy = easy;
+    return easy;
+}
+
+static struct curl_slist* batch_headers(const uplink_t *uplink, const char *key) {
+    char line[MAX_CONFIG_VALUE_LEN + 64];
+    struct curl_slist *h = NULL;
+
+    snprintf(line, sizeof(line), "Content-Type: %s",
+             uplink->config.format == UPLINK_FORMAT_BINARY ? UPLINK_CONTENT_TYPE_BINARY
+                                                           : UPLINK_CONTENT_TYPE_JSON);
+    h = curl_slist_append(h, line);
+    if (uplink->config.compress) h = curl_slist_append(h, "Content-Encoding: gzip");
+    if (uplink->config.api_key[0]) {
+        snprintf(line, sizeof(line), "Authorization: Bearer %s", uplink->config.api_key);
+        h = curl_slist_append(h, line);
+    }
+    if (key && key[0]) {
+        snprintf(line, sizeof(line), "Idempotency-Key: %s", key);
+        h = curl_slist_append(h, line);
+    }
+    /* A 100-continue handshake would cost a round trip per batch */
+    h = curl_slist_append(h, "Expect:");
+    return h;
+}
+
+void uplink_http_global_init(void) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+void uplink_http_global_cleanup(void) {
+    curl_global_cleanup();
+}
+
+static void http_close(uplink_t *uplink);
+
+static result_t http_open(uplink_t *uplink) {
+    http_transport_t *http = calloc(1, sizeof(*http));
+    if (!http) return RESULT_NO_MEMORY;
+    uplink->transport_data = http;
+
+    http->slots = calloc((size_t)uplink->window, sizeof(*http->slots));
+    http->multi = curl_multi_init();
+    if (!http->slots || !http->multi) {
+        http_close(uplink);
+        return RESULT_NO_MEMORY;
+    }
+
+    curl_multi_setopt(http->multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(http->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)uplink->window);
+    curl_multi_setopt(http->multi, CURLMOPT_MAXCONNECTS, (long)uplink->window);
+    return RESULT_OK;
+}
+
+static void http_cancel(uplink_t *uplink) {
+    http_transport_t *http = uplink->transport_data;
+    for (int i = 0; http->slots && i < uplink->window; i++) {
+        http_slot_t *slot = &http->slots[i];
+        if (!slot->busy) continue;
+        curl_multi_remove_handle(http->multi, slot->easy);
+        slot->busy = false;
+    }
+}
+
+static void http_close(uplink_t *uplink) {
+    http_transport_t *http = uplink->transport_data;
+    if (!http) return;
+    http_cancel(uplink);
+    for (int i = 0; http->slots && i < uplink->window; i++) {
+        http_slot_t *slot = &http->slots[i];
+        if (slot->easy) curl_easy_cleanup(slot->easy);
+        curl_slist_free_all(slot->headers);
+        uplink_buf_free(&slot->body);
+    }
+    if (http->multi) curl_multi_cleanup(http->multi);
+    free(http->slots);
+    free(http);
+    uplink->transport_data = NULL;
+}
+
+static result_t http_submit(uplink_t *uplink, const uplink_entry_t *entries, int count,
+                            uint64_t tag, const char *key) {
+    http_transport_t *http = uplink->transport_data;
+
+    http_slot_t *slot = NULL;
+    for (int i = 0; i < uplink->window && !slot; i++) {
+        if (!http->slots[i].busy) slot = &http->slots[i];
+    }
+    if (!slot) return RESULT_BUSY;
+
+    size_t raw_len = 0;
+    result_t r = uplink_encode_batch(uplink, entries, count, &slot->body, &raw_len);
+    if (r != RESULT_OK) return r;
+
+    CURL *easy = slot_easy(uplink, slot);
+    if (!easy) return RESULT_NO_MEMORY;
+
+    curl_slist_free_all(slot->headers);
+    slot->headers = batch_headers(uplink, key);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, slot->headers);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, (char *)slot->body.data);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)slot->body.len);
+
+    if (curl_multi_add_handle(http->multi, easy) != CURLM_OK) return RESULT_ERROR;
+
+    slot->tag = tag;
+    slot->count = count;
+    slot->busy = true;
+    uplink->stats.bytes_encoded += raw_len;
+    uplink->stats.bytes_sent += slot->body.len;
+
+    /* Get the request onto the wire before the caller encodes the next one */
+    int running;
+    curl_multi_perform(http->multi, &running);
+    return RESULT_OK;
+}
+
+static int collect(http_transport_t *http, uplink_ack_t *acks, int max) {
+    int n = 0;
+    CURLMsg *msg;
+    int left;
+    while (n < max && (msg = curl_multi_info_read(http->multi, &left)) != NULL) {
+        if (msg->msg != CURLMSG_DONE) continue;
+
+        http_slot_t *slot = NULL;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&slot);
+        if (!slot || !slot->busy) continue;
+
+        long code = 0;
+        CURLcode res = msg->data.result;
+        if (res == CURLE_OK) curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &code);
+        bool ok = res == CURLE_OK && code >= 200 && code < 300;
+
+        if (res != CURLE_OK) {
+            LOG_WARNING("Remote upload failed: %s", curl_easy_strerror(res));
+        } else if (!ok) {
+            LOG_WARNING("Remote upload HTTP error: %ld", code);
+        }
+
+        curl_multi_remove_handle(http->multi, msg->easy_handle);
+        slot->busy = false;
+
+        acks[n++] = (uplink_ack_t){
+            .tag = slot->tag,
+            .count = slot->count,
+            .bytes = slot->body.len,
+            .ok = ok,
+            .code = code,
+        };
+    }
+    return n;
+}
+
+static int http_poll(uplink_t *uplink, int timeout_ms, uplink_ack_t *acks, int max) {
+    http_transport_t *http = uplink->transport_data;
+
+    uint64_t deadline = get_time_ms() + (uint64_t)MAX(timeout_ms, 0);
+    int n = 0;
+    for (;;) {
+        int running;
+        curl_multi_perform(http->multi, &running);
+        n += collect(http, acks + n, max - n);
+        if (n > 0) break;
+
+        uint64_t now = get_time_ms();
+        if (now >= deadline) break;
+        curl_multi_poll(http->multi, NULL, 0, (int)(deadline - now), NULL);
+    }
+    return n;
+}
+
+const uplink_transport_ops_t uplink_http_ops = {
+    .open = http_open,
+    .close = http_close,
+    .submit = http_submit,
+    .poll = http_poll,
+    .cancel = http_cancel,
+    .service = NULL,
+};
+
+#endif /* HAVE_CURL */
@@ -0,0 +1,338 @@
+/**
+ * @file uplink_mqtt.c
+ * @brief Uplink transport: QoS 1 MQTT publishes on a persistent session
+ */
+
+#include "uplink_transport.h"
+#include "mqtt_client.h"
+#include "config_defaults.h"
+#include "utils/logger.h"
+#include <string.h>
+
+#define IDEMPOTENCY_PROPERTY    "idempotency-key"
+#define ACK_BATCH               64
+
+typedef struct {
+    uint64_t tag;
+    int count;
+    int pending;                /* Messages not yet acked */
+    size_t bytes;
+    long reason;                /* First failing PUBACK reason */
+    bool failed;
+    bool busy;
+} mqtt_batch_t;
+
+typedef struct {
+    uint16_t packet_id;
+    int batch;
+} mqtt_pending_t;
+
+typedef struct {
+    mqtt_client_t *client;
+    char prefix[MAX_PATH_LEN];
+    mqtt_batch_t *batches;      /* One per window position */
+    mqtt_pending_t *pending;
+    int pending_count;
+    int pending_cap;
+    uplink_buf_t body;
+    uplink_entry_t *group;      /* Scratch for per-module messages */
+    int group_cap;
+} mqtt_transport_t;
+
+/* ============================================================================
+ * URL
+ * ============================================================================ */
+
+/* mqtt://[user[:password]@]host[:port][/prefix] */
+static result_t parse_url(const char *url, mqtt_config_t *cfg, char *prefix, size_t prefix_len) {
+    const char *p = url + strlen("mqtt://");
+    const char *slash = strchr(p, '/');
+    const char *auth_end = slash ? slash : p + strlen(p);
+
+    const char *at = NULL;
+    for (const char *c = p; c < auth_end; c++) {
+        if (*c == '@') at = c;
+    }
+    if (at) {
+        const char *colon = memchr(p, ':', (size_t)(at - p));
+        const char *user_end = colon ? colon : at;
+        snprintf(cfg->username, sizeof(cfg->username), "%.*s", (int)(user_end - p), p);
+        if (colon) {
+            snprintf(cfg->password, sizeof(cfg->password), "%.*s", (int)(at - colon - 1), colon + 1);
+        }
+        p = at + 1;
+    }
+
+    const char *host = p;
+    const char *host_end;
+    const char *port = NULL;
+    if (*p == '[') {
+        host = p + 1;
+        host_end = memchr(host, ']', (size_t)(auth_end - host));
+        if (!host_end) return RESULT_PARSE_ERROR;
+        if (host_end + 1 < auth_end && host_end[1] == ':') port = host_end + 2;
+    } else {
+        host_end = memchr(p, ':', (size_t)(auth_end - p));
+        if (host_end) port = host_end + 1;
+        else host_end = auth_end;
+    }
+    if (host_end == host || (size_t)(host_end - host) >= sizeof(cfg->host)) return RESULT_PARSE_ERROR;
+    snprintf(cfg->host, sizeof(cfg->host), "%.*s", (int)(host_end - host), host);
+
+    cfg->port = WT_MQTT_PORT;
+    if (port) {
+        char *end;
+        long v = strtol(port, &end, 10);
+        if (end != auth_end || v <= 0 || v > 65535) return RESULT_PARSE_ERROR;
+        cfg->port = (uint16_t)v;
+    }
+
+    const char *topic = slash ? slash + 1 : "";
+    size_t len = strlen(topic);
+    while (len > 0 && topic[len - 1] == '/') len--;
+    if (len == 0) {
+        topic = WT_UPLINK_TOPIC_PREFIX;
+        len = strlen(topic);
+    }
+    if (len >= prefix_len) return RESULT_PARSE_ERROR;
+    snprintf(prefix, prefix_len, "%.*s", (int)len, topic);
+    return RESULT_OK;
+}
+
+/* ============================================================================
+ * Batches
+ * ============================================================================ */
+
+static void mqtt_close(uplink_t *uplink);
+static void pump(mqtt_transport_t *mqtt, int timeout_ms);
+
+static result_t mqtt_open(uplink_t *uplink) {
+    const uplink_config_t *config = &uplink->config;
+    mqtt_config_t cfg = {
+        .version = config->mqtt_version == MQTT_V5 ? MQTT_V5 : MQTT_V311,
+        .clean_session = false,
+        .session_expiry_s = WT_MQTT_SESSION_EXPIRY_S,
+        .keepalive_s = WT_MQTT_KEEPALIVE_S,
+        .timeout_ms = config->timeout_s * 1000,
+    };
+
+    mqtt_transport_t *mqtt = calloc(1, sizeof(*mqtt));
+    if (!mqtt) return RESULT_NO_MEMORY;
+    uplink->transport_data = mqtt;
+
+    if (parse_url(config->url, &cfg, mqtt->prefix, sizeof(mqtt->prefix)) != RESULT_OK) {
+        LOG_ERROR("Uplink: bad MQTT URL, expected mqtt://[user[:password]@]host[:port][/prefix]");
+        mqtt_close(uplink);
+        return RESULT_INVALID_PARAM;
+    }
+    if (cfg.password[0] == '\0') SAFE_STRNCPY(cfg.password, config->api_key, sizeof(cfg.password));
+    /* MQTT has no password without a user name */
+    if (cfg.username[0] == '\0' && cfg.password[0] != '\0') {
+        SAFE_STRNCPY(cfg.username, config->device, sizeof(cfg.username));
+    }
+    /* A stable client id lets the broker resume the session after a restart */
+    snprintf(cfg.client_id, sizeof(cfg.client_id), "wt-%s", config->device[0] ? config->device : "rtu");
+
+    mqtt->batches = calloc((size_t)uplink->window, sizeof(*mqtt->batches));
+    result_t r = mqtt->batches ? mqtt_client_create(&cfg, &mqtt->client) : RESULT_NO_MEMORY;
+    if (r != RESULT_OK) {
+        mqtt_close(uplink);
+        return r;
+    }
+    return RESULT_OK;
+}
+
+static void mqtt_cancel(uplink_t *uplink) {
+    mqtt_transport_t *mqtt = uplink->transport_data;
+    /* The spool resends these under new packet ids */
+    mqtt_client_forget(mqtt->client);
+    mqtt->pending_count = 0;
+    for (int i = 0; mqtt->batches && i < uplink->window; i++) mqtt->batches[i].busy = false;
+}
+
+static void mqtt_close(uplink_t *uplink) {
+    mqtt_transport_t *mqtt = uplink->transport_data;
+    if (!mqtt) return;
+    mqtt_client_destroy(mqtt->client);
+    uplink_buf_free(&mqtt->body);
+    free(mqtt->batches);
+    free(mqtt->pending);
+    free(mqtt->group);
+    free(mqtt);
+    uplink->transport_data = NULL;
+}
+
+static result_t track(mqtt_transport_t *mqtt, uint16_t packet_id, int batch) {
+    if (mqtt->pending_count == mqtt->pending_cap) {
+        int cap = mqtt->pending_cap ? mqtt->pending_cap * 2 : 64;
+        mqtt_pending_t *grown = realloc(mqtt->pending, (size_t)cap * sizeof(*grown));
+        if (!grown) return RESULT_NO_MEMORY;
+        mqtt->pending = grown;
+        mqtt->pending_cap = cap;
+    }
+    mqtt->pending[mqtt->pending_count++] = (mqtt_pending_t){ packet_id, batch };
+    return RESULT_OK;
+}
+
+/* Encode and publish one message of a batch */
+static result_t publish(uplink_t *uplink, int batch, const char *topic,
+                        const uplink_entry_t *entries, int count, const char *key) {
+    mqtt_transport_t *mqtt = uplink->transport_data;
+
+    size_t raw_len = 0;
+    result_t r = uplink_encode_batch(uplink, entries, count, &mqtt->body, &raw_len);
+    if (r != RESULT_OK) return r;
+
+    mqtt_props_t props = {
+        .content_type = uplink->config.format == UPLINK_FORMAT_BINARY ? UPLINK_CONTENT_TYPE_BINARY
+                                                                      : UPLINK_CONTENT_TYPE_JSON,
+        .user_key = key && key[0] ? IDEMPOTENCY_PROPERTY : NULL,
+        .user_value = key,
+    };
+    uint16_t packet_id;
+    r = mqtt_client_publish(mqtt->client, topic, mqtt->body.data, mqtt->body.len, &props, &packet_id);
+    /* A batch may need more messages than the broker's Receive Maximum allows
+     * in flight: wait for acks rather than fail it half published */
+    uint64_t deadline = get_time_ms() + (uint64_t)uplink->config.timeout_s * 1000;
+    uint64_t now;
+    while (r == RESULT_BUSY && mqtt_client_in_flight(mqtt->client) > 0 &&
+           (now = get_time_ms()) < deadline) {
+        pump(mqtt, (int)(deadline - now));
+        r = mqtt_client_publish(mqtt->client, topic, mqtt->body.data, mqtt->body.len, &props,
+                                &packet_id);
+    }
+    if (r != RESULT_OK) return r;
+
+    r = track(mqtt, packet_id, batch);
+    if (r != RESULT_OK) return r;
+
+    mqtt->batches[batch].pending++;
+    mqtt->batches[batch].bytes += mqtt->body.len;
+    uplink->stats.bytes_encoded += raw_len;
+    uplink->stats.bytes_sent += mqtt->body.len;
+    return RESULT_OK;
+}
+
+/* Publish one message per module, entries in their original order */
+static result_t publish_by_module(uplink_t *uplink, int batch, const uplink_entry_t *entries,
+                                  int count, const char *key) {
+    mqtt_transport_t *mqtt = uplink->transport_data;
+    if (count > mqtt->group_cap) {
+        uplink_entry_t *grown = realloc(mqtt->group, (size_t)count * sizeof(*grown));
+        if (!grown) return RESULT_NO_MEMORY;
+        mqtt->group = grown;
+        mqtt->group_cap = count;
+    }
+
+    char topic[MAX_PATH_LEN * 2];
+    char module_key[MAX_CONFIG_VALUE_LEN];
+    for (int i = 0; i < count; i++) {
+        int module_id = entries[i].module_id;
+        bool seen = false;
+        for (int j = 0; j < i && !seen; j++) seen = entries[j].module_id == module_id;
+        if (seen) continue;
+
+        int n = 0;
+        for (int j = i; j < count; j++) {
+            if (entries[j].module_id == module_id) mqtt->group[n++] = entries[j];
+        }
+        snprintf(topic, sizeof(topic), "%s/%s/%d", mqtt->prefix, uplink->config.device, module_id);
+        if (key && key[0]) snprintf(module_key, sizeof(module_key), "%s-m%d", key, module_id);
+
+        result_t r = publish(uplink, batch, topic, mqtt->group, n, key && key[0] ? module_key : NULL);
+        if (r != RESULT_OK) return r;
+    }
+    return RESULT_OK;
+}
+
+static result_t mqtt_submit(uplink_t *uplink, const uplink_entry_t *entries, int count,
+                            uint64_t tag, const char *key) {
+    mqtt_transport_t *mqtt = uplink->transport_data;
+
+    int batch = -1;
+    for (int i = 0; i < uplink->window && batch < 0; i++) {
+        if (!mqtt->batches[i].busy) batch = i;
+    }
+    if (batch < 0) return RESULT_BUSY;
+    mqtt->batches[batch] = (mqtt_batch_t){ .tag = tag, .count = count };
+
+    result_t r;
+    if (uplink->config.topics == UPLINK_TOPICS_MODULE) {
+        r = publish_by_module(uplink, batch, entries, count, key);
+    } else {
+        char topic[MAX_PATH_LEN * 2];
+        snprintf(topic, sizeof(topic), "%s/%s/batch", mqtt->prefix, uplink->config.device);
+        r = publish(uplink, batch, topic, entries, count, key);
+    }
+
+    /* Partly published: let the acks of what went out report the batch failed */
+    if (r != RESULT_OK && mqtt->batches[batch].pending == 0) return r;
+    mqtt->batches[batch].failed = r != RESULT_OK;
+    mqtt->batches[batch].busy = true;
+    return RESULT_OK;
+}
+
+/* Apply acks from the broker to their batches */
+static void pump(mqtt_transport_t *mqtt, int timeout_ms) {
+    mqtt_ack_t acks[ACK_BATCH];
+    int n = mqtt_client_poll(mqtt->client, timeout_ms, acks, ACK_BATCH);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < mqtt->pending_count; j++) {
+            if (mqtt->pending[j].packet_id != acks[i].packet_id) continue;
+
+            mqtt_batch_t *batch = &mqtt->batches[mqtt->pending[j].batch];
+            batch->pending--;
+            if (!acks[i].ok && !batch->failed) {
+                batch->failed = true;
+                batch->reason = acks[i].reason;
+            }
+            mqtt->pending[j] = mqtt->pending[--mqtt->pending_count];
+            break;
+        }
+    }
+}
+
+static int mqtt_poll(uplink_t *uplink, int timeout_ms, uplink_ack_t *acks, int max) {
+    mqtt_transport_t *mqtt = uplink->transport_data;
+
+    uint64_t deadline = get_time_ms() + (uint64_t)MAX(timeout_ms, 0);
+    int n = 0;
+    for (;;) {
+        for (int i = 0; i < uplink->window && n < max; i++) {
+            mqtt_batch_t *batch = &mqtt->batches[i];
+            if (!batch->busy || batch->pending > 0) continue;
+
+            if (batch->failed) {
+                LOG_WARNING("Remote upload failed: MQTT %s",
+                            batch->reason ? "publish refused" : "broker unreachable");
+            }
+            acks[n++] = (uplink_ack_t){
+                .tag = batch->tag,
+                .count = batch->count,
+                .bytes = batch->bytes,
+                .ok = !batch->failed,
+                .code = batch->reason,
+            };
+            batch->busy = false;
+        }
+        if (n > 0 || mqtt_client_in_flight(mqtt->client) == 0) break;
+
+        uint64_t now = get_time_ms();
+        if (now >= deadline) break;
+        pump(mqtt, (int)(deadline - now));
+    }
+    return n;
+}
+
+static void mqtt_service(uplink_t *uplink) {
+    pump(uplink->transport_data, 0);
+}
+
+const uplink_transport_ops_t uplink_mqtt_ops = {
+    .open = mqtt_open,
+    .close = mqtt_close,
+    .submit = mqtt_submit,
+    .poll = mqtt_poll,
+    .cancel = mqtt_cancel,
+    .service = mqtt_service,
+};
@@ -0,0 +1,50 @@
+/**
+ * @file uplink_transport.h
+ * @brief Internal interface between uplink.c and its transports
+ *
+ * uplink.c owns the window, the statistics and the choice of transport
+ * (by URL scheme); a transport only moves encoded batches and reports
+ * each one finished exactly once through its poll.
+ */
+
+#ifndef UPLINK_TRANSPORT_H
+#define UPLINK_TRANSPORT_H
+
+#include "uplink.h"
+
+/* Transport operations (implemented by each transport) */
+typedef struct {
+    result_t (*open)(uplink_t *uplink);
+    void (*close)(uplink_t *uplink);
+    result_t (*submit)(uplink_t *uplink, const uplink_entry_t *entries, int count,
+                       uint64_t tag, const char *key);
+    int (*poll)(uplink_t *uplink, int timeout_ms, uplink_ack_t *acks, int max);
+    void (*cancel)(uplink_t *uplink);
+    void (*service)(uplink_t *uplink);      /* Optional idle housekeeping */
+} uplink_transport_ops_t;
+
+struct uplink {
+    uplink_config_t config;
+    const uplink_transport_ops_t *ops;
+    void *transport_data;       /* Transport-specific state */
+    int window;
+    int in_flight;
+    uplink_stats_t stats;       /* bytes_* kept by the transport, the rest by uplink.c */
+};
+
+/**
+ * @brief Encode a batch with the uplink's format and compression
+ * @param raw_len Size before compression (optional)
+ */
+result_t uplink_encode_batch(const uplink_t *uplink, const uplink_entry_t *entries, int count,
+                             uplink_buf_t *out, size_t *raw_len);
+
+#ifdef HAVE_CURL
+extern const uplink_transport_ops_t uplink_http_ops;
+void uplink_http_global_init(void);
+void uplink_http_global_cleanup(void);
+#endif
+
+extern const uplink_transport_ops_t uplink_mqtt_ops;
+
+#endif
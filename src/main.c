@@ -15,11 +15,14 @@
 #include "config_defaults.h"
 #include "db/database.h"
 #include "db/db_events.h"
+#include "db/db_storage.h"
+#include "db/db_writer.h"
 #include "sensors/sensor_manager.h"
 #include "actuators/actuator_manager.h"
 #include "alarms/alarm_manager.h"
 #include "logging/data_logger.h"
 #include "profinet/profinet_manager.h"
+#include "profinet/profinet_gsdml.h"
 #include "health/health_check.h"
 #include "hal/led_status.h"
 #include "tui/tui_main.h"
@@ -259,6 +262,15 @@ static result_t init_database(void) {
         }
     }
 
+    /* Pragmas for the medium the database lives on, applied per connection */
+    const char *profile_name = g_app_config.database.storage_profile[0] ?
+                               g_app_config.database.storage_profile : WT_STORAGE_PROFILE;
+    db_storage_profile_t profile = DB_STORAGE_SD;
+    if (db_storage_profile_parse(profile_name, &profile) != RESULT_OK) {
+        LOG_WARNING("Unknown storage_profile '%s', using sd", profile_name);
+    }
+    db_storage_set_profile(profile);
+
     /* Initialize database */
     result_t r = database_init(&g_db, db_path);
     if (r != RESULT_OK) {
@@ -275,6 +287,16 @@ static result_t init_database(void) {
         return r;
     }
 
+    /* Background writes go through one writer thread; reads use a pool */
+    r = db_writer_init(&g_db);
+    if (r == RESULT_OK) r = db_writer_start();
+    if (r != RESULT_OK) {
+        LOG_WARNING("Database writer unavailable, writing on the main connection");
+    }
+
+    /* WAL checkpoints and vacuum off the committing threads */
+    db_storage_start(&g_db);
+
     LOG_INFO("Database initialized: %s", db_path);
     if (using_fallback) {
         LOG_WARNING("Using non-standard database location (install properly for production)");
@@ -419,6 +441,21 @@ static result_t init_data_logger(void) {
 
     SAFE_STRNCPY(log_config.device_name, g_app_config.system.device_name, sizeof(log_config.device_name));
     SAFE_STRNCPY(log_config.remote_url, g_app_config.logging.remote_url, sizeof(log_config.remote_url));
+    SAFE_STRNCPY(log_config.spool_dir, g_app_config.logging.spool_dir, sizeof(log_config.spool_dir));
+    log_config.spool_max_mb = g_app_config.logging.spool_max_mb;
+    SAFE_STRNCPY(log_config.remote_format, g_app_config.logging.remote_format,
+                 sizeof(log_config.remote_format));
+    log_config.remote_compress = g_app_config.logging.remote_compress;
+    log_config.remote_window = g_app_config.logging.remote_window;
+    SAFE_STRNCPY(log_config.remote_topics, g_app_config.logging.remote_topics,
+                 sizeof(log_config.remote_topics));
+    log_config.mqtt_version = g_app_config.logging.mqtt_version;
+    SAFE_STRNCPY(log_config.compression, g_app_config.logging.compression,
+                 sizeof(log_config.compression));
+    log_config.compression_dev = g_app_config.logging.compression_dev;
+    log_config.compression_heartbeat_s = g_app_config.logging.compression_heartbeat_s;
+    SAFE_STRNCPY(log_config.compression_devs, g_app_config.logging.compression_devs,
+                 sizeof(log_config.compression_devs));
 
     result_t r = data_logger_init(&g_db, &log_config);
     if (r != RESULT_OK) {
@@ -561,6 +598,10 @@ static void shutdown_subsystems(void) {
         LOG_INFO("PROFINET manager stopped");
     }
 
+    /* Every writer is stopped: drain the queue and close the pool */
+    db_storage_stop();
+    db_writer_shutdown();
+
     if (database_is_connected(&g_db)) {
         DB_EVENT_INFO(&g_db, "system", "Water-Treat RTU stopped");
         database_close(&g_db);
@@ -584,6 +625,7 @@ static void print_usage(const char *prog_name) {
     printf("  -h, --help          Show this help message\n");
     printf("  -V, --version       Show version information\n");
     printf("      --test-config   Print resolved config and exit\n");
+    printf("      --generate-gsdml DIR  Write GSDML for the configured modules and exit\n");
     printf("\n");
     printf("Environment Variables:\n");
     printf("  WT_HTTP_PORT        HTTP server port override\n");
@@ -611,6 +653,7 @@ int main(int argc, char *argv[]) {
     int verbose_level = 0;
     int cli_http_port = -1;  /* -1 means not specified */
     bool test_config_mode = false;
+    const char *gsdml_dir = NULL;
 
     // Parse command line arguments
     static struct option long_options[] = {
@@ -621,6 +664,7 @@ int main(int argc, char *argv[]) {
         {"help",        no_argument,       0, 'h'},
         {"version",     no_argument,       0, 'V'},
         {"test-config", no_argument,       0, 'T'},
+        {"generate-gsdml", required_argument, 0, 'G'},
         {0, 0, 0, 0}
     };
 
@@ -653,6 +697,9 @@ int main(int argc, char *argv[]) {
             case 'T':
                 test_config_mode = true;
                 break;
+            case 'G':
+                gsdml_dir = optarg;
+                break;
             default:
                 print_usage(argv[0]);
                 return 1;
@@ -724,6 +771,19 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // GSDML mode: describe the module layout the device would plug and exit
+    if (gsdml_dir) {
+        char gsdml_path[MAX_PATH_LEN];
+        result_t r = profinet_gsdml_generate(&g_db, &g_app_config.profinet, gsdml_dir,
+                                             gsdml_path, sizeof(gsdml_path));
+        if (r == RESULT_OK) printf("Wrote %s\n", gsdml_path);
+        db_storage_stop();
+        db_writer_shutdown();
+        database_close(&g_db);
+        logger_shutdown();
+        return r == RESULT_OK ? 0 : 1;
+    }
+
     // Initialize PROFINET
     if (init_profinet() != RESULT_OK) {
         LOG_WARNING("PROFINET initialization failed, continuing without it");
@@ -65,6 +65,164 @@ static im0_data_t g_im0_data = {
     .im_supported = 0x001F          // I&M0-4 supported (bits 0-4)
 };
 
+/* ============================================================================
+ * Sensor Diagnostic Records
+ * ========================================================================== */
+
+#define RECORD_HEADER_SIZE  6
+#define RECORD_BUF_SIZE     64
+
+/* Response buffer: read_cb only runs on the stack thread */
+static uint8_t g_record_buf[RECORD_BUF_SIZE];
+
+typedef struct {
+    uint8_t *p;
+    uint16_t len;
+} record_writer_t;
+
+static void put_u8(record_writer_t *w, uint8_t v) {
+    w->p[w->len++] = v;
+}
+
+static void put_u16(record_writer_t *w, uint16_t v) {
+    put_u8(w, (uint8_t)(v >> 8));
+    put_u8(w, (uint8_t)v);
+}
+
+static void put_u32(record_writer_t *w, uint32_t v) {
+    put_u16(w, (uint16_t)(v >> 16));
+    put_u16(w, (uint16_t)v);
+}
+
+static void put_f32(record_writer_t *w, float v) {
+    uint32_t raw;
+    memcpy(&raw, &v, sizeof(raw));
+    put_u32(w, raw);
+}
+
+static void record_begin(record_writer_t *w, uint16_t type, int sensor_slot) {
+    w->p = g_record_buf;
+    w->len = 0;
+    put_u16(w, type);
+    put_u16(w, 0);      /* Length, patched in record_end() */
+    put_u8(w, 1);       /* Version 1.0 */
+    put_u8(w, 0);
+    put_u16(w, (uint16_t)sensor_slot);
+}
+
+static uint16_t record_end(record_writer_t *w) {
+    uint16_t body = (uint16_t)(w->len - 4);
+    g_record_buf[2] = (uint8_t)(body >> 8);
+    g_record_buf[3] = (uint8_t)body;
+    return w->len;
+}
+
+static void record_error(pnet_result_t *result, uint8_t code, uint8_t code_1) {
+    result->pnio_status.error_code = code;
+    result->pnio_status.error_decode = PNET_ERROR_DECODE_PNIORW;
+    result->pnio_status.error_code_1 = code_1;
+    result->pnio_status.error_code_2 = 0;
+}
+
+static bool is_sensor_record(uint16_t idx) {
+    uint16_t base = idx & (uint16_t)~PROFINET_RECORD_CHANNEL_MASK;
+    return base == PROFINET_RECORD_SENSOR_STATUS ||
+           base == PROFINET_RECORD_SENSOR_CALIBRATION ||
+           base == PROFINET_RECORD_SENSOR_STATISTICS;
+}
+
+/*
+ * Build a sensor record from the diagnostics cache. Only memory copies:
+ * the cache is fed by the sensor worker, never by SQLite on this thread.
+ */
+static int read_sensor_record(uint16_t slot, uint16_t subslot, uint16_t idx,
+                              uint8_t **data, uint16_t *length, pnet_result_t *result) {
+    uint16_t base = idx & (uint16_t)~PROFINET_RECORD_CHANNEL_MASK;
+    int channel = idx & PROFINET_RECORD_CHANNEL_MASK;
+
+    int sensor_slot = profinet_manager_channel_sensor(slot, subslot, channel);
+    if (sensor_slot < 0) {
+        record_error(result, PNET_ERROR_CODE_READ, PNET_ERROR_CODE_1_ACC_INVALID_SLOT_SUBSLOT);
+        return -1;
+    }
+
+    profinet_sensor_diag_t d;
+    if (profinet_manager_get_diag(sensor_slot, &d) != RESULT_OK) {
+        /* No reading yet, or writer busy: the controller retries */
+        record_error(result, PNET_ERROR_CODE_READ, PNET_ERROR_CODE_1_ACC_STATE_CONFLICT);
+        return -1;
+    }
+
+    record_writer_t w;
+    record_begin(&w, base, sensor_slot);
+
+    switch (base) {
+        case PROFINET_RECORD_SENSOR_STATUS: {
+            uint64_t now = get_time_ms();
+            uint64_t age = (d.last_read_ms && now >= d.last_read_ms) ? now - d.last_read_ms : UINT32_MAX;
+            put_u8(&w, d.quality);
+            put_u8(&w, d.connected ? 1 : 0);
+            put_f32(&w, d.value);
+            put_u32(&w, (uint32_t)d.raw_value);
+            put_u32(&w, d.consecutive_failures);
+            put_u32(&w, (uint32_t)(d.total_reads >> 32));
+            put_u32(&w, (uint32_t)d.total_reads);
+            put_u32(&w, (uint32_t)(d.total_failures >> 32));
+            put_u32(&w, (uint32_t)d.total_failures);
+            put_u32(&w, (uint32_t)MIN(age, (uint64_t)UINT32_MAX));
+            break;
+        }
+
+        case PROFINET_RECORD_SENSOR_CALIBRATION:
+            put_f32(&w, d.cal_scale);
+            put_f32(&w, d.cal_offset);
+            put_f32(&w, d.scale_factor);
+            put_f32(&w, d.offset);
+            put_u32(&w, (uint32_t)d.raw_min);
+            put_u32(&w, (uint32_t)d.raw_max);
+            put_f32(&w, d.eng_min);
+            put_f32(&w, d.eng_max);
+            break;
+
+        default:
+            put_u32(&w, d.stat_count);
+            put_f32(&w, d.stat_min);
+            put_f32(&w, d.stat_max);
+            put_f32(&w, d.stat_mean);
+            break;
+    }
+
+    uint16_t len = record_end(&w);
+    if (len > *length) {
+        record_error(result, PNET_ERROR_CODE_READ, PNET_ERROR_CODE_1_ACC_INVALID_RANGE);
+        return -1;
+    }
+
+    *data = g_record_buf;
+    *length = len;
+    return 0;
+}
+
+static int write_sensor_record(uint16_t slot, uint16_t subslot, uint16_t idx,
+                               pnet_result_t *result) {
+    uint16_t base = idx & (uint16_t)~PROFINET_RECORD_CHANNEL_MASK;
+    int channel = idx & PROFINET_RECORD_CHANNEL_MASK;
+
+    if (base != PROFINET_RECORD_SENSOR_STATISTICS) {
+        record_error(result, PNET_ERROR_CODE_WRITE, PNET_ERROR_CODE_1_ACC_ACCESS_DENIED);
+        return -1;
+    }
+
+    int sensor_slot = profinet_manager_channel_sensor(slot, subslot, channel);
+    if (sensor_slot < 0 || profinet_manager_request_stats_reset(sensor_slot) != RESULT_OK) {
+        record_error(result, PNET_ERROR_CODE_WRITE, PNET_ERROR_CODE_1_ACC_INVALID_SLOT_SUBSLOT);
+        return -1;
+    }
+
+    LOG_INFO("Statistics reset requested for sensor slot %d", sensor_slot);
+    return 0;
+}
+
 /* ============================================================================
  * State and Connection Callbacks
  * ========================================================================== */
@@ -146,7 +304,7 @@ int profinet_read_callback(pnet_t *net, void *arg,
                            uint8_t **data, uint16_t *length,
                            pnet_result_t *result) {
     UNUSED(net); UNUSED(arg); UNUSED(arep); UNUSED(api);
-    UNUSED(sequence_number); UNUSED(result);
+    UNUSED(sequence_number);
     
     LOG_DEBUG("PROFINET read: slot=%u.%u, idx=0x%04X", slot, subslot, idx);
     
@@ -169,6 +327,9 @@ int profinet_read_callback(pnet_t *net, void *arg,
             break;
 
         default:
+            if (is_sensor_record(idx)) {
+                return read_sensor_record(slot, subslot, idx, data, length, result);
+            }
             // Application-specific read
             *data = NULL;
             *length = 0;
@@ -184,10 +345,14 @@ int profinet_write_callback(pnet_t *net, void *arg,
                             uint16_t write_length, const uint8_t *data,
                             pnet_result_t *result) {
     UNUSED(net); UNUSED(arg); UNUSED(arep); UNUSED(api);
-    UNUSED(sequence_number); UNUSED(result);
+    UNUSED(sequence_number);
     
     LOG_DEBUG("PROFINET write: slot=%u.%u, idx=0x%04X, len=%u", 
               slot, subslot, idx, write_length);
+
+    if (is_sensor_record(idx)) {
+        return write_sensor_record(slot, subslot, idx, result);
+    }
     
     // Handle parameterization data
     if (idx <= 0x7FFF) {
@@ -3,6 +3,26 @@
 
 #include "common.h"
 
+/*
+ * Vendor-specific acyclic records (index = base + channel)
+ *
+ * Served per input submodule; channel selects the sensor inside a packed
+ * submodule (always 0 for single-sensor modules). All fields big-endian,
+ * each record starts with a 6-byte block header (type = base index,
+ * length, version 1.0).
+ *
+ *   STATUS:      slot, quality, connected, value, raw value,
+ *                consecutive failures, total reads/failures, age (ms)
+ *   CALIBRATION: slot, cal scale/offset, scale factor/offset,
+ *                raw min/max, engineering min/max
+ *   STATISTICS:  slot, sample count, min, max, mean
+ *                (write any data to restart the statistics)
+ */
+#define PROFINET_RECORD_SENSOR_STATUS       0x1000
+#define PROFINET_RECORD_SENSOR_CALIBRATION  0x1100
+#define PROFINET_RECORD_SENSOR_STATISTICS   0x1200
+#define PROFINET_RECORD_CHANNEL_MASK        0x00FF
+
 #ifdef HAVE_PNET
 #include <pnet_api.h>
 
@@ -0,0 +1,472 @@
+/**
+ * @file profinet_gsdml.c
+ * @brief GSDML device description generation from the module configuration
+ *
+ * The static file under gsd/ describes one module per sensor. With packed
+ * submodules enabled the controller must be configured with the packed
+ * module types instead, so the description is generated from the same
+ * layout the device plugs at runtime.
+ */
+
+#include "profinet_gsdml.h"
+#include "profinet_manager.h"
+#include "db/db_modules.h"
+#include "utils/logger.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define GSDML_MIN_SLOTS        15      /* Slots declared by the static GSDML */
+#define GSDML_MIN_IO_LENGTH    512
+
+/* ============================================================================
+ * Actuator Module Types (unchanged from the static GSDML)
+ * ============================================================================ */
+
+typedef struct {
+    const char *id;
+    uint32_t module_ident;
+    uint32_t submodule_ident;
+    const char *text;
+    const char *order;
+    const char *items[4];
+} gsdml_output_module_t;
+
+static const gsdml_output_module_t output_modules[] = {
+    { "MOD_Pump_Control", 0x00000100, 0x00000101, "Pump", "WT-ACT-PUMP",
+      { "IDT_Pump_Cmd", "IDT_Pump_PWM", "IDT_Reserved", "IDT_Reserved" } },
+    { "MOD_Valve_Control", 0x00000110, 0x00000111, "Valve", "WT-ACT-VALVE",
+      { "IDT_Valve_Cmd", "IDT_Reserved", "IDT_Reserved", "IDT_Reserved" } },
+    { "MOD_Generic_Digital_Output", 0x00000120, 0x00000121, "GenDO", "WT-ACT-GEN",
+      { "IDT_DO_Cmd", "IDT_DO_PWM", "IDT_Reserved", "IDT_Reserved" } },
+};
+
+/* ============================================================================
+ * Helpers
+ * ============================================================================ */
+
+/* Module names end up inside XML comments: keep only safe characters */
+static void comment_safe(char *dst, size_t len, const char *src) {
+    size_t j = 0;
+    for (size_t i = 0; src[i] && j + 1 < len; i++) {
+        char c = src[i];
+        if (c == '-' && j > 0 && dst[j - 1] == '-') continue;
+        if (c == '<' || c == '>' || c == '&' || c < 0x20) c = '_';
+        dst[j++] = c;
+    }
+    dst[j] = '\0';
+}
+
+/* Index of the first layout module using the same type, or -1 if new */
+static int first_of_type(const profinet_layout_t *layout, int i) {
+    for (int j = 0; j < i; j++) {
+        if (layout->modules[j].module_ident == layout->modules[i].module_ident) return j;
+    }
+    return -1;
+}
+
+static int type_channels(const profinet_layout_module_t *m) {
+    return m->channel_count > 0 ? m->channel_count : 1;
+}
+
+static void write_header(FILE *f, const profinet_config_t *config,
+                         const profinet_layout_t *layout, const char *date) {
+    fprintf(f,
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<!--\n"
+        "    GSDML Device Description File\n"
+        "    Water Treatment RTU / Field I/O Device\n"
+        "\n"
+        "    Generated %s from the RTU module configuration.\n"
+        "    Do not edit by hand: regenerate with the generate-gsdml option.\n"
+        "\n"
+        "    Vendor ID: 0x%04X\n"
+        "    Device ID: 0x%04X\n"
+        "    Input modules: %d (%s)\n"
+        "\n"
+        "    Every input channel is a 5-byte record:\n"
+        "      Bytes 0-3: Float32 sensor value (big-endian)\n"
+        "      Byte 4:    Quality (0x00=Good, 0x40=Uncertain, 0x80=Bad, 0xC0=NotConnected)\n"
+        "-->\n",
+        date, config->vendor_id, config->device_id, layout->count,
+        config->packed_channels >= 2 ? "packed" : "one sensor per module");
+
+    fprintf(f,
+        "<ISO15745Profile xmlns=\"http://www.profibus.com/GSDML/2003/11/DeviceProfile\"\n"
+        "                 xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
+        "                 xsi:schemaLocation=\"http://www.profibus.com/GSDML/2003/11/DeviceProfile\">\n"
+        "\n"
+        "    <ProfileHeader>\n"
+        "        <ProfileIdentification>PROFINET Device Profile</ProfileIdentification>\n"
+        "        <ProfileRevision>1.00</ProfileRevision>\n"
+        "        <ProfileName>Device Profile for PROFINET Devices</ProfileName>\n"
+        "        <ProfileSource>PROFIBUS Nutzerorganisation e.V. (PNO)</ProfileSource>\n"
+        "        <ProfileClassID>Device</ProfileClassID>\n"
+        "        <ISO15745Reference>\n"
+        "            <ISO15745Part>4</ISO15745Part>\n"
+        "            <ISO15745Edition>1</ISO15745Edition>\n"
+        "            <ProfileTechnology>GSDML</ProfileTechnology>\n"
+        "        </ISO15745Reference>\n"
+        "    </ProfileHeader>\n"
+        "\n"
+        "    <ProfileBody>\n"
+        "        <DeviceIdentity VendorID=\"0x%04X\" DeviceID=\"0x%04X\">\n"
+        "            <InfoText TextId=\"IDT_DeviceInfo\"/>\n"
+        "            <VendorName Value=\"Water Treatment Training\"/>\n"
+        "        </DeviceIdentity>\n"
+        "\n"
+        "        <DeviceFunction>\n"
+        "            <Family MainFamily=\"I/O\" ProductFamily=\"Water Treatment RTU\"/>\n"
+        "        </DeviceFunction>\n"
+        "\n",
+        config->vendor_id, config->device_id);
+}
+
+static void write_dap(FILE *f, const profinet_config_t *config,
+                      const profinet_layout_t *layout, int max_slot, size_t input_len) {
+    size_t max_input = MAX((size_t)GSDML_MIN_IO_LENGTH, input_len);
+
+    fprintf(f,
+        "        <ApplicationProcess>\n"
+        "            <DeviceAccessPointList>\n"
+        "                <DeviceAccessPointItem ID=\"DAP_1\"\n"
+        "                                       PNIO_Version=\"V2.4\"\n"
+        "                                       PhysicalSlots=\"0..%d\"\n"
+        "                                       MinDeviceInterval=\"%u\"\n"
+        "                                       DNS_CompatibleName=\"water-treat-rtu\"\n"
+        "                                       FixedInSlots=\"0\"\n"
+        "                                       ObjectUUID_LocalIndex=\"1\"\n"
+        "                                       MultipleWriteSupported=\"true\"\n"
+        "                                       RequiredSchemaVersion=\"V2.4\"\n"
+        "                                       DeviceAccessSupported=\"false\"\n"
+        "                                       LLDP_NoD_Supported=\"true\"\n"
+        "                                       ResetToFactoryModes=\"2\">\n"
+        "\n"
+        "                    <ModuleInfo>\n"
+        "                        <Name TextId=\"IDT_DAP_Name\"/>\n"
+        "                        <InfoText TextId=\"IDT_DAP_Info\"/>\n"
+        "                        <VendorName Value=\"Water Treatment Training\"/>\n"
+        "                        <OrderNumber Value=\"WT-RTU-001\"/>\n"
+        "                        <HardwareRelease Value=\"1.0\"/>\n"
+        "                        <SoftwareRelease Value=\"V1.0\"/>\n"
+        "                    </ModuleInfo>\n"
+        "\n"
+        "                    <CertificationInfo ConformanceClass=\"B\" ApplicationClass=\"\"/>\n"
+        "\n"
+        "                    <IOConfigData MaxInputLength=\"%zu\" MaxOutputLength=\"%d\"/>\n"
+        "\n"
+        "                    <UseableModules>\n"
+        "                        <!-- Sensor Input Modules -->\n",
+        max_slot, config->min_device_interval ? config->min_device_interval : 32,
+        max_input, GSDML_MIN_IO_LENGTH);
+
+    for (int i = 0; i < layout->count; i++) {
+        if (first_of_type(layout, i) >= 0) continue;
+        fprintf(f,
+            "                        <ModuleItemRef ModuleItemTarget=\"MOD_Input_%08X\" AllowedInSlots=\"1..%d\"/>\n",
+            layout->modules[i].module_ident, max_slot);
+    }
+
+    fprintf(f, "\n                        <!-- Actuator Output Modules -->\n");
+    for (size_t i = 0; i < ARRAY_SIZE(output_modules); i++) {
+        fprintf(f,
+            "                        <ModuleItemRef ModuleItemTarget=\"%s\" AllowedInSlots=\"1..%d\"/>\n",
+            output_modules[i].id, max_slot);
+    }
+
+    fprintf(f,
+        "                    </UseableModules>\n"
+        "\n"
+        "                    <VirtualSubmoduleList>\n"
+        "                        <VirtualSubmoduleItem ID=\"VSM_DAP\" SubmoduleIdentNumber=\"0x00000001\"\n"
+        "                                             MayIssueProcessAlarm=\"false\">\n"
+        "                            <ModuleInfo>\n"
+        "                                <Name TextId=\"IDT_VSM_DAP\"/>\n"
+        "                                <InfoText TextId=\"IDT_VSM_DAP_Info\"/>\n"
+        "                            </ModuleInfo>\n"
+        "                            <IOData/>\n"
+        "                        </VirtualSubmoduleItem>\n"
+        "\n"
+        "                        <!-- Port Submodules -->\n"
+        "                        <VirtualSubmoduleItem ID=\"VSM_Port1\" SubmoduleIdentNumber=\"0x00008000\"\n"
+        "                                             MayIssueProcessAlarm=\"false\">\n"
+        "                            <ModuleInfo>\n"
+        "                                <Name TextId=\"IDT_Port1\"/>\n"
+        "                                <InfoText TextId=\"IDT_Port_Info\"/>\n"
+        "                            </ModuleInfo>\n"
+        "                            <IOData/>\n"
+        "                        </VirtualSubmoduleItem>\n"
+        "                    </VirtualSubmoduleList>\n"
+        "\n"
+        "                    <SystemDefinedSubmoduleList>\n"
+        "                        <InterfaceSubmoduleItem ID=\"ISM_1\" SubmoduleIdentNumber=\"0x00000100\"\n"
+        "                                               SubslotNumber=\"32768\"\n"
+        "                                               TextId=\"IDT_Interface\"\n"
+        "                                               SupportedRT_Classes=\"RT_CLASS_1\"\n"
+        "                                               SupportedProtocols=\"SNMP;LLDP\"\n"
+        "                                               NetworkComponentDiagnosisSupported=\"false\"\n"
+        "                                               DCP_BoundarySupported=\"false\"\n"
+        "                                               PTP_BoundarySupported=\"false\"\n"
+        "                                               DCP_HelloSupported=\"false\">\n"
+        "                            <ApplicationRelations>\n"
+        "                                <TimingProperties SendClock=\"32\" ReductionRatio=\"1 2 4 8 16 32 64 128 256 512\"/>\n"
+        "                            </ApplicationRelations>\n"
+        "                        </InterfaceSubmoduleItem>\n"
+        "                        <PortSubmoduleItem ID=\"PSM_1\" SubmoduleIdentNumber=\"0x00000200\"\n"
+        "                                          SubslotNumber=\"32769\"\n"
+        "                                          TextId=\"IDT_Port1\"\n"
+        "                                          MaxPortRxDelay=\"350\"\n"
+        "                                          MaxPortTxDelay=\"160\">\n"
+        "                        </PortSubmoduleItem>\n"
+        "                    </SystemDefinedSubmoduleList>\n"
+        "\n"
+        "                    <Graphics>\n"
+        "                        <GraphicItemRef Type=\"DeviceSymbol\" GraphicItemTarget=\"GFX_Device\"/>\n"
+        "                    </Graphics>\n"
+        "                </DeviceAccessPointItem>\n"
+        "            </DeviceAccessPointList>\n"
+        "\n");
+}
+
+/* Channel-to-sensor assignment of every slot using this module type */
+static void write_assignment(FILE *f, database_t *db, const profinet_layout_t *layout,
+                             uint32_t module_ident) {
+    for (int i = 0; i < layout->count; i++) {
+        const profinet_layout_module_t *m = &layout->modules[i];
+        if (m->module_ident != module_ident) continue;
+
+        int channels = type_channels(m);
+        for (int c = 0; c < channels; c++) {
+            int module_id = m->channel_count > 0 ? m->channel_module_ids[c] : m->module_id;
+            int sensor_slot = m->channel_count > 0 ? m->channel_slots[c] : m->slot;
+
+            db_module_t module;
+            char name[64] = "?";
+            if (db_module_get(db, module_id, &module) == RESULT_OK) {
+                comment_safe(name, sizeof(name), module.name);
+            }
+
+            fprintf(f, "                     Slot %d ch %d (bytes %d-%d): sensor slot %d \"%s\"\n",
+                    m->slot, c, c * PROFINET_CHANNEL_RECORD_SIZE,
+                    c * PROFINET_CHANNEL_RECORD_SIZE + PROFINET_CHANNEL_RECORD_SIZE - 1,
+                    sensor_slot, name);
+        }
+    }
+}
+
+static void write_input_modules(FILE *f, database_t *db, const profinet_layout_t *layout) {
+    fprintf(f,
+        "            <!-- ================================================================\n"
+        "                 SENSOR INPUT MODULES (RTU publishes to Controller)\n"
+        "                 ================================================================ -->\n"
+        "            <ModuleList>\n");
+
+    for (int i = 0; i < layout->count; i++) {
+        if (first_of_type(layout, i) >= 0) continue;
+
+        const profinet_layout_module_t *m = &layout->modules[i];
+        int channels = type_channels(m);
+
+        fprintf(f, "                <!-- %d channel(s), %d bytes\n",
+                channels, channels * PROFINET_CHANNEL_RECORD_SIZE);
+        write_assignment(f, db, layout, m->module_ident);
+        fprintf(f, "                -->\n");
+
+        fprintf(f,
+            "                <ModuleItem ID=\"MOD_Input_%08X\" ModuleIdentNumber=\"0x%08X\">\n"
+            "                    <ModuleInfo>\n"
+            "                        <Name TextId=\"IDT_MOD_Input_%08X\"/>\n"
+            "                        <InfoText TextId=\"IDT_MOD_Input_Info\"/>\n"
+            "                        <OrderNumber Value=\"WT-SENS-%dCH\"/>\n"
+            "                    </ModuleInfo>\n"
+            "                    <VirtualSubmoduleList>\n"
+            "                        <VirtualSubmoduleItem ID=\"VSM_Input_%08X\" SubmoduleIdentNumber=\"0x%08X\"\n"
+            "                                             MayIssueProcessAlarm=\"true\">\n"
+            "                            <ModuleInfo>\n"
+            "                                <Name TextId=\"IDT_MOD_Input_%08X\"/>\n"
+            "                                <InfoText TextId=\"IDT_MOD_Input_Info\"/>\n"
+            "                            </ModuleInfo>\n"
+            "                            <IOData>\n"
+            "                                <Input>\n",
+            m->module_ident, m->module_ident, m->module_ident, channels,
+            m->module_ident, m->submodule_ident, m->module_ident);
+
+        for (int c = 0; c < channels; c++) {
+            fprintf(f,
+                "                                    <DataItem DataType=\"Float32\" UseAsBits=\"false\" TextId=\"IDT_Ch%d_Value\"/>\n"
+                "                                    <DataItem DataType=\"Unsigned8\" UseAsBits=\"false\" TextId=\"IDT_Quality\"/>\n",
+                c);
+        }
+
+        fprintf(f,
+            "                                </Input>\n"
+            "                            </IOData>\n"
+            "                        </VirtualSubmoduleItem>\n"
+            "                    </VirtualSubmoduleList>\n"
+            "                </ModuleItem>\n"
+            "\n");
+    }
+}
+
+static void write_output_modules(FILE *f) {
+    fprintf(f,
+        "                <!-- ================================================================\n"
+        "                     ACTUATOR OUTPUT MODULES (Controller commands to RTU)\n"
+        "                     ================================================================ -->\n");
+
+    for (size_t i = 0; i < ARRAY_SIZE(output_modules); i++) {
+        const gsdml_output_module_t *m = &output_modules[i];
+
+        fprintf(f,
+            "                <ModuleItem ID=\"%s\" ModuleIdentNumber=\"0x%08X\">\n"
+            "                    <ModuleInfo>\n"
+            "                        <Name TextId=\"IDT_MOD_%s\"/>\n"
+            "                        <InfoText TextId=\"IDT_MOD_%s_Info\"/>\n"
+            "                        <OrderNumber Value=\"%s\"/>\n"
+            "                    </ModuleInfo>\n"
+            "                    <VirtualSubmoduleList>\n"
+            "                        <VirtualSubmoduleItem ID=\"VSM_%s\" SubmoduleIdentNumber=\"0x%08X\"\n"
+            "                                             MayIssueProcessAlarm=\"false\">\n"
+            "                            <ModuleInfo>\n"
+            "                                <Name TextId=\"IDT_VSM_%s\"/>\n"
+            "                                <InfoText TextId=\"IDT_VSM_%s_Info\"/>\n"
+            "                            </ModuleInfo>\n"
+            "                            <IOData>\n"
+            "                                <Output>\n",
+            m->id, m->module_ident, m->text, m->text, m->order,
+            m->text, m->submodule_ident, m->text, m->text);
+
+        for (size_t c = 0; c < ARRAY_SIZE(m->items); c++) {
+            fprintf(f,
+                "                                    <DataItem DataType=\"Unsigned8\" UseAsBits=\"false\" TextId=\"%s\"/>\n",
+                m->items[c]);
+        }
+
+        fprintf(f,
+            "                                </Output>\n"
+            "                            </IOData>\n"
+            "                        </VirtualSubmoduleItem>\n"
+            "                    </VirtualSubmoduleList>\n"
+            "                </ModuleItem>\n"
+            "\n");
+    }
+
+    fprintf(f, "            </ModuleList>\n\n");
+}
+
+static void write_texts(FILE *f, const profinet_layout_t *layout) {
+    int max_channels = 1;
+
+    fprintf(f,
+        "            <GraphicsList>\n"
+        "                <GraphicItem ID=\"GFX_Device\" GraphicFile=\"water-treat-rtu.bmp\"/>\n"
+        "            </GraphicsList>\n"
+        "\n"
+        "            <ExternalTextList>\n"
+        "                <PrimaryLanguage>\n"
+        "                    <Text TextId=\"IDT_DeviceInfo\" Value=\"Water Treatment RTU - Field I/O Device for SCADA Training\"/>\n"
+        "                    <Text TextId=\"IDT_DAP_Name\" Value=\"Water Treatment RTU\"/>\n"
+        "                    <Text TextId=\"IDT_DAP_Info\" Value=\"PROFINET I/O Device for water treatment sensor/actuator interface\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_DAP\" Value=\"Device Access Point\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_DAP_Info\" Value=\"Main device access point\"/>\n"
+        "                    <Text TextId=\"IDT_Interface\" Value=\"PROFINET Interface\"/>\n"
+        "                    <Text TextId=\"IDT_Port1\" Value=\"Port 1\"/>\n"
+        "                    <Text TextId=\"IDT_Port_Info\" Value=\"Ethernet port\"/>\n"
+        "                    <Text TextId=\"IDT_Quality\" Value=\"Data Quality (0x00=Good, 0x40=Uncertain, 0x80=Bad, 0xC0=NotConnected)\"/>\n"
+        "                    <Text TextId=\"IDT_MOD_Input_Info\" Value=\"Sensor inputs as 32-bit float + quality byte per channel\"/>\n");
+
+    for (int i = 0; i < layout->count; i++) {
+        const profinet_layout_module_t *m = &layout->modules[i];
+        max_channels = MAX(max_channels, type_channels(m));
+        if (first_of_type(layout, i) >= 0) continue;
+        fprintf(f, "                    <Text TextId=\"IDT_MOD_Input_%08X\" Value=\"%d-Channel Sensor Input\"/>\n",
+                m->module_ident, type_channels(m));
+    }
+
+    for (int c = 0; c < max_channels; c++) {
+        fprintf(f, "                    <Text TextId=\"IDT_Ch%d_Value\" Value=\"Channel %d Value (Float32, big-endian)\"/>\n",
+                c, c);
+    }
+
+    fprintf(f,
+        "                    <Text TextId=\"IDT_MOD_Pump\" Value=\"Pump Control Module\"/>\n"
+        "                    <Text TextId=\"IDT_MOD_Pump_Info\" Value=\"Peristaltic pump control (ON/OFF/PWM)\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_Pump\" Value=\"Pump Control\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_Pump_Info\" Value=\"Pump command output\"/>\n"
+        "                    <Text TextId=\"IDT_Pump_Cmd\" Value=\"Command (0=OFF, 1=ON, 2=PWM)\"/>\n"
+        "                    <Text TextId=\"IDT_Pump_PWM\" Value=\"PWM Duty Cycle (0-100)\"/>\n"
+        "                    <Text TextId=\"IDT_MOD_Valve\" Value=\"Valve Control Module\"/>\n"
+        "                    <Text TextId=\"IDT_MOD_Valve_Info\" Value=\"Solenoid valve control (ON/OFF)\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_Valve\" Value=\"Valve Control\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_Valve_Info\" Value=\"Valve command output\"/>\n"
+        "                    <Text TextId=\"IDT_Valve_Cmd\" Value=\"Command (0=CLOSE, 1=OPEN)\"/>\n"
+        "                    <Text TextId=\"IDT_MOD_GenDO\" Value=\"Generic Digital Output\"/>\n"
+        "                    <Text TextId=\"IDT_MOD_GenDO_Info\" Value=\"Generic digital output module\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_GenDO\" Value=\"Digital Output\"/>\n"
+        "                    <Text TextId=\"IDT_VSM_GenDO_Info\" Value=\"Generic digital output control\"/>\n"
+        "                    <Text TextId=\"IDT_DO_Cmd\" Value=\"Command\"/>\n"
+        "                    <Text TextId=\"IDT_DO_PWM\" Value=\"PWM Value\"/>\n"
+        "                    <Text TextId=\"IDT_Reserved\" Value=\"Reserved\"/>\n"
+        "                </PrimaryLanguage>\n"
+        "            </ExternalTextList>\n"
+        "        </ApplicationProcess>\n"
+        "    </ProfileBody>\n"
+        "</ISO15745Profile>\n");
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+result_t profinet_gsdml_generate(database_t *db, const profinet_config_t *config,
+                                 const char *dir, char *path, size_t path_len) {
+    CHECK_NULL(db); CHECK_NULL(config); CHECK_NULL(dir);
+
+    static profinet_layout_t layout;
+    result_t r = profinet_manager_build_layout(db, config->packed_channels, &layout);
+    if (r != RESULT_OK) {
+        LOG_ERROR("Failed to build PROFINET layout: %s", result_to_string(r));
+        return r;
+    }
+
+    int max_slot = GSDML_MIN_SLOTS;
+    size_t input_len = 0;
+    for (int i = 0; i < layout.count; i++) {
+        max_slot = MAX(max_slot, layout.modules[i].slot);
+        input_len += layout.modules[i].input_len;
+    }
+
+    char date[16];
+    time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    strftime(date, sizeof(date), "%Y%m%d", &tm);
+
+    char file[MAX_PATH_LEN];
+    snprintf(file, sizeof(file), "%s/GSDML-V2.4-WaterTreat-RTU-%s.xml", dir, date);
+
+    FILE *f = fopen(file, "w");
+    if (!f) {
+        LOG_ERROR("Cannot create %s", file);
+        return RESULT_IO_ERROR;
+    }
+
+    write_header(f, config, &layout, date);
+    write_dap(f, config, &layout, max_slot, input_len);
+    write_input_modules(f, db, &layout);
+    write_output_modules(f);
+    write_texts(f, &layout);
+
+    bool ok = !ferror(f);
+    if (fclose(f) != 0) ok = false;
+    if (!ok) {
+        LOG_ERROR("Failed writing %s", file);
+        return RESULT_IO_ERROR;
+    }
+
+    if (path) SAFE_STRNCPY(path, file, path_len);
+    LOG_INFO("Generated GSDML %s (%d input modules, %zu input bytes)",
+             file, layout.count, input_len);
+    return RESULT_OK;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file profinet_gsdml.h
+ * @brief GSDML device description generation from the module configuration
+ */
+
+#ifndef PROFINET_GSDML_H
+#define PROFINET_GSDML_H
+
+#include "common.h"
+#include "db/database.h"
+#include "config/config.h"
+
+/**
+ * @brief Write a GSDML file matching the current PROFINET module layout
+ *
+ * The input modules are derived from the database exactly as the device
+ * plugs them (see profinet_manager_build_layout()), so packed submodules
+ * declare one Float32 + quality record per channel. Actuator module types
+ * are emitted unchanged from the static GSDML.
+ *
+ * @param db Database holding the module configuration
+ * @param config PROFINET configuration (vendor/device ID, packing)
+ * @param dir Output directory, typically "gsd"
+ * @param path Receives the written file path (may be NULL)
+ * @param path_len Size of path buffer
+ * @return RESULT_OK on success
+ */
+result_t profinet_gsdml_generate(database_t *db, const profinet_config_t *config,
+                                 const char *dir, char *path, size_t path_len);
+
+#endif
@@ -9,6 +9,8 @@
 #include "db/db_modules.h"
 #include "utils/logger.h"
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>  /* htonl, ntohl for network byte order per DEVELOPMENT_GUIDELINES.md */
@@ -16,6 +18,9 @@
 #define PROFINET_TICK_INTERVAL_US   1000
 #define MAX_PROFINET_SLOTS          64
 #define PROFINET_DATA_SIZE          256
+#define PROFINET_SLOT_LUT_SIZE      256     /* Slot numbers with O(1) lookup */
+#define PROFINET_DIRTY_WORDS        ((MAX_PROFINET_SLOTS + 63) / 64)
+#define PROFINET_OUTPUT_QUEUE_SIZE  64      /* Power of two, >= MAX_PROFINET_SLOTS */
 
 typedef struct {
     int slot;
@@ -33,6 +38,80 @@ typedef struct {
     uint8_t input_iops;
 } profinet_slot_t;
 
+/*
+ * Input process image (back buffer)
+ *
+ * Producers (sensor worker, anything calling update_input/set_input_iops)
+ * write here without taking g_pn.mutex. Each entry is guarded by a sequence
+ * counter (odd while a write is in progress) and flagged in a dirty bitmap.
+ * The tick thread snapshots dirty entries into the front buffer
+ * (profinet_slot_t.input_data/input_iops) and pushes only those to the
+ * stack, so a cycle never publishes a half-written value and producers
+ * never wait on pnet_handle_periodic().
+ */
+typedef struct {
+    atomic_uint seq;
+    uint16_t size;
+    uint8_t iops;
+    uint8_t data[PROFINET_DATA_SIZE];
+} profinet_image_entry_t;
+
+/*
+ * Output command mailbox (one per slot)
+ *
+ * The tick thread only copies new controller output into the slot's
+ * mailbox and pushes the slot index onto an SPSC queue. If the slot is
+ * already queued the newer data overwrites the older (coalescing), so a
+ * slow actuator never sees a backlog of stale commands. The dispatch
+ * thread applies the latest data via on_data_received().
+ */
+typedef struct {
+    atomic_uint seq;
+    atomic_bool pending;
+    uint16_t size;
+    uint64_t queued_us;
+    uint8_t data[PROFINET_DATA_SIZE];
+} profinet_output_cmd_t;
+
+/*
+ * Sensor diagnostics cache (one per sensor slot)
+ *
+ * Written only by the sensor worker; readers (record service on the stack
+ * thread) retry on a torn sequence, so neither side ever blocks.
+ */
+typedef struct {
+    atomic_uint seq;
+    atomic_bool valid;
+    atomic_bool stats_reset;
+    profinet_sensor_diag_t diag;
+} profinet_diag_entry_t;
+
+#define PROFINET_DIAG_READ_RETRIES  8
+
+/*
+ * Diagnosis alarm table entry, one per (slot, subslot, type)
+ *
+ * The first alarm for a key is due immediately; repeats inside the
+ * coalescing window that follows a send are held until the window ends
+ * and only the latest data goes out. The entry is released once a window
+ * passes with nothing pending.
+ */
+typedef struct {
+    bool used;
+    bool pending;               /* Data waiting to be sent */
+    uint16_t slot;
+    uint16_t subslot;
+    uint16_t type;
+    uint16_t len;
+    uint64_t due_ms;            /* Earliest send time of pending data */
+    uint64_t quiet_until_ms;    /* End of coalescing window after last send */
+    uint8_t data[PROFINET_ALARM_DATA_MAX];
+} profinet_alarm_entry_t;
+
+#define PROFINET_ALARM_TABLE_SIZE   64
+#define PROFINET_ALARM_DAP_SLOT     0
+#define PROFINET_ALARM_DAP_SUBSLOT  1
+
 typedef struct {
 #ifdef HAVE_PNET
     pnet_t *pnet;
@@ -46,6 +125,55 @@ typedef struct {
     profinet_slot_t slots[MAX_PROFINET_SLOTS];
     int slot_count;
 
+    /* slot number -> index + 1 into slots[] (0 = not mapped) */
+    int16_t slot_lut[PROFINET_SLOT_LUT_SIZE];
+
+    /*
+     * sensor slot -> channel record inside a packed submodule, packed as
+     * CHANNEL_ENTRY(index + 1 into slots[], byte offset of the 5-byte
+     * record); 0 = not packed. One word so sensor threads read it lock-free.
+     */
+    _Atomic uint32_t channel_lut[PROFINET_SLOT_LUT_SIZE];
+
+    /* Layout last applied to slots[] and channel_lut */
+    profinet_layout_t layout;
+    bool layout_loaded;
+    pthread_mutex_t layout_mutex;   /* Serialises layout rebuilds */
+
+    profinet_image_entry_t input_image[MAX_PROFINET_SLOTS];
+    atomic_uint_least64_t input_dirty[PROFINET_DIRTY_WORDS];
+    atomic_uint_least64_t input_updates;
+    atomic_uint_least64_t input_publishes;
+
+    /* Output dispatch: tick thread -> dispatch thread */
+    profinet_output_cmd_t output_cmds[MAX_PROFINET_SLOTS];
+    uint16_t output_queue[PROFINET_OUTPUT_QUEUE_SIZE];
+    atomic_uint output_head;        /* Written by producer (tick thread) */
+    atomic_uint output_tail;        /* Written by consumer (dispatch thread) */
+    sem_t output_sem;
+    pthread_t dispatch_thread;
+    atomic_uint_least64_t output_commands;
+    atomic_uint_least64_t output_coalesced;
+    atomic_uint_least64_t output_dropped;
+    atomic_uint_least64_t output_applied;
+    atomic_uint_least64_t output_latency_sum_us;
+    atomic_uint_least64_t output_latency_max_us;
+
+    /* Diagnosis alarms: producers queue, tick thread sends */
+    profinet_alarm_entry_t alarms[PROFINET_ALARM_TABLE_SIZE];
+    pthread_mutex_t alarm_mutex;
+    double alarm_tokens;
+    uint64_t alarm_refill_ms;
+    atomic_uint_least64_t alarms_requested;
+    atomic_uint_least64_t alarms_sent;
+    atomic_uint_least64_t alarms_suppressed;
+    atomic_uint_least64_t alarms_aggregated;
+    atomic_uint_least64_t alarms_deferred;
+    atomic_uint_least64_t alarms_dropped;
+
+    /* Diagnostics for acyclic record reads, indexed by sensor slot */
+    profinet_diag_entry_t diag[PROFINET_SLOT_LUT_SIZE];
+
     pthread_t tick_thread;
     pthread_mutex_t mutex;
     volatile bool running;
@@ -65,30 +193,227 @@ typedef struct {
 
 static profinet_manager_t g_pn = {0};
 
+#define CHANNEL_ENTRY(index, offset)    (((uint32_t)(index) << 16) | (uint16_t)(offset))
+#define CHANNEL_INDEX(entry)            ((int)((entry) >> 16))
+#define CHANNEL_OFFSET(entry)           ((uint16_t)((entry) & 0xFFFFu))
+
 /* ============================================================================
  * Internal Functions
  * ========================================================================== */
 
-static profinet_slot_t* find_slot(int slot, int subslot) {
+static int find_slot_index(int slot, int subslot) {
+    if (slot >= 0 && slot < PROFINET_SLOT_LUT_SIZE) {
+        int idx = g_pn.slot_lut[slot] - 1;
+        if (idx >= 0 && g_pn.slots[idx].subslot == subslot) {
+            return idx;
+        }
+    }
+
+    /* Slots outside the LUT or with several subslots fall back to a scan */
     for (int i = 0; i < g_pn.slot_count; i++) {
         if (g_pn.slots[i].slot == slot && g_pn.slots[i].subslot == subslot) {
-            return &g_pn.slots[i];
+            return i;
         }
     }
-    return NULL;
+    return -1;
+}
+
+static profinet_slot_t* find_slot(int slot, int subslot) {
+    int idx = find_slot_index(slot, subslot);
+    return (idx >= 0) ? &g_pn.slots[idx] : NULL;
+}
+
+static void map_slot(int idx) {
+    int slot = g_pn.slots[idx].slot;
+    if (slot >= 0 && slot < PROFINET_SLOT_LUT_SIZE && g_pn.slot_lut[slot] == 0) {
+        g_pn.slot_lut[slot] = (int16_t)(idx + 1);
+    }
 }
 
 static profinet_slot_t* add_slot(int slot, int subslot) {
+    /* An existing slot is live to the producers: callers update its fields
+     * in place, it is never cleared */
+    int idx = find_slot_index(slot, subslot);
+    if (idx >= 0) {
+        map_slot(idx);
+        return &g_pn.slots[idx];
+    }
+
     if (g_pn.slot_count >= MAX_PROFINET_SLOTS) return NULL;
-    
-    profinet_slot_t *s = &g_pn.slots[g_pn.slot_count++];
+    idx = g_pn.slot_count;
+
+    /* Initialise a new slot before the count makes it visible to scans */
+    profinet_slot_t *s = &g_pn.slots[idx];
     memset(s, 0, sizeof(*s));
     s->slot = slot;
     s->subslot = subslot;
+    atomic_thread_fence(memory_order_release);
+    g_pn.slot_count = idx + 1;
+    map_slot(idx);
     return s;
 }
 
+/* ============================================================================
+ * Input Process Image
+ * ========================================================================== */
+
+static void image_mark_dirty(int idx) {
+    atomic_fetch_or_explicit(&g_pn.input_dirty[idx / 64],
+                             (uint_least64_t)1 << (idx % 64),
+                             memory_order_release);
+}
+
+static void image_mark_all_dirty(void) {
+    for (int i = 0; i < g_pn.slot_count; i++) {
+        image_mark_dirty(i);
+    }
+}
+
+static void image_write_begin(profinet_image_entry_t *e) {
+    unsigned int seq;
+    do {
+        seq = atomic_load_explicit(&e->seq, memory_order_relaxed);
+    } while ((seq & 1u) ||
+             !atomic_compare_exchange_weak_explicit(&e->seq, &seq, seq + 1,
+                                                    memory_order_acquire,
+                                                    memory_order_relaxed));
+}
+
+static void image_write_end(profinet_image_entry_t *e, int idx) {
+    atomic_fetch_add_explicit(&e->seq, 1, memory_order_release);
+    atomic_fetch_add_explicit(&g_pn.input_updates, 1, memory_order_relaxed);
+    image_mark_dirty(idx);
+}
+
+/* ============================================================================
+ * Output Dispatch
+ * ========================================================================== */
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * Queue controller output for the dispatch thread (single producer).
+ * Only memcpy and a few atomics, so it is safe on the stack thread.
+ */
+static void output_enqueue(int idx, const uint8_t *data, size_t len) {
+    profinet_output_cmd_t *cmd = &g_pn.output_cmds[idx];
+    if (len > sizeof(cmd->data)) len = sizeof(cmd->data);
+
+    atomic_fetch_add_explicit(&cmd->seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(cmd->data, data, len);
+    cmd->size = (uint16_t)len;
+    atomic_fetch_add_explicit(&cmd->seq, 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&g_pn.output_commands, 1, memory_order_relaxed);
+
+    if (atomic_load_explicit(&cmd->pending, memory_order_acquire)) {
+        /* Still queued: the dispatch thread will pick up the newer data */
+        atomic_fetch_add_explicit(&g_pn.output_coalesced, 1, memory_order_relaxed);
+        return;
+    }
+
+    unsigned int head = atomic_load_explicit(&g_pn.output_head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&g_pn.output_tail, memory_order_acquire);
+    if (head - tail >= PROFINET_OUTPUT_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&g_pn.output_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    cmd->queued_us = monotonic_us();
+    atomic_store_explicit(&cmd->pending, true, memory_order_release);
+    g_pn.output_queue[head & (PROFINET_OUTPUT_QUEUE_SIZE - 1)] = (uint16_t)idx;
+    atomic_store_explicit(&g_pn.output_head, head + 1, memory_order_release);
+    sem_post(&g_pn.output_sem);
+}
+
+/* Apply one queued slot (consumer side, dispatch thread only) */
+static void output_apply(int idx) {
+    profinet_output_cmd_t *cmd = &g_pn.output_cmds[idx];
+    uint8_t data[PROFINET_DATA_SIZE];
+    uint16_t len;
+    unsigned int before;
+
+    uint64_t queued_us = cmd->queued_us;
+    /* Clear first so writes landing after the snapshot are queued again */
+    atomic_store_explicit(&cmd->pending, false, memory_order_release);
+
+    do {
+        before = atomic_load_explicit(&cmd->seq, memory_order_acquire);
+        len = cmd->size;
+        if (len > sizeof(data)) len = sizeof(data);
+        memcpy(data, cmd->data, len);
+        atomic_thread_fence(memory_order_acquire);
+    } while ((before & 1u) ||
+             atomic_load_explicit(&cmd->seq, memory_order_relaxed) != before);
+
+    profinet_data_cb_t cb = g_pn.on_data_received;
+    if (cb && len > 0) {
+        cb(g_pn.slots[idx].slot, g_pn.slots[idx].subslot, data, len, g_pn.callback_ctx);
+    }
+
+    uint64_t latency = monotonic_us() - queued_us;
+    atomic_fetch_add_explicit(&g_pn.output_applied, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_pn.output_latency_sum_us, latency, memory_order_relaxed);
+    uint_least64_t max = atomic_load_explicit(&g_pn.output_latency_max_us, memory_order_relaxed);
+    while (latency > max &&
+           !atomic_compare_exchange_weak_explicit(&g_pn.output_latency_max_us, &max, latency,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void* profinet_dispatch_thread(void *arg) {
+    UNUSED(arg);
+
+    while (true) {
+        sem_wait(&g_pn.output_sem);
+
+        unsigned int tail = atomic_load_explicit(&g_pn.output_tail, memory_order_relaxed);
+        unsigned int head = atomic_load_explicit(&g_pn.output_head, memory_order_acquire);
+        if (tail == head) {
+            if (!g_pn.running) break;   /* Wake-up from profinet_manager_stop() */
+            continue;
+        }
+
+        int idx = g_pn.output_queue[tail & (PROFINET_OUTPUT_QUEUE_SIZE - 1)];
+        atomic_store_explicit(&g_pn.output_tail, tail + 1, memory_order_release);
+        output_apply(idx);
+    }
+
+    return NULL;
+}
+
 #ifdef HAVE_PNET
+/**
+ * Copy one back-buffer entry into the front buffer.
+ * Returns false if a producer was mid-write; the caller re-marks the slot
+ * dirty and picks it up next cycle instead of spinning on the stack thread.
+ */
+static bool image_snapshot(int idx) {
+    profinet_image_entry_t *e = &g_pn.input_image[idx];
+    profinet_slot_t *s = &g_pn.slots[idx];
+
+    unsigned int before = atomic_load_explicit(&e->seq, memory_order_acquire);
+    if (before & 1u) return false;
+
+    uint16_t size = e->size;
+    uint8_t iops = e->iops;
+    if (size > sizeof(s->input_data)) size = sizeof(s->input_data);
+    memcpy(s->input_data, e->data, size);
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&e->seq, memory_order_relaxed) != before) return false;
+
+    s->input_size = size;
+    s->input_iops = iops;
+    s->input_valid = true;
+    return true;
+}
+
 static void poll_output_slots(void) {
     /* Poll all output slots for new data from controller */
     for (int i = 0; i < g_pn.slot_count; i++) {
@@ -109,17 +434,206 @@ static void poll_output_slots(void) {
         if (ret == 0 && new_data && iops == PNET_IOXS_GOOD) {
             /* Check if data actually changed to avoid redundant callbacks */
             if (len > 0 && memcmp(data, slot->output_data, len) != 0) {
-                /* New data received - cache and dispatch to listeners */
+                /* New data received - cache and hand off to the dispatch thread */
                 memcpy(slot->output_data, data, len);
                 slot->output_valid = true;
+                output_enqueue(i, data, len);
+            }
+        }
+    }
+}
 
-                /* Call the data callback (actuator manager handler) */
-                if (g_pn.on_data_received) {
-                    g_pn.on_data_received(slot->slot, slot->subslot, data, len, g_pn.callback_ctx);
-                }
+/**
+ * Swap dirty back-buffer entries into the front buffer and push them to
+ * the stack together with their IOPS. Clean slots are not touched.
+ */
+static void publish_input_image(void) {
+    for (int w = 0; w < PROFINET_DIRTY_WORDS; w++) {
+        uint_least64_t bits = atomic_exchange_explicit(&g_pn.input_dirty[w], 0,
+                                                       memory_order_acq_rel);
+        while (bits) {
+            int idx = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            if (idx >= g_pn.slot_count) continue;
+            if (!image_snapshot(idx)) {
+                image_mark_dirty(idx);
+                continue;
             }
+
+            profinet_slot_t *s = &g_pn.slots[idx];
+            if (!s->plugged || s->input_size == 0) continue;
+
+            pnet_input_set_data_and_iops(g_pn.pnet, 0, s->slot, s->subslot,
+                                          s->input_data, s->input_size, s->input_iops);
+            atomic_fetch_add_explicit(&g_pn.input_publishes, 1, memory_order_relaxed);
+        }
+    }
+}
+
+/* ============================================================================
+ * Diagnosis Alarm Dispatcher
+ * ========================================================================== */
+
+static profinet_alarm_entry_t* alarm_find(int slot, int subslot, uint16_t type) {
+    profinet_alarm_entry_t *free_entry = NULL;
+
+    for (int i = 0; i < PROFINET_ALARM_TABLE_SIZE; i++) {
+        profinet_alarm_entry_t *e = &g_pn.alarms[i];
+        if (!e->used) {
+            if (!free_entry) free_entry = e;
+            continue;
         }
+        if (e->slot == slot && e->subslot == subslot && e->type == type) return e;
+    }
+
+    if (free_entry) {
+        memset(free_entry, 0, sizeof(*free_entry));
+        free_entry->used = true;
+        free_entry->slot = (uint16_t)slot;
+        free_entry->subslot = (uint16_t)subslot;
+        free_entry->type = type;
     }
+    return free_entry;
+}
+
+static void alarm_refill(uint64_t now) {
+    if (g_pn.config.alarm_rate <= 0) return;
+
+    double burst = MAX(g_pn.config.alarm_burst, 1);
+    g_pn.alarm_tokens += (double)(now - g_pn.alarm_refill_ms) * g_pn.config.alarm_rate / 1000.0;
+    if (g_pn.alarm_tokens > burst) g_pn.alarm_tokens = burst;
+    g_pn.alarm_refill_ms = now;
+}
+
+static bool alarm_take_token(void) {
+    if (g_pn.config.alarm_rate <= 0) return true;
+    if (g_pn.alarm_tokens < 1.0) return false;
+    g_pn.alarm_tokens -= 1.0;
+    return true;
+}
+
+static void alarm_refund_token(void) {
+    if (g_pn.config.alarm_rate > 0) g_pn.alarm_tokens += 1.0;
+}
+
+static bool alarm_transmit(uint16_t slot, uint16_t subslot, uint16_t type,
+                           const uint8_t *data, uint16_t len) {
+    // p-net v0.2.0 API: positional arguments instead of struct
+    // pnet_alarm_send_process_alarm(pnet, arep, api, slot, subslot, usi, len, data)
+    int ret = pnet_alarm_send_process_alarm(
+        g_pn.pnet,
+        g_pn.arep,           // arep from connection
+        0,                   // api (always 0 for standard PROFINET)
+        slot,
+        subslot,
+        type,                // User Structure Identifier (USI)
+        len,
+        data
+    );
+    if (ret != 0) {
+        /* Previous alarm not yet acknowledged; retried next tick */
+        LOG_DEBUG("PROFINET alarm slot=%u type=0x%04X not accepted, retrying", slot, type);
+        return false;
+    }
+
+    atomic_fetch_add_explicit(&g_pn.alarms_sent, 1, memory_order_relaxed);
+    LOG_INFO("Sent PROFINET alarm: slot=%u, type=0x%04X", slot, type);
+    return true;
+}
+
+static int alarm_count_due(uint16_t type, uint64_t now) {
+    int count = 0;
+    for (int i = 0; i < PROFINET_ALARM_TABLE_SIZE; i++) {
+        const profinet_alarm_entry_t *e = &g_pn.alarms[i];
+        if (e->used && e->pending && e->type == type && now >= e->due_ms) count++;
+    }
+    return count;
+}
+
+/* One "multiple channels faulted" alarm for every due entry of a type */
+static bool alarm_send_aggregate(uint16_t type, uint64_t now, int window_ms) {
+    uint8_t payload[PROFINET_ALARM_DATA_MAX];
+    uint16_t len = 4;
+    uint16_t count = 0;
+
+    for (int i = 0; i < PROFINET_ALARM_TABLE_SIZE; i++) {
+        const profinet_alarm_entry_t *e = &g_pn.alarms[i];
+        if (!e->used || !e->pending || e->type != type || now < e->due_ms) continue;
+
+        count++;
+        if (len + 4 <= sizeof(payload)) {
+            payload[len++] = (uint8_t)(e->slot >> 8);
+            payload[len++] = (uint8_t)e->slot;
+            payload[len++] = (uint8_t)(e->subslot >> 8);
+            payload[len++] = (uint8_t)e->subslot;
+        }
+    }
+    payload[0] = (uint8_t)(type >> 8);
+    payload[1] = (uint8_t)type;
+    payload[2] = (uint8_t)(count >> 8);
+    payload[3] = (uint8_t)count;
+
+    if (!alarm_transmit(PROFINET_ALARM_DAP_SLOT, PROFINET_ALARM_DAP_SUBSLOT,
+                        PROFINET_ALARM_USI_MULTI_CHANNEL, payload, len)) {
+        return false;
+    }
+
+    for (int i = 0; i < PROFINET_ALARM_TABLE_SIZE; i++) {
+        profinet_alarm_entry_t *e = &g_pn.alarms[i];
+        if (!e->used || !e->pending || e->type != type || now < e->due_ms) continue;
+        e->pending = false;
+        e->quiet_until_ms = now + (uint64_t)window_ms;
+    }
+    atomic_fetch_add_explicit(&g_pn.alarms_aggregated, count, memory_order_relaxed);
+    return true;
+}
+
+/* Send due alarms within the rate budget (tick thread, connected) */
+static void flush_alarms(void) {
+    uint64_t now = get_time_ms();
+    int window_ms = MAX(g_pn.config.alarm_window_ms, 0);
+    int aggregate = g_pn.config.alarm_aggregate;
+    bool held = false;
+
+    pthread_mutex_lock(&g_pn.alarm_mutex);
+    alarm_refill(now);
+
+    for (int i = 0; i < PROFINET_ALARM_TABLE_SIZE && !held; i++) {
+        profinet_alarm_entry_t *e = &g_pn.alarms[i];
+        if (!e->used) continue;
+
+        if (!e->pending) {
+            if (now >= e->quiet_until_ms) e->used = false;
+            continue;
+        }
+        if (now < e->due_ms) continue;
+
+        if (!alarm_take_token()) {
+            held = true;
+            break;
+        }
+
+        bool sent;
+        if (aggregate >= 2 && alarm_count_due(e->type, now) >= aggregate) {
+            sent = alarm_send_aggregate(e->type, now, window_ms);
+        } else {
+            sent = alarm_transmit(e->slot, e->subslot, e->type, e->data, e->len);
+            if (sent) {
+                e->pending = false;
+                e->quiet_until_ms = now + (uint64_t)window_ms;
+            }
+        }
+
+        if (!sent) {
+            /* Stack busy: keep everything queued for the next tick */
+            alarm_refund_token();
+            break;
+        }
+    }
+
+    if (held) atomic_fetch_add_explicit(&g_pn.alarms_deferred, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&g_pn.alarm_mutex);
 }
 
 static void* profinet_tick_thread(void *arg) {
@@ -132,9 +646,11 @@ static void* profinet_tick_thread(void *arg) {
             pnet_handle_periodic(g_pn.pnet);
             g_pn.cycle_count++;
 
-            /* Poll output slots when connected to controller */
+            /* Exchange cyclic data when connected to controller */
             if (g_pn.connected) {
+                publish_input_image();
                 poll_output_slots();
+                flush_alarms();
             }
         }
 
@@ -147,34 +663,189 @@ static void* profinet_tick_thread(void *arg) {
 }
 #endif
 
-static result_t load_modules_from_db(void) {
-    if (!g_pn.db) return RESULT_NOT_INITIALIZED;
-    
+static bool is_profinet_sensor(const db_module_t *module) {
+    /* Calculated sensors are not published (matches sensor_manager) */
+    return strcmp(module->module_type, "calculated") != 0;
+}
+
+static void layout_packed(const db_module_t *modules, int count, int channels,
+                          profinet_layout_t *layout) {
+    profinet_layout_module_t *m = NULL;
+
+    for (int i = 0; i < count; i++) {
+        if (!is_profinet_sensor(&modules[i])) continue;
+
+        if (!m || m->channel_count >= channels) {
+            if (layout->count >= PROFINET_LAYOUT_MAX_MODULES) {
+                LOG_WARNING("PROFINET layout full, sensor slot %d not published", modules[i].slot);
+                break;
+            }
+            m = &layout->modules[layout->count++];
+            memset(m, 0, sizeof(*m));
+            m->slot = modules[i].slot;
+            m->subslot = PROFINET_PACKED_SUBSLOT;
+        }
+
+        m->channel_slots[m->channel_count] = modules[i].slot;
+        m->channel_module_ids[m->channel_count] = modules[i].id;
+        m->channel_count++;
+    }
+
+    /* Ident and size depend on the final channel count of each module */
+    for (int i = 0; i < layout->count; i++) {
+        m = &layout->modules[i];
+        m->module_ident = PROFINET_PACKED_IDENT(m->channel_count);
+        m->submodule_ident = PROFINET_PACKED_IDENT(m->channel_count);
+        m->input_len = (size_t)m->channel_count * PROFINET_CHANNEL_RECORD_SIZE;
+    }
+}
+
+result_t profinet_manager_build_layout(database_t *db, int packed_channels,
+                                       profinet_layout_t *layout) {
+    CHECK_NULL(db); CHECK_NULL(layout);
+
+    memset(layout, 0, sizeof(*layout));
+
     db_module_t *modules = NULL;
     int count = 0;
-    
-    result_t r = db_module_list(g_pn.db, &modules, &count);
+    result_t r = db_module_list(db, &modules, &count);
     if (r != RESULT_OK) return r;
-    
-    for (int i = 0; i < count && i < MAX_PROFINET_SLOTS; i++) {
-        profinet_slot_t *slot = add_slot(modules[i].slot, modules[i].subslot);
-        if (slot) {
-            slot->module_id = modules[i].id;
-            slot->module_ident = modules[i].module_ident;
-            slot->submodule_ident = modules[i].submodule_ident;
-            slot->input_size = 4;  // Default: 4 bytes (float)
-            slot->output_size = 0;
-            LOG_DEBUG("Loaded slot %d: module_id=%d, ident=0x%08X", 
-                      slot->slot, slot->module_id, slot->module_ident);
+
+    if (packed_channels >= 2) {
+        layout_packed(modules, count, MIN(packed_channels, PROFINET_PACKED_MAX_CHANNELS), layout);
+    } else {
+        for (int i = 0; i < count && layout->count < PROFINET_LAYOUT_MAX_MODULES; i++) {
+            profinet_layout_module_t *m = &layout->modules[layout->count++];
+            m->slot = modules[i].slot;
+            m->subslot = modules[i].subslot;
+            m->module_ident = modules[i].module_ident;
+            m->submodule_ident = modules[i].submodule_ident;
+            m->module_id = modules[i].id;
+            m->input_len = PROFINET_CHANNEL_RECORD_SIZE;
         }
     }
-    
-    if (modules) free(modules);
-    
-    LOG_INFO("Loaded %d modules from database", g_pn.slot_count);
+
+    free(modules);
     return RESULT_OK;
 }
 
+/* Initial packed image: every channel NOT_CONNECTED until its sensor reports */
+static void init_packed_image(int idx, size_t len) {
+    profinet_image_entry_t *e = &g_pn.input_image[idx];
+
+    image_write_begin(e);
+    memset(e->data, 0, len);
+    for (size_t off = 0; off + PROFINET_CHANNEL_RECORD_SIZE <= len;
+         off += PROFINET_CHANNEL_RECORD_SIZE) {
+        e->data[off + 4] = QUALITY_NOT_CONNECTED;
+    }
+    e->size = (uint16_t)len;
+    e->iops = PNET_IOXS_BAD;
+    atomic_fetch_add_explicit(&e->seq, 1, memory_order_release);
+}
+
+/*
+ * (Re)build slots[] and channel_lut from the modules in the database
+ *
+ * Runs at init and again from profinet_manager_apply_layout() on a sensor
+ * reload, so a sensor deleted or moved since the last build loses its
+ * packed mapping. Slots are updated in place; an unchanged layout is left
+ * alone.
+ */
+static result_t load_modules_from_db(void) {
+    if (!g_pn.db) return RESULT_NOT_INITIALIZED;
+
+    static profinet_layout_t layout;
+    static uint32_t lut[PROFINET_SLOT_LUT_SIZE];
+
+    pthread_mutex_lock(&g_pn.layout_mutex);
+
+    result_t r = profinet_manager_build_layout(g_pn.db, g_pn.config.packed_channels, &layout);
+    if (r != RESULT_OK ||
+        (g_pn.layout_loaded && memcmp(&layout, &g_pn.layout, sizeof(layout)) == 0)) {
+        pthread_mutex_unlock(&g_pn.layout_mutex);
+        return r;
+    }
+
+    bool reload = g_pn.layout_loaded;
+    memset(lut, 0, sizeof(lut));
+    pthread_mutex_lock(&g_pn.mutex);
+
+    int packed = 0;
+    for (int i = 0; i < layout.count; i++) {
+        const profinet_layout_module_t *m = &layout.modules[i];
+        profinet_slot_t *slot = add_slot(m->slot, m->subslot);
+        if (!slot) break;
+
+        int idx = (int)(slot - g_pn.slots);
+        slot->module_id = m->module_id;
+        slot->module_ident = m->module_ident;
+        slot->submodule_ident = m->submodule_ident;
+        slot->input_size = m->input_len;
+        slot->output_size = 0;
+        slot->input_iops = PNET_IOXS_BAD;
+
+        if (m->channel_count > 0) {
+            for (int c = 0; c < m->channel_count; c++) {
+                int sensor_slot = m->channel_slots[c];
+                if (sensor_slot < 0 || sensor_slot >= PROFINET_SLOT_LUT_SIZE) continue;
+                lut[sensor_slot] = CHANNEL_ENTRY(idx + 1, c * PROFINET_CHANNEL_RECORD_SIZE);
+            }
+            init_packed_image(idx, m->input_len);
+            packed++;
+        }
+
+        LOG_DEBUG("Loaded slot %d: module_id=%d, ident=0x%08X, channels=%d",
+                  slot->slot, slot->module_id, slot->module_ident, m->channel_count);
+    }
+
+    /* Packed modules that left the layout report every channel NOT_CONNECTED */
+    for (int i = 0; i < g_pn.layout.count; i++) {
+        const profinet_layout_module_t *old = &g_pn.layout.modules[i];
+        if (old->channel_count == 0) continue;
+
+        bool kept = false;
+        for (int j = 0; j < layout.count && !kept; j++) {
+            kept = layout.modules[j].channel_count > 0 &&
+                   layout.modules[j].slot == old->slot &&
+                   layout.modules[j].subslot == old->subslot;
+        }
+        int idx = find_slot_index(old->slot, old->subslot);
+        if (!kept && idx >= 0) init_packed_image(idx, old->input_len);
+    }
+
+    /* Every entry is rewritten: mappings missing from the new layout clear */
+    for (int s = 0; s < PROFINET_SLOT_LUT_SIZE; s++) {
+        if (atomic_load_explicit(&g_pn.channel_lut[s], memory_order_relaxed) != lut[s]) {
+            atomic_store_explicit(&g_pn.channel_lut[s], lut[s], memory_order_release);
+        }
+    }
+
+    memcpy(&g_pn.layout, &layout, sizeof(layout));
+    g_pn.layout_loaded = true;
+
+    pthread_mutex_unlock(&g_pn.mutex);
+    pthread_mutex_unlock(&g_pn.layout_mutex);
+
+    if (packed > 0) {
+        LOG_INFO("%s %d modules from database (%d packed, up to %d channels each)",
+                 reload ? "Rebuilt" : "Loaded", g_pn.slot_count, packed,
+                 g_pn.config.packed_channels);
+    } else {
+        LOG_INFO("%s %d modules from database", reload ? "Rebuilt" : "Loaded", g_pn.slot_count);
+    }
+    return RESULT_OK;
+}
+
+/* Packed channel for a sensor slot, or -1 */
+static int find_channel(int slot, int subslot, uint16_t *offset) {
+    if (subslot != 0 || slot < 0 || slot >= PROFINET_SLOT_LUT_SIZE) return -1;
+    uint32_t entry = atomic_load_explicit(&g_pn.channel_lut[slot], memory_order_acquire);
+    int idx = CHANNEL_INDEX(entry) - 1;
+    if (idx >= 0) *offset = CHANNEL_OFFSET(entry);
+    return idx;
+}
+
 /* ============================================================================
  * Public API
  * ========================================================================== */
@@ -189,6 +860,11 @@ result_t profinet_manager_init(database_t *db, const profinet_config_t *config)
     memcpy(&g_pn.config, config, sizeof(profinet_config_t));
     
     pthread_mutex_init(&g_pn.mutex, NULL);
+    pthread_mutex_init(&g_pn.alarm_mutex, NULL);
+    pthread_mutex_init(&g_pn.layout_mutex, NULL);
+    sem_init(&g_pn.output_sem, 0, 0);
+    g_pn.alarm_tokens = MAX(config->alarm_burst, 1);
+    g_pn.alarm_refill_ms = get_time_ms();
     
 #ifdef HAVE_PNET
     // Configure p-net
@@ -241,6 +917,20 @@ result_t profinet_manager_init(database_t *db, const profinet_config_t *config)
     return RESULT_OK;
 }
 
+static result_t start_dispatch_thread(void) {
+    if (pthread_create(&g_pn.dispatch_thread, NULL, profinet_dispatch_thread, NULL) != 0) {
+        LOG_ERROR("Failed to create PROFINET output dispatch thread");
+        return RESULT_ERROR;
+    }
+    return RESULT_OK;
+}
+
+/* Caller clears g_pn.running first; the extra post wakes an idle consumer */
+static void stop_dispatch_thread(void) {
+    sem_post(&g_pn.output_sem);
+    pthread_join(g_pn.dispatch_thread, NULL);
+}
+
 #ifdef HAVE_PNET
 // Static buffer for network interface name (p-net v0.2.0 uses const char *)
 static char g_netif_name[64] = "eth0";
@@ -281,10 +971,14 @@ result_t profinet_manager_start(const char *interface) {
             continue;
         }
         
+        pnet_submodule_dir_t dir = PNET_DIR_INPUT;
+        if (slot->output_size > 0) {
+            dir = (slot->input_size > 0) ? PNET_DIR_IO : PNET_DIR_OUTPUT;
+        }
+
         ret = pnet_plug_submodule(g_pn.pnet, 0, slot->slot, slot->subslot,
                                   slot->module_ident, slot->submodule_ident,
-                                  PNET_DIR_INPUT,
-                                  slot->input_size, slot->output_size);
+                                  dir, slot->input_size, slot->output_size);
         if (ret != 0) {
             LOG_WARNING("Failed to plug submodule at slot %d.%d", slot->slot, slot->subslot);
             continue;
@@ -297,10 +991,18 @@ result_t profinet_manager_start(const char *interface) {
     // p-net v0.2.0: Device state machine is handled internally by the stack
     // The device becomes ready for connections after modules are plugged
 
-    // Start tick thread
+    // Start output dispatch, then tick thread
     g_pn.running = true;
+    if (start_dispatch_thread() != RESULT_OK) {
+        g_pn.pnet = NULL;
+        g_pn.running = false;
+        return RESULT_ERROR;
+    }
+
     if (pthread_create(&g_pn.tick_thread, NULL, profinet_tick_thread, NULL) != 0) {
         LOG_ERROR("Failed to create PROFINET tick thread");
+        g_pn.running = false;
+        stop_dispatch_thread();
         // p-net v0.2.0: No explicit close function, just clean up handle
         g_pn.pnet = NULL;
         g_pn.running = false;
@@ -313,6 +1015,10 @@ result_t profinet_manager_start(const char *interface) {
     UNUSED(interface);
     LOG_WARNING("PROFINET support not compiled in (HAVE_PNET not defined)");
     g_pn.running = true;
+    if (start_dispatch_thread() != RESULT_OK) {
+        g_pn.running = false;
+        return RESULT_ERROR;
+    }
     g_pn.state = PROFINET_STATE_READY;
 #endif
 
@@ -330,7 +1036,12 @@ result_t profinet_manager_stop(void) {
     LOG_DEBUG("Waiting for PROFINET tick thread to terminate...");
     pthread_join(g_pn.tick_thread, NULL);
     LOG_DEBUG("PROFINET tick thread terminated");
+#endif
+
+    /* Tick thread is gone, so nothing else is enqueued; drain and exit */
+    stop_dispatch_thread();
 
+#ifdef HAVE_PNET
     /*
      * p-net cleanup: The p-net library (v0.2.0+) may not have explicit
      * pnet_close() depending on version. We attempt to call it if available,
@@ -365,6 +1076,9 @@ result_t profinet_manager_stop(void) {
 
 void profinet_manager_shutdown(void) {
     profinet_manager_stop();
+    sem_destroy(&g_pn.output_sem);
+    pthread_mutex_destroy(&g_pn.alarm_mutex);
+    pthread_mutex_destroy(&g_pn.layout_mutex);
     pthread_mutex_destroy(&g_pn.mutex);
     g_pn.initialized = false;
     LOG_INFO("PROFINET manager shutdown");
@@ -372,30 +1086,23 @@ void profinet_manager_shutdown(void) {
 
 result_t profinet_manager_update_input(int slot, int subslot, const void *data, size_t size) {
     if (!g_pn.initialized) return RESULT_NOT_INITIALIZED;
-    
-    pthread_mutex_lock(&g_pn.mutex);
-    
-    profinet_slot_t *s = find_slot(slot, subslot);
-    if (!s || !s->plugged) {
-        pthread_mutex_unlock(&g_pn.mutex);
-        return RESULT_NOT_FOUND;
-    }
-    
-    if (size > sizeof(s->input_data)) size = sizeof(s->input_data);
-    
-    memcpy(s->input_data, data, size);
-    s->input_size = size;
-    s->input_valid = true;
-    
-#ifdef HAVE_PNET
-    if (g_pn.pnet && g_pn.connected) {
-        uint8_t iops = PNET_IOXS_GOOD;
-        pnet_input_set_data_and_iops(g_pn.pnet, 0, slot, subslot, 
-                                      s->input_data, s->input_size, iops);
-    }
-#endif
-    
-    pthread_mutex_unlock(&g_pn.mutex);
+    CHECK_NULL(data);
+
+    /*
+     * Lock-free: write into the back buffer and flag the slot dirty.
+     * The tick thread publishes it on its next cycle.
+     */
+    int idx = find_slot_index(slot, subslot);
+    if (idx < 0 || !g_pn.slots[idx].plugged) return RESULT_NOT_FOUND;
+
+    profinet_image_entry_t *e = &g_pn.input_image[idx];
+    if (size > sizeof(e->data)) size = sizeof(e->data);
+
+    image_write_begin(e);
+    memcpy(e->data, data, size);
+    e->size = (uint16_t)size;
+    image_write_end(e, idx);
+
     return RESULT_OK;
 }
 
@@ -436,7 +1143,23 @@ result_t profinet_manager_update_input_with_quality(int slot, int subslot,
     /* Quality byte (OPC UA compatible values) */
     data[4] = (uint8_t)quality;
 
-    return profinet_manager_update_input(slot, subslot, data, 5);
+    /* Sensor carried as one channel of a packed submodule */
+    uint16_t offset = 0;
+    int idx = find_channel(slot, subslot, &offset);
+    if (idx >= 0) {
+        if (!g_pn.initialized) return RESULT_NOT_INITIALIZED;
+        if (!g_pn.slots[idx].plugged) return RESULT_NOT_FOUND;
+
+        profinet_image_entry_t *e = &g_pn.input_image[idx];
+        image_write_begin(e);
+        memcpy(&e->data[offset], data, sizeof(data));
+        /* Submodule is providing; per-channel health is in the quality byte */
+        e->iops = PNET_IOXS_GOOD;
+        image_write_end(e, idx);
+        return RESULT_OK;
+    }
+
+    return profinet_manager_update_input(slot, subslot, data, sizeof(data));
 }
 
 result_t profinet_manager_get_output(int slot, int subslot, void *data, size_t *size) {
@@ -517,6 +1240,24 @@ result_t profinet_manager_get_stats(profinet_stats_t *stats) {
         if (g_pn.slots[i].plugged) plugged++;
     }
     stats->plugged_modules = plugged;
+    stats->input_updates = atomic_load_explicit(&g_pn.input_updates, memory_order_relaxed);
+    stats->input_publishes = atomic_load_explicit(&g_pn.input_publishes, memory_order_relaxed);
+    stats->output_commands = atomic_load_explicit(&g_pn.output_commands, memory_order_relaxed);
+    stats->output_coalesced = atomic_load_explicit(&g_pn.output_coalesced, memory_order_relaxed);
+    stats->output_dropped = atomic_load_explicit(&g_pn.output_dropped, memory_order_relaxed);
+    stats->output_applied = atomic_load_explicit(&g_pn.output_applied, memory_order_relaxed);
+    stats->output_latency_max_us =
+        atomic_load_explicit(&g_pn.output_latency_max_us, memory_order_relaxed);
+    stats->alarms_requested = atomic_load_explicit(&g_pn.alarms_requested, memory_order_relaxed);
+    stats->alarms_sent = atomic_load_explicit(&g_pn.alarms_sent, memory_order_relaxed);
+    stats->alarms_suppressed = atomic_load_explicit(&g_pn.alarms_suppressed, memory_order_relaxed);
+    stats->alarms_aggregated = atomic_load_explicit(&g_pn.alarms_aggregated, memory_order_relaxed);
+    stats->alarms_deferred = atomic_load_explicit(&g_pn.alarms_deferred, memory_order_relaxed);
+    stats->alarms_dropped = atomic_load_explicit(&g_pn.alarms_dropped, memory_order_relaxed);
+    stats->output_latency_avg_us = stats->output_applied > 0
+        ? atomic_load_explicit(&g_pn.output_latency_sum_us, memory_order_relaxed) /
+          stats->output_applied
+        : 0;
     
     pthread_mutex_unlock(&g_pn.mutex);
     return RESULT_OK;
@@ -526,25 +1267,32 @@ result_t profinet_manager_send_alarm(int slot, int subslot, uint16_t alarm_type,
                                      const uint8_t *data, size_t data_len) {
 #ifdef HAVE_PNET
     if (!g_pn.pnet || !g_pn.connected) return RESULT_NOT_INITIALIZED;
+    if (data_len > PROFINET_ALARM_DATA_MAX || (data_len > 0 && !data)) return RESULT_INVALID_PARAM;
 
-    // p-net v0.2.0 API: positional arguments instead of struct
-    // pnet_alarm_send_process_alarm(pnet, arep, api, slot, subslot, usi, len, data)
-    int ret = pnet_alarm_send_process_alarm(
-        g_pn.pnet,
-        g_pn.arep,           // arep from connection
-        0,                   // api (always 0 for standard PROFINET)
-        (uint16_t)slot,
-        (uint16_t)subslot,
-        alarm_type,          // User Structure Identifier (USI)
-        (uint16_t)data_len,
-        data
-    );
-    if (ret != 0) {
-        LOG_ERROR("Failed to send PROFINET alarm");
-        return RESULT_ERROR;
+    atomic_fetch_add_explicit(&g_pn.alarms_requested, 1, memory_order_relaxed);
+    uint64_t now = get_time_ms();
+
+    pthread_mutex_lock(&g_pn.alarm_mutex);
+
+    profinet_alarm_entry_t *e = alarm_find(slot, subslot, alarm_type);
+    if (!e) {
+        pthread_mutex_unlock(&g_pn.alarm_mutex);
+        atomic_fetch_add_explicit(&g_pn.alarms_dropped, 1, memory_order_relaxed);
+        LOG_WARNING("PROFINET alarm table full, dropping slot=%d type=0x%04X", slot, alarm_type);
+        return RESULT_BUSY;
     }
 
-    LOG_INFO("Sent PROFINET alarm: slot=%d, type=0x%04X", slot, alarm_type);
+    /* Unsent data for this key is replaced by the newer alarm */
+    if (e->pending) {
+        atomic_fetch_add_explicit(&g_pn.alarms_suppressed, 1, memory_order_relaxed);
+    }
+
+    e->pending = true;
+    e->due_ms = MAX(now, e->quiet_until_ms);
+    e->len = (uint16_t)data_len;
+    if (data_len > 0) memcpy(e->data, data, data_len);
+
+    pthread_mutex_unlock(&g_pn.alarm_mutex);
     return RESULT_OK;
 #else
     UNUSED(slot); UNUSED(subslot); UNUSED(alarm_type); UNUSED(data); UNUSED(data_len);
@@ -560,11 +1308,18 @@ void profinet_manager_set_connected(bool connected, uint32_t arep) {
 #ifdef HAVE_PNET
     if (connected) {
         g_pn.arep = arep;
+        /* New AR: the controller needs every input, not just recent changes */
+        image_mark_all_dirty();
     } else {
         g_pn.arep = 0;
+        /* Queued alarms belong to the old AR */
+        pthread_mutex_lock(&g_pn.alarm_mutex);
+        memset(g_pn.alarms, 0, sizeof(g_pn.alarms));
+        pthread_mutex_unlock(&g_pn.alarm_mutex);
     }
 #else
     UNUSED(arep);
+    image_mark_all_dirty();
 #endif
 
     if (connected && g_pn.on_connect) {
@@ -575,15 +1330,17 @@ void profinet_manager_set_connected(bool connected, uint32_t arep) {
 }
 
 void profinet_manager_handle_output_data(int slot, int subslot, const uint8_t *data, size_t len) {
-    profinet_slot_t *s = find_slot(slot, subslot);
-    if (s && len <= sizeof(s->output_data)) {
+    int idx = find_slot_index(slot, subslot);
+    if (idx < 0 || !data) return;
+
+    profinet_slot_t *s = &g_pn.slots[idx];
+    if (len <= sizeof(s->output_data)) {
         memcpy(s->output_data, data, len);
         s->output_size = len;
         s->output_valid = true;
-        
-        if (g_pn.on_data_received) {
-            g_pn.on_data_received(slot, subslot, data, len, g_pn.callback_ctx);
-        }
+
+        /* Applied on the dispatch thread, never inline on the stack thread */
+        output_enqueue(idx, data, len);
     }
 }
 
@@ -607,10 +1364,20 @@ result_t profinet_manager_write_input_data(void *mgr, int slot, int subslot,
 
 result_t profinet_manager_set_input_iops(void *mgr, int slot, int subslot, uint8_t iops) {
     UNUSED(mgr);
-    profinet_slot_t *s = find_slot(slot, subslot);
-    if (!s) return RESULT_NOT_FOUND;
 
-    s->input_iops = iops;
+    /* IOPS is per submodule; a packed channel reports through its quality byte */
+    uint16_t offset;
+    if (find_channel(slot, subslot, &offset) >= 0) return RESULT_OK;
+
+    int idx = find_slot_index(slot, subslot);
+    if (idx < 0) return RESULT_NOT_FOUND;
+
+    profinet_image_entry_t *e = &g_pn.input_image[idx];
+    if (e->iops == iops) return RESULT_OK;
+
+    image_write_begin(e);
+    e->iops = iops;
+    image_write_end(e, idx);
     return RESULT_OK;
 }
 
@@ -619,24 +1386,120 @@ result_t profinet_manager_add_module(void *mgr, int slot, uint32_t module_ident,
                                      size_t input_len, size_t output_len) {
     UNUSED(mgr);
 
-    if (g_pn.slot_count >= MAX_PROFINET_SLOTS) {
+    /* Sensors in a packed submodule are plugged from the layout; a reload
+     * applies it (profinet_manager_apply_layout()) before adding modules */
+    uint16_t offset;
+    if (find_channel(slot, subslot, &offset) >= 0) {
+        LOG_DEBUG("Slot %d is a packed channel (offset %u), not adding module", slot, offset);
+        return RESULT_OK;
+    }
+
+    /* Re-adding an existing slot (e.g. on reload) updates it in place */
+    profinet_slot_t *s = add_slot(slot, subslot);
+    if (!s) {
         LOG_ERROR("Maximum slots exceeded");
         return RESULT_ERROR;
     }
 
-    profinet_slot_t *s = &g_pn.slots[g_pn.slot_count++];
-    memset(s, 0, sizeof(*s));
-
-    s->slot = slot;
-    s->subslot = subslot;
     s->module_ident = module_ident;
     s->submodule_ident = submodule_ident;
     s->input_size = input_len;
     s->output_size = output_len;
     s->input_iops = PNET_IOXS_BAD;
 
+    profinet_image_entry_t *e = &g_pn.input_image[s - g_pn.slots];
+    image_write_begin(e);
+    e->size = 0;
+    e->iops = PNET_IOXS_BAD;
+    atomic_fetch_add_explicit(&e->seq, 1, memory_order_release);
+
     LOG_INFO("Added PROFINET module: slot=%d, subslot=%d, ident=0x%08X",
              slot, subslot, module_ident);
 
     return RESULT_OK;
 }
+
+result_t profinet_manager_apply_layout(void) {
+    if (!g_pn.initialized) return RESULT_NOT_INITIALIZED;
+
+    /* Unpacked modules are plugged one by one through add_module */
+    if (g_pn.config.packed_channels < 2) return RESULT_OK;
+    return load_modules_from_db();
+}
+
+/* ============================================================================
+ * Sensor Diagnostics Cache
+ * ========================================================================== */
+
+result_t profinet_manager_publish_diag(int slot, const profinet_sensor_diag_t *diag) {
+    CHECK_NULL(diag);
+    if (slot < 0 || slot >= PROFINET_SLOT_LUT_SIZE) return RESULT_OUT_OF_RANGE;
+
+    profinet_diag_entry_t *e = &g_pn.diag[slot];
+    atomic_fetch_add_explicit(&e->seq, 1, memory_order_acquire);
+    atomic_thread_fence(memory_order_release);
+    e->diag = *diag;
+    atomic_fetch_add_explicit(&e->seq, 1, memory_order_release);
+    atomic_store_explicit(&e->valid, true, memory_order_release);
+    return RESULT_OK;
+}
+
+result_t profinet_manager_get_diag(int slot, profinet_sensor_diag_t *diag) {
+    CHECK_NULL(diag);
+    if (slot < 0 || slot >= PROFINET_SLOT_LUT_SIZE) return RESULT_OUT_OF_RANGE;
+
+    profinet_diag_entry_t *e = &g_pn.diag[slot];
+    if (!atomic_load_explicit(&e->valid, memory_order_acquire)) return RESULT_NOT_FOUND;
+
+    for (int attempt = 0; attempt < PROFINET_DIAG_READ_RETRIES; attempt++) {
+        unsigned int before = atomic_load_explicit(&e->seq, memory_order_acquire);
+        if (before & 1u) continue;
+
+        *diag = e->diag;
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&e->seq, memory_order_relaxed) == before) return RESULT_OK;
+    }
+    return RESULT_BUSY;
+}
+
+void profinet_manager_clear_diag(void) {
+    for (int i = 0; i < PROFINET_SLOT_LUT_SIZE; i++) {
+        atomic_store_explicit(&g_pn.diag[i].valid, false, memory_order_release);
+        atomic_store_explicit(&g_pn.diag[i].stats_reset, false, memory_order_relaxed);
+    }
+}
+
+result_t profinet_manager_request_stats_reset(int slot) {
+    if (slot < 0 || slot >= PROFINET_SLOT_LUT_SIZE) return RESULT_OUT_OF_RANGE;
+    if (!atomic_load_explicit(&g_pn.diag[slot].valid, memory_order_acquire)) return RESULT_NOT_FOUND;
+
+    atomic_store_explicit(&g_pn.diag[slot].stats_reset, true, memory_order_release);
+    return RESULT_OK;
+}
+
+bool profinet_manager_take_stats_reset(int slot) {
+    if (slot < 0 || slot >= PROFINET_SLOT_LUT_SIZE) return false;
+    return atomic_exchange_explicit(&g_pn.diag[slot].stats_reset, false, memory_order_acq_rel);
+}
+
+int profinet_manager_channel_sensor(int slot, int subslot, int channel) {
+    if (channel < 0 || channel >= PROFINET_PACKED_MAX_CHANNELS) return -1;
+
+    int idx = find_slot_index(slot, subslot);
+    if (idx < 0) return -1;
+
+    /* Packed submodule: find the sensor mapped to this channel's record */
+    uint32_t want = CHANNEL_ENTRY(idx + 1, channel * PROFINET_CHANNEL_RECORD_SIZE);
+    for (int s = 0; s < PROFINET_SLOT_LUT_SIZE; s++) {
+        if (atomic_load_explicit(&g_pn.channel_lut[s], memory_order_acquire) == want) return s;
+    }
+
+    /* Single-sensor submodule: the sensor shares the slot number */
+    if (channel == 0 && slot < PROFINET_SLOT_LUT_SIZE &&
+        atomic_load_explicit(&g_pn.channel_lut[slot], memory_order_acquire) == 0 &&
+        g_pn.slots[idx].input_size > 0 && g_pn.slots[idx].output_size == 0) {
+        return slot;
+    }
+    return -1;
+}
@@ -23,6 +23,20 @@ typedef struct {
     uint32_t cycle_count;
     int slot_count;
     int plugged_modules;
+    uint64_t input_updates;     /* Producer writes into the input image */
+    uint64_t input_publishes;   /* Submodules pushed to the stack */
+    uint64_t output_commands;   /* Output frames received from controller */
+    uint64_t output_coalesced;  /* Superseded before the actuator applied them */
+    uint64_t output_dropped;    /* Dispatch queue full */
+    uint64_t output_applied;    /* Delivered to on_data callback */
+    uint64_t output_latency_avg_us;  /* Queue-to-apply latency */
+    uint64_t output_latency_max_us;
+    uint64_t alarms_requested;  /* profinet_manager_send_alarm() calls */
+    uint64_t alarms_sent;       /* Alarms delivered to the stack */
+    uint64_t alarms_suppressed; /* Superseded within the coalescing window */
+    uint64_t alarms_aggregated; /* Channels folded into multi-channel alarms */
+    uint64_t alarms_deferred;   /* Ticks the rate limiter held alarms back */
+    uint64_t alarms_dropped;    /* Alarm table full */
 } profinet_stats_t;
 
 // PROFINET IOXS values (only define when p-net is not available)
@@ -32,8 +46,96 @@ typedef struct {
 #define PNET_IOXS_GOOD 0x80
 #endif
 
+/*
+ * Input module layout
+ *
+ * Each sensor is one 5-byte channel record (Float32 BE + quality byte).
+ * With [profinet] packed_channels = N (N >= 2) sensors are grouped, in
+ * ascending slot order, into multi-channel submodules of up to N records.
+ * A packed module is plugged at the slot of its first sensor and carries
+ * ident PROFINET_PACKED_IDENT(channel count). The same layout is used for
+ * plugging and for GSDML generation so the two can never disagree.
+ */
+#define PROFINET_CHANNEL_RECORD_SIZE    5
+#define PROFINET_PACKED_MAX_CHANNELS    32
+#define PROFINET_PACKED_SUBSLOT         1
+#define PROFINET_PACKED_IDENT_BASE      0x00001000u
+#define PROFINET_PACKED_IDENT(n)        (PROFINET_PACKED_IDENT_BASE + (uint32_t)(n))
+#define PROFINET_LAYOUT_MAX_MODULES     64
+
+typedef struct {
+    int slot;
+    int subslot;
+    uint32_t module_ident;
+    uint32_t submodule_ident;
+    size_t input_len;
+    int module_id;                  /* Single-sensor modules only */
+    int channel_count;              /* 0 = single-sensor module */
+    int channel_slots[PROFINET_PACKED_MAX_CHANNELS];    /* Sensor slot per channel */
+    int channel_module_ids[PROFINET_PACKED_MAX_CHANNELS];
+} profinet_layout_module_t;
+
+typedef struct {
+    profinet_layout_module_t modules[PROFINET_LAYOUT_MAX_MODULES];
+    int count;
+} profinet_layout_t;
+
+/*
+ * Per-sensor diagnostics served as acyclic records (profinet_callbacks.c)
+ *
+ * Published by the sensor worker after every read and copied out of an
+ * in-memory cache by the stack thread, so record reads never touch SQLite.
+ * Statistics cover the samples since the last reset (sensor reload or a
+ * record write from the controller).
+ */
+typedef struct {
+    float value;
+    int32_t raw_value;
+    uint8_t quality;                /* data_quality_t */
+    bool connected;
+    uint32_t consecutive_failures;
+    uint64_t total_reads;
+    uint64_t total_failures;
+    uint64_t last_read_ms;          /* get_time_ms() of last read */
+
+    /* Calibration coefficients */
+    float cal_scale;
+    float cal_offset;
+    float scale_factor;
+    float offset;
+    int32_t raw_min;
+    int32_t raw_max;
+    float eng_min;
+    float eng_max;
+
+    /* Recent statistics */
+    uint32_t stat_count;
+    float stat_min;
+    float stat_max;
+    float stat_mean;
+} profinet_sensor_diag_t;
+
+/*
+ * Diagnosis alarms
+ *
+ * Alarms are queued per (slot, subslot, type) and sent from the tick
+ * thread, coalesced within [profinet] alarm_window_ms and rate limited by
+ * a token bucket. When alarm_aggregate or more channels of one type are
+ * due together they are sent as a single alarm on the DAP (slot 0,
+ * subslot 1) with USI PROFINET_ALARM_USI_MULTI_CHANNEL and payload:
+ *   u16 original type, u16 channel count, then (u16 slot, u16 subslot)
+ *   pairs for as many channels as fit (all big-endian).
+ */
+#define PROFINET_ALARM_DATA_MAX             28      /* Process alarm payload limit */
+#define PROFINET_ALARM_USI_MULTI_CHANNEL    0x7F00
+
 typedef void (*profinet_connect_cb_t)(void *ctx);
 typedef void (*profinet_disconnect_cb_t)(void *ctx);
+/*
+ * Output data callback. Runs on the PROFINET dispatch thread, not the stack
+ * thread: commands for a slot are coalesced, so only the latest output is
+ * delivered if the handler falls behind.
+ */
 typedef void (*profinet_data_cb_t)(int slot, int subslot, const uint8_t *data, size_t len, void *ctx);
 
 result_t profinet_manager_init(database_t *db, const profinet_config_t *config);
@@ -41,6 +143,15 @@ result_t profinet_manager_start(const char *interface);
 result_t profinet_manager_stop(void);
 void profinet_manager_shutdown(void);
 
+/**
+ * @brief Write input data into the PROFINET process image
+ *
+ * Non-blocking: the data lands in a back buffer and the slot is marked
+ * dirty. The tick thread publishes dirty slots (data + IOPS) to the stack
+ * once per cycle, so callers never contend with pnet_handle_periodic().
+ *
+ * @return RESULT_OK, or RESULT_NOT_FOUND if the slot is not plugged
+ */
 result_t profinet_manager_update_input(int slot, int subslot, const void *data, size_t size);
 result_t profinet_manager_update_input_float(int slot, int subslot, float value);
 
@@ -67,6 +178,15 @@ result_t profinet_manager_set_input_iops(void *mgr, int slot, int subslot, uint8
 result_t profinet_manager_add_module(void *mgr, int slot, uint32_t module_ident, int subslot,
                                       uint32_t submodule_ident, size_t input_len, size_t output_len);
 
+/**
+ * @brief Rebuild the packed input layout from the modules in the database
+ *
+ * Call once per sensor reload, before re-adding the sensors' modules:
+ * profinet_manager_add_module() skips sensors the layout packs. No-op
+ * unless packed_channels >= 2.
+ */
+result_t profinet_manager_apply_layout(void);
+
 result_t profinet_manager_set_callbacks(profinet_connect_cb_t on_connect,
                                         profinet_disconnect_cb_t on_disconnect,
                                         profinet_data_cb_t on_data, void *ctx);
@@ -75,9 +195,67 @@ profinet_state_t profinet_manager_get_state(void);
 bool profinet_manager_is_connected(void);
 bool profinet_manager_is_running(void);
 result_t profinet_manager_get_stats(profinet_stats_t *stats);
+
+/**
+ * @brief Queue a diagnosis (process) alarm for the controller
+ *
+ * Non-blocking. Repeats for the same (slot, subslot, type) within the
+ * coalescing window replace the queued data and count as suppressed.
+ *
+ * @param data_len At most PROFINET_ALARM_DATA_MAX bytes
+ * @return RESULT_OK if queued, RESULT_NOT_INITIALIZED without a controller
+ *         connection, RESULT_BUSY if the alarm table is full
+ */
 result_t profinet_manager_send_alarm(int slot, int subslot, uint16_t alarm_type,
                                      const uint8_t *data, size_t data_len);
 
+/**
+ * @brief Compute the input module layout for the sensors in the database
+ *
+ * @param db              Database with the modules table
+ * @param packed_channels Channels per packed submodule (< 2 = unpacked)
+ * @param layout          Output layout
+ * @return RESULT_OK on success
+ */
+result_t profinet_manager_build_layout(database_t *db, int packed_channels,
+                                       profinet_layout_t *layout);
+
+/**
+ * @brief Publish diagnostics for a sensor slot (single writer per slot)
+ *
+ * @return RESULT_OK, or RESULT_OUT_OF_RANGE for an invalid slot
+ */
+result_t profinet_manager_publish_diag(int slot, const profinet_sensor_diag_t *diag);
+
+/**
+ * @brief Copy the cached diagnostics for a sensor slot
+ *
+ * Lock-free and bounded; safe to call from the stack thread.
+ *
+ * @return RESULT_OK, RESULT_NOT_FOUND if nothing was published yet,
+ *         or RESULT_BUSY if the writer kept the entry busy
+ */
+result_t profinet_manager_get_diag(int slot, profinet_sensor_diag_t *diag);
+
+/** @brief Drop all cached diagnostics (e.g. on sensor reload) */
+void profinet_manager_clear_diag(void);
+
+/** @brief Ask the sensor worker to restart statistics for a slot */
+result_t profinet_manager_request_stats_reset(int slot);
+
+/** @brief Consume a pending statistics reset request for a slot */
+bool profinet_manager_take_stats_reset(int slot);
+
+/**
+ * @brief Resolve the sensor slot behind a submodule channel
+ *
+ * Single-sensor submodules only have channel 0; packed submodules have
+ * one channel per record.
+ *
+ * @return Sensor slot, or -1 if the submodule/channel carries no sensor
+ */
+int profinet_manager_channel_sensor(int slot, int subslot, int channel);
+
 const char* profinet_state_to_string(profinet_state_t state);
 
 // Internal callbacks used by profinet_callbacks.c
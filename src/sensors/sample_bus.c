@@ -0,0 +1,276 @@
+/**
+ * @file sample_bus.c
+ * @brief In-process publish/subscribe bus for sensor samples
+ *
+ * Each subscriber owns a power-of-two ring indexed by free-running 64-bit
+ * head/tail counters. The producer is the only writer of head. Under
+ * DROP_NEWEST the consumer is the only writer of tail, a plain SPSC ring.
+ * Under DROP_OLDEST the producer may also advance tail to evict the oldest
+ * sample, so the consumer copies first and then claims what it copied with
+ * a CAS on tail; if the producer evicted in between, the copy is discarded
+ * and retried. Counters never wrap, so a successful CAS proves no slot in
+ * the copied range was overwritten.
+ */
+
+#include "sample_bus.h"
+#include "utils/logger.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+struct sample_subscriber {
+    char name[32];
+    sample_bus_policy_t policy;
+    uint32_t capacity;
+    uint32_t mask;
+    sensor_sample_t *ring;
+
+    _Alignas(64) atomic_uint_least64_t head;    /* Producer */
+    _Alignas(64) atomic_uint_least64_t tail;    /* Consumer (and producer on eviction) */
+
+    _Alignas(64) atomic_uint_least64_t delivered;
+    atomic_uint_least64_t dropped;
+
+    /* Sleep/wake for sample_bus_wait(); the producer only signals a waiter */
+    atomic_int waiting;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+};
+
+static struct {
+    _Atomic(sample_subscriber_t *) subs[WT_SAMPLE_BUS_MAX_SUBSCRIBERS];
+    atomic_int publishing;              /* Publishes in flight over subs[] */
+    atomic_uint_least64_t published;
+    pthread_mutex_t registry_mutex;     /* Serializes subscribe/unsubscribe */
+} g_bus = {
+    .registry_mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* ============================================================================
+ * Subscription
+ * ============================================================================ */
+
+result_t sample_bus_subscribe(const char *name, uint32_t capacity,
+                              sample_bus_policy_t policy, sample_subscriber_t **out) {
+    CHECK_NULL(out);
+    if (capacity < 2 || capacity > (1u << 20)) return RESULT_INVALID_PARAM;
+
+    uint32_t size = 2;
+    while (size < capacity) size <<= 1;
+
+    sample_subscriber_t *sub = calloc(1, sizeof(*sub));
+    if (!sub) return RESULT_NO_MEMORY;
+    sub->ring = calloc(size, sizeof(sensor_sample_t));
+    if (!sub->ring) {
+        free(sub);
+        return RESULT_NO_MEMORY;
+    }
+
+    SAFE_STRNCPY(sub->name, name ? name : "anon", sizeof(sub->name));
+    sub->policy = policy;
+    sub->capacity = size;
+    sub->mask = size - 1;
+    atomic_init(&sub->head, 0);
+    atomic_init(&sub->tail, 0);
+    atomic_init(&sub->delivered, 0);
+    atomic_init(&sub->dropped, 0);
+    atomic_init(&sub->waiting, 0);
+    pthread_mutex_init(&sub->mutex, NULL);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sub->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_mutex_lock(&g_bus.registry_mutex);
+    int idx = -1;
+    for (int i = 0; i < WT_SAMPLE_BUS_MAX_SUBSCRIBERS; i++) {
+        if (!atomic_load(&g_bus.subs[i])) {
+            idx = i;
+            break;
+        }
+    }
+    if (idx >= 0) atomic_store(&g_bus.subs[idx], sub);
+    pthread_mutex_unlock(&g_bus.registry_mutex);
+
+    if (idx < 0) {
+        LOG_WARNING("Sample bus: no free subscriber slot for '%s'", sub->name);
+        pthread_cond_destroy(&sub->cond);
+        pthread_mutex_destroy(&sub->mutex);
+        free(sub->ring);
+        free(sub);
+        return RESULT_BUSY;
+    }
+
+    LOG_DEBUG("Sample bus: '%s' subscribed (%u samples, drop %s)", sub->name, size,
+              policy == SAMPLE_BUS_DROP_OLDEST ? "oldest" : "newest");
+    *out = sub;
+    return RESULT_OK;
+}
+
+void sample_bus_unsubscribe(sample_subscriber_t *sub) {
+    if (!sub) return;
+
+    pthread_mutex_lock(&g_bus.registry_mutex);
+    for (int i = 0; i < WT_SAMPLE_BUS_MAX_SUBSCRIBERS; i++) {
+        if (atomic_load(&g_bus.subs[i]) == sub) {
+            atomic_store(&g_bus.subs[i], NULL);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_bus.registry_mutex);
+
+    /*
+     * A publish that loaded the pointer before it was cleared is still
+     * counted in publishing; once that drains nobody can reach sub.
+     */
+    while (atomic_load(&g_bus.publishing) != 0) {
+        sched_yield();
+    }
+
+    pthread_cond_destroy(&sub->cond);
+    pthread_mutex_destroy(&sub->mutex);
+    free(sub->ring);
+    free(sub);
+}
+
+/* ============================================================================
+ * Producer
+ * ============================================================================ */
+
+static bool ring_push(sample_subscriber_t *sub, const sensor_sample_t *sample) {
+    uint64_t head = atomic_load_explicit(&sub->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&sub->tail, memory_order_acquire);
+
+    if (head - tail >= sub->capacity) {
+        if (sub->policy == SAMPLE_BUS_DROP_NEWEST) {
+            atomic_fetch_add_explicit(&sub->dropped, 1, memory_order_relaxed);
+            return false;
+        }
+        /* Evict the oldest; if the CAS fails the consumer just freed a slot */
+        if (atomic_compare_exchange_strong_explicit(&sub->tail, &tail, tail + 1,
+                                                    memory_order_acq_rel,
+                                                    memory_order_acquire)) {
+            atomic_fetch_add_explicit(&sub->dropped, 1, memory_order_relaxed);
+        }
+    }
+
+    sub->ring[head & sub->mask] = *sample;
+    atomic_store_explicit(&sub->head, head + 1, memory_order_release);
+    return true;
+}
+
+void sample_bus_publish(const sensor_sample_t *samples, int count) {
+    if (!samples || count <= 0) return;
+
+    atomic_fetch_add(&g_bus.publishing, 1);
+    atomic_fetch_add_explicit(&g_bus.published, (uint64_t)count, memory_order_relaxed);
+
+    for (int i = 0; i < WT_SAMPLE_BUS_MAX_SUBSCRIBERS; i++) {
+        sample_subscriber_t *sub = atomic_load(&g_bus.subs[i]);
+        if (!sub) continue;
+
+        bool pushed = false;
+        for (int n = 0; n < count; n++) {
+            pushed |= ring_push(sub, &samples[n]);
+        }
+
+        /* Pairs with the store/recheck in sample_bus_wait() */
+        atomic_thread_fence(memory_order_seq_cst);
+        if (pushed && atomic_load_explicit(&sub->waiting, memory_order_relaxed)) {
+            pthread_mutex_lock(&sub->mutex);
+            pthread_cond_signal(&sub->cond);
+            pthread_mutex_unlock(&sub->mutex);
+        }
+    }
+
+    atomic_fetch_sub(&g_bus.publishing, 1);
+}
+
+/* ============================================================================
+ * Consumer
+ * ============================================================================ */
+
+int sample_bus_poll(sample_subscriber_t *sub, sensor_sample_t *out, int max) {
+    if (!sub || !out || max <= 0) return 0;
+
+    for (;;) {
+        uint64_t tail = atomic_load_explicit(&sub->tail, memory_order_acquire);
+        uint64_t head = atomic_load_explicit(&sub->head, memory_order_acquire);
+        if (head == tail) return 0;
+
+        uint64_t avail = head - tail;
+        int n = avail < (uint64_t)max ? (int)avail : max;
+        for (int i = 0; i < n; i++) {
+            out[i] = sub->ring[(tail + i) & sub->mask];
+        }
+
+        if (sub->policy == SAMPLE_BUS_DROP_NEWEST) {
+            atomic_store_explicit(&sub->tail, tail + n, memory_order_release);
+        } else if (!atomic_compare_exchange_strong_explicit(&sub->tail, &tail, tail + n,
+                                                            memory_order_acq_rel,
+                                                            memory_order_acquire)) {
+            continue;   /* Producer evicted under us; copy may be torn */
+        }
+
+        atomic_fetch_add_explicit(&sub->delivered, (uint64_t)n, memory_order_relaxed);
+        return n;
+    }
+}
+
+int sample_bus_wait(sample_subscriber_t *sub, sensor_sample_t *out, int max,
+                    uint32_t timeout_ms) {
+    int n = sample_bus_poll(sub, out, max);
+    if (n > 0 || timeout_ms == 0) return n;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&sub->mutex);
+    atomic_store(&sub->waiting, 1);
+    while (atomic_load(&sub->head) == atomic_load(&sub->tail)) {
+        if (pthread_cond_timedwait(&sub->cond, &sub->mutex, &deadline) != 0) break;
+    }
+    atomic_store(&sub->waiting, 0);
+    pthread_mutex_unlock(&sub->mutex);
+
+    return sample_bus_poll(sub, out, max);
+}
+
+/* ============================================================================
+ * Statistics
+ * ============================================================================ */
+
+result_t sample_bus_get_stats(sample_bus_stats_t *stats) {
+    CHECK_NULL(stats);
+    memset(stats, 0, sizeof(*stats));
+
+    stats->published = atomic_load_explicit(&g_bus.published, memory_order_relaxed);
+
+    /* Registry lock keeps every listed subscriber alive while it is read */
+    pthread_mutex_lock(&g_bus.registry_mutex);
+    for (int i = 0; i < WT_SAMPLE_BUS_MAX_SUBSCRIBERS; i++) {
+        sample_subscriber_t *sub = atomic_load(&g_bus.subs[i]);
+        if (!sub) continue;
+
+        sample_subscriber_stats_t *s = &stats->subscribers[stats->subscriber_count++];
+        SAFE_STRNCPY(s->name, sub->name, sizeof(s->name));
+        s->policy = sub->policy;
+        s->capacity = sub->capacity;
+        uint64_t tail = atomic_load(&sub->tail);
+        uint64_t head = atomic_load(&sub->head);
+        s->depth = (uint32_t)(head - tail);
+        s->delivered = atomic_load_explicit(&sub->delivered, memory_order_relaxed);
+        s->dropped = atomic_load_explicit(&sub->dropped, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&g_bus.registry_mutex);
+
+    return RESULT_OK;
+}
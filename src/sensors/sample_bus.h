@@ -0,0 +1,101 @@
+/**
+ * @file sample_bus.h
+ * @brief In-process publish/subscribe bus for sensor samples
+ *
+ * The scan thread publishes each batch of readings once; every subscriber
+ * (alarm evaluation, data logging, TUI) consumes from its own single-producer
+ * single-consumer ring at its own pace. A slow or stalled consumer only ever
+ * loses its own samples, according to the overflow policy it chose, and
+ * never delays the scan or the other subscribers.
+ *
+ * The registry is static, so no init call is needed. One thread publishes;
+ * each subscriber is drained by exactly one thread.
+ */
+
+#ifndef SAMPLE_BUS_H
+#define SAMPLE_BUS_H
+
+#include "common.h"
+#include "config_defaults.h"
+
+typedef struct {
+    int module_id;
+    int slot;
+    float value;                /* Last good value when quality is bad */
+    data_quality_t quality;
+    uint64_t timestamp_ms;      /* get_time_ms() at acquisition */
+    time_t wall_time;
+} sensor_sample_t;
+
+typedef enum {
+    SAMPLE_BUS_DROP_NEWEST = 0, /* Full ring rejects new samples, backlog kept intact */
+    SAMPLE_BUS_DROP_OLDEST,     /* Full ring discards its oldest sample */
+} sample_bus_policy_t;
+
+typedef struct sample_subscriber sample_subscriber_t;
+
+typedef struct {
+    char name[32];
+    sample_bus_policy_t policy;
+    uint32_t capacity;
+    uint32_t depth;             /* Samples waiting */
+    uint64_t delivered;         /* Samples handed to the consumer */
+    uint64_t dropped;           /* Samples lost to overflow */
+} sample_subscriber_stats_t;
+
+typedef struct {
+    uint64_t published;         /* Samples offered by the producer */
+    int subscriber_count;
+    sample_subscriber_stats_t subscribers[WT_SAMPLE_BUS_MAX_SUBSCRIBERS];
+} sample_bus_stats_t;
+
+/**
+ * @brief Attach a consumer
+ * @param name Label for stats
+ * @param capacity Ring size, rounded up to a power of two
+ * @return RESULT_OK, RESULT_BUSY if every subscriber slot is taken
+ */
+result_t sample_bus_subscribe(const char *name, uint32_t capacity,
+                              sample_bus_policy_t policy, sample_subscriber_t **out);
+
+/**
+ * @brief Detach and free a consumer
+ *
+ * Waits for an in-flight publish to finish with the ring. Must not be
+ * called from the publishing thread.
+ */
+void sample_bus_unsubscribe(sample_subscriber_t *sub);
+
+/**
+ * @brief Deliver a batch to every subscriber (producer thread only)
+ */
+void sample_bus_publish(const sensor_sample_t *samples, int count);
+
+/**
+ * @brief Take up to max queued samples without blocking
+ * @return Number of samples copied to out
+ */
+int sample_bus_poll(sample_subscriber_t *sub, sensor_sample_t *out, int max);
+
+/**
+ * @brief Take up to max samples, waiting up to timeout_ms for the first
+ * @return Number of samples copied to out (0 on timeout)
+ */
+int sample_bus_wait(sample_subscriber_t *sub, sensor_sample_t *out, int max,
+                    uint32_t timeout_ms);
+
+result_t sample_bus_get_stats(sample_bus_stats_t *stats);
+
+/**
+ * @brief Status string for a sample's quality (STATUS_* from common.h)
+ */
+static inline const char* sample_bus_quality_status(data_quality_t quality) {
+    switch (quality) {
+        case QUALITY_GOOD:          return STATUS_OK;
+        case QUALITY_UNCERTAIN:     return STATUS_WARNING;
+        case QUALITY_NOT_CONNECTED: return STATUS_DISCONNECTED;
+        default:                    return STATUS_BAD;
+    }
+}
+
+#endif
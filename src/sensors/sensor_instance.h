@@ -114,6 +114,12 @@ typedef struct {
     float range_min;                /* Minimum valid value */
     float range_max;                /* Maximum valid value */
 
+    /* Recent statistics (served as PROFINET diagnostic records) */
+    uint32_t stat_count;            /* Successful reads since last reset */
+    float stat_min;
+    float stat_max;
+    double stat_sum;
+
     /* Calculated sensor support */
     char formula[MAX_CONFIG_VALUE_LEN];
     int input_slots[8];
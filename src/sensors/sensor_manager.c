@@ -1,4 +1,5 @@
 #include "sensor_manager.h"
+#include "sample_bus.h"
 #include "profinet/profinet_manager.h"
 #include "alarms/alarm_manager.h"
 #include "db/db_modules.h"
@@ -21,10 +22,51 @@ typedef struct {
     bool success;
     data_quality_t quality;
     float last_value;  /* For failed reads */
+    profinet_sensor_diag_t diag;
 } sensor_read_result_t;
 
 #define MAX_SENSOR_UPDATES 64
 
+/* Fold a successful reading into the instance's recent statistics */
+static void update_statistics(sensor_instance_t *instance, float value) {
+    if (instance->stat_count == 0) {
+        instance->stat_min = value;
+        instance->stat_max = value;
+        instance->stat_sum = 0.0;
+    }
+    if (value < instance->stat_min) instance->stat_min = value;
+    if (value > instance->stat_max) instance->stat_max = value;
+    instance->stat_sum += value;
+    instance->stat_count++;
+}
+
+/* Snapshot diagnostics for the PROFINET record service (caller holds mutex) */
+static void fill_diag(const sensor_instance_t *instance, profinet_sensor_diag_t *diag) {
+    diag->value = instance->current_value;
+    diag->raw_value = instance->current_raw_value;
+    diag->quality = (uint8_t)instance->quality;
+    diag->connected = instance->connected;
+    diag->consecutive_failures = (uint32_t)instance->consecutive_failures;
+    diag->total_reads = instance->total_reads;
+    diag->total_failures = instance->total_failures;
+    diag->last_read_ms = instance->last_read_ms;
+
+    diag->cal_scale = instance->cal_scale;
+    diag->cal_offset = instance->cal_offset;
+    diag->scale_factor = instance->scale_factor;
+    diag->offset = instance->offset;
+    diag->raw_min = instance->raw_min;
+    diag->raw_max = instance->raw_max;
+    diag->eng_min = instance->eng_min;
+    diag->eng_max = instance->eng_max;
+
+    diag->stat_count = instance->stat_count;
+    diag->stat_min = instance->stat_min;
+    diag->stat_max = instance->stat_max;
+    diag->stat_mean = instance->stat_count ?
+        (float)(instance->stat_sum / instance->stat_count) : 0.0f;
+}
+
 // Worker thread function
 static void* sensor_worker_thread(void *arg) {
     sensor_manager_t *mgr = (sensor_manager_t *)arg;
@@ -33,6 +75,7 @@ static void* sensor_worker_thread(void *arg) {
 
     /* Pre-allocated buffer for sensor updates - avoids allocation in loop */
     sensor_read_result_t updates[MAX_SENSOR_UPDATES];
+    sensor_sample_t samples[MAX_SENSOR_UPDATES];
     int update_count = 0;
 
     while (mgr->running) {
@@ -40,7 +83,7 @@ static void* sensor_worker_thread(void *arg) {
 
         /*
          * CRITICAL SECTION: Only hold mutex while reading sensors
-         * LED updates and alarm checks moved outside to reduce contention
+         * LED updates and sample publishing moved outside to reduce contention
          */
         pthread_mutex_lock(&mgr->mutex);
 
@@ -63,6 +106,23 @@ static void* sensor_worker_thread(void *arg) {
                 upd->success = (result == RESULT_OK);
                 upd->quality = sensor_instance_get_quality(instance);
 
+                sensor_sample_t *sample = &samples[update_count];
+                sample->module_id = upd->module_id;
+                sample->slot = upd->slot;
+                sample->value = upd->success ? upd->value : upd->last_value;
+                sample->quality = (upd->success || upd->quality >= QUALITY_BAD) ?
+                    upd->quality : QUALITY_BAD;
+                sample->timestamp_ms = now_ms;
+                sample->wall_time = time(NULL);
+
+                if (mgr->profinet_mgr) {
+                    if (profinet_manager_take_stats_reset(instance->slot)) {
+                        instance->stat_count = 0;
+                    }
+                    if (upd->success) update_statistics(instance, upd->value);
+                    fill_diag(instance, &upd->diag);
+                }
+
                 mgr->total_reads++;
                 if (upd->success) {
                     mgr->successful_reads++;
@@ -85,11 +145,6 @@ static void* sensor_worker_thread(void *arg) {
             sensor_read_result_t *upd = &updates[i];
 
             if (upd->success) {
-                // Check alarm rules for this sensor value
-                if (alarm_manager_is_running()) {
-                    alarm_manager_check_value(upd->module_id, upd->value);
-                }
-
 #ifdef LED_SUPPORT
                 // Update LED status for this sensor slot (slots 1-4 map to sensor LEDs 0-3)
                 if (g_led_mgr.initialized && upd->slot >= 1 && upd->slot <= 4) {
@@ -125,6 +180,7 @@ static void* sensor_worker_thread(void *arg) {
                     uint8_t iops = (upd->quality == QUALITY_GOOD) ? PNET_IOXS_GOOD : PNET_IOXS_BAD;
                     profinet_manager_set_input_iops(mgr->profinet_mgr,
                                                    upd->slot, 0, iops);
+                    profinet_manager_publish_diag(upd->slot, &upd->diag);
                 }
 
                 LOG_DEBUG("Read sensor slot=%d: %.2f", upd->slot, upd->value);
@@ -152,12 +208,18 @@ static void* sensor_worker_thread(void *arg) {
                     profinet_manager_set_input_iops(mgr->profinet_mgr,
                                                    upd->slot, 0,
                                                    PNET_IOXS_BAD);
+                    profinet_manager_publish_diag(upd->slot, &upd->diag);
                 }
 
                 LOG_WARNING("Failed to read sensor slot=%d", upd->slot);
             }
         }
 
+        /* One hand-off per scan; alarms, logging and the TUI consume at their own pace */
+        if (update_count > 0) {
+            sample_bus_publish(samples, update_count);
+        }
+
         // Sleep for a short interval (10ms)
         usleep(10000);
     }
@@ -249,6 +311,11 @@ result_t sensor_manager_reload_sensors(sensor_manager_t *mgr) {
 
     mgr->instance_count = 0;
     memset(mgr->slot_map, 0, sizeof(mgr->slot_map));
+
+    /* Diagnostics of removed sensors must not be served any more */
+    if (mgr->profinet_mgr) {
+        profinet_manager_clear_diag();
+    }
     
     // Load modules from database
     db_module_t *modules = NULL;
@@ -259,6 +326,11 @@ result_t sensor_manager_reload_sensors(sensor_manager_t *mgr) {
         pthread_mutex_unlock(&mgr->mutex);
         return result;
     }
+
+    /* One layout rebuild for the whole batch; add_module below relies on it */
+    if (mgr->profinet_mgr) {
+        profinet_manager_apply_layout();
+    }
     
     // Create sensor instances
     for (int i = 0; i < module_count && mgr->instance_count < MAX_SENSOR_INSTANCES; i++) {
@@ -292,7 +364,7 @@ result_t sensor_manager_reload_sensors(sensor_manager_t *mgr) {
                     0x00000001,  // module_ident
                     0,           // subslot
                     0x00000001,  // submodule_ident
-                    sizeof(float), // input_length
+                    PROFINET_CHANNEL_RECORD_SIZE, // Float32 + quality
                     0            // output_length
                 );
             }
@@ -4,9 +4,11 @@
  */
 
 #include "dialog_alarm.h"
+#include "dialog_helpers.h"
 #include "tui/tui_common.h"
 #include "db/db_modules.h"
 #include "db/database.h"
+#include "config_defaults.h"
 #include <ncurses.h>
 #include <string.h>
 #include <stdlib.h>
@@ -23,6 +25,11 @@ enum {
     FIELD_THRESHOLD_LOW,
     FIELD_SEVERITY,
     FIELD_HYSTERESIS,
+    FIELD_WINDOW,
+    FIELD_ON_DELAY,
+    FIELD_OFF_DELAY,
+    FIELD_CHATTER_COUNT,
+    FIELD_CHATTER_WINDOW,
     FIELD_AUTO_CLEAR,
     FIELD_ENABLED,
     FIELD_INTERLOCK_ENABLED,
@@ -54,9 +61,11 @@ static const char *CONDITIONS[] = {
     "Below Low",     /* ALARM_CONDITION_BELOW_THRESHOLD */
     "Out of Range",  /* ALARM_CONDITION_OUT_OF_RANGE */
     "Rate Change",   /* ALARM_CONDITION_RATE_OF_CHANGE */
-    "Deviation"      /* ALARM_CONDITION_DEVIATION */
+    "Deviation",     /* ALARM_CONDITION_DEVIATION */
+    "Stale/Flatline",/* ALARM_CONDITION_STALE */
+    "Sigma"          /* ALARM_CONDITION_SIGMA */
 };
-static const int CONDITION_COUNT = 5;
+static const int CONDITION_COUNT = 7;
 
 /* Severity options - maps to alarm_severity_t enum */
 static const char *SEVERITIES[] = {"Low", "Medium", "High", "Critical"};
@@ -91,7 +100,7 @@ static void load_modules(void) {
 }
 
 static void draw_dialog(void) {
-    int dialog_h = 22;
+    int dialog_h = 26;
     int dialog_w = 60;
     int dialog_y = (LINES - dialog_h) / 2;
     int dialog_x = (COLS - dialog_w) / 2;
@@ -204,6 +213,69 @@ static void draw_dialog(void) {
     }
     row++;
 
+    /* Window (rate, deviation, stale, sigma) */
+    if (g_dlg.current_field == FIELD_WINDOW) attron(A_REVERSE);
+    mvprintw(row, label_x, "Window (s):");
+    if (g_dlg.current_field == FIELD_WINDOW) attroff(A_REVERSE);
+    if (g_dlg.editing && g_dlg.current_field == FIELD_WINDOW) {
+        attron(A_UNDERLINE);
+        mvprintw(row, value_x, "%-10s", g_dlg.edit_buffer);
+        attroff(A_UNDERLINE);
+    } else {
+        mvprintw(row, value_x, "%d", g_dlg.form->window_seconds);
+    }
+    row++;
+
+    /* Flood damping */
+    if (g_dlg.current_field == FIELD_ON_DELAY) attron(A_REVERSE);
+    mvprintw(row, label_x, "On delay (s):");
+    if (g_dlg.current_field == FIELD_ON_DELAY) attroff(A_REVERSE);
+    if (g_dlg.editing && g_dlg.current_field == FIELD_ON_DELAY) {
+        attron(A_UNDERLINE);
+        mvprintw(row, value_x, "%-10s", g_dlg.edit_buffer);
+        attroff(A_UNDERLINE);
+    } else {
+        mvprintw(row, value_x, "%d", g_dlg.form->on_delay_seconds);
+    }
+    row++;
+    if (g_dlg.current_field == FIELD_OFF_DELAY) attron(A_REVERSE);
+    mvprintw(row, label_x, "Off delay (s):");
+    if (g_dlg.current_field == FIELD_OFF_DELAY) attroff(A_REVERSE);
+    if (g_dlg.editing && g_dlg.current_field == FIELD_OFF_DELAY) {
+        attron(A_UNDERLINE);
+        mvprintw(row, value_x, "%-10s", g_dlg.edit_buffer);
+        attroff(A_UNDERLINE);
+    } else {
+        mvprintw(row, value_x, "%d", g_dlg.form->off_delay_seconds);
+    }
+    row++;
+    if (g_dlg.current_field == FIELD_CHATTER_COUNT) attron(A_REVERSE);
+    mvprintw(row, label_x, "Chatter count:");
+    if (g_dlg.current_field == FIELD_CHATTER_COUNT) attroff(A_REVERSE);
+    if (g_dlg.editing && g_dlg.current_field == FIELD_CHATTER_COUNT) {
+        attron(A_UNDERLINE);
+        mvprintw(row, value_x, "%-10s", g_dlg.edit_buffer);
+        attroff(A_UNDERLINE);
+    } else {
+        if (g_dlg.form->chatter_count >= 2) {
+            mvprintw(row, value_x, "%d", g_dlg.form->chatter_count);
+        } else {
+            mvprintw(row, value_x, "off");
+        }
+    }
+    row++;
+    if (g_dlg.current_field == FIELD_CHATTER_WINDOW) attron(A_REVERSE);
+    mvprintw(row, label_x, "Chatter window (s):");
+    if (g_dlg.current_field == FIELD_CHATTER_WINDOW) attroff(A_REVERSE);
+    if (g_dlg.editing && g_dlg.current_field == FIELD_CHATTER_WINDOW) {
+        attron(A_UNDERLINE);
+        mvprintw(row, value_x, "%-10s", g_dlg.edit_buffer);
+        attroff(A_UNDERLINE);
+    } else {
+        mvprintw(row, value_x, "%d", g_dlg.form->chatter_window_seconds);
+    }
+    row++;
+
     /* Auto-clear */
     if (g_dlg.current_field == FIELD_AUTO_CLEAR) attron(A_REVERSE);
     mvprintw(row, label_x, "Auto-clear:");
@@ -304,6 +376,26 @@ static void start_edit(void) {
             snprintf(g_dlg.edit_buffer, sizeof(g_dlg.edit_buffer), "%d",
                      g_dlg.form->hysteresis_percent);
             break;
+        case FIELD_WINDOW:
+            snprintf(g_dlg.edit_buffer, sizeof(g_dlg.edit_buffer), "%d",
+                     g_dlg.form->window_seconds);
+            break;
+        case FIELD_ON_DELAY:
+            snprintf(g_dlg.edit_buffer, sizeof(g_dlg.edit_buffer), "%d",
+                     g_dlg.form->on_delay_seconds);
+            break;
+        case FIELD_OFF_DELAY:
+            snprintf(g_dlg.edit_buffer, sizeof(g_dlg.edit_buffer), "%d",
+                     g_dlg.form->off_delay_seconds);
+            break;
+        case FIELD_CHATTER_COUNT:
+            snprintf(g_dlg.edit_buffer, sizeof(g_dlg.edit_buffer), "%d",
+                     g_dlg.form->chatter_count);
+            break;
+        case FIELD_CHATTER_WINDOW:
+            snprintf(g_dlg.edit_buffer, sizeof(g_dlg.edit_buffer), "%d",
+                     g_dlg.form->chatter_window_seconds);
+            break;
         case FIELD_INTERLOCK_SLOT:
             snprintf(g_dlg.edit_buffer, sizeof(g_dlg.edit_buffer), "%d",
                      g_dlg.form->interlock_slot);
@@ -334,6 +426,34 @@ static void commit_edit(void) {
         case FIELD_HYSTERESIS:
             g_dlg.form->hysteresis_percent = atoi(g_dlg.edit_buffer);
             break;
+        case FIELD_WINDOW: {
+            int val = atoi(g_dlg.edit_buffer);
+            g_dlg.form->window_seconds = val > 0 ? val : 1;
+            break;
+        }
+        case FIELD_ON_DELAY: {
+            int val = atoi(g_dlg.edit_buffer);
+            g_dlg.form->on_delay_seconds = val > 0 ? val : 0;
+            break;
+        }
+        case FIELD_OFF_DELAY: {
+            int val = atoi(g_dlg.edit_buffer);
+            g_dlg.form->off_delay_seconds = val > 0 ? val : 0;
+            break;
+        }
+        case FIELD_CHATTER_COUNT: {
+            /* Below 2 disables detection; capped at the manager's onset ring */
+            int val = atoi(g_dlg.edit_buffer);
+            if (val < 2) val = 0;
+            if (val > WT_ALARM_CHATTER_MAX) val = WT_ALARM_CHATTER_MAX;
+            g_dlg.form->chatter_count = val;
+            break;
+        }
+        case FIELD_CHATTER_WINDOW: {
+            int val = atoi(g_dlg.edit_buffer);
+            g_dlg.form->chatter_window_seconds = val > 0 ? val : 1;
+            break;
+        }
         case FIELD_INTERLOCK_SLOT:
             g_dlg.form->interlock_slot = atoi(g_dlg.edit_buffer);
             break;
@@ -348,6 +468,24 @@ static void commit_edit(void) {
     g_dlg.editing = false;
 }
 
+/* Band conditions need low below high; a rate rule's low of 0 means -high */
+static bool validate_form(void) {
+    const alarm_form_t *f = g_dlg.form;
+    bool band = f->condition == ALARM_CONDITION_OUT_OF_RANGE ||
+                (f->condition == ALARM_CONDITION_RATE_OF_CHANGE && f->threshold_low < 0.0f);
+    if (band && f->threshold_low >= f->threshold_high) {
+        dialog_error("Threshold Low must be below Threshold High");
+        g_dlg.current_field = FIELD_THRESHOLD_LOW;
+        return false;
+    }
+    if (f->condition == ALARM_CONDITION_RATE_OF_CHANGE && f->threshold_high <= 0.0f) {
+        dialog_error("Rate limit (Threshold High) must be above zero");
+        g_dlg.current_field = FIELD_THRESHOLD_HIGH;
+        return false;
+    }
+    return true;
+}
+
 static void handle_toggle_or_cycle(void) {
     int idx;
 
@@ -433,6 +571,7 @@ static bool handle_input(int ch) {
 
         case KEY_F(10):
         case KEY_F(2):
+            if (!validate_form()) break;
             g_dlg.confirmed = true;
             return false;  /* Save and exit */
 
@@ -513,6 +652,11 @@ void dialog_alarm_init_form(alarm_form_t *form) {
     form->threshold_low = 0.0f;
     form->severity = ALARM_SEVERITY_MEDIUM;
     form->hysteresis_percent = 5;
+    form->window_seconds = 60;
+    form->on_delay_seconds = 0;
+    form->off_delay_seconds = 0;
+    form->chatter_count = 0;
+    form->chatter_window_seconds = 60;
     form->enabled = true;
     form->auto_clear = true;
     form->interlock_enabled = false;
@@ -531,6 +675,11 @@ void dialog_alarm_load_rule(alarm_form_t *form, const db_alarm_rule_t *rule) {
     form->threshold_low = rule->threshold_low;
     form->severity = rule->severity;
     form->hysteresis_percent = rule->hysteresis_percent;
+    form->window_seconds = rule->window_seconds > 0 ? rule->window_seconds : 60;
+    form->on_delay_seconds = rule->on_delay_seconds;
+    form->off_delay_seconds = rule->off_delay_seconds;
+    form->chatter_count = rule->chatter_count;
+    form->chatter_window_seconds = rule->chatter_window_seconds > 0 ? rule->chatter_window_seconds : 60;
     form->enabled = rule->enabled;
     form->auto_clear = rule->auto_clear;
     form->interlock_enabled = rule->interlock_enabled;
@@ -549,6 +698,11 @@ void dialog_alarm_save_to_rule(const alarm_form_t *form, db_alarm_rule_t *rule)
     rule->threshold_low = form->threshold_low;
     rule->severity = form->severity;
     rule->hysteresis_percent = form->hysteresis_percent;
+    rule->window_seconds = form->window_seconds;
+    rule->on_delay_seconds = form->on_delay_seconds;
+    rule->off_delay_seconds = form->off_delay_seconds;
+    rule->chatter_count = form->chatter_count;
+    rule->chatter_window_seconds = form->chatter_window_seconds;
     rule->enabled = form->enabled;
     rule->auto_clear = form->auto_clear;
     rule->interlock_enabled = form->interlock_enabled;
@@ -26,6 +26,11 @@ typedef struct {
     float threshold_low;
     alarm_severity_t severity;
     int hysteresis_percent;
+    int window_seconds;         /* Rate/deviation/stale/sigma window */
+    int on_delay_seconds;
+    int off_delay_seconds;
+    int chatter_count;          /* 0 = chatter detection off */
+    int chatter_window_seconds;
     bool enabled;
     bool auto_clear;
 
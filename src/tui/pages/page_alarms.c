@@ -11,6 +11,7 @@
 #include "db/db_modules.h"
 #include "alarms/alarm_manager.h"
 #include "utils/logger.h"
+#include "config_defaults.h"
 #include <ncurses.h>
 #include <string.h>
 #include <time.h>
@@ -74,7 +75,10 @@ static void load_active_alarms(void) {
     db_alarm_history_t *alarms = NULL;
     int count = 0;
 
-    if (db_alarm_list_active(db, &alarms, &count) != RESULT_OK || !alarms) {
+    /* Served from the alarm manager's in-memory table; DB only if it isn't up */
+    result_t r = alarm_manager_list_active(&alarms, &count);
+    if (r == RESULT_NOT_INITIALIZED) r = db_alarm_list_active(db, &alarms, &count);
+    if (r != RESULT_OK || !alarms) {
         tui_list_set_count(&g_page.list, 0);
         return;
     }
@@ -159,6 +163,9 @@ static const char* condition_short_str(alarm_condition_t cond) {
         case ALARM_CONDITION_BELOW_THRESHOLD: return "Below";
         case ALARM_CONDITION_OUT_OF_RANGE:    return "Range";
         case ALARM_CONDITION_RATE_OF_CHANGE:  return "Rate";
+        case ALARM_CONDITION_DEVIATION:       return "Dev";
+        case ALARM_CONDITION_STALE:           return "Stale";
+        case ALARM_CONDITION_SIGMA:           return "Sigma";
         default: return "?";
     }
 }
@@ -197,7 +204,12 @@ static void draw_alarm_summary(WINDOW *win, int *row) {
     
     int total = 0, critical = 0, high = 0, medium = 0, low = 0;
     
-    if (db) {
+    if (alarm_manager_get_active_count(&total) == RESULT_OK) {
+        alarm_manager_get_active_by_severity(ALARM_SEVERITY_CRITICAL, &critical);
+        alarm_manager_get_active_by_severity(ALARM_SEVERITY_HIGH, &high);
+        alarm_manager_get_active_by_severity(ALARM_SEVERITY_MEDIUM, &medium);
+        alarm_manager_get_active_by_severity(ALARM_SEVERITY_LOW, &low);
+    } else if (db) {
         db_alarm_count_active(db, &total);
         db_alarm_count_by_severity(db, ALARM_SEVERITY_CRITICAL, &critical);
         db_alarm_count_by_severity(db, ALARM_SEVERITY_HIGH, &high);
@@ -351,8 +363,8 @@ static void draw_rules_list(WINDOW *win, int *row) {
 
     /* Header */
     wattron(win, A_BOLD);
-    mvwprintw(win, *row, 4, "%-3s %-20s %-6s %-8s %-6s %-12s %-4s",
-              "ID", "Name", "Cond", "Thresh", "Sev", "Interlock", "On");
+    mvwprintw(win, *row, 4, "%-3s %-20s %-6s %-8s %-6s %-12s %-4s %s",
+              "ID", "Name", "Cond", "Thresh", "Sev", "Interlock", "On", "State");
     wattroff(win, A_BOLD);
     (*row)++;
 
@@ -419,7 +431,21 @@ static void draw_rules_list(WINDOW *win, int *row) {
             wattroff(win, COLOR_PAIR(TUI_COLOR_WARNING));
         }
 
-        wprintw(win, "%s", r->enabled ? "[X]" : "[ ]");
+        wprintw(win, "%-4s ", r->enabled ? "[X]" : "[ ]");
+
+        /* Damping state from the alarm manager */
+        alarm_rule_status_t st;
+        if (alarm_manager_get_rule_status(r->id, &st) == RESULT_OK) {
+            if (st.shelved) {
+                wprintw(win, "SHELVED %dm", (st.shelve_remaining_s + 59) / 60);
+            } else if (st.chatter_latched) {
+                wprintw(win, "CHATTER");
+            } else if (st.delay_pending) {
+                wprintw(win, "DELAY");
+            } else if (st.in_alarm) {
+                wprintw(win, "ALARM");
+            }
+        }
 
         if (idx == g_page.list.selected) {
             wattroff(win, A_REVERSE);
@@ -438,7 +464,7 @@ static void draw_help(WINDOW *win) {
 
     if (g_page.view_mode == 2) {
         /* Rules view help */
-        mvwprintw(win, row, 2, "n:New  Enter:Edit  d:Delete  e:Toggle  1/2/3:Views  r:Refresh");
+        mvwprintw(win, row, 2, "n:New  Enter:Edit  d:Delete  e:Toggle  s:Shelve  1/2/3:Views  r:Refresh");
     } else {
         /* Alarms view help */
         mvwprintw(win, row, 2, "a:Ack  A:Ack All  Enter:Details  1/2/3:Views  r:Refresh");
@@ -546,13 +572,43 @@ static void toggle_rule_enabled(void) {
     database_t *db = tui_get_database();
     if (!db) return;
 
+    /* Through the manager, so disabling a rule in alarm clears it */
     bool new_state = !r->enabled;
-    if (db_alarm_rule_set_enabled(db, r->id, new_state) == RESULT_OK) {
+    result_t res = alarm_manager_enable_rule(r->id, new_state);
+    if (res == RESULT_NOT_INITIALIZED) res = db_alarm_rule_set_enabled(db, r->id, new_state);
+    if (res == RESULT_OK) {
         r->enabled = new_state;
         tui_set_status("Rule %d %s", r->id, new_state ? "enabled" : "disabled");
     }
 }
 
+static void toggle_rule_shelved(void) {
+    if (g_page.view_mode != 2 || g_page.list.selected >= g_page.rule_count) return;
+
+    rule_display_t *r = &g_page.rules[g_page.list.selected];
+    alarm_rule_status_t st;
+    if (alarm_manager_get_rule_status(r->id, &st) != RESULT_OK) {
+        tui_set_status("Rule %d is not loaded by the alarm manager", r->id);
+        return;
+    }
+
+    if (st.shelved) {
+        if (alarm_manager_unshelve(r->id, "operator") == RESULT_OK) {
+            tui_set_status("Rule %d unshelved", r->id);
+        }
+        return;
+    }
+
+    result_t res = alarm_manager_shelve(r->id, 0, "operator");
+    if (res == RESULT_OK) {
+        tui_set_status("Rule %d shelved for %d min", r->id, WT_ALARM_SHELVE_DEFAULT_SEC / 60);
+    } else if (res == RESULT_NOT_SUPPORTED) {
+        tui_set_status("Rule %d drives an interlock and cannot be shelved", r->id);
+    } else {
+        tui_set_status("Failed to shelve rule %d: %s", r->id, result_to_string(res));
+    }
+}
+
 static void switch_view(int mode) {
     g_page.view_mode = mode;
     /* Reset list widget for new view */
@@ -609,6 +665,7 @@ void page_alarms_input(WINDOW *win, int ch) {
                             dialog_alarm_save_to_rule(&form, &db_rule);
                             if (db_alarm_rule_update(db, &db_rule) == RESULT_OK) {
                                 tui_set_status("Rule '%s' updated", form.name);
+                                alarm_manager_reload_rules();
                                 load_alarm_rules();
                             } else {
                                 tui_set_status("Failed to update rule");
@@ -635,6 +692,7 @@ void page_alarms_input(WINDOW *win, int ch) {
                         int new_id = 0;
                         if (db_alarm_rule_create(db, &db_rule, &new_id) == RESULT_OK) {
                             tui_set_status("Rule '%s' created (ID: %d)", form.name, new_id);
+                            alarm_manager_reload_rules();
                             load_alarm_rules();
                         } else {
                             tui_set_status("Failed to create rule");
@@ -663,6 +721,13 @@ void page_alarms_input(WINDOW *win, int ch) {
             }
             break;
 
+        case 's':
+        case 'S':
+            if (g_page.view_mode == 2) {
+                toggle_rule_shelved();
+            }
+            break;
+
         case 'd':
         case 'D':
         case KEY_DC:
@@ -671,7 +736,10 @@ void page_alarms_input(WINDOW *win, int ch) {
                 database_t *db = tui_get_database();
                 if (db) {
                     rule_display_t *rule = &g_page.rules[g_page.list.selected];
-                    if (db_alarm_rule_delete(db, rule->id) == RESULT_OK) {
+                    /* Through the manager, so a standing alarm is cleared with it */
+                    result_t res = alarm_manager_delete_rule(rule->id);
+                    if (res == RESULT_NOT_INITIALIZED) res = db_alarm_rule_delete(db, rule->id);
+                    if (res == RESULT_OK) {
                         tui_set_status("Rule '%s' deleted", rule->name);
                         load_alarm_rules();
                         /* tui_list_set_count() in load_alarm_rules() adjusts selection */
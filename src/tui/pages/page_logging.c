@@ -240,6 +240,10 @@ static void draw_stats(WINDOW *win, int *row) {
     mvwprintw(win, stat_row++, 52, "Remote Failed: %lu", g_page.stats.total_remote_failed);
     mvwprintw(win, stat_row++, 52, "Queue: %d/%d", 
               g_page.stats.queue_count, g_page.stats.queue_capacity);
+    mvwprintw(win, stat_row++, 52, "Dropped: %lu (aged %lu)",
+              g_page.stats.total_dropped, g_page.stats.total_dropped_age);
+    mvwprintw(win, stat_row++, 52, "Spool: %lu pending, %lu KB",
+              g_page.stats.spool_backlog, g_page.stats.spool_bytes / 1024);
 }
 
 static void draw_events(WINDOW *win, int *row) {
@@ -101,6 +101,13 @@ static void draw_sensor_list(WINDOW *win) {
             wattron(win, A_REVERSE);
         }
 
+        /* Prefer the scan's latest sample over the stored status row */
+        sensor_sample_t live;
+        if (tui_live_sample(s->slot, s->id, &live)) {
+            s->value = live.value;
+            SAFE_STRNCPY(s->status, sample_bus_quality_status(live.quality), sizeof(s->status));
+        }
+
         /* Use centralized status color function */
         int color = tui_status_color(s->status);
 
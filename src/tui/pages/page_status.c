@@ -8,6 +8,7 @@
 #include "db/database.h"
 #include "db/db_modules.h"
 #include "db/db_alarms.h"
+#include "alarms/alarm_manager.h"
 #include "profinet/profinet_manager.h"
 #include "utils/logger.h"
 #include <ncurses.h>
@@ -119,6 +120,11 @@ static void refresh_profinet_stats(void) {
 }
 
 static void refresh_alarm_stats(void) {
+    if (alarm_manager_get_active_count(&g_page.active_alarms) == RESULT_OK) {
+        alarm_manager_get_active_by_severity(ALARM_SEVERITY_CRITICAL, &g_page.critical_alarms);
+        return;
+    }
+
     database_t *db = tui_get_database();
     if (!db) return;
     
@@ -236,6 +242,13 @@ static void draw_sensor_table(WINDOW *win, int *row) {
         int idx = g_page.list.scroll_offset + i;
         sensor_display_t *s = &g_page.sensors[idx];
 
+        /* Prefer the scan's latest sample over the stored status row */
+        sensor_sample_t live;
+        if (tui_live_sample(s->slot, s->id, &live)) {
+            s->value = live.value;
+            SAFE_STRNCPY(s->status, sample_bus_quality_status(live.quality), sizeof(s->status));
+        }
+
         int color = tui_status_color(s->status);
 
         mvwprintw(win, *row, 4, "%-4d %-24s ", s->slot, s->name);
@@ -20,6 +20,13 @@ static struct {
 #endif
 } g_ctx = {0};
 
+/* Latest sample per slot, fed from the sample bus by the TUI thread */
+static struct {
+    sample_subscriber_t *sub;
+    sensor_sample_t latest[SENSOR_MAX_SLOT + 1];
+    bool seen[SENSOR_MAX_SLOT + 1];
+} g_live = {0};
+
 /* ============================================================================
  * Context Management
  * ========================================================================== */
@@ -67,6 +74,43 @@ void tui_reload_sensors(void) {
     }
 }
 
+/* ============================================================================
+ * Live Values
+ * ========================================================================== */
+
+void tui_live_refresh(void) {
+    if (!g_live.sub &&
+        sample_bus_subscribe("tui", WT_SAMPLE_BUS_TUI_DEPTH, SAMPLE_BUS_DROP_OLDEST,
+                             &g_live.sub) != RESULT_OK) {
+        g_live.sub = NULL;
+        return;
+    }
+
+    /* Only the newest sample per slot matters; older ones are overwritten */
+    sensor_sample_t batch[32];
+    int n;
+    while ((n = sample_bus_poll(g_live.sub, batch, 32)) > 0) {
+        for (int i = 0; i < n; i++) {
+            int slot = batch[i].slot;
+            if (slot < 0 || slot > SENSOR_MAX_SLOT) continue;
+            g_live.latest[slot] = batch[i];
+            g_live.seen[slot] = true;
+        }
+    }
+}
+
+bool tui_live_sample(int slot, int module_id, sensor_sample_t *out) {
+    if (slot < 0 || slot > SENSOR_MAX_SLOT || !g_live.seen[slot]) return false;
+    if (g_live.latest[slot].module_id != module_id) return false;
+    if (out) *out = g_live.latest[slot];
+    return true;
+}
+
+void tui_live_release(void) {
+    sample_bus_unsubscribe(g_live.sub);
+    memset(&g_live, 0, sizeof(g_live));
+}
+
 void tui_notify_sensor_changed(int sensor_slot) {
     /* Reload sensors from database */
     tui_reload_sensors();
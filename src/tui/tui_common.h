@@ -5,6 +5,7 @@
 #include "db/database.h"
 #include "config/config.h"
 #include "sensors/sensor_manager.h"
+#include "sensors/sample_bus.h"
 #ifdef LED_SUPPORT
 #include "hal/led_status.h"
 #endif
@@ -53,6 +54,26 @@ void tui_reload_sensors(void);
  */
 void tui_notify_sensor_changed(int sensor_slot);
 
+/**
+ * @brief Drain the TUI's sample bus subscription into the live-value table
+ *
+ * Called once per main-loop pass; subscribes on first use.
+ */
+void tui_live_refresh(void);
+
+/**
+ * @brief Latest published sample for a sensor
+ * @param slot Sensor slot
+ * @param module_id Module expected at that slot (guards against reassignment)
+ * @return true if a sample has been seen since the TUI started
+ */
+bool tui_live_sample(int slot, int module_id, sensor_sample_t *out);
+
+/**
+ * @brief Drop the sample bus subscription (TUI shutdown)
+ */
+void tui_live_release(void);
+
 // Drawing utilities
 void tui_draw_box(WINDOW *win, int y, int x, int height, int width, const char *title);
 void tui_draw_hline(WINDOW *win, int y, int x, int width);
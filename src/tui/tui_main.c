@@ -372,6 +372,8 @@ void tui_run(void) {
     g_tui.running = true;
 
     while (g_tui.running) {
+        tui_live_refresh();
+
         // Draw status bar and footer
         draw_status_bar();
         draw_footer();
@@ -514,6 +516,8 @@ void tui_shutdown(void) {
         pages[g_tui.current_page].cleanup();
     }
 
+    tui_live_release();
+
     /* Destroy windows */
     if (g_tui.status_bar) delwin(g_tui.status_bar);
     if (g_tui.main_win) delwin(g_tui.main_win);
@@ -0,0 +1,595 @@
+/**
+ * @file bench_alarms.c
+ * @brief Alarm engine scalability bench on an in-memory database
+ *
+ * For each (rules, modules) pair, builds a synthetic rule set on a fresh
+ * :memory: database, starts the real alarm manager and drives it twice:
+ *
+ *   direct   alarm_manager_check_value() called back to back from one thread,
+ *            round-robin over the modules (the hot path the sample bus feeds)
+ *   thread   samples published on the sample bus at --rate, evaluated by the
+ *            alarm check thread as in the running RTU
+ *
+ * Every module carries a noisy baseline. A small rotating subset makes a
+ * one-sample excursion that trips its threshold rules and clears on the
+ * next sample, so each excursion is one raise and one clear per rule.
+ * Rules are a mix of ABOVE, BELOW and OUT_OF_RANGE, plus --window-pct
+ * SIGMA rules with an unreachable threshold (windowed statistics cost,
+ * never a transition).
+ *
+ * Reported per configuration (JSON on stdout):
+ *   evaluations_per_sec  rule evaluations / wall time
+ *   check_value_ns       latency of one alarm_manager_check_value() call
+ *   sample_to_raise_us   bus publish of an excursion -> raise callback
+ *   db                   journal rows, SQLite row changes and commits per
+ *                        alarm transition (raise or clear), and rows the
+ *                        journal dropped because its queue was full
+ *
+ * First, one RATE_OF_CHANGE rule (low left at 0) is fed a flat signal, a
+ * fall steeper than its limit and a flat signal again; it must raise on
+ * the fall only and clear afterwards, or the run fails.
+ *
+ * Usage: bench_alarms [--rules N,N,...] [--modules N,N,...] [--calls N]
+ *                     [--duration S] [--rate N] [--window-pct N]
+ */
+
+#include "common.h"
+#include "bench_common.h"
+#include "alarms/alarm_manager.h"
+#include "alarms/alarm_journal.h"
+#include "sensors/sample_bus.h"
+#include "db/database.h"
+#include "db/db_modules.h"
+#include "db/db_alarms.h"
+#include "utils/logger.h"
+#include "config_defaults.h"
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define BENCH_MAX_CONFIGS       8
+#define BENCH_MAX_MODULES       4096
+#define BENCH_SAMPLE_CAP        (1u << 20)
+#define BENCH_BATCH             64      /* Samples per publish, as one sensor scan */
+#define BENCH_EXCURSION_PERIOD  256     /* Rounds between excursions of one module */
+#define BENCH_FLUSH_TIMEOUT_MS  10000
+
+#define BASELINE        50.0f
+#define LIMIT_LOW       20.0f
+#define LIMIT_HIGH      80.0f
+
+typedef struct {
+    int rules[BENCH_MAX_CONFIGS];
+    int rule_sets;
+    int modules[BENCH_MAX_CONFIGS];
+    int module_sets;
+    int calls;
+    int duration_s;
+    int rate;
+    int window_pct;
+} bench_options_t;
+
+static bench_options_t g_opt = {
+    .rules = {10, 100, 1000, 10000},
+    .rule_sets = 4,
+    .modules = {64, 1000},
+    .module_sets = 2,
+    .calls = 200000,
+    .duration_s = 2,
+    .rate = 20000,
+    .window_pct = 10,
+};
+
+/* Raise/clear callbacks run on the evaluating thread under the alarm mutex */
+static atomic_uint_least64_t g_raised;
+static atomic_uint_least64_t g_cleared;
+static _Atomic uint64_t g_excursion_ns[BENCH_MAX_MODULES];
+static bench_samples_t g_sample_to_raise;
+static pthread_mutex_t g_samples_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int g_module_ids[BENCH_MAX_MODULES];
+static int g_module_count;
+static uint32_t g_noise_state = 0x2545F491u;
+
+/* ============================================================================
+ * Synthetic Workload
+ * ========================================================================== */
+
+static float next_noise(void) {
+    g_noise_state ^= g_noise_state << 13;
+    g_noise_state ^= g_noise_state >> 17;
+    g_noise_state ^= g_noise_state << 5;
+    return ((float)(g_noise_state & 0xFFFF) / 65535.0f - 0.5f) * 4.0f;
+}
+
+/* Module index m in round r: one sample past a limit, alternating sides */
+static bool in_excursion(int m, uint64_t round) {
+    return ((round + (uint64_t)m * 7) % BENCH_EXCURSION_PERIOD) == 0;
+}
+
+static float sample_value(int m, uint64_t round) {
+    if (in_excursion(m, round)) {
+        return ((round / BENCH_EXCURSION_PERIOD) & 1) ? LIMIT_LOW - 10.0f : LIMIT_HIGH + 10.0f;
+    }
+    return BASELINE + next_noise();
+}
+
+static void on_raised(db_alarm_history_t *alarm, void *ctx) {
+    UNUSED(ctx);
+    atomic_fetch_add(&g_raised, 1);
+
+    /* Fresh database: module IDs are consecutive from g_module_ids[0] */
+    int m = alarm->module_id - g_module_ids[0];
+    if (m < 0 || m >= g_module_count || g_module_ids[m] != alarm->module_id) return;
+
+    /* First raise of an excursion closes the publish -> raise measurement */
+    uint64_t published = atomic_exchange(&g_excursion_ns[m], 0);
+    if (published) {
+        uint64_t now = bench_now_ns();
+        pthread_mutex_lock(&g_samples_mutex);
+        bench_samples_add(&g_sample_to_raise, (now - published) / 1000);
+        pthread_mutex_unlock(&g_samples_mutex);
+    }
+}
+
+static void on_cleared(db_alarm_history_t *alarm, void *ctx) {
+    UNUSED(alarm); UNUSED(ctx);
+    atomic_fetch_add(&g_cleared, 1);
+}
+
+static int build_rule_set(database_t *db, int rules, int modules) {
+    g_module_count = 0;
+    for (int m = 0; m < BENCH_MAX_MODULES; m++) atomic_store(&g_excursion_ns[m], 0);
+
+    database_begin_transaction(db);
+
+    for (int m = 0; m < modules; m++) {
+        db_module_t module = {0};
+        module.slot = m + 1;
+        snprintf(module.name, sizeof(module.name), "bench-%d", m);
+        SAFE_STRNCPY(module.module_type, "sensor", sizeof(module.module_type));
+        SAFE_STRNCPY(module.status, STATUS_ACTIVE, sizeof(module.status));
+        if (db_module_create(db, &module, &g_module_ids[m]) != RESULT_OK) {
+            database_rollback(db);
+            return -1;
+        }
+    }
+
+    g_module_count = modules;
+
+    int windowed_every = g_opt.window_pct > 0 ? 100 / g_opt.window_pct : 0;
+    for (int i = 0; i < rules; i++) {
+        db_alarm_rule_t rule = {0};
+        rule.module_id = g_module_ids[i % modules];
+        snprintf(rule.name, sizeof(rule.name), "rule-%d", i);
+        rule.severity = (alarm_severity_t)(i % (ALARM_SEVERITY_CRITICAL + 1));
+        rule.enabled = true;
+        rule.auto_clear = true;
+        rule.hysteresis_percent = WT_ALARM_HYSTERESIS_PCT;
+        rule.window_seconds = WT_ALARM_WINDOW_SEC;
+        rule.chatter_window_seconds = 60;
+
+        if (windowed_every > 0 && i % windowed_every == windowed_every - 1) {
+            rule.condition = ALARM_CONDITION_SIGMA;
+            rule.threshold_high = 1.0e6f;
+        } else {
+            switch (i % 3) {
+                case 0:
+                    rule.condition = ALARM_CONDITION_ABOVE_THRESHOLD;
+                    rule.threshold_high = LIMIT_HIGH;
+                    break;
+                case 1:
+                    rule.condition = ALARM_CONDITION_BELOW_THRESHOLD;
+                    rule.threshold_low = LIMIT_LOW;
+                    break;
+                default:
+                    rule.condition = ALARM_CONDITION_OUT_OF_RANGE;
+                    rule.threshold_high = LIMIT_HIGH;
+                    rule.threshold_low = LIMIT_LOW;
+                    break;
+            }
+        }
+
+        int rule_id;
+        if (db_alarm_rule_create(db, &rule, &rule_id) != RESULT_OK) {
+            database_rollback(db);
+            return -1;
+        }
+    }
+
+    return database_commit(db) == RESULT_OK ? 0 : -1;
+}
+
+/* ============================================================================
+ * Measurement
+ * ========================================================================== */
+
+typedef struct {
+    uint64_t raised;
+    uint64_t cleared;
+    uint64_t journal_written;
+    uint64_t journal_batches;
+    uint64_t journal_dropped;
+    int64_t total_changes;
+    uint64_t evaluations;
+    uint64_t checks;
+} bench_mark_t;
+
+static void mark(database_t *db, bench_mark_t *m) {
+    /* Everything raised so far must be on disk before it is counted */
+    alarm_journal_flush(BENCH_FLUSH_TIMEOUT_MS);
+
+    alarm_journal_stats_t js = {0};
+    alarm_journal_get_stats(&js);
+    alarm_manager_stats_t as = {0};
+    alarm_manager_get_stats(&as);
+
+    m->raised = atomic_load(&g_raised);
+    m->cleared = atomic_load(&g_cleared);
+    m->journal_written = js.written;
+    m->journal_batches = js.batches;
+    m->journal_dropped = js.dropped;
+    m->total_changes = sqlite3_total_changes(db->db);
+    m->evaluations = as.evaluations;
+    m->checks = as.total_checks;
+}
+
+static void print_db_cost(const bench_mark_t *a, const bench_mark_t *b, int trailing_comma) {
+    uint64_t transitions = (b->raised - a->raised) + (b->cleared - a->cleared);
+    uint64_t rows = b->journal_written - a->journal_written;
+    uint64_t commits = b->journal_batches - a->journal_batches;
+    uint64_t dropped = b->journal_dropped - a->journal_dropped;
+    int64_t changes = b->total_changes - a->total_changes;
+    double t = transitions ? (double)transitions : 1.0;
+
+    printf("      \"db\": {\"transitions\": %llu, \"journal_rows\": %llu, "
+           "\"journal_dropped\": %llu, \"row_changes\": %lld, \"commits\": %llu, "
+           "\"rows_per_transition\": %.3f, \"changes_per_transition\": %.3f, "
+           "\"commits_per_transition\": %.4f}%s\n",
+           (unsigned long long)transitions, (unsigned long long)rows,
+           (unsigned long long)dropped, (long long)changes, (unsigned long long)commits,
+           (double)rows / t, (double)changes / t, (double)commits / t,
+           trailing_comma ? "," : "");
+}
+
+/* Back-to-back calls on the caller's thread; the check thread keeps polling */
+static void run_direct(database_t *db, int modules) {
+    bench_samples_t latency;
+    bench_samples_init(&latency, (size_t)g_opt.calls);
+
+    bench_mark_t before, after;
+    mark(db, &before);
+
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < g_opt.calls; i++) {
+        int m = i % modules;
+        float value = sample_value(m, (uint64_t)(i / modules));
+
+        uint64_t t0 = bench_now_ns();
+        alarm_manager_check_value(g_module_ids[m], value);
+        bench_samples_add(&latency, bench_now_ns() - t0);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    mark(db, &after);
+
+    double secs = (double)elapsed / 1e9;
+    printf("    \"direct\": {\n");
+    printf("      \"calls\": %d, \"elapsed_s\": %.3f, \"calls_per_sec\": %.0f, "
+           "\"evaluations\": %llu, \"evaluations_per_sec\": %.0f,\n",
+           g_opt.calls, secs, (double)g_opt.calls / secs,
+           (unsigned long long)(after.evaluations - before.evaluations),
+           (double)(after.evaluations - before.evaluations) / secs);
+    printf("    ");
+    bench_print_samples(stdout, "check_value_ns", &latency, "ns", 1);
+    print_db_cost(&before, &after, 0);
+    printf("    },\n");
+
+    bench_samples_free(&latency);
+}
+
+static void timespec_add_ns(struct timespec *ts, long ns) {
+    ts->tv_nsec += ns;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+/* Scan-shaped batches on the sample bus, evaluated by the check thread */
+static void run_threaded(database_t *db, int modules) {
+    bench_samples_init(&g_sample_to_raise, BENCH_SAMPLE_CAP);
+    for (int m = 0; m < modules; m++) atomic_store(&g_excursion_ns[m], 0);
+
+    sample_bus_stats_t bus_before, bus_after;
+    sample_bus_get_stats(&bus_before);
+    bench_mark_t before, after;
+    mark(db, &before);
+
+    long batch_ns = (long)(1e9 * BENCH_BATCH / (double)g_opt.rate);
+    uint64_t end = bench_now_ns() + (uint64_t)g_opt.duration_s * 1000000000ULL;
+    uint64_t published = 0;
+    uint64_t seq = 0;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (bench_now_ns() < end) {
+        sensor_sample_t batch[BENCH_BATCH];
+        for (int i = 0; i < BENCH_BATCH; i++, seq++) {
+            int m = (int)(seq % (uint64_t)modules);
+            uint64_t round = seq / (uint64_t)modules;
+            batch[i].module_id = g_module_ids[m];
+            batch[i].slot = m + 1;
+            batch[i].value = sample_value(m, round);
+            batch[i].quality = QUALITY_GOOD;
+            batch[i].timestamp_ms = get_time_ms();
+            batch[i].wall_time = time(NULL);
+            if (in_excursion(m, round)) atomic_store(&g_excursion_ns[m], bench_now_ns());
+        }
+        sample_bus_publish(batch, BENCH_BATCH);
+        published += BENCH_BATCH;
+
+        timespec_add_ns(&next, batch_ns);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    /* Let the check thread drain its ring before the counters are read */
+    usleep(2 * WT_ALARM_TIMER_TICK_MS * 1000);
+    mark(db, &after);
+    sample_bus_get_stats(&bus_after);
+
+    uint64_t dropped = 0;
+    for (int i = 0; i < bus_after.subscriber_count; i++) {
+        if (strcmp(bus_after.subscribers[i].name, "alarms") != 0) continue;
+        dropped = bus_after.subscribers[i].dropped;
+        for (int j = 0; j < bus_before.subscriber_count; j++) {
+            if (strcmp(bus_before.subscribers[j].name, "alarms") == 0) {
+                dropped -= bus_before.subscribers[j].dropped;
+            }
+        }
+    }
+
+    printf("    \"thread\": {\n");
+    printf("      \"rate\": %d, \"duration_s\": %d, \"published\": %llu, \"bus_dropped\": %llu, "
+           "\"evaluations_per_sec\": %.0f, \"poll_checks\": %llu,\n",
+           g_opt.rate, g_opt.duration_s, (unsigned long long)published,
+           (unsigned long long)dropped,
+           (double)(after.evaluations - before.evaluations) / (double)g_opt.duration_s,
+           (unsigned long long)(after.checks - before.checks));
+    pthread_mutex_lock(&g_samples_mutex);
+    printf("    ");
+    bench_print_samples(stdout, "sample_to_raise_us", &g_sample_to_raise, "us", 1);
+    pthread_mutex_unlock(&g_samples_mutex);
+    print_db_cost(&before, &after, 0);
+    printf("    }\n");
+
+    bench_samples_free(&g_sample_to_raise);
+}
+
+static int run_config(int rules, int modules, bool last) {
+    database_t db;
+    if (database_init(&db, ":memory:") != RESULT_OK) {
+        fprintf(stderr, "database_init failed\n");
+        return -1;
+    }
+
+    uint64_t build_start = bench_now_us();
+    if (build_rule_set(&db, rules, modules) != 0) {
+        fprintf(stderr, "building %d rules over %d modules failed\n", rules, modules);
+        database_close(&db);
+        return -1;
+    }
+    uint64_t build_us = bench_now_us() - build_start;
+
+    uint64_t init_start = bench_now_us();
+    if (alarm_manager_init(&db) != RESULT_OK) {
+        fprintf(stderr, "alarm_manager_init failed\n");
+        database_close(&db);
+        return -1;
+    }
+    uint64_t init_us = bench_now_us() - init_start;
+
+    alarm_manager_set_callbacks(on_raised, on_cleared, NULL);
+    alarm_manager_start();
+
+    alarm_manager_stats_t stats = {0};
+    alarm_manager_get_stats(&stats);
+
+    printf("  {\n");
+    printf("    \"rules\": %d, \"modules\": %d, \"indexed_rules\": %d, \"indexed_modules\": %d, "
+           "\"build_us\": %llu, \"index_build_us\": %llu,\n",
+           rules, modules, stats.cached_rule_count, stats.indexed_modules,
+           (unsigned long long)build_us, (unsigned long long)init_us);
+
+    run_direct(&db, modules);
+    run_threaded(&db, modules);
+
+    printf("  }%s\n", last ? "" : ",");
+    fflush(stdout);
+
+    alarm_manager_shutdown();
+    database_close(&db);
+    return stats.cached_rule_count == rules ? 0 : -1;
+}
+
+/* ============================================================================
+ * Rate of Change
+ * ========================================================================== */
+
+#define RATE_LIMIT          60.0f   /* units/min; low left at 0 as the dialog does */
+#define RATE_STEP_MS        10
+
+/* Feed value(t) every RATE_STEP_MS for ms; returns whether the rule ended in alarm */
+static bool feed_rate(int module_id, int rule_id, float *value, float per_s, int ms,
+                      bool stop_on_change, int *elapsed_ms) {
+    alarm_rule_status_t status = {0};
+    alarm_manager_get_rule_status(rule_id, &status);
+    bool start = status.in_alarm;
+
+    for (*elapsed_ms = 0; *elapsed_ms < ms; *elapsed_ms += RATE_STEP_MS) {
+        *value += per_s * RATE_STEP_MS / 1000.0f;
+        alarm_manager_check_value(module_id, *value);
+        alarm_manager_get_rule_status(rule_id, &status);
+        if (stop_on_change && status.in_alarm != start) break;
+        usleep(RATE_STEP_MS * 1000);
+    }
+    return status.in_alarm;
+}
+
+/*
+ * One RATE_OF_CHANGE rule with the dialog's default low: a flat signal
+ * must not raise, a fall steeper than the limit must, and flat again
+ * must clear it.
+ */
+static int run_rate_check(void) {
+    database_t db;
+    if (database_init(&db, ":memory:") != RESULT_OK) return -1;
+
+    db_module_t module = {0};
+    module.slot = 1;
+    SAFE_STRNCPY(module.name, "rate", sizeof(module.name));
+    SAFE_STRNCPY(module.module_type, "sensor", sizeof(module.module_type));
+    SAFE_STRNCPY(module.status, STATUS_ACTIVE, sizeof(module.status));
+    int module_id = 0, rule_id = 0;
+    db_module_create(&db, &module, &module_id);
+
+    db_alarm_rule_t rule = {0};
+    rule.module_id = module_id;
+    SAFE_STRNCPY(rule.name, "rate", sizeof(rule.name));
+    rule.condition = ALARM_CONDITION_RATE_OF_CHANGE;
+    rule.threshold_high = RATE_LIMIT;
+    rule.threshold_low = 0.0f;
+    rule.severity = ALARM_SEVERITY_MEDIUM;
+    rule.enabled = true;
+    rule.auto_clear = true;
+    rule.hysteresis_percent = WT_ALARM_HYSTERESIS_PCT;
+    rule.window_seconds = 1;
+    rule.chatter_window_seconds = 60;
+    if (db_alarm_rule_create(&db, &rule, &rule_id) != RESULT_OK ||
+        alarm_manager_init(&db) != RESULT_OK) {
+        database_close(&db);
+        return -1;
+    }
+    alarm_manager_start();
+
+    float value = BASELINE;
+    int flat_ms, fall_ms, clear_ms;
+    bool flat = feed_rate(module_id, rule_id, &value, 0.0f, 1000, true, &flat_ms);
+    bool falling = !flat && feed_rate(module_id, rule_id, &value, -2.0f * RATE_LIMIT / 60.0f,
+                                      2000, true, &fall_ms);
+    bool held = falling && feed_rate(module_id, rule_id, &value, 0.0f, 5000, true, &clear_ms);
+
+    printf("  \"rate_of_change\": {\"flat_raised\": %s, \"falling_raised\": %s, "
+           "\"raise_ms\": %d, \"flat_cleared\": %s, \"clear_ms\": %d},\n",
+           flat ? "true" : "false", falling ? "true" : "false", falling ? fall_ms : -1,
+           falling && !held ? "true" : "false", falling && !held ? clear_ms : -1);
+
+    alarm_manager_shutdown();
+    database_close(&db);
+    return !flat && falling && !held ? 0 : -1;
+}
+
+/* ============================================================================
+ * Main
+ * ========================================================================== */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--rules N,N,...] [--modules N,N,...] [--calls N]\n"
+            "          [--duration S] [--rate N] [--window-pct N]\n", prog);
+}
+
+static int parse_list(const char *arg, int *out, int *count) {
+    char buf[128];
+    SAFE_STRNCPY(buf, arg, sizeof(buf));
+    *count = 0;
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        if (*count >= BENCH_MAX_CONFIGS) return -1;
+        out[(*count)++] = atoi(tok);
+    }
+    return *count > 0 ? 0 : -1;
+}
+
+static int parse_args(int argc, char *argv[]) {
+    static const struct option opts[] = {
+        {"rules",      required_argument, NULL, 'r'},
+        {"modules",    required_argument, NULL, 'm'},
+        {"calls",      required_argument, NULL, 'c'},
+        {"duration",   required_argument, NULL, 'd'},
+        {"rate",       required_argument, NULL, 'R'},
+        {"window-pct", required_argument, NULL, 'w'},
+        {"help",       no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "r:m:c:d:R:w:h", opts, NULL)) != -1) {
+        switch (c) {
+            case 'r':
+                if (parse_list(optarg, g_opt.rules, &g_opt.rule_sets) != 0) goto bad;
+                break;
+            case 'm':
+                if (parse_list(optarg, g_opt.modules, &g_opt.module_sets) != 0) goto bad;
+                break;
+            case 'c': g_opt.calls = atoi(optarg); break;
+            case 'd': g_opt.duration_s = atoi(optarg); break;
+            case 'R': g_opt.rate = atoi(optarg); break;
+            case 'w': g_opt.window_pct = atoi(optarg); break;
+            default: goto bad;
+        }
+    }
+
+    for (int i = 0; i < g_opt.rule_sets; i++) {
+        if (g_opt.rules[i] < 1 || g_opt.rules[i] > WT_ALARM_MAX_RULES) goto bad;
+    }
+    for (int i = 0; i < g_opt.module_sets; i++) {
+        if (g_opt.modules[i] < 1 || g_opt.modules[i] > BENCH_MAX_MODULES) goto bad;
+    }
+    if (g_opt.calls < 1 || g_opt.duration_s < 1 || g_opt.rate < BENCH_BATCH ||
+        g_opt.window_pct < 0 || g_opt.window_pct > 100) {
+        goto bad;
+    }
+    return 0;
+
+bad:
+    usage(argv[0]);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    if (parse_args(argc, argv) != 0) return 2;
+
+    logger_config_t log_cfg = {0};
+    /* Journal overflow is reported in the JSON; per-record errors would skew timing */
+    log_cfg.level = LOG_LEVEL_FATAL;
+    log_cfg.destinations = LOG_DEST_CONSOLE;
+    logger_init(&log_cfg);
+
+    printf("{\n");
+    printf("  \"bench\": \"alarms\",\n");
+    printf("  \"max_rules\": %d, \"calls\": %d, \"duration_s\": %d, \"rate\": %d, "
+           "\"window_pct\": %d,\n",
+           WT_ALARM_MAX_RULES, g_opt.calls, g_opt.duration_s, g_opt.rate, g_opt.window_pct);
+    int rc = run_rate_check() == 0 ? 0 : 1;
+    atomic_store(&g_raised, 0);
+    atomic_store(&g_cleared, 0);
+
+    printf("  \"results\": [\n");
+
+    int total = g_opt.rule_sets * g_opt.module_sets;
+    int n = 0;
+    for (int r = 0; r < g_opt.rule_sets; r++) {
+        for (int m = 0; m < g_opt.module_sets; m++) {
+            n++;
+            if (run_config(g_opt.rules[r], g_opt.modules[m], n == total) != 0) rc = 1;
+        }
+    }
+
+    printf("  ]\n");
+    printf("}\n");
+
+    logger_shutdown();
+    return rc;
+}
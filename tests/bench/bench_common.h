@@ -0,0 +1,91 @@
+/**
+ * @file bench_common.h
+ * @brief Shared helpers for the hardware-free benches (sample sets, JSON)
+ *
+ * Benches print one JSON object on stdout so CI can archive and diff the
+ * numbers; log output goes to stderr.
+ */
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t *v;
+    size_t n;
+    size_t cap;
+    uint64_t dropped;   /* Samples beyond cap (counted, not stored) */
+} bench_samples_t;
+
+static inline uint64_t bench_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline int bench_samples_init(bench_samples_t *s, size_t cap) {
+    memset(s, 0, sizeof(*s));
+    s->v = malloc(cap * sizeof(uint64_t));
+    if (!s->v) return -1;
+    s->cap = cap;
+    return 0;
+}
+
+static inline void bench_samples_free(bench_samples_t *s) {
+    free(s->v);
+    memset(s, 0, sizeof(*s));
+}
+
+static inline void bench_samples_add(bench_samples_t *s, uint64_t value) {
+    if (s->n < s->cap) {
+        s->v[s->n++] = value;
+    } else {
+        s->dropped++;
+    }
+}
+
+static int bench_cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Sorts in place; call once all producers are done */
+static inline uint64_t bench_percentile(bench_samples_t *s, double pct) {
+    if (s->n == 0) return 0;
+    size_t idx = (size_t)((pct / 100.0) * (double)(s->n - 1) + 0.5);
+    return s->v[idx];
+}
+
+static inline void bench_samples_sort(bench_samples_t *s) {
+    qsort(s->v, s->n, sizeof(uint64_t), bench_cmp_u64);
+}
+
+/* Emit "name": {count, p50, p99, max, mean} (unit is the caller's) */
+static inline void bench_print_samples(FILE *out, const char *name, bench_samples_t *s,
+                                       const char *unit, int trailing_comma) {
+    bench_samples_sort(s);
+    double sum = 0;
+    for (size_t i = 0; i < s->n; i++) sum += (double)s->v[i];
+
+    fprintf(out, "  \"%s\": {\"count\": %zu, \"p50_%s\": %llu, \"p99_%s\": %llu, "
+                 "\"max_%s\": %llu, \"mean_%s\": %.2f}%s\n",
+            name, s->n,
+            unit, (unsigned long long)bench_percentile(s, 50.0),
+            unit, (unsigned long long)bench_percentile(s, 99.0),
+            unit, (unsigned long long)(s->n ? s->v[s->n - 1] : 0),
+            unit, s->n ? sum / (double)s->n : 0.0,
+            trailing_comma ? "," : "");
+}
+
+#endif /* BENCH_COMMON_H */
@@ -0,0 +1,307 @@
+/**
+ * @file bench_compress.c
+ * @brief Historian compression: points kept, uplink bytes and rebuild error
+ *
+ * Generates --days of one-per-interval samples for four typical process
+ * values (tank level with fill cycles, diurnal temperature, noisy pH, a
+ * pump flow switching on and off, including a stretch of bad readings)
+ * and runs them through the compressor in each mode with per-sensor
+ * deviations.
+ *
+ * Every original point is rebuilt from the kept ones (linear for
+ * swinging door, step for deadband) and compared. A run fails if any
+ * point is off by more than its deviation, shows the wrong status, or a
+ * sensor goes longer than the heartbeat plus one interval without a kept
+ * point; with --min-reduction, also if the swinging-door run keeps more
+ * than (1 - min) of the points.
+ *
+ * Reported (JSON on stdout), per mode: points in/out, reduction, worst
+ * error as a fraction of the deviation, longest gap, and uplink bytes
+ * (binary + gzip, batches of 50) for the kept points.
+ *
+ * Usage: bench_compress [--days N] [--interval-s N] [--heartbeat-s N]
+ *                       [--min-reduction F]
+ */
+
+#include "common.h"
+#include "bench_common.h"
+#include "config_defaults.h"
+#include "logging/compressor.h"
+#include "logging/uplink.h"
+#include "utils/logger.h"
+#include <getopt.h>
+#include <math.h>
+
+#define BENCH_EPOCH_S       1700000000LL
+#define BENCH_DEVICE        "bench-rtu"
+#define SENSORS             4
+#define UPLINK_BATCH        50
+
+typedef struct {
+    int days;
+    int interval_s;
+    int heartbeat_s;
+    double min_reduction;
+} bench_options_t;
+
+static bench_options_t g_opt = {
+    .days = 7,
+    .interval_s = 60,
+    .heartbeat_s = WT_COMPRESSION_HEARTBEAT_S,
+    .min_reduction = 0.0,
+};
+
+static const struct {
+    const char *name;
+    float dev;
+} g_sensors[SENSORS] = {
+    { "tank_level_m",   0.01f },
+    { "temperature_c",  0.1f },
+    { "ph",             0.05f },
+    { "pump_flow_m3h",  0.2f },
+};
+
+static uplink_entry_t *g_points;
+static int g_count;
+static uint32_t g_noise_state = 0x2545F491u;
+
+/* ============================================================================
+ * Synthetic Signals
+ * ========================================================================== */
+
+static float noise(float amplitude) {
+    g_noise_state ^= g_noise_state << 13;
+    g_noise_state ^= g_noise_state >> 17;
+    g_noise_state ^= g_noise_state << 5;
+    return ((float)(g_noise_state & 0xFFFF) / 65535.0f - 0.5f) * 2.0f * amplitude;
+}
+
+static float quantize(float v, float step) {
+    return roundf(v / step) * step;
+}
+
+static float signal_value(int sensor, double hours) {
+    switch (sensor) {
+        case 0: {
+            /* Level holds for hours, then a 40 minute fill every 9 hours */
+            double phase = fmod(hours, 9.0);
+            double level = 2.0 + (phase < 8.33 ? 0.0 : (phase - 8.33) * 1.5);
+            return quantize((float)level + noise(0.002f), 0.001f);
+        }
+        case 1:
+            return quantize(18.0f + 3.0f * (float)sin(2.0 * M_PI * hours / 24.0) + noise(0.02f), 0.01f);
+        case 2:
+            return quantize(7.2f + noise(0.03f), 0.01f);
+        default: {
+            /* Pump runs 2 hours in 6 */
+            bool on = fmod(hours, 6.0) < 2.0;
+            return quantize(on ? 12.5f + noise(0.05f) : 0.0f, 0.01f);
+        }
+    }
+}
+
+static void build_points(void) {
+    int per_sensor = g_opt.days * 86400 / g_opt.interval_s;
+    g_points = calloc((size_t)per_sensor * SENSORS, sizeof(*g_points));
+    g_count = 0;
+    for (int i = 0; i < per_sensor; i++) {
+        double hours = (double)i * g_opt.interval_s / 3600.0;
+        for (int s = 0; s < SENSORS; s++) {
+            uplink_entry_t *p = &g_points[g_count++];
+            p->module_id = s + 1;
+            p->timestamp = (time_t)(BENCH_EPOCH_S + (int64_t)i * g_opt.interval_s);
+            p->value = signal_value(s, hours);
+            /* The pH probe reads bad for half an hour on day 2 */
+            bool bad = s == 2 && hours >= 30.0 && hours < 30.5;
+            SAFE_STRNCPY(p->status, bad ? STATUS_BAD : STATUS_OK, sizeof(p->status));
+            if (bad) p->value = 14.0f;
+        }
+    }
+}
+
+/* ============================================================================
+ * Runs
+ * ========================================================================== */
+
+typedef struct {
+    const char *name;
+    compress_mode_t mode;
+    bool exact;                 /* Deviation 0 for every sensor */
+    int points_out;
+    double worst_error;         /* Fraction of the deviation */
+    int bad_status;
+    int longest_gap_s;
+    uint64_t uplink_bytes;
+} compress_run_t;
+
+static float sensor_dev(const compress_run_t *run, int sensor) {
+    return run->exact ? 0.0f : g_sensors[sensor].dev;
+}
+
+/* Rebuild each original point of one sensor from the kept ones */
+static void check_sensor(compress_run_t *run, int sensor, const uplink_entry_t *kept, int kept_count) {
+    float dev = sensor_dev(run, sensor);
+    int k = 0;
+    for (int i = sensor; i < g_count; i += SENSORS) {
+        const uplink_entry_t *p = &g_points[i];
+        while (k + 1 < kept_count && kept[k + 1].timestamp <= p->timestamp) k++;
+        const uplink_entry_t *a = &kept[k];
+        const uplink_entry_t *b = k + 1 < kept_count ? &kept[k + 1] : a;
+
+        double rebuilt = a->value;
+        const char *status = a->status;
+        if (p->timestamp == b->timestamp) {
+            rebuilt = b->value;
+            status = b->status;
+        } else if (run->mode == COMPRESS_SWINGING_DOOR && b != a) {
+            double f = (double)(p->timestamp - a->timestamp) / (double)(b->timestamp - a->timestamp);
+            rebuilt = a->value + f * ((double)b->value - (double)a->value);
+        }
+
+        double err = fabs(rebuilt - (double)p->value);
+        double limit = (double)dev + 1e-5 * fabs((double)p->value) + 1e-6;
+        if (err > limit) run->worst_error = MAX(run->worst_error, 1e9);
+        else if (dev > 0) run->worst_error = MAX(run->worst_error, err / dev);
+        if (strcmp(status, p->status) != 0) run->bad_status++;
+    }
+
+    for (int k2 = 1; k2 < kept_count; k2++) {
+        run->longest_gap_s = MAX(run->longest_gap_s,
+                                 (int)(kept[k2].timestamp - kept[k2 - 1].timestamp));
+    }
+}
+
+static int run_mode(compress_run_t *run) {
+    compress_config_t cfg = { .mode = run->mode, .dev = 0.0f, .heartbeat_s = g_opt.heartbeat_s };
+    compressor_t *c = malloc(sizeof(*c));
+    uplink_entry_t *kept = malloc((size_t)(g_count + SENSORS) * sizeof(*kept));
+    if (!c || !kept) return -1;
+
+    compressor_init(c, &cfg);
+    for (int s = 0; s < SENSORS; s++) compressor_set_dev(c, s + 1, sensor_dev(run, s));
+
+    int n = 0;
+    for (int i = 0; i < g_count; i++) n += compressor_push(c, &g_points[i], &kept[n]);
+    n += compressor_flush(c, &kept[n], SENSORS);
+    run->points_out = n;
+
+    uplink_buf_t buf = {0};
+    for (int off = 0; off < n; off += UPLINK_BATCH) {
+        if (uplink_encode(UPLINK_FORMAT_BINARY, true, BENCH_DEVICE, &kept[off],
+                          MIN(UPLINK_BATCH, n - off), &buf) == RESULT_OK) {
+            run->uplink_bytes += buf.len;
+        }
+    }
+    uplink_buf_free(&buf);
+
+    /* Kept points come out per sensor in time order */
+    uplink_entry_t *mine = malloc((size_t)(n + 1) * sizeof(*mine));
+    for (int s = 0; s < SENSORS && mine; s++) {
+        int m = 0;
+        for (int i = 0; i < n; i++) {
+            if (kept[i].module_id == s + 1) mine[m++] = kept[i];
+        }
+        check_sensor(run, s, mine, m);
+    }
+
+    free(mine);
+    free(kept);
+    free(c);
+    return 0;
+}
+
+/* ============================================================================
+ * Main
+ * ========================================================================== */
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--days N] [--interval-s N] [--heartbeat-s N] [--min-reduction F]\n",
+            prog);
+}
+
+static int parse_args(int argc, char *argv[]) {
+    static const struct option opts[] = {
+        {"days",          required_argument, NULL, 'd'},
+        {"interval-s",    required_argument, NULL, 'i'},
+        {"heartbeat-s",   required_argument, NULL, 'b'},
+        {"min-reduction", required_argument, NULL, 'r'},
+        {"help",          no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "d:i:b:r:h", opts, NULL)) != -1) {
+        switch (c) {
+            case 'd': g_opt.days = atoi(optarg); break;
+            case 'i': g_opt.interval_s = atoi(optarg); break;
+            case 'b': g_opt.heartbeat_s = atoi(optarg); break;
+            case 'r': g_opt.min_reduction = atof(optarg); break;
+            default: goto bad;
+        }
+    }
+
+    if (g_opt.days < 1 || g_opt.interval_s < 1 || g_opt.heartbeat_s < 0 ||
+        g_opt.min_reduction < 0 || g_opt.min_reduction >= 1) {
+        goto bad;
+    }
+    return 0;
+
+bad:
+    usage(argv[0]);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    if (parse_args(argc, argv) != 0) return 2;
+
+    logger_config_t log_cfg = {0};
+    log_cfg.level = LOG_LEVEL_ERROR;
+    log_cfg.destinations = LOG_DEST_CONSOLE;
+    logger_init(&log_cfg);
+
+    build_points();
+
+    compress_run_t runs[] = {
+        { .name = "off",                .mode = COMPRESS_OFF },
+        { .name = "swinging_door_exact", .mode = COMPRESS_SWINGING_DOOR, .exact = true },
+        { .name = "deadband",           .mode = COMPRESS_DEADBAND },
+        { .name = "swinging_door",      .mode = COMPRESS_SWINGING_DOOR },
+    };
+    int n_runs = (int)(sizeof(runs) / sizeof(runs[0]));
+    int rc = 0;
+
+    printf("{\n");
+    printf("  \"bench\": \"compress\",\n");
+    printf("  \"days\": %d, \"interval_s\": %d, \"heartbeat_s\": %d, \"points\": %d,\n",
+           g_opt.days, g_opt.interval_s, g_opt.heartbeat_s, g_count);
+    printf("  \"devs\": {");
+    for (int s = 0; s < SENSORS; s++) {
+        printf("%s\"%s\": %g", s ? ", " : "", g_sensors[s].name, (double)g_sensors[s].dev);
+    }
+    printf("},\n");
+    printf("  \"runs\": {");
+    for (int i = 0; i < n_runs; i++) {
+        compress_run_t *r = &runs[i];
+        if (run_mode(r) != 0) return 1;
+
+        bool gap_ok = r->mode == COMPRESS_OFF || g_opt.heartbeat_s == 0 ||
+                      r->longest_gap_s <= g_opt.heartbeat_s + g_opt.interval_s;
+        if (r->worst_error > 1.0 || r->bad_status > 0 || !gap_ok) rc = 1;
+
+        double reduction = 1.0 - (double)r->points_out / (double)g_count;
+        if (r->mode == COMPRESS_SWINGING_DOOR && !r->exact && reduction < g_opt.min_reduction) rc = 1;
+
+        printf("%s\n    \"%s\": {\"points_out\": %d, \"reduction\": %.3f, \"worst_error_of_dev\": %.3f, "
+               "\"bad_status\": %d, \"longest_gap_s\": %d, \"uplink_bytes\": %llu}",
+               i ? "," : "", r->name, r->points_out, reduction, MIN(r->worst_error, 999.0),
+               r->bad_status, r->longest_gap_s, (unsigned long long)r->uplink_bytes);
+    }
+    printf("\n  },\n");
+    printf("  \"uplink_reduction\": %.3f\n",
+           runs[0].uplink_bytes ? 1.0 - (double)runs[3].uplink_bytes / (double)runs[0].uplink_bytes : 0.0);
+    printf("}\n");
+
+    free(g_points);
+    logger_shutdown();
+    return rc;
+}
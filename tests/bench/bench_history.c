@@ -0,0 +1,561 @@
+/**
+ * @file bench_history.c
+ * @brief Sensor history storage: row-per-sample log vs compressed blocks
+ *
+ * Replays the same synthetic history into two fresh database files, the
+ * way the data logger writes it: one batch per logging pass, every module
+ * once per pass.
+ *
+ *   rows     db_sensor_log_insert_batch() into sensor_data_log
+ *   blocks   db_history_append() + db_history_flush(), open blocks
+ *            checkpointed every --checkpoint passes
+ *
+ * Modules cycle through four signal shapes: a setpoint that rarely moves,
+ * a slow sine at 0.01 resolution, full-precision noisy ADC readings and
+ * 0.1-resolution noise. Timestamps are whole seconds with occasional
+ * one-second jitter; about 1% of samples are BAD.
+ *
+ * Every sample is read back through db_history_query() and compared bit
+ * for bit, and every rollup bucket of every tier is checked against the
+ * samples it covers; any mismatch fails the run.
+ *
+ * Reported (JSON on stdout):
+ *   bytes_per_sample   database growth / samples, per format
+ *   pages_written      WAL frames appended while writing, per format
+ *   write_ns           wall time per sample for the whole write path
+ *   decode_ns          wall time per sample for db_history_query()
+ *   trend_us           wall time per module for a whole-range trend, from
+ *                      raw samples and from each rollup tier
+ *   retention          expiring the whole history: one DELETE over
+ *                      sensor_data_log vs dropping history partitions
+ *   compressed         blocks holding changed values only, rollups fed
+ *                      every sample: the minute tier must still return
+ *                      one point per logged minute
+ *
+ * Usage: bench_history [--modules N] [--samples N] [--interval S]
+ *                      [--checkpoint N]
+ */
+
+#include "common.h"
+#include "bench_common.h"
+#include "db/database.h"
+#include "db/db_modules.h"
+#include "db/db_history.h"
+#include "db/db_rollup.h"
+#include "utils/logger.h"
+#include <getopt.h>
+#include <math.h>
+#include <unistd.h>
+
+#define BENCH_MAX_MODULES   1024
+#define BENCH_EPOCH_S       1700000000LL
+
+typedef struct {
+    int modules;
+    int samples;
+    int interval_s;
+    int checkpoint;
+} bench_options_t;
+
+static bench_options_t g_opt = {
+    .modules = 64,
+    .samples = 1440,
+    .interval_s = 60,
+    .checkpoint = 5,
+};
+
+typedef struct {
+    int64_t ts_ms;
+    float value;
+    data_quality_t quality;
+} bench_sample_t;
+
+static bench_sample_t *g_expected;      /* [module][sample] */
+static uint32_t g_noise_state = 0x2545F491u;
+
+/* ============================================================================
+ * Synthetic Workload
+ * ========================================================================== */
+
+static float next_noise(void) {
+    g_noise_state ^= g_noise_state << 13;
+    g_noise_state ^= g_noise_state >> 17;
+    g_noise_state ^= g_noise_state << 5;
+    return (float)(g_noise_state & 0xFFFF) / 65535.0f - 0.5f;
+}
+
+static float sample_value(int m, int i) {
+    switch (m % 4) {
+        case 0:  return 7.0f + (float)((i / 500) % 3) * 0.5f;
+        case 1:  return roundf((20.0f + 5.0f * sinf((float)i / 200.0f + (float)m)) * 100.0f) / 100.0f;
+        case 2:  return 50.0f + next_noise() * 4.0f;
+        default: return roundf((7.2f + next_noise() * 0.6f) * 10.0f) / 10.0f;
+    }
+}
+
+static void build_workload(void) {
+    g_expected = calloc((size_t)g_opt.modules * g_opt.samples, sizeof(bench_sample_t));
+    for (int m = 0; m < g_opt.modules; m++) {
+        for (int i = 0; i < g_opt.samples; i++) {
+            bench_sample_t *s = &g_expected[(size_t)m * g_opt.samples + i];
+            int64_t t = BENCH_EPOCH_S + (int64_t)i * g_opt.interval_s;
+            if ((i + m) % 11 == 0) t += 1;      /* Scan landed just past the second */
+            s->ts_ms = t * 1000;
+            s->value = sample_value(m, i);
+            s->quality = ((i * 31 + m) % 100) == 0 ? QUALITY_BAD : QUALITY_GOOD;
+        }
+    }
+}
+
+/* ============================================================================
+ * Database Cost
+ * ========================================================================== */
+
+static int64_t pragma_int(database_t *db, const char *sql, int column) {
+    sqlite3_stmt *stmt;
+    int64_t v = -1;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) v = sqlite3_column_int64(stmt, column);
+        sqlite3_finalize(stmt);
+    }
+    return v;
+}
+
+/* Fold the WAL into the main file and return its size */
+static int64_t db_bytes(database_t *db) {
+    pragma_int(db, "PRAGMA wal_checkpoint(TRUNCATE)", 0);
+    return pragma_int(db, "PRAGMA page_count", 0) * pragma_int(db, "PRAGMA page_size", 0);
+}
+
+/* Frames appended to the WAL since the last TRUNCATE checkpoint */
+static int64_t wal_frames(database_t *db) {
+    return pragma_int(db, "PRAGMA wal_checkpoint(PASSIVE)", 1);
+}
+
+static int open_db(database_t *db, const char *path, int *module_ids) {
+    unlink(path);
+    if (database_init(db, path) != RESULT_OK) return -1;
+    database_execute(db, "PRAGMA wal_autocheckpoint = 0;");
+
+    for (int m = 0; m < g_opt.modules; m++) {
+        db_module_t mod = {0};
+        mod.slot = m + 1;
+        snprintf(mod.name, sizeof(mod.name), "bench_%d", m);
+        SAFE_STRNCPY(mod.module_type, "sensor", sizeof(mod.module_type));
+        if (db_module_create(db, &mod, &module_ids[m]) != RESULT_OK) return -1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * Runs
+ * ========================================================================== */
+
+typedef struct {
+    int64_t bytes;
+    int64_t pages;
+    uint64_t write_ns;
+    uint64_t retention_ns;
+    int64_t retention_pages;
+} bench_cost_t;
+
+static int run_rows(const char *path, bench_cost_t *cost) {
+    database_t db;
+    int ids[BENCH_MAX_MODULES];
+    if (open_db(&db, path, ids) != 0) return -1;
+
+    int64_t base = db_bytes(&db);
+    int *batch_ids = malloc(sizeof(int) * g_opt.modules);
+    float *values = malloc(sizeof(float) * g_opt.modules);
+    const char **statuses = malloc(sizeof(char *) * g_opt.modules);
+
+    uint64_t t0 = bench_now_ns();
+    for (int i = 0; i < g_opt.samples; i++) {
+        for (int m = 0; m < g_opt.modules; m++) {
+            const bench_sample_t *s = &g_expected[(size_t)m * g_opt.samples + i];
+            batch_ids[m] = ids[m];
+            values[m] = s->value;
+            statuses[m] = s->quality == QUALITY_GOOD ? STATUS_OK : STATUS_BAD;
+        }
+        db_sensor_log_insert_batch(&db, batch_ids, values, statuses, g_opt.modules);
+    }
+    cost->write_ns = bench_now_ns() - t0;
+    cost->pages = wal_frames(&db);
+    cost->bytes = db_bytes(&db) - base;
+
+    /* Retention the way it used to run: one statement over every row */
+    t0 = bench_now_ns();
+    database_execute(&db, "DELETE FROM sensor_data_log WHERE timestamp < datetime('now', '+1 day');");
+    cost->retention_ns = bench_now_ns() - t0;
+    cost->retention_pages = wal_frames(&db);
+
+    free(batch_ids);
+    free(values);
+    free(statuses);
+    database_close(&db);
+    return 0;
+}
+
+typedef struct {
+    const bench_sample_t *expected;
+    int index;
+    int mismatches;
+} verify_ctx_t;
+
+static bool verify_cb(void *ctx, int64_t ts_ms, float value, data_quality_t quality) {
+    verify_ctx_t *v = ctx;
+    if (v->index >= g_opt.samples) {
+        v->mismatches++;
+        return false;
+    }
+    const bench_sample_t *s = &v->expected[v->index++];
+    if (s->ts_ms != ts_ms || quality != s->quality ||
+        memcmp(&s->value, &value, sizeof(value)) != 0) {
+        v->mismatches++;
+    }
+    return true;
+}
+
+static int run_blocks(const char *path, int *ids, bench_cost_t *cost, uint64_t *decode_ns,
+                      db_history_stats_t *stats) {
+    database_t db;
+    if (open_db(&db, path, ids) != 0) return -1;
+
+    int64_t base = db_bytes(&db);
+    db_history_writer_t writer;
+    db_history_writer_init(&writer);
+
+    uint64_t t0 = bench_now_ns();
+    for (int i = 0; i < g_opt.samples; i++) {
+        for (int m = 0; m < g_opt.modules; m++) {
+            const bench_sample_t *s = &g_expected[(size_t)m * g_opt.samples + i];
+            db_history_append(&writer, ids[m], s->ts_ms, s->value, s->quality);
+        }
+        db_history_flush(&db, &writer, (i + 1) % g_opt.checkpoint == 0);
+    }
+    db_history_flush(&db, &writer, true);
+    cost->write_ns = bench_now_ns() - t0;
+    cost->pages = wal_frames(&db);
+    cost->bytes = db_bytes(&db) - base;
+    *stats = writer.stats;
+    db_history_writer_free(&writer);
+
+    int mismatches = 0;
+    t0 = bench_now_ns();
+    for (int m = 0; m < g_opt.modules; m++) {
+        verify_ctx_t v = { .expected = &g_expected[(size_t)m * g_opt.samples] };
+        db_history_query(&db, ids[m], 0, INT64_MAX, verify_cb, &v);
+        if (v.index != g_opt.samples) v.mismatches += abs(g_opt.samples - v.index);
+        mismatches += v.mismatches;
+    }
+    *decode_ns = bench_now_ns() - t0;
+
+    database_close(&db);
+    return mismatches;
+}
+
+/* ============================================================================
+ * Rollups
+ * ========================================================================== */
+
+typedef struct {
+    const bench_sample_t *expected;
+    int points;
+    int mismatches;
+} rollup_ctx_t;
+
+/* Recompute one bucket from the workload and compare */
+static bool rollup_cb(void *ctx, const db_rollup_point_t *p) {
+    rollup_ctx_t *r = ctx;
+    uint32_t count = 0;
+    float min = 0, max = 0, first = 0, last = 0;
+    double sum = 0.0;
+
+    int lo = 0, hi = g_opt.samples;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (r->expected[mid].ts_ms < p->bucket_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    for (int i = lo; i < g_opt.samples; i++) {
+        const bench_sample_t *s = &r->expected[i];
+        if (s->ts_ms >= p->bucket_ms + p->width_ms) break;
+        if (s->quality != QUALITY_GOOD) continue;
+        if (count == 0) {
+            min = max = first = s->value;
+        } else {
+            min = MIN(min, s->value);
+            max = MAX(max, s->value);
+        }
+        last = s->value;
+        sum += s->value;
+        count++;
+    }
+
+    float avg = count ? (float)(sum / count) : 0.0f;
+    if (p->count != count || p->min != min || p->max != max || p->first != first ||
+        p->last != last || fabsf(p->avg - avg) > 1e-4f * MAX(1.0f, fabsf(avg))) {
+        r->mismatches++;
+    }
+    r->points++;
+    return true;
+}
+
+/* Aggregate raw samples into hourly points the way a trend view would */
+typedef struct {
+    int64_t bucket_ms;
+    uint32_t count;
+    int points;
+} raw_trend_ctx_t;
+
+static bool raw_trend_cb(void *ctx, const db_rollup_point_t *p) {
+    raw_trend_ctx_t *t = ctx;
+    int64_t bucket = p->bucket_ms - p->bucket_ms % db_rollup_tier_width_ms(DB_ROLLUP_HOUR);
+    if (t->count == 0 || bucket != t->bucket_ms) {
+        t->bucket_ms = bucket;
+        t->points++;
+    }
+    t->count++;
+    return true;
+}
+
+static bool verify_cb_count(void *ctx, int64_t ts_ms, float value, data_quality_t quality) {
+    (*(int *)ctx)++;
+    return true;
+}
+
+static bool count_cb(void *ctx, const db_rollup_point_t *p) {
+    (*(int *)ctx)++;
+    return true;
+}
+
+static int run_rollups(const char *path, const int *ids, uint64_t *trend_ns, bench_cost_t *cost) {
+    database_t db;
+    if (database_init(&db, path) != RESULT_OK) return 1;
+
+    /* Hourly trend from raw samples, then from each tier's own resolution */
+    uint64_t t0 = bench_now_ns();
+    for (int m = 0; m < g_opt.modules; m++) {
+        raw_trend_ctx_t t = {0};
+        db_rollup_query(&db, ids[m], 0, INT64_MAX, 0, raw_trend_cb, &t);
+    }
+    trend_ns[0] = bench_now_ns() - t0;
+
+    for (int tier = 0; tier < DB_ROLLUP_TIERS; tier++) {
+        t0 = bench_now_ns();
+        for (int m = 0; m < g_opt.modules; m++) {
+            int points = 0;
+            db_rollup_query(&db, ids[m], 0, INT64_MAX, db_rollup_tier_width_ms(tier),
+                            count_cb, &points);
+        }
+        trend_ns[tier + 1] = bench_now_ns() - t0;
+    }
+
+    int mismatches = 0;
+    for (int tier = 0; tier < DB_ROLLUP_TIERS; tier++) {
+        for (int m = 0; m < g_opt.modules; m++) {
+            rollup_ctx_t r = { .expected = &g_expected[(size_t)m * g_opt.samples] };
+            db_rollup_query(&db, ids[m], 0, INT64_MAX, db_rollup_tier_width_ms(tier),
+                            rollup_cb, &r);
+            if (r.points == 0) r.mismatches++;
+            mismatches += r.mismatches;
+        }
+    }
+
+    /* The workload lies years in the past, so every partition expires */
+    db_bytes(&db);
+    uint64_t t1 = bench_now_ns();
+    db_history_cleanup(&db, 1);
+    cost->retention_ns = bench_now_ns() - t1;
+    cost->retention_pages = wal_frames(&db);
+
+    int left = 0;
+    db_history_query(&db, ids[0], 0, INT64_MAX, verify_cb_count, &left);
+    if (left != 0) mismatches++;
+
+    database_close(&db);
+    return mismatches;
+}
+
+/*
+ * The data logger feeds the rollups every sample but stores only what the
+ * compressor archives. Stand in for it with deadband 0 (changed values
+ * only): the minute tier must still hold one bucket per logged minute.
+ */
+static int run_compressed(const char *path, int *stored, int *minutes, int *minute_rows) {
+    database_t db;
+    int ids[BENCH_MAX_MODULES];
+    if (open_db(&db, path, ids) != 0) return 1;
+
+    db_history_writer_t writer;
+    db_history_writer_init(&writer);
+    writer.rollups.store_single = true;
+
+    for (int i = 0; i < g_opt.samples; i++) {
+        for (int m = 0; m < g_opt.modules; m++) {
+            const bench_sample_t *s = &g_expected[(size_t)m * g_opt.samples + i];
+            const bench_sample_t *prev = i > 0 ? s - 1 : NULL;
+            db_history_observe(&writer, ids[m], s->ts_ms, s->value, s->quality);
+            if (!prev || prev->value != s->value || prev->quality != s->quality) {
+                db_history_store(&writer, ids[m], s->ts_ms, s->value, s->quality);
+                (*stored)++;
+            }
+        }
+        db_history_flush(&db, &writer, (i + 1) % g_opt.checkpoint == 0);
+    }
+    db_history_flush(&db, &writer, true);
+    db_history_writer_free(&writer);
+
+    int mismatches = 0;
+    int64_t width = db_rollup_tier_width_ms(DB_ROLLUP_MINUTE);
+    for (int m = 0; m < g_opt.modules; m++) {
+        const bench_sample_t *expected = &g_expected[(size_t)m * g_opt.samples];
+        int64_t last = INT64_MIN;
+        for (int i = 0; i < g_opt.samples; i++) {
+            int64_t bucket = expected[i].ts_ms - expected[i].ts_ms % width;
+            if (expected[i].quality != QUALITY_GOOD || bucket == last) continue;
+            last = bucket;
+            (*minutes)++;
+        }
+
+        rollup_ctx_t r = { .expected = expected };
+        db_rollup_query(&db, ids[m], 0, INT64_MAX, width, rollup_cb, &r);
+        *minute_rows += r.points;
+        mismatches += r.mismatches;
+    }
+    if (*minute_rows != *minutes) mismatches++;
+
+    database_close(&db);
+    return mismatches;
+}
+
+/* ============================================================================
+ * Main
+ * ========================================================================== */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--modules N] [--samples N] [--interval S] [--checkpoint N]\n", prog);
+}
+
+static int parse_args(int argc, char *argv[]) {
+    static const struct option opts[] = {
+        {"modules",    required_argument, NULL, 'm'},
+        {"samples",    required_argument, NULL, 's'},
+        {"interval",   required_argument, NULL, 'i'},
+        {"checkpoint", required_argument, NULL, 'c'},
+        {"help",       no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "m:s:i:c:h", opts, NULL)) != -1) {
+        switch (c) {
+            case 'm': g_opt.modules = atoi(optarg); break;
+            case 's': g_opt.samples = atoi(optarg); break;
+            case 'i': g_opt.interval_s = atoi(optarg); break;
+            case 'c': g_opt.checkpoint = atoi(optarg); break;
+            default: goto bad;
+        }
+    }
+
+    if (g_opt.modules < 1 || g_opt.modules > BENCH_MAX_MODULES || g_opt.samples < 1 ||
+        g_opt.interval_s < 1 || g_opt.checkpoint < 1) {
+        goto bad;
+    }
+    return 0;
+
+bad:
+    usage(argv[0]);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    if (parse_args(argc, argv) != 0) return 2;
+
+    logger_config_t log_cfg = {0};
+    log_cfg.level = LOG_LEVEL_ERROR;
+    log_cfg.destinations = LOG_DEST_CONSOLE;
+    logger_init(&log_cfg);
+
+    char dir[] = "/tmp/bench_history.XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char rows_path[64], blocks_path[64], compressed_path[64];
+    snprintf(rows_path, sizeof(rows_path), "%s/rows.db", dir);
+    snprintf(blocks_path, sizeof(blocks_path), "%s/blocks.db", dir);
+    snprintf(compressed_path, sizeof(compressed_path), "%s/compressed.db", dir);
+
+    build_workload();
+    uint64_t total = (uint64_t)g_opt.modules * g_opt.samples;
+
+    bench_cost_t rows = {0}, blocks = {0};
+    uint64_t decode_ns = 0;
+    db_history_stats_t stats = {0};
+    int rc = 0;
+
+    if (run_rows(rows_path, &rows) != 0) rc = 1;
+    int ids[BENCH_MAX_MODULES];
+    int mismatches = run_blocks(blocks_path, ids, &blocks, &decode_ns, &stats);
+    if (mismatches != 0) rc = 1;
+
+    uint64_t trend_ns[DB_ROLLUP_TIERS + 1] = {0};
+    int rollup_mismatches = mismatches < 0 ? 1 : run_rollups(blocks_path, ids, trend_ns, &blocks);
+    if (rollup_mismatches != 0) rc = 1;
+
+    int stored = 0, minutes = 0, minute_rows = 0;
+    int compressed_mismatches = run_compressed(compressed_path, &stored, &minutes, &minute_rows);
+    if (compressed_mismatches != 0) rc = 1;
+
+    printf("{\n");
+    printf("  \"bench\": \"history\",\n");
+    printf("  \"modules\": %d, \"samples_per_module\": %d, \"interval_s\": %d, "
+           "\"checkpoint_passes\": %d,\n",
+           g_opt.modules, g_opt.samples, g_opt.interval_s, g_opt.checkpoint);
+    printf("  \"rows\": {\"bytes_per_sample\": %.2f, \"pages_written\": %lld, "
+           "\"write_ns\": %.0f},\n",
+           (double)rows.bytes / (double)total, (long long)rows.pages,
+           (double)rows.write_ns / (double)total);
+    printf("  \"blocks\": {\"bytes_per_sample\": %.2f, \"pages_written\": %lld, "
+           "\"write_ns\": %.0f, \"decode_ns\": %.0f, \"blocks\": %llu, \"checkpoints\": %llu},\n",
+           (double)blocks.bytes / (double)total, (long long)blocks.pages,
+           (double)blocks.write_ns / (double)total, (double)decode_ns / (double)total,
+           (unsigned long long)stats.blocks_written, (unsigned long long)stats.checkpoints);
+    double per_module_us = 1000.0 * g_opt.modules;
+    printf("  \"rollups\": {\"buckets\": %llu, \"trend_us\": {\"raw\": %.0f, \"minute\": %.0f, "
+           "\"hour\": %.0f, \"day\": %.0f}, \"mismatches\": %d},\n",
+           (unsigned long long)stats.rollup_buckets,
+           (double)trend_ns[0] / per_module_us, (double)trend_ns[1] / per_module_us,
+           (double)trend_ns[2] / per_module_us, (double)trend_ns[3] / per_module_us,
+           rollup_mismatches);
+    printf("  \"compressed\": {\"stored_fraction\": %.3f, \"minutes\": %d, \"minute_points\": %d, "
+           "\"mismatches\": %d},\n",
+           (double)stored / (double)total, minutes, minute_rows, compressed_mismatches);
+    printf("  \"retention\": {\"rows_ms\": %.1f, \"rows_pages\": %lld, "
+           "\"partitions_ms\": %.1f, \"partitions_pages\": %lld},\n",
+           (double)rows.retention_ns / 1e6, (long long)rows.retention_pages,
+           (double)blocks.retention_ns / 1e6, (long long)blocks.retention_pages);
+    printf("  \"storage_reduction\": %.1f, \"page_write_reduction\": %.1f,\n",
+           blocks.bytes > 0 ? (double)rows.bytes / (double)blocks.bytes : 0.0,
+           blocks.pages > 0 ? (double)rows.pages / (double)blocks.pages : 0.0);
+    printf("  \"mismatches\": %d\n", mismatches);
+    printf("}\n");
+
+    unlink(rows_path);
+    unlink(blocks_path);
+    unlink(compressed_path);
+    char side[80];
+    snprintf(side, sizeof(side), "%s-wal", rows_path);    unlink(side);
+    snprintf(side, sizeof(side), "%s-shm", rows_path);    unlink(side);
+    snprintf(side, sizeof(side), "%s-wal", blocks_path);  unlink(side);
+    snprintf(side, sizeof(side), "%s-shm", blocks_path);  unlink(side);
+    snprintf(side, sizeof(side), "%s-wal", compressed_path);  unlink(side);
+    snprintf(side, sizeof(side), "%s-shm", compressed_path);  unlink(side);
+    rmdir(dir);
+
+    free(g_expected);
+    logger_shutdown();
+    return rc;
+}
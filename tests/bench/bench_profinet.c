@@ -0,0 +1,419 @@
+/**
+ * @file bench_profinet.c
+ * @brief End-to-end PROFINET cycle bench against an in-process controller
+ *
+ * Runs the real profinet_manager / profinet_callbacks code (built with
+ * HAVE_PNET against tests/bench/mock_pnet) and plays the PLC from a
+ * separate thread:
+ *
+ *   sensor thread  -> profinet_manager_update_input_with_quality()
+ *   PLC thread     -> writes outputs / reads inputs every --cycle-us
+ *   engineering    -> acyclic diagnostic record reads, back to back
+ *   alarm storm    -> every sensor raises a diagnosis alarm at --alarm-hz
+ *   dispatch cb    -> stands in for the actuator GPIO write
+ *
+ * Reported (JSON on stdout):
+ *   device_tick_us      interval between pnet_handle_periodic() calls
+ *   controller_jitter_us PLC wake-up lateness vs. its absolute schedule
+ *   input_staleness_us  sensor write -> first seen by the PLC
+ *   output_latency_us   PLC write -> on_data callback ("GPIO") done
+ *   record_read_us      diagnostic record request -> response
+ *   alarms              requested / sent / suppressed / aggregated, and
+ *                       how many the controller actually received
+ *
+ * Usage: bench_profinet [--cycle-us N] [--duration S] [--sensors N]
+ *                       [--sensor-period-us N] [--gpio-delay-us N]
+ *                       [--alarm-hz N]
+ */
+
+#include "common.h"
+#include "bench_common.h"
+#include "mock_pnet.h"
+#include "profinet/profinet_manager.h"
+#include "profinet/profinet_callbacks.h"
+#include "db/database.h"
+#include "utils/logger.h"
+#include "config_defaults.h"
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define BENCH_SEQ_WINDOW        4096    /* Power of two */
+#define BENCH_MAX_SENSORS       48
+#define BENCH_SAMPLE_CAP        (1u << 20)
+#define BENCH_OUTPUT_SUBSLOT    1
+#define BENCH_SENSOR_SUBSLOT    0
+
+typedef struct {
+    int cycle_us;
+    int duration_s;
+    int sensors;
+    int sensor_period_us;
+    int gpio_delay_us;
+    int alarm_hz;
+} bench_options_t;
+
+static bench_options_t g_opt = {
+    .cycle_us = 1000,
+    .duration_s = 5,
+    .sensors = 16,
+    .sensor_period_us = 10000,
+    .gpio_delay_us = 0,
+    .alarm_hz = 20,
+};
+
+static atomic_bool g_running;
+static int g_output_slot;
+
+/* Write timestamps indexed by sequence number (value carried in the data) */
+static uint64_t g_input_write_us[BENCH_MAX_SENSORS][BENCH_SEQ_WINDOW];
+static uint64_t g_output_write_us[BENCH_SEQ_WINDOW];
+
+static bench_samples_t g_controller_jitter;
+static bench_samples_t g_input_staleness;
+static bench_samples_t g_output_latency;
+static bench_samples_t g_record_read;
+static uint64_t g_controller_cycles;
+static uint64_t g_record_errors;
+
+/* ============================================================================
+ * Device Side
+ * ========================================================================== */
+
+static void* sensor_thread(void *arg) {
+    UNUSED(arg);
+    uint32_t seq = 0;
+    profinet_sensor_diag_t diag = {0};
+
+    while (atomic_load(&g_running)) {
+        seq++;
+        for (int i = 0; i < g_opt.sensors; i++) {
+            g_input_write_us[i][seq & (BENCH_SEQ_WINDOW - 1)] = bench_now_us();
+            profinet_manager_update_input_with_quality(i + 1, BENCH_SENSOR_SUBSLOT,
+                                                       (float)seq, QUALITY_GOOD);
+            profinet_manager_set_input_iops(NULL, i + 1, BENCH_SENSOR_SUBSLOT,
+                                            PNET_IOXS_GOOD);
+
+            /* What the sensor worker publishes after each read */
+            diag.value = (float)seq;
+            diag.total_reads = seq;
+            diag.last_read_ms = get_time_ms();
+            diag.stat_count = seq;
+            profinet_manager_publish_diag(i + 1, &diag);
+        }
+        usleep((useconds_t)g_opt.sensor_period_us);
+    }
+    return NULL;
+}
+
+/* Flapping sensors / bus dropout: all channels alarm at once, repeatedly */
+static void* alarm_thread(void *arg) {
+    UNUSED(arg);
+    if (g_opt.alarm_hz <= 0) return NULL;
+
+    while (atomic_load(&g_running)) {
+        for (int i = 0; i < g_opt.sensors; i++) {
+            uint8_t code = (uint8_t)QUALITY_BAD;
+            profinet_manager_send_alarm(i + 1, BENCH_SENSOR_SUBSLOT, 0x0001, &code, 1);
+        }
+        usleep((useconds_t)(1000000 / g_opt.alarm_hz));
+    }
+    return NULL;
+}
+
+/* on_data callback - where actuator_manager would drive the relay */
+static void output_applied(int slot, int subslot, const uint8_t *data, size_t len, void *ctx) {
+    UNUSED(slot); UNUSED(subslot); UNUSED(ctx);
+    if (len < 4) return;
+
+    if (g_opt.gpio_delay_us > 0) {
+        uint64_t until = bench_now_us() + (uint64_t)g_opt.gpio_delay_us;
+        while (bench_now_us() < until) {
+        }
+    }
+
+    uint32_t be;
+    memcpy(&be, data, sizeof(be));
+    uint32_t seq = ntohl(be);
+    uint64_t written = g_output_write_us[seq & (BENCH_SEQ_WINDOW - 1)];
+    if (written) {
+        bench_samples_add(&g_output_latency, bench_now_us() - written);
+    }
+}
+
+/* ============================================================================
+ * Controller Side
+ * ========================================================================== */
+
+/* Engineering tool: diagnostic record reads while cyclic traffic runs */
+static void* record_thread(void *arg) {
+    UNUSED(arg);
+    uint8_t buf[64];
+    int sensor = 0;
+
+    while (atomic_load(&g_running)) {
+        if (!mock_pnet_is_connected()) {
+            usleep(1000);
+            continue;
+        }
+
+        uint16_t len = sizeof(buf);
+        uint64_t start = bench_now_us();
+        int ret = mock_pnet_controller_read_record((uint16_t)(sensor + 1), BENCH_SENSOR_SUBSLOT,
+                                                   PROFINET_RECORD_SENSOR_STATUS, buf, &len);
+        uint64_t elapsed = bench_now_us() - start;
+
+        /* Block header (6) + sensor slot (2) */
+        if (ret == 0 && len >= 8 && ((buf[6] << 8) | buf[7]) == sensor + 1) {
+            bench_samples_add(&g_record_read, elapsed);
+        } else {
+            g_record_errors++;
+        }
+
+        sensor = (sensor + 1) % g_opt.sensors;
+        usleep(1000);
+    }
+    return NULL;
+}
+
+static void timespec_add_us(struct timespec *ts, long us) {
+    ts->tv_nsec += us * 1000L;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+static void* controller_thread(void *arg) {
+    UNUSED(arg);
+    uint32_t out_seq = 0;
+    uint32_t last_seen[BENCH_MAX_SENSORS] = {0};
+
+    mock_pnet_controller_connect();
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (atomic_load(&g_running)) {
+        timespec_add_us(&next, g_opt.cycle_us);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        uint64_t now = bench_now_us();
+        uint64_t due = (uint64_t)next.tv_sec * 1000000ULL + (uint64_t)next.tv_nsec / 1000;
+        bench_samples_add(&g_controller_jitter, now > due ? now - due : 0);
+
+        if (!mock_pnet_is_connected()) continue;
+        g_controller_cycles++;
+
+        /* Outputs: a fresh command every cycle */
+        out_seq++;
+        uint32_t be = htonl(out_seq);
+        g_output_write_us[out_seq & (BENCH_SEQ_WINDOW - 1)] = bench_now_us();
+        mock_pnet_controller_write_output((uint16_t)g_output_slot, BENCH_OUTPUT_SUBSLOT,
+                                          (const uint8_t *)&be, sizeof(be));
+
+        /* Inputs: record latency of each newly visible sample */
+        for (int i = 0; i < g_opt.sensors; i++) {
+            uint8_t data[8];
+            uint16_t len = sizeof(data);
+            uint8_t iops = 0;
+            if (mock_pnet_controller_read_input((uint16_t)(i + 1), BENCH_SENSOR_SUBSLOT,
+                                                data, &len, &iops, NULL) != 0 || len < 4) {
+                continue;
+            }
+
+            uint32_t raw;
+            float value;
+            memcpy(&raw, data, sizeof(raw));
+            raw = ntohl(raw);
+            memcpy(&value, &raw, sizeof(value));
+
+            uint32_t seq = (uint32_t)value;
+            if (seq != 0 && seq != last_seen[i]) {
+                last_seen[i] = seq;
+                uint64_t written = g_input_write_us[i][seq & (BENCH_SEQ_WINDOW - 1)];
+                uint64_t seen = bench_now_us();
+                if (written && seen >= written) {
+                    bench_samples_add(&g_input_staleness, seen - written);
+                }
+            }
+        }
+    }
+
+    mock_pnet_controller_disconnect();
+    return NULL;
+}
+
+/* ============================================================================
+ * Main
+ * ========================================================================== */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--cycle-us N] [--duration S] [--sensors N]\n"
+            "          [--sensor-period-us N] [--gpio-delay-us N] [--alarm-hz N]\n", prog);
+}
+
+static int parse_args(int argc, char *argv[]) {
+    static const struct option opts[] = {
+        {"cycle-us",         required_argument, NULL, 'c'},
+        {"duration",         required_argument, NULL, 'd'},
+        {"sensors",          required_argument, NULL, 's'},
+        {"sensor-period-us", required_argument, NULL, 'p'},
+        {"gpio-delay-us",    required_argument, NULL, 'g'},
+        {"alarm-hz",         required_argument, NULL, 'a'},
+        {"help",             no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "c:d:s:p:g:a:h", opts, NULL)) != -1) {
+        switch (c) {
+            case 'c': g_opt.cycle_us = atoi(optarg); break;
+            case 'd': g_opt.duration_s = atoi(optarg); break;
+            case 's': g_opt.sensors = atoi(optarg); break;
+            case 'p': g_opt.sensor_period_us = atoi(optarg); break;
+            case 'g': g_opt.gpio_delay_us = atoi(optarg); break;
+            case 'a': g_opt.alarm_hz = atoi(optarg); break;
+            default: usage(argv[0]); return -1;
+        }
+    }
+
+    if (g_opt.cycle_us < 100 || g_opt.duration_s < 1 ||
+        g_opt.sensors < 1 || g_opt.sensors > BENCH_MAX_SENSORS ||
+        g_opt.sensor_period_us < 100 || g_opt.gpio_delay_us < 0) {
+        usage(argv[0]);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (parse_args(argc, argv) != 0) return 2;
+
+    logger_config_t log_cfg = {0};
+    log_cfg.level = LOG_LEVEL_WARNING;
+    log_cfg.destinations = LOG_DEST_CONSOLE;
+    logger_init(&log_cfg);
+
+    database_t db;
+    if (database_init(&db, ":memory:") != RESULT_OK) {
+        fprintf(stderr, "database_init failed\n");
+        return 1;
+    }
+
+    profinet_config_t pn_cfg = {0};
+    SAFE_STRNCPY(pn_cfg.station_name, "bench-rtu", sizeof(pn_cfg.station_name));
+    SAFE_STRNCPY(pn_cfg.product_name, "Water Treatment RTU", sizeof(pn_cfg.product_name));
+    pn_cfg.vendor_id = 0x0493;
+    pn_cfg.device_id = 0x0001;
+    pn_cfg.min_device_interval = 32;
+    pn_cfg.enabled = true;
+    pn_cfg.alarm_window_ms = WT_PROFINET_ALARM_WINDOW_MS;
+    pn_cfg.alarm_rate = WT_PROFINET_ALARM_RATE;
+    pn_cfg.alarm_burst = WT_PROFINET_ALARM_BURST;
+    pn_cfg.alarm_aggregate = WT_PROFINET_ALARM_AGGREGATE;
+
+    if (profinet_manager_init(&db, &pn_cfg) != RESULT_OK) {
+        fprintf(stderr, "profinet_manager_init failed\n");
+        return 1;
+    }
+
+    /* Same module layout sensor_manager / actuator_manager register */
+    for (int i = 0; i < g_opt.sensors; i++) {
+        profinet_manager_add_module(NULL, i + 1, 0x00000001, BENCH_SENSOR_SUBSLOT,
+                                    0x00000001, 5, 0);
+    }
+    g_output_slot = g_opt.sensors + 1;
+    profinet_manager_add_module(NULL, g_output_slot, 0x00000002, BENCH_OUTPUT_SUBSLOT,
+                                0x00000002, 0, 4);
+
+    profinet_manager_set_callbacks(NULL, NULL, output_applied, NULL);
+
+    if (bench_samples_init(&g_controller_jitter, BENCH_SAMPLE_CAP) != 0 ||
+        bench_samples_init(&g_input_staleness, BENCH_SAMPLE_CAP) != 0 ||
+        bench_samples_init(&g_output_latency, BENCH_SAMPLE_CAP) != 0 ||
+        bench_samples_init(&g_record_read, BENCH_SAMPLE_CAP) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (profinet_manager_start("bench0") != RESULT_OK) {
+        fprintf(stderr, "profinet_manager_start failed\n");
+        return 1;
+    }
+
+    atomic_store(&g_running, true);
+    pthread_t sensor_tid, controller_tid, record_tid, alarm_tid;
+    pthread_create(&sensor_tid, NULL, sensor_thread, NULL);
+    pthread_create(&controller_tid, NULL, controller_thread, NULL);
+    pthread_create(&record_tid, NULL, record_thread, NULL);
+    pthread_create(&alarm_tid, NULL, alarm_thread, NULL);
+
+    sleep((unsigned int)g_opt.duration_s);
+
+    atomic_store(&g_running, false);
+    pthread_join(alarm_tid, NULL);
+    pthread_join(record_tid, NULL);
+    pthread_join(controller_tid, NULL);
+    pthread_join(sensor_tid, NULL);
+
+    profinet_stats_t stats = {0};
+    profinet_manager_get_stats(&stats);
+
+    /* Stop joins the dispatch thread, so g_output_latency is final after this */
+    profinet_manager_stop();
+    profinet_manager_shutdown();
+
+    bench_samples_t device_tick;
+    bench_samples_init(&device_tick, BENCH_SAMPLE_CAP);
+    device_tick.n = mock_pnet_tick_intervals(device_tick.v, device_tick.cap);
+
+    printf("{\n");
+    printf("  \"bench\": \"profinet\",\n");
+    printf("  \"cycle_us\": %d, \"duration_s\": %d, \"sensors\": %d, "
+           "\"sensor_period_us\": %d, \"gpio_delay_us\": %d,\n",
+           g_opt.cycle_us, g_opt.duration_s, g_opt.sensors,
+           g_opt.sensor_period_us, g_opt.gpio_delay_us);
+    printf("  \"controller_cycles\": %llu,\n", (unsigned long long)g_controller_cycles);
+    bench_print_samples(stdout, "device_tick", &device_tick, "us", 1);
+    bench_print_samples(stdout, "controller_jitter", &g_controller_jitter, "us", 1);
+    bench_print_samples(stdout, "input_staleness", &g_input_staleness, "us", 1);
+    bench_print_samples(stdout, "output_latency", &g_output_latency, "us", 1);
+    bench_print_samples(stdout, "record_read", &g_record_read, "us", 1);
+    printf("  \"record_errors\": %llu,\n", (unsigned long long)g_record_errors);
+    printf("  \"alarms\": {\"hz\": %d, \"requested\": %llu, \"sent\": %llu, "
+           "\"suppressed\": %llu, \"aggregated\": %llu, \"deferred\": %llu, "
+           "\"dropped\": %llu, \"controller_received\": %u},\n",
+           g_opt.alarm_hz,
+           (unsigned long long)stats.alarms_requested,
+           (unsigned long long)stats.alarms_sent,
+           (unsigned long long)stats.alarms_suppressed,
+           (unsigned long long)stats.alarms_aggregated,
+           (unsigned long long)stats.alarms_deferred,
+           (unsigned long long)stats.alarms_dropped,
+           mock_pnet_alarm_count());
+    printf("  \"stats\": {\"input_updates\": %llu, \"input_publishes\": %llu, "
+           "\"output_commands\": %llu, \"output_coalesced\": %llu, "
+           "\"output_dropped\": %llu, \"output_applied\": %llu}\n",
+           (unsigned long long)stats.input_updates,
+           (unsigned long long)stats.input_publishes,
+           (unsigned long long)stats.output_commands,
+           (unsigned long long)stats.output_coalesced,
+           (unsigned long long)stats.output_dropped,
+           (unsigned long long)stats.output_applied);
+    printf("}\n");
+
+    int rc = (g_input_staleness.n > 0 && g_output_latency.n > 0 && g_record_read.n > 0) ? 0 : 1;
+
+    bench_samples_free(&device_tick);
+    bench_samples_free(&g_controller_jitter);
+    bench_samples_free(&g_input_staleness);
+    bench_samples_free(&g_output_latency);
+    bench_samples_free(&g_record_read);
+    database_close(&db);
+    logger_shutdown();
+    return rc;
+}
@@ -0,0 +1,452 @@
+/**
+ * @file bench_spool.c
+ * @brief Store-and-forward spool: throughput and crash recovery
+ *
+ * Appends --records numbered records to a fresh spool and drains them in
+ * batches through spool_peek() / spool_commit(), then runs recovery
+ * scenarios against spools left on disk the way a crash or an outage
+ * leaves them:
+ *
+ *   torn_tail       The newest record is half written (the tail of its
+ *                   payload never reached the mapping) after part of the
+ *                   backlog was committed. Reopening must count one
+ *                   corrupt record, resume at the committed cursor, and
+ *                   append over the torn bytes.
+ *   torn_sealed     A record in the middle of a sealed segment fails its
+ *                   CRC. The rest of that segment is skipped, counted as
+ *                   corrupt once the commit passes it.
+ *   size_cap        An undrained backlog is pushed past max_bytes: the
+ *                   oldest segments are dropped and counted, and what is
+ *                   left is delivered in order up to the newest record.
+ *   expired         Records older than max_age_seconds are skipped and
+ *                   counted on commit; the cursor survives a reopen.
+ *
+ * Records carry their sequence number, so every delivery is checked for
+ * order and gaps. Any failed check fails the run.
+ *
+ * Reported (JSON on stdout): append and drain ns per record, and per
+ * scenario the counters from spool_get_stats() and pass/fail.
+ *
+ * Usage: bench_spool [--records N] [--payload BYTES]
+ */
+
+#include "common.h"
+#include "bench_common.h"
+#include "logging/spool.h"
+#include "utils/logger.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#define BENCH_BATCH         100
+#define BENCH_SEGMENT       (64 * 1024)
+#define SMALL_SEGMENT       4096
+#define SEGMENT_HEADER      32      /* sizeof(segment_header_t) in spool.c */
+#define RECORD_HEADER       16      /* sizeof(record_header_t) in spool.c */
+#define RECORD_ALIGN        8
+
+typedef struct {
+    int records;
+    int payload;
+} bench_options_t;
+
+static bench_options_t g_opt = {
+    .records = 100000,
+    .payload = 64,
+};
+
+static char g_dir[] = "/tmp/bench_spool.XXXXXX";
+static int g_failures;
+
+#define CHECK(cond) do {                                                    \
+    if (!(cond)) {                                                          \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __func__, __LINE__, #cond); \
+        g_failures++;                                                       \
+        ok = false;                                                         \
+    }                                                                       \
+} while (0)
+
+/* ============================================================================
+ * Helpers
+ * ========================================================================== */
+
+static uint32_t record_bytes(void) {
+    return (RECORD_HEADER + (uint32_t)g_opt.payload + RECORD_ALIGN - 1) &
+           ~(uint32_t)(RECORD_ALIGN - 1);
+}
+
+static void make_payload(uint8_t *buf, uint32_t seq) {
+    memset(buf, (int)(seq & 0xFF), (size_t)g_opt.payload);
+    memcpy(buf, &seq, sizeof(seq));
+}
+
+static uint32_t payload_seq(const spool_record_t *rec) {
+    uint32_t seq;
+    memcpy(&seq, rec->data, sizeof(seq));
+    return seq;
+}
+
+static void scenario_config(spool_config_t *cfg, const char *name, uint32_t segment_bytes) {
+    memset(cfg, 0, sizeof(*cfg));
+    snprintf(cfg->dir, sizeof(cfg->dir), "%s/%s", g_dir, name);
+    cfg->segment_bytes = segment_bytes;
+    cfg->max_bytes = 64ULL * 1024 * 1024;
+}
+
+static void segment_file(const spool_config_t *cfg, uint64_t seq, char *buf, size_t size) {
+    snprintf(buf, size, "%s/%016llx.seg", cfg->dir, (unsigned long long)seq);
+}
+
+static void remove_dir(const char *path) {
+    DIR *dir = opendir(path);
+    if (!dir) return;
+    struct dirent *de;
+    char file[MAX_PATH_LEN + 64];
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_name[0] == '.') continue;
+        snprintf(file, sizeof(file), "%s/%s", path, de->d_name);
+        unlink(file);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+static result_t append_range(spool_t *spool, uint32_t from, uint32_t to, time_t timestamp) {
+    uint8_t buf[4096];
+    for (uint32_t seq = from; seq < to; seq++) {
+        make_payload(buf, seq);
+        result_t r = spool_append(spool, buf, (uint32_t)g_opt.payload, timestamp);
+        if (r != RESULT_OK) return r;
+    }
+    return spool_sync(spool);
+}
+
+/*
+ * Deliver up to limit records (all if limit < 0), committing each batch.
+ * Checks they are consecutive from *next, except across gaps the caller
+ * expects (allow_gaps); returns the number delivered.
+ */
+static int drain(spool_t *spool, int limit, uint32_t *next, bool allow_gaps, int *order_errors) {
+    spool_record_t recs[BENCH_BATCH];
+    spool_pos_t end;
+    int delivered = 0;
+
+    while (limit < 0 || delivered < limit) {
+        int max = limit < 0 ? BENCH_BATCH : MIN(BENCH_BATCH, limit - delivered);
+        int n = spool_peek(spool, recs, max, &end);
+        if (n == 0) break;
+        for (int i = 0; i < n; i++) {
+            uint32_t seq = payload_seq(&recs[i]);
+            if (seq != *next && !(allow_gaps && seq > *next)) (*order_errors)++;
+            *next = seq + 1;
+        }
+        spool_commit(spool, &end, n);
+        delivered += n;
+    }
+    return delivered;
+}
+
+/* Overwrite the second half of a record's payload, as a torn write leaves it */
+static int tear_record(const spool_config_t *cfg, uint64_t seq, uint32_t index) {
+    char path[MAX_PATH_LEN + 64];
+    segment_file(cfg, seq, path, sizeof(path));
+
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) return -1;
+    uint32_t half = (uint32_t)g_opt.payload / 2;
+    off_t off = (off_t)SEGMENT_HEADER + (off_t)index * record_bytes() + RECORD_HEADER + half;
+    uint8_t junk[4096];
+    memset(junk, 0xA5, sizeof(junk));
+    ssize_t n = pwrite(fd, junk, (size_t)g_opt.payload - half, off);
+    close(fd);
+    return n == (ssize_t)(g_opt.payload - half) ? 0 : -1;
+}
+
+static void print_stats(const char *name, const spool_stats_t *s, bool ok, bool last) {
+    printf("    \"%s\": {\"appended\": %llu, \"committed\": %llu, \"dropped\": %llu, "
+           "\"expired\": %llu, \"corrupt\": %llu, \"backlog\": %llu, \"segments\": %d, "
+           "\"ok\": %s}%s\n",
+           name, (unsigned long long)s->appended, (unsigned long long)s->committed,
+           (unsigned long long)s->dropped, (unsigned long long)s->expired,
+           (unsigned long long)s->corrupt, (unsigned long long)s->backlog, s->segments,
+           ok ? "true" : "false", last ? "" : ",");
+}
+
+/* ============================================================================
+ * Throughput
+ * ========================================================================== */
+
+static bool run_throughput(uint64_t *append_ns, uint64_t *drain_ns) {
+    bool ok = true;
+    spool_config_t cfg;
+    scenario_config(&cfg, "throughput", BENCH_SEGMENT);
+    cfg.max_bytes = (uint64_t)g_opt.records * record_bytes() * 2 + 4ULL * BENCH_SEGMENT;
+
+    spool_t *spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+
+    uint64_t t0 = bench_now_ns();
+    CHECK(append_range(spool, 0, (uint32_t)g_opt.records, time(NULL)) == RESULT_OK);
+    uint64_t t1 = bench_now_ns();
+
+    uint32_t next = 0;
+    int order_errors = 0;
+    int delivered = drain(spool, -1, &next, false, &order_errors);
+    uint64_t t2 = bench_now_ns();
+
+    spool_stats_t s;
+    spool_get_stats(spool, &s);
+    CHECK(delivered == g_opt.records);
+    CHECK(order_errors == 0);
+    CHECK(s.backlog == 0 && s.segments == 1);
+
+    spool_close(spool);
+    remove_dir(cfg.dir);
+
+    *append_ns = (t1 - t0) / (uint64_t)g_opt.records;
+    *drain_ns = (t2 - t1) / (uint64_t)g_opt.records;
+    return ok;
+}
+
+/* ============================================================================
+ * Recovery Scenarios
+ * ========================================================================== */
+
+static bool run_torn_tail(spool_stats_t *out) {
+    const uint32_t total = 100, committed = 40;
+    bool ok = true;
+    spool_config_t cfg;
+    scenario_config(&cfg, "torn_tail", BENCH_SEGMENT);
+
+    spool_t *spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    CHECK(append_range(spool, 0, total, time(NULL)) == RESULT_OK);
+    uint32_t next = 0;
+    int order_errors = 0;
+    CHECK(drain(spool, (int)committed, &next, false, &order_errors) == (int)committed);
+    spool_close(spool);
+
+    CHECK(tear_record(&cfg, 1, total - 1) == 0);
+
+    spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    spool_stats_t s;
+    spool_get_stats(spool, &s);
+    CHECK(s.corrupt == 1);
+    CHECK(s.backlog == total - committed - 1);
+
+    /* The next append lands where the torn record was */
+    CHECK(append_range(spool, total, total + 1, time(NULL)) == RESULT_OK);
+
+    int delivered = drain(spool, -1, &next, true, &order_errors);
+    CHECK(delivered == (int)(total - committed));
+    CHECK(next == total + 1);
+    CHECK(order_errors == 0);
+
+    spool_get_stats(spool, out);
+    CHECK(out->backlog == 0);
+    spool_close(spool);
+    remove_dir(cfg.dir);
+    return ok;
+}
+
+static bool run_torn_sealed(spool_stats_t *out) {
+    const uint32_t per_segment = (SMALL_SEGMENT - SEGMENT_HEADER) / record_bytes();
+    const uint32_t total = per_segment * 2 + per_segment / 2, torn = per_segment / 4;
+    bool ok = true;
+    spool_config_t cfg;
+    scenario_config(&cfg, "torn_sealed", SMALL_SEGMENT);
+
+    spool_t *spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    CHECK(append_range(spool, 0, total, time(NULL)) == RESULT_OK);
+    spool_close(spool);
+
+    CHECK(tear_record(&cfg, 1, torn) == 0);
+
+    spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    spool_stats_t s;
+    spool_get_stats(spool, &s);
+    CHECK(s.corrupt == 0);                  /* Only the newest segment is checked on open */
+    CHECK(s.backlog == total - (per_segment - torn));
+
+    uint32_t next = 0;
+    int order_errors = 0;
+    int delivered = drain(spool, -1, &next, true, &order_errors);
+    CHECK(delivered == (int)(total - (per_segment - torn)));
+    CHECK(next == total);
+    CHECK(order_errors == 0);
+
+    spool_get_stats(spool, out);
+    CHECK(out->corrupt == 1);
+    CHECK(out->committed == (uint64_t)delivered);
+    CHECK(out->backlog == 0);
+    spool_close(spool);
+    remove_dir(cfg.dir);
+    return ok;
+}
+
+static bool run_size_cap(spool_stats_t *out) {
+    const uint32_t per_segment = (SMALL_SEGMENT - SEGMENT_HEADER) / record_bytes();
+    const uint32_t total = per_segment * 10;
+    bool ok = true;
+    spool_config_t cfg;
+    scenario_config(&cfg, "size_cap", SMALL_SEGMENT);
+    cfg.max_bytes = 3 * SMALL_SEGMENT;
+
+    spool_t *spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    CHECK(append_range(spool, 0, total, time(NULL)) == RESULT_OK);
+
+    spool_stats_t s;
+    spool_get_stats(spool, &s);
+    CHECK(s.dropped > 0);
+    CHECK(s.segments <= 3);
+    CHECK(s.backlog + s.dropped == total);
+    spool_close(spool);
+
+    /* The dropped count is not persisted, the cursor past the dropped data is */
+    spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    uint32_t next = (uint32_t)s.dropped;
+    int order_errors = 0;
+    int delivered = drain(spool, -1, &next, false, &order_errors);
+    CHECK(delivered == (int)s.backlog);
+    CHECK(next == total);
+    CHECK(order_errors == 0);
+
+    spool_get_stats(spool, out);
+    out->dropped = s.dropped;
+    CHECK(out->backlog == 0);
+    spool_close(spool);
+    remove_dir(cfg.dir);
+    return ok;
+}
+
+static bool run_expired(spool_stats_t *out) {
+    const uint32_t stale = 30, fresh = 10;
+    bool ok = true;
+    spool_config_t cfg;
+    scenario_config(&cfg, "expired", BENCH_SEGMENT);
+    cfg.max_age_seconds = 60;
+
+    spool_t *spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    time_t now = time(NULL);
+    CHECK(append_range(spool, 0, stale, now - 3600) == RESULT_OK);
+    CHECK(append_range(spool, stale, stale + fresh, now) == RESULT_OK);
+
+    uint32_t next = stale;
+    int order_errors = 0;
+    int delivered = drain(spool, -1, &next, false, &order_errors);
+    CHECK(delivered == (int)fresh);
+    CHECK(order_errors == 0);
+
+    spool_get_stats(spool, out);
+    CHECK(out->expired == stale);
+    CHECK(out->committed == fresh);
+    CHECK(out->backlog == 0);
+    spool_close(spool);
+
+    /* Everything was consumed: nothing is owed after a reopen */
+    spool = NULL;
+    CHECK(spool_open(&cfg, &spool) == RESULT_OK);
+    if (!spool) return false;
+    spool_stats_t s;
+    spool_get_stats(spool, &s);
+    CHECK(s.backlog == 0);
+    spool_record_t rec;
+    spool_pos_t end;
+    CHECK(spool_peek(spool, &rec, 1, &end) == 0);
+    spool_close(spool);
+    remove_dir(cfg.dir);
+    return ok;
+}
+
+/* ============================================================================
+ * Main
+ * ========================================================================== */
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--records N] [--payload BYTES]\n", prog);
+}
+
+static int parse_args(int argc, char *argv[]) {
+    static const struct option opts[] = {
+        {"records", required_argument, NULL, 'r'},
+        {"payload", required_argument, NULL, 'p'},
+        {"help",    no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "r:p:h", opts, NULL)) != -1) {
+        switch (c) {
+            case 'r': g_opt.records = atoi(optarg); break;
+            case 'p': g_opt.payload = atoi(optarg); break;
+            default: goto bad;
+        }
+    }
+
+    /* Room for the sequence number, and several records per small segment */
+    if (g_opt.records < 1 || g_opt.payload < (int)sizeof(uint32_t) || g_opt.payload > 256) {
+        goto bad;
+    }
+    return 0;
+
+bad:
+    usage(argv[0]);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    if (parse_args(argc, argv) != 0) return 2;
+
+    logger_config_t log_cfg = {0};
+    log_cfg.level = LOG_LEVEL_ERROR;
+    log_cfg.destinations = LOG_DEST_CONSOLE;
+    logger_init(&log_cfg);
+
+    if (!mkdtemp(g_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    uint64_t append_ns = 0, drain_ns = 0;
+    bool throughput_ok = run_throughput(&append_ns, &drain_ns);
+
+    spool_stats_t torn_tail = {0}, torn_sealed = {0}, size_cap = {0}, expired = {0};
+    bool torn_tail_ok = run_torn_tail(&torn_tail);
+    bool torn_sealed_ok = run_torn_sealed(&torn_sealed);
+    bool size_cap_ok = run_size_cap(&size_cap);
+    bool expired_ok = run_expired(&expired);
+
+    printf("{\n");
+    printf("  \"bench\": \"spool\",\n");
+    printf("  \"records\": %d, \"payload\": %d,\n", g_opt.records, g_opt.payload);
+    printf("  \"throughput\": {\"append_ns\": %llu, \"drain_ns\": %llu, \"ok\": %s},\n",
+           (unsigned long long)append_ns, (unsigned long long)drain_ns,
+           throughput_ok ? "true" : "false");
+    printf("  \"recovery\": {\n");
+    print_stats("torn_tail", &torn_tail, torn_tail_ok, false);
+    print_stats("torn_sealed", &torn_sealed, torn_sealed_ok, false);
+    print_stats("size_cap", &size_cap, size_cap_ok, false);
+    print_stats("expired", &expired, expired_ok, true);
+    printf("  },\n");
+    printf("  \"failures\": %d\n", g_failures);
+    printf("}\n");
+
+    rmdir(g_dir);
+    logger_shutdown();
+    return g_failures == 0 ? 0 : 1;
+}
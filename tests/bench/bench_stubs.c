@@ -0,0 +1,29 @@
+/**
+ * @file bench_stubs.c
+ * @brief Link stubs so benches can use logger.c without the ncurses TUI,
+ *        and alarm_manager.c without the actuator stack
+ */
+
+#include "tui/tui_main.h"
+#include "actuators/actuator_manager.h"
+
+bool tui_is_active(void) {
+    return false;
+}
+
+void tui_log_message(int level, const char *message) {
+    (void)level;
+    (void)message;
+}
+
+/* Interlock target referenced by alarm_manager.c; bench rules never set interlocks */
+actuator_manager_t g_actuator_mgr;
+
+result_t actuator_manager_manual_set(actuator_manager_t *mgr, int slot,
+                                     actuator_state_t state, uint8_t pwm_duty) {
+    (void)mgr;
+    (void)slot;
+    (void)state;
+    (void)pwm_duty;
+    return RESULT_OK;
+}
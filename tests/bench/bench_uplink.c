@@ -0,0 +1,443 @@
+/**
+ * @file bench_uplink.c
+ * @brief Remote upload protocol: encoding size and backlog catch-up time
+ *
+ * Encodes the same synthetic log stream the data logger would upload
+ * (every module once per pass, --batch entries per request) in each
+ * format, then replays a backlog through the real transport against an
+ * in-process HTTP/1.1 server that holds each response for --rtt-ms, once
+ * with a single batch in flight and once with --window batches.
+ *
+ * Every binary batch is decoded again and compared bit for bit; the
+ * server decodes every request it receives and counts the entries. Any
+ * mismatch, lost entry or failed batch fails the run.
+ *
+ * Reported (JSON on stdout):
+ *   encoding           bytes per entry and encode ns per entry, per format
+ *   catchup            wall time and entries/s per window, connections used
+ *
+ * Usage: bench_uplink [--modules N] [--passes N] [--batch N]
+ *                     [--backlog N] [--rtt-ms N] [--window N]
+ */
+
+#include "common.h"
+#include "bench_common.h"
+#include "config_defaults.h"
+#include "logging/uplink.h"
+#include "utils/logger.h"
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define BENCH_EPOCH_S       1700000000LL
+#define BENCH_DEVICE        "bench-rtu"
+#define MAX_BATCH           1000
+#define MAX_REQUEST         (1024 * 1024)
+
+typedef struct {
+    int modules;
+    int passes;
+    int batch;
+    int backlog;
+    int rtt_ms;
+    int window;
+} bench_options_t;
+
+static bench_options_t g_opt = {
+    .modules = 64,
+    .passes = 200,
+    .batch = 50,
+    .backlog = 20000,
+    .rtt_ms = 50,
+    .window = 8,
+};
+
+static uplink_entry_t *g_entries;
+static uint32_t g_noise_state = 0x2545F491u;
+
+/* ============================================================================
+ * Synthetic Workload
+ * ========================================================================== */
+
+static float next_noise(void) {
+    g_noise_state ^= g_noise_state << 13;
+    g_noise_state ^= g_noise_state >> 17;
+    g_noise_state ^= g_noise_state << 5;
+    return (float)(g_noise_state & 0xFFFF) / 65535.0f - 0.5f;
+}
+
+static float sample_value(int m, int i) {
+    switch (m % 4) {
+        case 0:  return 7.0f + (float)((i / 500) % 3) * 0.5f;
+        case 1:  return roundf((20.0f + 5.0f * sinf((float)i / 200.0f + (float)m)) * 100.0f) / 100.0f;
+        case 2:  return 50.0f + next_noise() * 4.0f;
+        default: return roundf((7.2f + next_noise() * 0.6f) * 10.0f) / 10.0f;
+    }
+}
+
+static void build_workload(int count) {
+    g_entries = calloc((size_t)count, sizeof(*g_entries));
+    for (int n = 0; n < count; n++) {
+        int m = n % g_opt.modules;
+        int i = n / g_opt.modules;
+        uplink_entry_t *e = &g_entries[n];
+        e->module_id = m + 1;
+        e->value = sample_value(m, i);
+        e->timestamp = (time_t)(BENCH_EPOCH_S + (int64_t)i * 60 + ((i + m) % 11 == 0));
+        const char *status = ((i * 31 + m) % 100) == 0 ? "bad" :
+                             ((i * 7 + m) % 50) == 0 ? "uncertain" : "ok";
+        SAFE_STRNCPY(e->status, status, sizeof(e->status));
+    }
+}
+
+static bool entry_equal(const uplink_entry_t *a, const uplink_entry_t *b) {
+    return a->module_id == b->module_id && a->timestamp == b->timestamp &&
+           memcmp(&a->value, &b->value, sizeof(a->value)) == 0 &&
+           strcmp(a->status, b->status) == 0;
+}
+
+/* ============================================================================
+ * Encoding
+ * ========================================================================== */
+
+typedef struct {
+    const char *name;
+    uplink_format_t format;
+    bool compress;
+    uint64_t bytes;
+    uint64_t encode_ns;
+    int mismatches;
+} encoding_run_t;
+
+static void run_encoding(encoding_run_t *run, int count) {
+    uplink_buf_t buf = {0};
+    uplink_entry_t decoded[MAX_BATCH];
+
+    for (int off = 0; off < count; off += g_opt.batch) {
+        int n = MIN(g_opt.batch, count - off);
+        uint64_t t0 = bench_now_ns();
+        if (uplink_encode(run->format, run->compress, BENCH_DEVICE, &g_entries[off], n,
+                          &buf) != RESULT_OK) {
+            run->mismatches++;
+            continue;
+        }
+        run->encode_ns += bench_now_ns() - t0;
+        run->bytes += buf.len;
+
+        if (run->format != UPLINK_FORMAT_BINARY) continue;
+
+        char device[MAX_NAME_LEN];
+        int got = 0;
+        if (uplink_decode(buf.data, buf.len, device, sizeof(device), decoded, MAX_BATCH,
+                          &got) != RESULT_OK || got != n || strcmp(device, BENCH_DEVICE) != 0) {
+            run->mismatches++;
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            if (!entry_equal(&decoded[i], &g_entries[off + i])) run->mismatches++;
+        }
+    }
+    uplink_buf_free(&buf);
+}
+
+/* ============================================================================
+ * Stand-in Server
+ * ========================================================================== */
+
+static struct {
+    int listen_fd;
+    int port;
+    atomic_int connections;
+    atomic_int requests;
+    atomic_int entries;
+    atomic_int bad_requests;
+} g_server;
+
+/* Read one request into buf; returns body length, -1 on close or error */
+static int read_request(int fd, char *buf, size_t cap, char **body) {
+    size_t len = 0;
+    char *hdr_end = NULL;
+    while (!hdr_end) {
+        if (len + 1 >= cap) return -1;
+        ssize_t n = recv(fd, buf + len, cap - len - 1, 0);
+        if (n <= 0) return -1;
+        len += (size_t)n;
+        buf[len] = '\0';
+        hdr_end = strstr(buf, "\r\n\r\n");
+    }
+
+    long content_length = 0;
+    for (char *line = strstr(buf, "\r\n"); line && line < hdr_end; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, "Content-Length:", 15) == 0) {
+            content_length = strtol(line + 17, NULL, 10);
+        }
+    }
+
+    size_t header_len = (size_t)(hdr_end + 4 - buf);
+    if (content_length < 0 || header_len + (size_t)content_length > cap) return -1;
+    while (len < header_len + (size_t)content_length) {
+        ssize_t n = recv(fd, buf + len, header_len + (size_t)content_length - len, 0);
+        if (n <= 0) return -1;
+        len += (size_t)n;
+    }
+    *body = buf + header_len;
+    return (int)content_length;
+}
+
+static void* connection_thread(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    char *buf = malloc(MAX_REQUEST);
+    uplink_entry_t *decoded = malloc(MAX_BATCH * sizeof(*decoded));
+    static const char ok[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+
+    for (;;) {
+        char *body;
+        int len = read_request(fd, buf, MAX_REQUEST, &body);
+        if (len < 0) break;
+
+        if (g_opt.rtt_ms > 0) usleep((useconds_t)g_opt.rtt_ms * 1000);
+
+        int got = 0;
+        if (uplink_decode(body, (size_t)len, NULL, 0, decoded, MAX_BATCH, &got) == RESULT_OK) {
+            atomic_fetch_add(&g_server.entries, got);
+        } else {
+            atomic_fetch_add(&g_server.bad_requests, 1);
+        }
+        atomic_fetch_add(&g_server.requests, 1);
+        if (send(fd, ok, sizeof(ok) - 1, MSG_NOSIGNAL) < 0) break;
+    }
+
+    free(decoded);
+    free(buf);
+    close(fd);
+    return NULL;
+}
+
+static void* accept_thread(void *arg) {
+    UNUSED(arg);
+    for (;;) {
+        int fd = accept(g_server.listen_fd, NULL, NULL);
+        if (fd < 0) break;
+        atomic_fetch_add(&g_server.connections, 1);
+        pthread_t t;
+        if (pthread_create(&t, NULL, connection_thread, (void *)(intptr_t)fd) == 0) {
+            pthread_detach(t);
+        } else {
+            close(fd);
+        }
+    }
+    return NULL;
+}
+
+static int server_start(void) {
+    g_server.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (g_server.listen_fd < 0) return -1;
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t alen = sizeof(addr);
+    if (bind(g_server.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(g_server.listen_fd, 64) != 0 ||
+        getsockname(g_server.listen_fd, (struct sockaddr *)&addr, &alen) != 0) {
+        close(g_server.listen_fd);
+        return -1;
+    }
+    g_server.port = ntohs(addr.sin_port);
+
+    pthread_t t;
+    if (pthread_create(&t, NULL, accept_thread, NULL) != 0) return -1;
+    pthread_detach(t);
+    return 0;
+}
+
+/* ============================================================================
+ * Catch-up
+ * ========================================================================== */
+
+typedef struct {
+    int window;
+    uint64_t elapsed_us;
+    int connections;
+    int acked;
+    int failed;
+    int received;
+    uint64_t bytes_sent;
+} catchup_run_t;
+
+static int run_catchup(catchup_run_t *run) {
+    uplink_config_t cfg = {
+        .format = UPLINK_FORMAT_BINARY,
+        .compress = true,
+        .window = run->window,
+        .timeout_s = 30,
+    };
+    snprintf(cfg.url, sizeof(cfg.url), "http://127.0.0.1:%d/api/logs", g_server.port);
+    SAFE_STRNCPY(cfg.device, BENCH_DEVICE, sizeof(cfg.device));
+
+    uplink_t *uplink;
+    if (uplink_open(&cfg, &uplink) != RESULT_OK) return -1;
+
+    int conns0 = atomic_load(&g_server.connections);
+    int entries0 = atomic_load(&g_server.entries);
+    uplink_ack_t acks[WT_UPLINK_MAX_WINDOW];
+    int next = 0;
+    uint64_t seq = 0;
+    uint64_t t0 = bench_now_us();
+
+    while (next < g_opt.backlog || uplink_in_flight(uplink) > 0) {
+        while (next < g_opt.backlog && uplink_in_flight(uplink) < uplink_window(uplink)) {
+            int n = MIN(g_opt.batch, g_opt.backlog - next);
+            char key[32];
+            snprintf(key, sizeof(key), "bench-%llu", (unsigned long long)seq);
+            if (uplink_submit(uplink, &g_entries[next], n, seq++, key) != RESULT_OK) {
+                run->failed += n;
+            }
+            next += n;
+        }
+        int got = uplink_poll(uplink, 1000, acks, WT_UPLINK_MAX_WINDOW);
+        for (int i = 0; i < got; i++) {
+            if (acks[i].ok) run->acked += acks[i].count;
+            else run->failed += acks[i].count;
+        }
+    }
+
+    run->elapsed_us = bench_now_us() - t0;
+    uplink_stats_t stats;
+    uplink_get_stats(uplink, &stats);
+    run->bytes_sent = stats.bytes_sent;
+    uplink_close(uplink);
+
+    /* The server counts after responding; let the last handler finish */
+    for (int i = 0; i < 100 && atomic_load(&g_server.entries) - entries0 < run->acked; i++) {
+        usleep(1000);
+    }
+    run->received = atomic_load(&g_server.entries) - entries0;
+    run->connections = atomic_load(&g_server.connections) - conns0;
+    return 0;
+}
+
+/* ============================================================================
+ * Main
+ * ========================================================================== */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--modules N] [--passes N] [--batch N] [--backlog N] [--rtt-ms N] "
+            "[--window N]\n", prog);
+}
+
+static int parse_args(int argc, char *argv[]) {
+    static const struct option opts[] = {
+        {"modules", required_argument, NULL, 'm'},
+        {"passes",  required_argument, NULL, 'p'},
+        {"batch",   required_argument, NULL, 'b'},
+        {"backlog", required_argument, NULL, 'n'},
+        {"rtt-ms",  required_argument, NULL, 'r'},
+        {"window",  required_argument, NULL, 'w'},
+        {"help",    no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "m:p:b:n:r:w:h", opts, NULL)) != -1) {
+        switch (c) {
+            case 'm': g_opt.modules = atoi(optarg); break;
+            case 'p': g_opt.passes = atoi(optarg); break;
+            case 'b': g_opt.batch = atoi(optarg); break;
+            case 'n': g_opt.backlog = atoi(optarg); break;
+            case 'r': g_opt.rtt_ms = atoi(optarg); break;
+            case 'w': g_opt.window = atoi(optarg); break;
+            default: goto bad;
+        }
+    }
+
+    if (g_opt.modules < 1 || g_opt.passes < 1 || g_opt.batch < 1 || g_opt.batch > MAX_BATCH ||
+        g_opt.backlog < 0 || g_opt.rtt_ms < 0 || g_opt.window < 1 ||
+        g_opt.window > WT_UPLINK_MAX_WINDOW) {
+        goto bad;
+    }
+    return 0;
+
+bad:
+    usage(argv[0]);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    if (parse_args(argc, argv) != 0) return 2;
+
+    logger_config_t log_cfg = {0};
+    log_cfg.level = LOG_LEVEL_ERROR;
+    log_cfg.destinations = LOG_DEST_CONSOLE;
+    logger_init(&log_cfg);
+
+    int encoded = g_opt.modules * g_opt.passes;
+    build_workload(MAX(encoded, g_opt.backlog));
+
+    encoding_run_t enc[] = {
+        { .name = "json",        .format = UPLINK_FORMAT_JSON,   .compress = false },
+        { .name = "json_gzip",   .format = UPLINK_FORMAT_JSON,   .compress = true },
+        { .name = "binary",      .format = UPLINK_FORMAT_BINARY, .compress = false },
+        { .name = "binary_gzip", .format = UPLINK_FORMAT_BINARY, .compress = true },
+    };
+    int n_enc = (int)(sizeof(enc) / sizeof(enc[0]));
+    int rc = 0;
+    for (int i = 0; i < n_enc; i++) {
+        run_encoding(&enc[i], encoded);
+        if (enc[i].mismatches) rc = 1;
+    }
+
+    printf("{\n");
+    printf("  \"bench\": \"uplink\",\n");
+    printf("  \"modules\": %d, \"entries\": %d, \"batch\": %d, \"compression\": %s,\n",
+           g_opt.modules, encoded, g_opt.batch, uplink_compress_available() ? "true" : "false");
+    printf("  \"encoding\": {\n");
+    for (int i = 0; i < n_enc; i++) {
+        printf("    \"%s\": {\"bytes_per_entry\": %.2f, \"encode_ns\": %.0f, \"mismatches\": %d}%s\n",
+               enc[i].name, (double)enc[i].bytes / encoded,
+               (double)enc[i].encode_ns / encoded, enc[i].mismatches,
+               i < n_enc - 1 ? "," : "");
+    }
+    printf("  },\n");
+    printf("  \"size_reduction\": %.1f,\n",
+           enc[3].bytes > 0 ? (double)enc[0].bytes / (double)enc[3].bytes : 0.0);
+
+    uplink_global_init();
+    catchup_run_t runs[2] = { { .window = 1 }, { .window = g_opt.window } };
+    bool transport = g_opt.backlog > 0 && server_start() == 0;
+    printf("  \"catchup\": {\"backlog\": %d, \"rtt_ms\": %d", g_opt.backlog, g_opt.rtt_ms);
+    for (int i = 0; transport && i < 2; i++) {
+        if (run_catchup(&runs[i]) != 0) {
+            printf(", \"transport\": \"unavailable\"");
+            break;
+        }
+        catchup_run_t *r = &runs[i];
+        if (r->failed || r->acked != g_opt.backlog || r->received != r->acked) rc = 1;
+        printf(",\n    \"window_%d\": {\"elapsed_ms\": %.1f, \"entries_per_s\": %.0f, "
+               "\"bytes_sent\": %llu, \"connections\": %d, \"acked\": %d, \"received\": %d, "
+               "\"failed\": %d}",
+               r->window, (double)r->elapsed_us / 1000.0,
+               r->elapsed_us ? (double)r->acked * 1e6 / (double)r->elapsed_us : 0.0,
+               (unsigned long long)r->bytes_sent, r->connections, r->acked, r->received,
+               r->failed);
+    }
+    printf("},\n");
+    if (atomic_load(&g_server.bad_requests) > 0) rc = 1;
+    printf("  \"speedup\": %.1f, \"bad_requests\": %d\n",
+           runs[1].elapsed_us > 0 ? (double)runs[0].elapsed_us / (double)runs[1].elapsed_us : 0.0,
+           atomic_load(&g_server.bad_requests));
+    printf("}\n");
+
+    uplink_global_cleanup();
+    free(g_entries);
+    logger_shutdown();
+    return rc;
+}
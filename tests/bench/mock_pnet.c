@@ -0,0 +1,378 @@
+/**
+ * @file mock_pnet.c
+ * @brief In-process p-net stand-in used by the PROFINET bench
+ *
+ * Implements the device API from mock_pnet/pnet_api.h on top of plain
+ * memory, plus a controller side (mock_pnet.h) that a bench thread uses in
+ * place of a PLC. Connection events and record reads are delivered from
+ * pnet_handle_periodic(), i.e. on the device's tick thread, just like the
+ * real stack.
+ */
+
+#include "mock_pnet.h"
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#define MOCK_MAX_SUBMODULES     128
+#define MOCK_DATA_SIZE          256
+#define MOCK_TICK_SAMPLES       (1u << 18)
+#define MOCK_AREP               1
+
+typedef struct {
+    uint16_t slot;
+    uint16_t subslot;
+    uint32_t module_ident;
+    uint32_t submodule_ident;
+    pnet_submodule_dir_t dir;
+    uint16_t input_len;
+    uint16_t output_len;
+
+    uint8_t input[MOCK_DATA_SIZE];
+    uint16_t input_size;
+    uint8_t input_iops;
+    uint64_t input_us;
+
+    uint8_t output[MOCK_DATA_SIZE];
+    uint16_t output_size;
+    bool output_new;
+} mock_submodule_t;
+
+typedef struct {
+    bool pending;
+    bool done;
+    uint16_t slot;
+    uint16_t subslot;
+    uint16_t idx;
+    uint8_t data[MOCK_DATA_SIZE];
+    uint16_t len;
+    int result;
+} mock_record_req_t;
+
+struct pnet {
+    pnet_cfg_t cfg;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    mock_submodule_t subs[MOCK_MAX_SUBMODULES];
+    int sub_count;
+
+    bool want_connected;
+    bool connected;
+
+    mock_record_req_t record;
+
+    uint64_t last_tick_us;
+    uint64_t tick_us[MOCK_TICK_SAMPLES];
+    size_t tick_count;
+
+    uint32_t alarm_count;
+};
+
+static struct pnet g_mock = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+uint64_t mock_pnet_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static mock_submodule_t* find_sub(uint16_t slot, uint16_t subslot) {
+    for (int i = 0; i < g_mock.sub_count; i++) {
+        if (g_mock.subs[i].slot == slot && g_mock.subs[i].subslot == subslot) {
+            return &g_mock.subs[i];
+        }
+    }
+    return NULL;
+}
+
+/* ============================================================================
+ * Device API (pnet_api.h)
+ * ========================================================================== */
+
+pnet_t *pnet_init(const pnet_cfg_t *cfg) {
+    if (!cfg) return NULL;
+
+    pthread_mutex_lock(&g_mock.mutex);
+    memcpy(&g_mock.cfg, cfg, sizeof(*cfg));
+    g_mock.sub_count = 0;
+    g_mock.connected = false;
+    g_mock.want_connected = false;
+    g_mock.tick_count = 0;
+    g_mock.last_tick_us = 0;
+    g_mock.alarm_count = 0;
+    memset(&g_mock.record, 0, sizeof(g_mock.record));
+    pthread_mutex_unlock(&g_mock.mutex);
+
+    return &g_mock;
+}
+
+static void serve_record_request(pnet_t *net) {
+    mock_record_req_t *req = &net->record;
+    uint8_t *data = NULL;
+    uint16_t len = sizeof(req->data);
+    pnet_result_t result;
+    memset(&result, 0, sizeof(result));
+
+    req->result = -1;
+    if (net->cfg.read_cb) {
+        req->result = net->cfg.read_cb(net, net->cfg.cb_arg, MOCK_AREP, 0,
+                                       req->slot, req->subslot, req->idx, 0,
+                                       &data, &len, &result);
+    }
+
+    if (req->result == 0 && data && len > 0) {
+        if (len > sizeof(req->data)) len = sizeof(req->data);
+        memcpy(req->data, data, len);
+        req->len = len;
+    } else {
+        req->len = 0;
+    }
+}
+
+void pnet_handle_periodic(pnet_t *net) {
+    if (!net) return;
+
+    uint64_t now = mock_pnet_now_us();
+
+    pthread_mutex_lock(&net->mutex);
+    if (net->last_tick_us != 0 && net->tick_count < MOCK_TICK_SAMPLES) {
+        net->tick_us[net->tick_count++] = now - net->last_tick_us;
+    }
+    net->last_tick_us = now;
+
+    bool want = net->want_connected;
+    bool was = net->connected;
+    net->connected = want;
+    bool record_pending = net->record.pending;
+    pthread_mutex_unlock(&net->mutex);
+
+    /* Callbacks run without the mock lock - they call back into pnet_* */
+    if (want && !was) {
+        pnet_result_t result;
+        memset(&result, 0, sizeof(result));
+        if (net->cfg.connect_cb) net->cfg.connect_cb(net, net->cfg.cb_arg, MOCK_AREP, &result);
+        if (net->cfg.dcontrol_cb) {
+            net->cfg.dcontrol_cb(net, net->cfg.cb_arg, MOCK_AREP,
+                                 PNET_CONTROL_COMMAND_PRM_END, &result);
+        }
+        if (net->cfg.state_cb) net->cfg.state_cb(net, net->cfg.cb_arg, MOCK_AREP, PNET_EVENT_APPLRDY);
+    } else if (!want && was) {
+        if (net->cfg.state_cb) net->cfg.state_cb(net, net->cfg.cb_arg, MOCK_AREP, PNET_EVENT_ABORT);
+    }
+
+    if (record_pending) {
+        serve_record_request(net);
+        pthread_mutex_lock(&net->mutex);
+        net->record.pending = false;
+        net->record.done = true;
+        pthread_cond_broadcast(&net->cond);
+        pthread_mutex_unlock(&net->mutex);
+    }
+}
+
+int pnet_plug_module(pnet_t *net, uint32_t api, uint16_t slot, uint32_t module_ident) {
+    (void)net; (void)api; (void)slot; (void)module_ident;
+    return 0;
+}
+
+int pnet_plug_submodule(pnet_t *net, uint32_t api, uint16_t slot, uint16_t subslot,
+                        uint32_t module_ident, uint32_t submodule_ident,
+                        pnet_submodule_dir_t direction, uint16_t length_input,
+                        uint16_t length_output) {
+    (void)api;
+    if (!net) return -1;
+
+    pthread_mutex_lock(&net->mutex);
+    mock_submodule_t *s = find_sub(slot, subslot);
+    if (!s) {
+        if (net->sub_count >= MOCK_MAX_SUBMODULES) {
+            pthread_mutex_unlock(&net->mutex);
+            return -1;
+        }
+        s = &net->subs[net->sub_count++];
+    }
+    memset(s, 0, sizeof(*s));
+    s->slot = slot;
+    s->subslot = subslot;
+    s->module_ident = module_ident;
+    s->submodule_ident = submodule_ident;
+    s->dir = direction;
+    s->input_len = length_input;
+    s->output_len = length_output;
+    pthread_mutex_unlock(&net->mutex);
+    return 0;
+}
+
+int pnet_input_set_data_and_iops(pnet_t *net, uint32_t api, uint16_t slot, uint16_t subslot,
+                                 const uint8_t *data, uint16_t size, uint8_t iops) {
+    (void)api;
+    if (!net || !data || size > MOCK_DATA_SIZE) return -1;
+
+    pthread_mutex_lock(&net->mutex);
+    mock_submodule_t *s = find_sub(slot, subslot);
+    if (!s) {
+        pthread_mutex_unlock(&net->mutex);
+        return -1;
+    }
+    memcpy(s->input, data, size);
+    s->input_size = size;
+    s->input_iops = iops;
+    s->input_us = mock_pnet_now_us();
+    pthread_mutex_unlock(&net->mutex);
+    return 0;
+}
+
+int pnet_output_get_data_and_iops(pnet_t *net, uint32_t api, uint16_t slot, uint16_t subslot,
+                                  bool *new_flag, uint8_t *data, uint16_t *length,
+                                  uint8_t *iops) {
+    (void)api;
+    if (!net || !new_flag || !data || !length || !iops) return -1;
+
+    pthread_mutex_lock(&net->mutex);
+    mock_submodule_t *s = find_sub(slot, subslot);
+    if (!s || s->output_len == 0) {
+        pthread_mutex_unlock(&net->mutex);
+        return -1;
+    }
+    uint16_t len = (s->output_size < *length) ? s->output_size : *length;
+    memcpy(data, s->output, len);
+    *length = len;
+    *new_flag = s->output_new;
+    *iops = net->connected ? PNET_IOXS_GOOD : PNET_IOXS_BAD;
+    s->output_new = false;
+    pthread_mutex_unlock(&net->mutex);
+    return 0;
+}
+
+int pnet_alarm_send_process_alarm(pnet_t *net, uint32_t arep, uint32_t api,
+                                  uint16_t slot, uint16_t subslot, uint16_t usi,
+                                  uint16_t length, const uint8_t *data) {
+    (void)arep; (void)api; (void)slot; (void)subslot; (void)usi; (void)length; (void)data;
+    if (!net) return -1;
+
+    pthread_mutex_lock(&net->mutex);
+    int ret = net->connected ? 0 : -1;
+    if (ret == 0) net->alarm_count++;
+    pthread_mutex_unlock(&net->mutex);
+    return ret;
+}
+
+/* ============================================================================
+ * Controller API (mock_pnet.h)
+ * ========================================================================== */
+
+void mock_pnet_controller_connect(void) {
+    pthread_mutex_lock(&g_mock.mutex);
+    g_mock.want_connected = true;
+    pthread_mutex_unlock(&g_mock.mutex);
+}
+
+void mock_pnet_controller_disconnect(void) {
+    pthread_mutex_lock(&g_mock.mutex);
+    g_mock.want_connected = false;
+    pthread_mutex_unlock(&g_mock.mutex);
+}
+
+bool mock_pnet_is_connected(void) {
+    pthread_mutex_lock(&g_mock.mutex);
+    bool connected = g_mock.connected;
+    pthread_mutex_unlock(&g_mock.mutex);
+    return connected;
+}
+
+int mock_pnet_controller_write_output(uint16_t slot, uint16_t subslot,
+                                      const uint8_t *data, uint16_t len) {
+    if (!data) return -1;
+
+    pthread_mutex_lock(&g_mock.mutex);
+    mock_submodule_t *s = find_sub(slot, subslot);
+    if (!s || len > s->output_len) {
+        pthread_mutex_unlock(&g_mock.mutex);
+        return -1;
+    }
+    memcpy(s->output, data, len);
+    s->output_size = len;
+    s->output_new = true;
+    pthread_mutex_unlock(&g_mock.mutex);
+    return 0;
+}
+
+int mock_pnet_controller_read_input(uint16_t slot, uint16_t subslot,
+                                    uint8_t *data, uint16_t *len, uint8_t *iops,
+                                    uint64_t *updated_us) {
+    if (!data || !len) return -1;
+
+    pthread_mutex_lock(&g_mock.mutex);
+    mock_submodule_t *s = find_sub(slot, subslot);
+    if (!s || s->input_size == 0) {
+        pthread_mutex_unlock(&g_mock.mutex);
+        return -1;
+    }
+    uint16_t n = (s->input_size < *len) ? s->input_size : *len;
+    memcpy(data, s->input, n);
+    *len = n;
+    if (iops) *iops = s->input_iops;
+    if (updated_us) *updated_us = s->input_us;
+    pthread_mutex_unlock(&g_mock.mutex);
+    return 0;
+}
+
+int mock_pnet_controller_read_record(uint16_t slot, uint16_t subslot, uint16_t idx,
+                                     uint8_t *data, uint16_t *len) {
+    if (!data || !len) return -1;
+
+    pthread_mutex_lock(&g_mock.mutex);
+    while (g_mock.record.pending) {
+        pthread_cond_wait(&g_mock.cond, &g_mock.mutex);
+    }
+    g_mock.record.slot = slot;
+    g_mock.record.subslot = subslot;
+    g_mock.record.idx = idx;
+    g_mock.record.done = false;
+    g_mock.record.pending = true;
+
+    /* Served by pnet_handle_periodic() on the device tick thread */
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 1;
+    while (!g_mock.record.done) {
+        if (pthread_cond_timedwait(&g_mock.cond, &g_mock.mutex, &deadline) != 0) {
+            g_mock.record.pending = false;
+            pthread_mutex_unlock(&g_mock.mutex);
+            return -1;
+        }
+    }
+
+    int ret = g_mock.record.result;
+    uint16_t n = (g_mock.record.len < *len) ? g_mock.record.len : *len;
+    memcpy(data, g_mock.record.data, n);
+    *len = n;
+    pthread_mutex_unlock(&g_mock.mutex);
+    return ret;
+}
+
+size_t mock_pnet_tick_intervals(uint64_t *out_us, size_t max) {
+    pthread_mutex_lock(&g_mock.mutex);
+    size_t n = (g_mock.tick_count < max) ? g_mock.tick_count : max;
+    if (out_us) memcpy(out_us, g_mock.tick_us, n * sizeof(uint64_t));
+    pthread_mutex_unlock(&g_mock.mutex);
+    return n;
+}
+
+uint32_t mock_pnet_alarm_count(void) {
+    pthread_mutex_lock(&g_mock.mutex);
+    uint32_t n = g_mock.alarm_count;
+    pthread_mutex_unlock(&g_mock.mutex);
+    return n;
+}
+
+int mock_pnet_plugged_count(void) {
+    pthread_mutex_lock(&g_mock.mutex);
+    int n = g_mock.sub_count;
+    pthread_mutex_unlock(&g_mock.mutex);
+    return n;
+}
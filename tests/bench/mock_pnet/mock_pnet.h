@@ -0,0 +1,39 @@
+/**
+ * @file mock_pnet.h
+ * @brief Controller-side API of the in-process p-net stand-in
+ *
+ * The bench drives these calls from its own "PLC" thread while the device
+ * code runs unchanged on top of pnet_api.h. All timestamps are
+ * CLOCK_MONOTONIC microseconds.
+ */
+
+#ifndef MOCK_PNET_H
+#define MOCK_PNET_H
+
+#include "pnet_api.h"
+#include <stddef.h>
+
+/* Ask the device to enter/leave data exchange (applied on next tick) */
+void mock_pnet_controller_connect(void);
+void mock_pnet_controller_disconnect(void);
+bool mock_pnet_is_connected(void);
+
+/* Cyclic data as seen by the controller */
+int mock_pnet_controller_write_output(uint16_t slot, uint16_t subslot,
+                                      const uint8_t *data, uint16_t len);
+int mock_pnet_controller_read_input(uint16_t slot, uint16_t subslot,
+                                    uint8_t *data, uint16_t *len, uint8_t *iops,
+                                    uint64_t *updated_us);
+
+/* Acyclic record read through the device's read callback */
+int mock_pnet_controller_read_record(uint16_t slot, uint16_t subslot, uint16_t idx,
+                                     uint8_t *data, uint16_t *len);
+
+/* Instrumentation */
+size_t mock_pnet_tick_intervals(uint64_t *out_us, size_t max);
+uint32_t mock_pnet_alarm_count(void);
+int mock_pnet_plugged_count(void);
+
+uint64_t mock_pnet_now_us(void);
+
+#endif /* MOCK_PNET_H */
@@ -0,0 +1,151 @@
+/**
+ * @file pnet_api.h
+ * @brief Minimal in-process stand-in for the p-net v0.2.0 device API
+ *
+ * Only the types and calls used by src/profinet/ are provided. Building
+ * profinet_manager.c / profinet_callbacks.c against this header (with
+ * HAVE_PNET defined) exercises the real device code paths without a NIC
+ * or a PLC. The controller side lives in mock_pnet.h.
+ */
+
+#ifndef PNET_API_H
+#define PNET_API_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct pnet pnet_t;
+
+typedef enum {
+    PNET_IOXS_BAD  = 0x00,
+    PNET_IOXS_GOOD = 0x80
+} pnet_ioxs_values_t;
+
+typedef enum {
+    PNET_EVENT_ABORT = 0,
+    PNET_EVENT_STARTUP,
+    PNET_EVENT_PRMEND,
+    PNET_EVENT_APPLRDY,
+    PNET_EVENT_DATA
+} pnet_event_values_t;
+
+typedef enum {
+    PNET_CONTROL_COMMAND_PRM_BEGIN = 0,
+    PNET_CONTROL_COMMAND_PRM_END,
+    PNET_CONTROL_COMMAND_APP_RDY,
+    PNET_CONTROL_COMMAND_RELEASE
+} pnet_control_command_t;
+
+typedef enum {
+    PNET_DIR_NO_IO = 0,
+    PNET_DIR_INPUT,
+    PNET_DIR_OUTPUT,
+    PNET_DIR_IO
+} pnet_submodule_dir_t;
+
+/* Record read/write error codes (PNIORW) */
+#define PNET_ERROR_CODE_READ                        0xDE
+#define PNET_ERROR_CODE_WRITE                       0xDF
+#define PNET_ERROR_DECODE_PNIORW                    0x80
+#define PNET_ERROR_CODE_1_ACC_INVALID_INDEX         0xB0
+#define PNET_ERROR_CODE_1_ACC_WRITE_LENGTH_ERROR    0xB1
+#define PNET_ERROR_CODE_1_ACC_INVALID_SLOT_SUBSLOT  0xB2
+#define PNET_ERROR_CODE_1_ACC_STATE_CONFLICT        0xB5
+#define PNET_ERROR_CODE_1_ACC_ACCESS_DENIED         0xB6
+#define PNET_ERROR_CODE_1_ACC_INVALID_RANGE         0xB7
+
+typedef struct {
+    uint8_t error_code;
+    uint8_t error_decode;
+    uint8_t error_code_1;
+    uint8_t error_code_2;
+} pnet_pnio_status_t;
+
+typedef struct {
+    pnet_pnio_status_t pnio_status;
+    uint16_t add_data_1;
+    uint16_t add_data_2;
+} pnet_result_t;
+
+typedef struct {
+    pnet_submodule_dir_t data_dir;
+    uint16_t insize;
+    uint16_t outsize;
+} pnet_data_cfg_t;
+
+typedef struct {
+    uint32_t api_id;
+    uint16_t slot_nbr;
+    uint16_t subslot_nbr;
+    uint16_t alarm_type;
+    uint16_t sequence_number;
+} pnet_alarm_argument_t;
+
+typedef struct {
+    uint8_t vendor_id_hi;
+    uint8_t vendor_id_lo;
+    uint8_t device_id_hi;
+    uint8_t device_id_lo;
+} pnet_cfg_device_id_t;
+
+typedef struct {
+    const char *main_netif_name;
+} pnet_if_cfg_t;
+
+typedef struct {
+    char station_name[241];
+    char product_name[26];
+    pnet_cfg_device_id_t device_id;
+    uint16_t min_device_interval;
+
+    int (*state_cb)(pnet_t *net, void *arg, uint32_t arep, pnet_event_values_t event);
+    int (*connect_cb)(pnet_t *net, void *arg, uint32_t arep, pnet_result_t *result);
+    int (*release_cb)(pnet_t *net, void *arg, uint32_t arep, pnet_result_t *result);
+    int (*dcontrol_cb)(pnet_t *net, void *arg, uint32_t arep,
+                       pnet_control_command_t command, pnet_result_t *result);
+    int (*ccontrol_cb)(pnet_t *net, void *arg, uint32_t arep, pnet_result_t *result);
+    int (*read_cb)(pnet_t *net, void *arg, uint32_t arep, uint32_t api,
+                   uint16_t slot, uint16_t subslot, uint16_t idx, uint16_t seq,
+                   uint8_t **data, uint16_t *length, pnet_result_t *result);
+    int (*write_cb)(pnet_t *net, void *arg, uint32_t arep, uint32_t api,
+                    uint16_t slot, uint16_t subslot, uint16_t idx, uint16_t seq,
+                    uint16_t length, const uint8_t *data, pnet_result_t *result);
+    int (*exp_module_cb)(pnet_t *net, void *arg, uint32_t api, uint16_t slot,
+                         uint32_t module_ident);
+    int (*exp_submodule_cb)(pnet_t *net, void *arg, uint32_t api, uint16_t slot,
+                            uint16_t subslot, uint32_t module_ident,
+                            uint32_t submodule_ident, const pnet_data_cfg_t *exp_data_cfg);
+    int (*new_data_status_cb)(pnet_t *net, void *arg, uint32_t arep, uint32_t crep,
+                              uint8_t changes, uint8_t data_status);
+    int (*alarm_ind_cb)(pnet_t *net, void *arg, uint32_t arep,
+                        const pnet_alarm_argument_t *alarm_arg, uint16_t data_len,
+                        uint16_t data_usi, const uint8_t *data);
+    int (*alarm_cnf_cb)(pnet_t *net, void *arg, uint32_t arep, const pnet_pnio_status_t *status);
+    int (*alarm_ack_cnf_cb)(pnet_t *net, void *arg, uint32_t arep, int res);
+    int (*reset_cb)(pnet_t *net, void *arg, bool should_reset_application, uint16_t reset_mode);
+    int (*signal_led_cb)(pnet_t *net, void *arg, bool led_state);
+
+    void *cb_arg;
+    pnet_if_cfg_t if_cfg;
+} pnet_cfg_t;
+
+pnet_t *pnet_init(const pnet_cfg_t *cfg);
+void pnet_handle_periodic(pnet_t *net);
+
+int pnet_plug_module(pnet_t *net, uint32_t api, uint16_t slot, uint32_t module_ident);
+int pnet_plug_submodule(pnet_t *net, uint32_t api, uint16_t slot, uint16_t subslot,
+                        uint32_t module_ident, uint32_t submodule_ident,
+                        pnet_submodule_dir_t direction, uint16_t length_input,
+                        uint16_t length_output);
+
+int pnet_input_set_data_and_iops(pnet_t *net, uint32_t api, uint16_t slot, uint16_t subslot,
+                                 const uint8_t *data, uint16_t size, uint8_t iops);
+int pnet_output_get_data_and_iops(pnet_t *net, uint32_t api, uint16_t slot, uint16_t subslot,
+                                  bool *new_flag, uint8_t *data, uint16_t *length,
+                                  uint8_t *iops);
+
+int pnet_alarm_send_process_alarm(pnet_t *net, uint32_t arep, uint32_t api,
+                                  uint16_t slot, uint16_t subslot, uint16_t usi,
+                                  uint16_t length, const uint8_t *data);
+
+#endif /* PNET_API_H */